@@ -0,0 +1,148 @@
+#include "latency-histogram.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <cmath>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LatencyHistogram");
+
+LatencyHistogram::LatencyHistogram(uint8_t precision)
+    : m_precision(precision)
+{
+    NS_LOG_FUNCTION(this << (uint32_t)precision);
+    NS_ASSERT_MSG(precision >= 2 && precision <= 16, "precision out of range");
+    Reset();
+}
+
+void
+LatencyHistogram::Record(Time latency)
+{
+    int64_t steps = latency.GetTimeStep();
+    uint64_t value = steps > 0 ? steps : 0;
+    uint32_t index = GetIndex(value);
+    if (index >= m_counts.size())
+    {
+        m_counts.resize(index + 1, 0);
+    }
+    m_counts[index]++;
+    if (m_count == 0 || value < m_min)
+    {
+        m_min = value;
+    }
+    if (value > m_max)
+    {
+        m_max = value;
+    }
+    m_count++;
+    m_sum += value;
+}
+
+void
+LatencyHistogram::Reset()
+{
+    NS_LOG_FUNCTION(this);
+    m_counts.assign(1u << m_precision, 0);
+    m_count = 0;
+    m_min = 0;
+    m_max = 0;
+    m_sum = 0;
+}
+
+uint64_t
+LatencyHistogram::GetCount() const
+{
+    return m_count;
+}
+
+Time
+LatencyHistogram::GetMin() const
+{
+    return TimeStep(m_min);
+}
+
+Time
+LatencyHistogram::GetMax() const
+{
+    return TimeStep(m_max);
+}
+
+Time
+LatencyHistogram::GetMean() const
+{
+    if (m_count == 0)
+    {
+        return Time();
+    }
+    return TimeStep(std::llround(m_sum / m_count));
+}
+
+Time
+LatencyHistogram::GetPercentile(double percentile) const
+{
+    NS_ASSERT_MSG(percentile >= 0 && percentile <= 100, "percentile out of range");
+    if (m_count == 0)
+    {
+        return Time();
+    }
+    uint64_t rank = std::ceil(percentile / 100 * m_count);
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (uint32_t index = 0; index < m_counts.size(); ++index)
+    {
+        seen += m_counts[index];
+        if (seen >= rank)
+        {
+            uint64_t value = GetHighestValue(index);
+            return TimeStep(value < m_max ? value : m_max);
+        }
+    }
+    return TimeStep(m_max);
+}
+
+void
+LatencyHistogram::Print(std::ostream& os) const
+{
+    os << "count=" << m_count << " mean=" << GetMean() << " p50=" << GetPercentile(50)
+       << " p99=" << GetPercentile(99) << " p99.9=" << GetPercentile(99.9) << " max=" << GetMax();
+}
+
+uint32_t
+LatencyHistogram::GetIndex(uint64_t value) const
+{
+    if (value < (1u << m_precision))
+    {
+        return value;
+    }
+    // the values of a power of two share 2^(precision - 1) buckets
+    uint32_t msb = 63 - __builtin_clzll(value);
+    uint32_t shift = msb - m_precision + 1;
+    return (shift << (m_precision - 1)) + (value >> shift);
+}
+
+uint64_t
+LatencyHistogram::GetHighestValue(uint32_t index) const
+{
+    if (index < (1u << m_precision))
+    {
+        return index;
+    }
+    uint32_t shift = (index >> (m_precision - 1)) - 1;
+    uint64_t sub = index - (shift << (m_precision - 1));
+    return (sub << shift) + ((uint64_t(1) << shift) - 1);
+}
+
+std::ostream&
+operator<<(std::ostream& os, const LatencyHistogram& histogram)
+{
+    histogram.Print(os);
+    return os;
+}
+
+} // namespace ns3
@@ -0,0 +1,97 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include "ns3/nstime.h"
+
+#include <ostream>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup applications
+ *
+ * \brief A histogram of latencies with a bounded relative error.
+ *
+ * Latencies are counted in log-linear buckets, in the manner of HDR
+ * histograms: values below 2^precision time steps get a bucket each, and
+ * every power of two above is split in 2^(precision - 1) buckets. A
+ * percentile is thus known within a relative error of 2^(1 - precision)
+ * whatever the range of the latencies, recording costs a few integer
+ * operations and the memory used only grows with the log of the largest
+ * latency.
+ */
+class LatencyHistogram
+{
+  public:
+    /**
+     * \param precision log2 of the number of buckets below the first
+     *        power of two split, between 2 and 16
+     */
+    LatencyHistogram(uint8_t precision = 8);
+
+    /**
+     * \brief Count one latency
+     * \param latency the latency, negative ones are counted as zero
+     */
+    void Record(Time latency);
+
+    /// \brief Forget every latency
+    void Reset();
+
+    /// \return the number of latencies recorded
+    uint64_t GetCount() const;
+    /// \return the smallest latency recorded, zero if none
+    Time GetMin() const;
+    /// \return the largest latency recorded, zero if none
+    Time GetMax() const;
+    /// \return the mean of the latencies recorded, exact, zero if none
+    Time GetMean() const;
+
+    /**
+     * \param percentile between 0 and 100
+     * \return the smallest latency that percentile of the latencies
+     *         recorded are equal to or below, up to the precision of the
+     *         histogram, zero if none were recorded
+     */
+    Time GetPercentile(double percentile) const;
+
+    /**
+     * \brief Print count, mean, p50, p99, p99.9 and max on one line
+     * \param os the output stream
+     */
+    void Print(std::ostream& os) const;
+
+  private:
+    /**
+     * \param value a latency in time steps
+     * \return the index of its bucket
+     */
+    uint32_t GetIndex(uint64_t value) const;
+    /**
+     * \param index the index of a bucket
+     * \return the largest value counted in the bucket
+     */
+    uint64_t GetHighestValue(uint32_t index) const;
+
+    uint8_t m_precision;            //!< log2 of the number of buckets of unit width
+    std::vector<uint64_t> m_counts; //!< count of each bucket, grown on demand
+    uint64_t m_count;               //!< number of latencies recorded
+    uint64_t m_min;                 //!< smallest latency in time steps
+    uint64_t m_max;                 //!< largest latency in time steps
+    long double m_sum;              //!< sum of the latencies in time steps
+};
+
+/**
+ * \brief Stream insertion operator.
+ * \param os the stream
+ * \param histogram the histogram
+ * \returns a reference to the stream
+ */
+std::ostream& operator<<(std::ostream& os, const LatencyHistogram& histogram);
+
+} // namespace ns3
+
+#endif /* LATENCY_HISTOGRAM_H */
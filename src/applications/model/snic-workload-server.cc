@@ -1,5 +1,6 @@
 #include "snic-workload-server.h"
 
+#include "ns3/abort.h"
 #include "ns3/address-utils.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/inet6-socket-address.h"
@@ -12,6 +13,7 @@
 #include "ns3/snic-socket.h"
 #include "ns3/socket-factory.h"
 #include "ns3/socket.h"
+#include "ns3/string.h"
 #include "ns3/uinteger.h"
 
 namespace ns3
@@ -34,6 +36,18 @@ SnicWorkloadServer::GetTypeId()
                           UintegerValue(9),
                           MakeUintegerAccessor(&SnicWorkloadServer::m_port),
                           MakeUintegerChecker<uint16_t>())
+            .AddAttribute("SampleFile",
+                          "Binary file every latency is written to, as a host order int64 "
+                          "of nanoseconds. Empty for none, only the histogram is kept.",
+                          StringValue(""),
+                          MakeStringAccessor(&SnicWorkloadServer::m_sampleFileName),
+                          MakeStringChecker())
+            .AddAttribute("SampleBufferSize",
+                          "Latencies buffered in memory before they are written to the "
+                          "SampleFile.",
+                          UintegerValue(65536),
+                          MakeUintegerAccessor(&SnicWorkloadServer::m_sampleBufferSize),
+                          MakeUintegerChecker<uint32_t>(1))
             .AddTraceSource("Rx",
                             "A packet has been received",
                             MakeTraceSourceAccessor(&SnicWorkloadServer::m_rxTrace),
@@ -63,7 +77,7 @@ SnicWorkloadServer::Reset()
 {
     NS_LOG_FUNCTION_NOARGS();
     m_numReceived = 0;
-    m_uids.clear();
+    m_latencies.Reset();
 }
 
 void
@@ -73,6 +87,18 @@ SnicWorkloadServer::SetOutputFile(std::string name)
     m_outputFileName = name;
 }
 
+uint64_t
+SnicWorkloadServer::GetNumReceived() const
+{
+    return m_numReceived;
+}
+
+const LatencyHistogram&
+SnicWorkloadServer::GetLatencyHistogram() const
+{
+    return m_latencies;
+}
+
 void
 SnicWorkloadServer::DoDispose()
 {
@@ -135,10 +161,11 @@ SnicWorkloadServer::StartApplication()
 
     m_socket->SetRecvCallback(MakeCallback(&SnicWorkloadServer::HandleRead, this));
     m_socket6->SetRecvCallback(MakeCallback(&SnicWorkloadServer::HandleRead, this));
-    if (m_outputFileName != "")
+    if (m_sampleFileName != "")
     {
-        std::cout << m_outputFileName << std::endl;
-        m_outputFile.open(m_outputFileName, std::ofstream::app);
+        m_sampleFile.open(m_sampleFileName, std::ofstream::binary | std::ofstream::trunc);
+        NS_ABORT_MSG_IF(!m_sampleFile, "cannot open " << m_sampleFileName);
+        m_samples.reserve(m_sampleBufferSize);
     }
 }
 
@@ -147,9 +174,21 @@ SnicWorkloadServer::StopApplication()
 {
     NS_LOG_FUNCTION(this);
 
+    if (m_sampleFile.is_open())
+    {
+        FlushSamples();
+        m_sampleFile.close();
+    }
+    NS_LOG_INFO("latencies: " << m_latencies);
     if (m_outputFileName != "")
     {
-        m_outputFile.close();
+        std::ofstream outputFile(m_outputFileName, std::ofstream::app);
+        outputFile << "count:" << m_latencies.GetCount() << "\n"
+                   << "mean:" << m_latencies.GetMean() << "\n"
+                   << "p50:" << m_latencies.GetPercentile(50) << "\n"
+                   << "p99:" << m_latencies.GetPercentile(99) << "\n"
+                   << "p99.9:" << m_latencies.GetPercentile(99.9) << "\n"
+                   << "max:" << m_latencies.GetMax() << "\n";
     }
 
     if (m_socket)
@@ -183,42 +222,24 @@ SnicWorkloadServer::HandleRead(Ptr<Socket> socket)
                                    << packet->GetSize() << " bytes from "
                                    << InetSocketAddress::ConvertFrom(from).GetIpv4() << " port "
                                    << InetSocketAddress::ConvertFrom(from).GetPort());
-            uint32_t uid = packet->GetUid();
             Time currentTime = Simulator::Now();
-            Time latency;
             if (m_numReceived != 0)
             {
-                latency = currentTime - m_lastPacket;
-                NS_LOG_INFO("lat: " << latency << " " << packet->GetSize());
-                m_outputFile << latency << std::endl;
-                m_lastTimes.push(latency);
-                m_avgTotal += latency;
+                Time latency = currentTime - m_lastPacket;
+                NS_LOG_LOGIC("lat: " << latency << " " << packet->GetSize());
+                m_latencies.Record(latency);
+                if (m_sampleFile.is_open())
+                {
+                    m_samples.push_back(latency.GetNanoSeconds());
+                    if (m_samples.size() == m_sampleBufferSize)
+                    {
+                        FlushSamples();
+                    }
+                }
             }
             m_lastPacket = currentTime;
-            NS_LOG_INFO("cur time: " << currentTime.GetNanoSeconds());
-            // m_avgInterval += latency;
             m_numReceived++;
-
-            if (m_numReceived > 10)
-            {
-                uint32_t packetSize = packet->GetSize();
-                m_avgTotal -= m_lastTimes.front();
-                m_lastTimes.pop();
-                m_avgInterval = m_avgTotal / m_lastTimes.size();
-                NS_LOG_INFO("avg lat(" << m_lastTimes.size() << "): " << m_avgInterval);
-                NS_LOG_INFO("pktsize " << packetSize);
-                NS_LOG_INFO("avg tput(5): " << (double)(packetSize * 8) /
-                                                   m_avgInterval.GetNanoSeconds());
-                NS_LOG_INFO("avg int(5): " << m_avgInterval);
-            }
-            NS_LOG_INFO("numReceived=" << m_numReceived << " uid:" << uid);
-            m_uids.push_back(uid);
-            std::ostringstream coll;
-            packet->Print(coll);
-            // NS_LOG_DEBUG("packet content is " << coll.str());
-            uint8_t buffer[10];
-            packet->CopyData((uint8_t*)&buffer, 5);
-            // NS_LOG_DEBUG("packet is " << buffer);
+            NS_LOG_LOGIC("numReceived=" << m_numReceived << " uid:" << packet->GetUid());
         }
         else if (Inet6SocketAddress::IsMatchingType(from))
         {
@@ -256,4 +277,13 @@ SnicWorkloadServer::HandleRead(Ptr<Socket> socket)
     //}
 }
 
+void
+SnicWorkloadServer::FlushSamples()
+{
+    NS_LOG_FUNCTION(this << m_samples.size());
+    m_sampleFile.write(reinterpret_cast<const char*>(m_samples.data()),
+                       m_samples.size() * sizeof(int64_t));
+    m_samples.clear();
+}
+
 } // Namespace ns3
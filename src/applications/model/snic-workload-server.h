@@ -4,11 +4,12 @@
 #include "ns3/address.h"
 #include "ns3/application.h"
 #include "ns3/event-id.h"
+#include "ns3/latency-histogram.h"
 #include "ns3/ptr.h"
 #include "ns3/traced-callback.h"
 
 #include <fstream>
-#include <queue>
+#include <vector>
 
 namespace ns3
 {
@@ -37,10 +38,20 @@ class SnicWorkloadServer : public Application
     static TypeId GetTypeId();
     SnicWorkloadServer();
     ~SnicWorkloadServer() override;
+    /// \brief Forget the packets received so far
     void Reset();
 
+    /**
+     * \brief Append a summary of the latencies to a text file when stopped
+     * \param name the file name, empty for none
+     */
     void SetOutputFile(std::string name);
 
+    /// \return the number of packets received
+    uint64_t GetNumReceived() const;
+    /// \return the histogram of the time between two received packets
+    const LatencyHistogram& GetLatencyHistogram() const;
+
   protected:
     void DoDispose() override;
 
@@ -57,20 +68,21 @@ class SnicWorkloadServer : public Application
      */
     void HandleRead(Ptr<Socket> socket);
 
+    /// \brief Write the buffered samples to the sample file
+    void FlushSamples();
+
     uint16_t m_port;       //!< Port on which we listen for incoming packets.
     Ptr<Socket> m_socket;  //!< IPv4 Socket
     Ptr<Socket> m_socket6; //!< IPv6 Socket
     Address m_local;       //!< local multicast address
-    // tmp stat variables
-    uint64_t m_numReceived = 0;
-    std::vector<uint32_t> m_uids;
-    Time m_avgInterval;
-    Time m_avgTotal;
-    Time m_lastPacket;
-    Time m_last5Packets;
-    std::queue<Time> m_lastTimes;
-    std::string m_outputFileName;
-    std::ofstream m_outputFile;
+    uint64_t m_numReceived = 0;     //!< packets received
+    Time m_lastPacket;              //!< time the last packet was received
+    LatencyHistogram m_latencies;   //!< time between two received packets
+    std::string m_outputFileName;   //!< text file the summary is appended to
+    std::string m_sampleFileName;   //!< binary file of every latency, empty for none
+    uint32_t m_sampleBufferSize;    //!< latencies buffered before a write
+    std::vector<int64_t> m_samples; //!< buffered latencies in nanoseconds
+    std::ofstream m_sampleFile;     //!< the open sample file
 
     /// Callbacks for tracing the packet Rx events
     TracedCallback<Ptr<const Packet>> m_rxTrace;
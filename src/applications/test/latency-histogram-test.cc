@@ -0,0 +1,99 @@
+#include "ns3/latency-histogram.h"
+#include "ns3/nstime.h"
+#include "ns3/test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Checks the percentiles of LatencyHistogram against the exact ones.
+ */
+class LatencyHistogramTestCase : public TestCase
+{
+  public:
+    LatencyHistogramTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+LatencyHistogramTestCase::LatencyHistogramTestCase()
+    : TestCase("Check the percentiles of LatencyHistogram")
+{
+}
+
+void
+LatencyHistogramTestCase::DoRun()
+{
+    LatencyHistogram histogram;
+    NS_TEST_ASSERT_MSG_EQ(histogram.GetPercentile(50), Time(), "empty histogram");
+
+    // below 2^precision time steps every value has its own bucket
+    for (int64_t ns = 100; ns >= 1; --ns)
+    {
+        histogram.Record(NanoSeconds(ns));
+    }
+    NS_TEST_ASSERT_MSG_EQ(histogram.GetCount(), 100, "wrong count");
+    NS_TEST_ASSERT_MSG_EQ(histogram.GetMin(), NanoSeconds(1), "wrong min");
+    NS_TEST_ASSERT_MSG_EQ(histogram.GetMax(), NanoSeconds(100), "wrong max");
+    NS_TEST_ASSERT_MSG_EQ(histogram.GetPercentile(0), NanoSeconds(1), "wrong p0");
+    NS_TEST_ASSERT_MSG_EQ(histogram.GetPercentile(50), NanoSeconds(50), "wrong p50");
+    NS_TEST_ASSERT_MSG_EQ(histogram.GetPercentile(99), NanoSeconds(99), "wrong p99");
+    NS_TEST_ASSERT_MSG_EQ(histogram.GetPercentile(100), NanoSeconds(100), "wrong p100");
+
+    // over many orders of magnitude, within the relative error
+    histogram.Reset();
+    NS_TEST_ASSERT_MSG_EQ(histogram.GetCount(), 0, "not reset");
+    std::vector<int64_t> values;
+    uint32_t x = 1;
+    long double sum = 0;
+    for (uint32_t i = 0; i < 100000; ++i)
+    {
+        x = x * 1103515245 + 12345;
+        int64_t value = std::exp((x >> 8) % 2000 / 100.0);
+        values.push_back(value);
+        sum += value;
+        histogram.Record(TimeStep(value));
+    }
+    std::sort(values.begin(), values.end());
+    NS_TEST_ASSERT_MSG_EQ(histogram.GetMax().GetTimeStep(), values.back(), "wrong max");
+    NS_TEST_ASSERT_MSG_EQ(histogram.GetMean().GetTimeStep(),
+                          std::llround(sum / values.size()),
+                          "wrong mean");
+    for (double percentile : {1.0, 25.0, 50.0, 90.0, 99.0, 99.9, 99.99})
+    {
+        int64_t exact = values[std::ceil(percentile / 100 * values.size()) - 1];
+        int64_t estimate = histogram.GetPercentile(percentile).GetTimeStep();
+        NS_TEST_ASSERT_MSG_GT_OR_EQ(estimate, exact, "p" << percentile << " too small");
+        NS_TEST_ASSERT_MSG_LT_OR_EQ(estimate - exact,
+                                    exact / 128,
+                                    "p" << percentile << " too large");
+    }
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief LatencyHistogram TestSuite
+ */
+class LatencyHistogramTestSuite : public TestSuite
+{
+  public:
+    LatencyHistogramTestSuite();
+};
+
+LatencyHistogramTestSuite::LatencyHistogramTestSuite()
+    : TestSuite("latency-histogram", UNIT)
+{
+    AddTestCase(new LatencyHistogramTestCase, TestCase::QUICK);
+}
+
+static LatencyHistogramTestSuite
+    g_latencyHistogramTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,169 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Microbenchmark of the forwarding table of the learning bridges.
+//
+// For each table size, learns that many addresses spread over --ports
+// ports, then does what a bridge does for every forwarded frame --lookups
+// times: learn the source and look up the destination, both drawn at random
+// among the learned addresses. Reports the lookups per second of
+// MacLearningTable and of the std::map of Ptr<NetDevice> the bridges used
+// before, which read the clock and copied a Ptr on every access.
+
+#include "ns3/bridge-module.h"
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("MacLearningTableBench");
+
+/// the table the bridges used before MacLearningTable
+class MapLearningTable
+{
+  public:
+    void Learn(Mac48Address source, Ptr<Object> port)
+    {
+        LearnedState& state = m_learnState[source];
+        state.associatedPort = port;
+        state.expirationTime = Simulator::Now() + Seconds(300);
+    }
+
+    Ptr<Object> GetLearnedState(Mac48Address source)
+    {
+        Time now = Simulator::Now();
+        std::map<Mac48Address, LearnedState>::iterator iter = m_learnState.find(source);
+        if (iter != m_learnState.end())
+        {
+            if (iter->second.expirationTime > now)
+            {
+                return iter->second.associatedPort;
+            }
+            m_learnState.erase(iter);
+        }
+        return nullptr;
+    }
+
+  private:
+    struct LearnedState
+    {
+        Ptr<Object> associatedPort;
+        Time expirationTime;
+    };
+
+    std::map<Mac48Address, LearnedState> m_learnState;
+};
+
+/// time every table size, from within the simulation as a bridge would
+static void
+RunBenchmark(std::string sizes, uint32_t numLookups, uint32_t numPorts)
+{
+    std::vector<Ptr<Object>> ports;
+    for (uint32_t i = 0; i < numPorts; ++i)
+    {
+        ports.push_back(CreateObject<Object>());
+    }
+    Ptr<UniformRandomVariable> pick = CreateObject<UniformRandomVariable>();
+    pick->SetStream(1);
+
+    std::cout << std::left << std::setw(12) << "addresses" << std::setw(20) << "map lookups/s"
+              << std::setw(20) << "table lookups/s"
+              << "speedup" << std::endl;
+
+    std::stringstream sizeList(sizes);
+    std::string size;
+    while (std::getline(sizeList, size, ','))
+    {
+        uint32_t numAddresses = std::stoul(size);
+        NS_ABORT_MSG_IF(numAddresses == 0, "need at least one address");
+        std::vector<Mac48Address> addresses;
+        for (uint32_t i = 0; i < numAddresses; ++i)
+        {
+            addresses.push_back(Mac48Address::Allocate());
+        }
+        // the same frames are replayed against both tables
+        std::vector<std::pair<uint32_t, uint32_t>> frames;
+        for (uint32_t i = 0; i < numLookups; ++i)
+        {
+            frames.emplace_back(pick->GetInteger(0, numAddresses - 1),
+                                pick->GetInteger(0, numAddresses - 1));
+        }
+
+        MapLearningTable map;
+        for (uint32_t i = 0; i < numAddresses; ++i)
+        {
+            map.Learn(addresses[i], ports[i % numPorts]);
+        }
+        uint32_t hits = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& frame : frames)
+        {
+            map.Learn(addresses[frame.first], ports[frame.first % numPorts]);
+            hits += map.GetLearnedState(addresses[frame.second]) != nullptr;
+        }
+        std::chrono::duration<double> mapElapsed = std::chrono::steady_clock::now() - start;
+        NS_ABORT_MSG_IF(hits != numLookups, "map lost addresses");
+
+        MacLearningTable table;
+        for (uint32_t i = 0; i < numAddresses; ++i)
+        {
+            table.Learn(addresses[i], i % numPorts, Simulator::Now());
+        }
+        hits = 0;
+        start = std::chrono::steady_clock::now();
+        for (const auto& frame : frames)
+        {
+            // a bridge reads the clock once per frame
+            Time now = Simulator::Now();
+            table.Learn(addresses[frame.first], frame.first % numPorts, now);
+            hits += table.Lookup(addresses[frame.second], now) != MacLearningTable::NO_PORT;
+        }
+        std::chrono::duration<double> tableElapsed = std::chrono::steady_clock::now() - start;
+        NS_ABORT_MSG_IF(hits != numLookups, "table lost addresses");
+
+        std::cout << std::left << std::setw(12) << numAddresses << std::setw(20)
+                  << numLookups / mapElapsed.count() << std::setw(20)
+                  << numLookups / tableElapsed.count()
+                  << mapElapsed.count() / tableElapsed.count() << std::endl;
+    }
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string sizes = "1000,10000,100000,1000000";
+    uint32_t numLookups = 2000000;
+    uint32_t numPorts = 8;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("sizes", "Comma separated numbers of learned addresses", sizes);
+    cmd.AddValue("lookups", "Learn and lookup pairs timed per table", numLookups);
+    cmd.AddValue("ports", "Number of ports the addresses are spread over", numPorts);
+    cmd.Parse(argc, argv);
+
+    NS_ABORT_MSG_IF(numPorts == 0, "need at least one port");
+
+    // Time values created before the simulation starts are tracked for
+    // resolution changes, so the tables are timed from within Run()
+    Simulator::ScheduleNow(&RunBenchmark, sizes, numLookups, numPorts);
+    Simulator::Run();
+    Simulator::Destroy();
+    return 0;
+}
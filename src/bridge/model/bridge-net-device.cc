@@ -58,7 +58,8 @@ BridgeNetDevice::GetTypeId()
             .AddAttribute("ExpirationTime",
                           "Time it takes for learned MAC state entry to expire.",
                           TimeValue(Seconds(300)),
-                          MakeTimeAccessor(&BridgeNetDevice::m_expirationTime),
+                          MakeTimeAccessor(&BridgeNetDevice::SetExpirationTime,
+                                           &BridgeNetDevice::GetExpirationTime),
                           MakeTimeChecker());
     return tid;
 }
@@ -86,6 +87,7 @@ BridgeNetDevice::DoDispose()
         *iter = nullptr;
     }
     m_ports.clear();
+    m_portIndex.clear();
     m_channel = nullptr;
     m_node = nullptr;
     NetDevice::DoDispose();
@@ -152,13 +154,20 @@ BridgeNetDevice::ForwardUnicast(Ptr<NetDevice> incomingPort,
                  << incomingPort->GetInstanceTypeId().GetName() << ", packet=" << packet
                  << ", protocol=" << protocol << ", src=" << src << ", dst=" << dst << ")");
 
-    Learn(src, incomingPort);
-    Ptr<NetDevice> outPort = GetLearnedState(dst);
-    if (outPort && outPort != incomingPort)
+    // one clock read and no reference counting for both table accesses
+    uint32_t inPort = GetPortIndex(incomingPort);
+    uint32_t outPort = MacLearningTable::NO_PORT;
+    if (m_enableLearning)
+    {
+        Time now = Simulator::Now();
+        m_learnTable.Learn(src, inPort, now);
+        outPort = m_learnTable.Lookup(dst, now);
+    }
+    if (outPort != MacLearningTable::NO_PORT && outPort != inPort)
     {
         NS_LOG_LOGIC("Learning bridge state says to use port `"
-                     << outPort->GetInstanceTypeId().GetName() << "'");
-        outPort->SendFrom(packet->Copy(), src, dst, protocol);
+                     << m_ports[outPort]->GetInstanceTypeId().GetName() << "'");
+        m_ports[outPort]->SendFrom(packet->Copy(), src, dst, protocol);
     }
     else
     {
@@ -214,9 +223,7 @@ BridgeNetDevice::Learn(Mac48Address source, Ptr<NetDevice> port)
     NS_LOG_FUNCTION_NOARGS();
     if (m_enableLearning)
     {
-        LearnedState& state = m_learnState[source];
-        state.associatedPort = port;
-        state.expirationTime = Simulator::Now() + m_expirationTime;
+        m_learnTable.Learn(source, GetPortIndex(port), Simulator::Now());
     }
 }
 
@@ -226,24 +233,39 @@ BridgeNetDevice::GetLearnedState(Mac48Address source)
     NS_LOG_FUNCTION_NOARGS();
     if (m_enableLearning)
     {
-        Time now = Simulator::Now();
-        std::map<Mac48Address, LearnedState>::iterator iter = m_learnState.find(source);
-        if (iter != m_learnState.end())
+        uint32_t port = m_learnTable.Lookup(source, Simulator::Now());
+        if (port != MacLearningTable::NO_PORT)
         {
-            LearnedState& state = iter->second;
-            if (state.expirationTime > now)
-            {
-                return state.associatedPort;
-            }
-            else
-            {
-                m_learnState.erase(iter);
-            }
+            return m_ports[port];
         }
     }
     return nullptr;
 }
 
+uint32_t
+BridgeNetDevice::GetPortIndex(const Ptr<NetDevice>& port) const
+{
+    auto it = m_portIndex.find(port);
+    if (it == m_portIndex.end())
+    {
+        NS_FATAL_ERROR("not a port of this bridge");
+    }
+    return it->second;
+}
+
+void
+BridgeNetDevice::SetExpirationTime(Time expirationTime)
+{
+    NS_LOG_FUNCTION(this << expirationTime);
+    m_learnTable.SetExpirationTime(expirationTime);
+}
+
+Time
+BridgeNetDevice::GetExpirationTime() const
+{
+    return m_learnTable.GetExpirationTime();
+}
+
 uint32_t
 BridgeNetDevice::GetNBridgePorts() const
 {
@@ -281,6 +303,7 @@ BridgeNetDevice::AddBridgePort(Ptr<NetDevice> bridgePort)
                                     0,
                                     bridgePort,
                                     true);
+    m_portIndex[bridgePort] = m_ports.size();
     m_ports.push_back(bridgePort);
     m_channel->AddChannel(bridgePort->GetChannel());
 }
@@ -18,6 +18,7 @@
 #define BRIDGE_NET_DEVICE_H
 
 #include "ns3/bridge-channel.h"
+#include "ns3/mac-learning-table.h"
 #include "ns3/mac48-address.h"
 #include "ns3/net-device.h"
 #include "ns3/nstime.h"
@@ -113,6 +114,18 @@ class BridgeNetDevice : public NetDevice
      */
     Ptr<NetDevice> GetBridgePort(uint32_t n) const;
 
+    /**
+     * \brief Sets the time it takes for a learned address to expire
+     * \param expirationTime the expiration time
+     */
+    void SetExpirationTime(Time expirationTime);
+
+    /**
+     * \brief Gets the time it takes for a learned address to expire
+     * \returns the expiration time
+     */
+    Time GetExpirationTime() const;
+
     // inherited from NetDevice base class.
     void SetIfIndex(const uint32_t index) override;
     uint32_t GetIfIndex() const override;
@@ -203,27 +216,23 @@ class BridgeNetDevice : public NetDevice
      */
     Ptr<NetDevice> GetLearnedState(Mac48Address source);
 
+    /**
+     * \brief Gets the index of a bridged port
+     * \param port the port
+     * \returns the index of the port in the bridged ports
+     */
+    uint32_t GetPortIndex(const Ptr<NetDevice>& port) const;
+
   private:
     NetDevice::ReceiveCallback m_rxCallback;               //!< receive callback
     NetDevice::PromiscReceiveCallback m_promiscRxCallback; //!< promiscuous receive callback
 
-    Mac48Address m_address; //!< MAC address of the NetDevice
-    Time m_expirationTime;  //!< time it takes for learned MAC state to expire
-
-    /**
-     * \ingroup bridge
-     * Structure holding the status of an address
-     */
-    struct LearnedState
-    {
-        Ptr<NetDevice> associatedPort; //!< port associated with the address
-        Time expirationTime;           //!< time it takes for learned MAC state to expire
-    };
-
-    std::map<Mac48Address, LearnedState> m_learnState; //!< Container for known address statuses
+    Mac48Address m_address;                            //!< MAC address of the NetDevice
+    MacLearningTable m_learnTable;                     //!< port index of the known addresses
     Ptr<Node> m_node;                                  //!< node owning this NetDevice
     Ptr<BridgeChannel> m_channel;                      //!< virtual bridged channel
     std::vector<Ptr<NetDevice>> m_ports;               //!< bridged ports
+    std::map<Ptr<NetDevice>, uint32_t> m_portIndex;    //!< index of each bridged port
     uint32_t m_ifIndex;                                //!< Interface index
     uint16_t m_mtu;                                    //!< MTU of the bridged NetDevice
     bool m_enableLearning; //!< true if the bridge will learn the node status
@@ -0,0 +1,202 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "mac-learning-table.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::MacLearningTable implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("MacLearningTable");
+
+/// log2 of the number of slots of an empty table
+static const uint32_t INITIAL_BITS = 4;
+
+MacLearningTable::MacLearningTable(Time expirationTime)
+    : m_expirationTime(expirationTime)
+{
+    NS_LOG_FUNCTION(this << expirationTime);
+    Clear();
+}
+
+void
+MacLearningTable::SetExpirationTime(Time expirationTime)
+{
+    NS_LOG_FUNCTION(this << expirationTime);
+    m_expirationTime = expirationTime;
+}
+
+Time
+MacLearningTable::GetExpirationTime() const
+{
+    return m_expirationTime;
+}
+
+void
+MacLearningTable::Learn(Mac48Address address, uint32_t port, Time now)
+{
+    NS_LOG_FUNCTION(this << address << port);
+    NS_ASSERT(port != NO_PORT);
+    uint64_t key = GetKey(address);
+    uint32_t slot = FindSlot(key);
+    if (m_slots[slot].key == EMPTY)
+    {
+        // keep at most half of the slots used so probe sequences stay short
+        if (2 * (m_size + 1) > m_slots.size())
+        {
+            Grow(now);
+            slot = FindSlot(key);
+        }
+        m_slots[slot].key = key;
+        m_size++;
+    }
+    m_slots[slot].port = port;
+    m_slots[slot].expires = now + m_expirationTime;
+}
+
+uint32_t
+MacLearningTable::Lookup(Mac48Address address, Time now)
+{
+    NS_LOG_FUNCTION(this << address);
+    uint32_t slot = FindSlot(GetKey(address));
+    if (m_slots[slot].key == EMPTY)
+    {
+        return NO_PORT;
+    }
+    if (m_slots[slot].expires <= now)
+    {
+        NS_LOG_LOGIC("entry of " << address << " expired");
+        Erase(slot);
+        return NO_PORT;
+    }
+    return m_slots[slot].port;
+}
+
+void
+MacLearningTable::Clear()
+{
+    NS_LOG_FUNCTION(this);
+    m_slots.assign(1u << INITIAL_BITS, Entry{EMPTY, NO_PORT, Time()});
+    m_size = 0;
+    m_shift = 64 - INITIAL_BITS;
+}
+
+uint32_t
+MacLearningTable::GetSize() const
+{
+    return m_size;
+}
+
+uint64_t
+MacLearningTable::GetKey(Mac48Address address)
+{
+    uint8_t buffer[6];
+    address.CopyTo(buffer);
+    uint64_t key = 0;
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        key = (key << 8) | buffer[i];
+    }
+    return key;
+}
+
+uint32_t
+MacLearningTable::GetHome(uint64_t key) const
+{
+    // fibonacci hashing, simulated addresses are mostly consecutive
+    return (key * 0x9e3779b97f4a7c15ULL) >> m_shift;
+}
+
+uint32_t
+MacLearningTable::FindSlot(uint64_t key) const
+{
+    uint32_t mask = m_slots.size() - 1;
+    uint32_t slot = GetHome(key);
+    while (m_slots[slot].key != EMPTY && m_slots[slot].key != key)
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void
+MacLearningTable::Erase(uint32_t slot)
+{
+    uint32_t mask = m_slots.size() - 1;
+    uint32_t hole = slot;
+    m_size--;
+
+    // backward shift deletion: move up every key of the probe sequence that
+    // would no longer be reachable through the hole
+    for (uint32_t next = (hole + 1) & mask; m_slots[next].key != EMPTY; next = (next + 1) & mask)
+    {
+        uint32_t home = GetHome(m_slots[next].key);
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            m_slots[hole] = m_slots[next];
+            hole = next;
+        }
+    }
+    m_slots[hole].key = EMPTY;
+}
+
+void
+MacLearningTable::Grow(Time now)
+{
+    uint32_t valid = 0;
+    for (const Entry& entry : m_slots)
+    {
+        if (entry.key != EMPTY && entry.expires > now)
+        {
+            valid++;
+        }
+    }
+    uint32_t bits = 64 - m_shift;
+    while (2 * (valid + 1) > (1u << bits))
+    {
+        bits++;
+    }
+    NS_LOG_LOGIC("dropping " << m_size - valid << " expired entries, " << (1u << bits)
+                             << " slots");
+    Rehash(bits, now);
+}
+
+void
+MacLearningTable::Rehash(uint32_t bits, Time now)
+{
+    NS_ASSERT_MSG(bits < 32, "table too large");
+    std::vector<Entry> old(1u << bits, Entry{EMPTY, NO_PORT, Time()});
+    old.swap(m_slots);
+    m_shift = 64 - bits;
+    m_size = 0;
+    for (const Entry& entry : old)
+    {
+        if (entry.key != EMPTY && entry.expires > now)
+        {
+            m_slots[FindSlot(entry.key)] = entry;
+            m_size++;
+        }
+    }
+}
+
+} // namespace ns3
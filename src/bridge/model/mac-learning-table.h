@@ -0,0 +1,138 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef MAC_LEARNING_TABLE_H
+#define MAC_LEARNING_TABLE_H
+
+#include "ns3/mac48-address.h"
+#include "ns3/nstime.h"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::MacLearningTable declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup bridge
+ * \brief The forwarding table of a learning bridge.
+ *
+ * Maps a MAC address to the index of the port it was last seen on. The
+ * table is an open-addressing hash table keyed by the 48 bits of the
+ * address, so learning and looking up a known address allocate nothing.
+ * Entries are aged lazily: an entry older than the expiration time is
+ * only removed when a lookup finds it, or when the table is about to grow.
+ *
+ * The table does not read the simulation clock, callers forwarding a frame
+ * read it once and pass it to both Learn() and Lookup().
+ */
+class MacLearningTable
+{
+  public:
+    /// Port index returned for an unknown or expired address
+    static constexpr uint32_t NO_PORT = 0xffffffff;
+
+    /**
+     * \param expirationTime time a learned address stays valid
+     */
+    MacLearningTable(Time expirationTime = Seconds(300));
+
+    /**
+     * \param expirationTime time a learned address stays valid, from the
+     *        last time it was learned
+     */
+    void SetExpirationTime(Time expirationTime);
+    /// \return the time a learned address stays valid
+    Time GetExpirationTime() const;
+
+    /**
+     * \brief Record the port an address is sending from
+     * \param address the source address
+     * \param port index of the port the address is sending from
+     * \param now the current time
+     */
+    void Learn(Mac48Address address, uint32_t port, Time now);
+
+    /**
+     * \param address the destination address
+     * \param now the current time
+     * \return the index of the port the address was learned on, or NO_PORT
+     *         if it is unknown or expired
+     */
+    uint32_t Lookup(Mac48Address address, Time now);
+
+    /// \brief Forget every address
+    void Clear();
+
+    /// \return the number of addresses in the table, expired ones included
+    uint32_t GetSize() const;
+
+  private:
+    static constexpr uint64_t EMPTY = ~uint64_t(0);
+
+    /// an address, as the low 48 bits of the key, and where it was seen
+    struct Entry
+    {
+        uint64_t key;  //!< the address, or EMPTY
+        uint32_t port; //!< index of the port
+        Time expires;  //!< time the entry stops being valid
+    };
+
+    /**
+     * \param address a MAC address
+     * \return the key of the address
+     */
+    static uint64_t GetKey(Mac48Address address);
+    /**
+     * \param key a key
+     * \return the slot the probe sequence of the key starts at
+     */
+    uint32_t GetHome(uint64_t key) const;
+    /**
+     * \param key a key
+     * \return the slot holding the key, or the empty slot it would go in
+     */
+    uint32_t FindSlot(uint64_t key) const;
+    /**
+     * \brief Empty a slot, keeping every other key reachable
+     * \param slot the slot to empty
+     */
+    void Erase(uint32_t slot);
+    /**
+     * \brief Drop the expired entries and double the table if still half full
+     * \param now the current time
+     */
+    void Grow(Time now);
+    /**
+     * \brief Reinsert the valid entries in a table of the given size
+     * \param bits log2 of the number of slots
+     * \param now the current time
+     */
+    void Rehash(uint32_t bits, Time now);
+
+    std::vector<Entry> m_slots; //!< the hash table
+    uint32_t m_size;            //!< number of used slots
+    uint32_t m_shift;           //!< 64 - log2(number of slots)
+    Time m_expirationTime;      //!< time a learned address stays valid
+};
+
+} // namespace ns3
+
+#endif /* MAC_LEARNING_TABLE_H */
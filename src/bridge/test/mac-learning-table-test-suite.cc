@@ -0,0 +1,120 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/mac-learning-table.h"
+#include "ns3/mac48-address.h"
+#include "ns3/nstime.h"
+#include "ns3/test.h"
+
+#include <map>
+
+namespace ns3
+{
+
+/**
+ * \ingroup bridge
+ * \defgroup bridge-test Bridge module tests
+ */
+
+/**
+ * \ingroup bridge-test
+ * \ingroup tests
+ *
+ * \brief MacLearningTable: forwarding table of BridgeNetDevice and SnicNetDevice
+ */
+class MacLearningTableTestCase : public TestCase
+{
+  public:
+    MacLearningTableTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+MacLearningTableTestCase::MacLearningTableTestCase()
+    : TestCase("MAC learning table")
+{
+}
+
+void
+MacLearningTableTestCase::DoRun()
+{
+    MacLearningTable table(MilliSeconds(10));
+    Mac48Address a("00:00:00:00:00:01");
+    Mac48Address b("00:00:00:00:00:02");
+    NS_TEST_ASSERT_MSG_EQ(table.Lookup(a, Seconds(0)), MacLearningTable::NO_PORT, "not learned");
+    table.Learn(a, 1, Seconds(0));
+    table.Learn(b, 2, Seconds(0));
+    NS_TEST_ASSERT_MSG_EQ(table.Lookup(a, MilliSeconds(5)), 1, "wrong port");
+    // learning again moves the address and restarts its aging
+    table.Learn(a, 3, MilliSeconds(5));
+    NS_TEST_ASSERT_MSG_EQ(table.Lookup(a, MilliSeconds(14)), 3, "address did not move");
+    NS_TEST_ASSERT_MSG_EQ(table.GetSize(), 2, "expired entry removed before a lookup");
+    NS_TEST_ASSERT_MSG_EQ(table.Lookup(b, MilliSeconds(10)), MacLearningTable::NO_PORT,
+                          "address not expired");
+    NS_TEST_ASSERT_MSG_EQ(table.GetSize(), 1, "expired entry left behind");
+
+    // against a plain model, with addresses colliding in the hash table and
+    // the table growing and dropping expired entries
+    MacLearningTable big(MicroSeconds(500));
+    std::map<uint32_t, std::pair<uint32_t, Time>> model;
+    uint32_t x = 1;
+    for (uint32_t i = 0; i < 50000; ++i)
+    {
+        Time now = MicroSeconds(i / 10);
+        x = x * 1103515245 + 12345;
+        uint32_t id = (x >> 16) % 3000;
+        uint8_t buffer[6] = {0, 0, 0, uint8_t(id >> 16), uint8_t(id >> 8), uint8_t(id)};
+        Mac48Address address;
+        address.CopyFrom(buffer);
+        if (x & 0x80000000)
+        {
+            uint32_t port = x & 0xff;
+            big.Learn(address, port, now);
+            model[id] = std::make_pair(port, now + MicroSeconds(500));
+            continue;
+        }
+        uint32_t expected = MacLearningTable::NO_PORT;
+        auto iter = model.find(id);
+        if (iter != model.end() && iter->second.second > now)
+        {
+            expected = iter->second.first;
+        }
+        if (big.Lookup(address, now) != expected)
+        {
+            NS_TEST_ASSERT_MSG_EQ(big.Lookup(address, now), expected, "wrong port for " << id);
+            break;
+        }
+    }
+    NS_TEST_ASSERT_MSG_LT_OR_EQ(big.GetSize(), model.size(), "table larger than the model");
+}
+
+/**
+ * \ingroup bridge-test
+ * \ingroup tests
+ *
+ * \brief MacLearningTable test suite
+ */
+class MacLearningTableTestSuite : public TestSuite
+{
+  public:
+    MacLearningTableTestSuite()
+        : TestSuite("bridge-mac-learning-table", UNIT)
+    {
+        AddTestCase(new MacLearningTableTestCase, TestCase::QUICK);
+    }
+} g_macLearningTableTestSuite; ///< the test suite
+
+} // namespace ns3
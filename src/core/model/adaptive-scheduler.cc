@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2023 UCSD WukLab, San Diego, USA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "adaptive-scheduler.h"
+
+#include "assert.h"
+#include "dary-heap-scheduler.h"
+#include "double.h"
+#include "event-impl.h"
+#include "ladder-scheduler.h"
+#include "log.h"
+#include "object.h"
+#include "uinteger.h"
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::AdaptiveScheduler class.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("AdaptiveScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED(AdaptiveScheduler);
+
+TypeId
+AdaptiveScheduler::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::AdaptiveScheduler")
+            .SetParent<Scheduler>()
+            .SetGroupName("Core")
+            .AddConstructor<AdaptiveScheduler>()
+            .AddAttribute("Window",
+                          "The number of operations between two choices of the scheduler.",
+                          UintegerValue(8192),
+                          MakeUintegerAccessor(&AdaptiveScheduler::m_window),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("Threshold",
+                          "The mean number of events above which the ladder queue is used.",
+                          UintegerValue(10000),
+                          MakeUintegerAccessor(&AdaptiveScheduler::m_threshold),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("MaxSameTime",
+                          "The fraction of the events scheduled for the current time above "
+                          "which the heap is used.",
+                          DoubleValue(0.5),
+                          MakeDoubleAccessor(&AdaptiveScheduler::m_maxSameTime),
+                          MakeDoubleChecker<double>(0, 1));
+    return tid;
+}
+
+AdaptiveScheduler::AdaptiveScheduler()
+    : m_scheduler(CreateObject<DaryHeapScheduler>()),
+      m_ladder(false),
+      m_size(0),
+      m_now(0),
+      m_window(8192),
+      m_threshold(10000),
+      m_maxSameTime(0.5),
+      m_ops(0),
+      m_populationSum(0),
+      m_inserts(0),
+      m_sameTime(0),
+      m_nSwitches(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+AdaptiveScheduler::~AdaptiveScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+TypeId
+AdaptiveScheduler::GetSchedulerType() const
+{
+    return m_scheduler->GetInstanceTypeId();
+}
+
+uint32_t
+AdaptiveScheduler::GetNSwitches() const
+{
+    return m_nSwitches;
+}
+
+void
+AdaptiveScheduler::Sample()
+{
+    m_ops++;
+    m_populationSum += m_size;
+    if (m_ops < m_window)
+    {
+        return;
+    }
+    double population = static_cast<double>(m_populationSum) / m_ops;
+    double sameTime = m_inserts > 0 ? static_cast<double>(m_sameTime) / m_inserts : 0;
+    // the ladder is kept down to half the threshold, lest the scheduler
+    // switches back and forth around it
+    double threshold = m_ladder ? m_threshold / 2.0 : m_threshold;
+    bool ladder = population >= threshold && sameTime <= m_maxSameTime;
+    NS_LOG_LOGIC("population " << population << " same time " << sameTime);
+    if (ladder != m_ladder)
+    {
+        Switch(ladder);
+    }
+    m_ops = 0;
+    m_populationSum = 0;
+    m_inserts = 0;
+    m_sameTime = 0;
+}
+
+void
+AdaptiveScheduler::Switch(bool ladder)
+{
+    NS_LOG_FUNCTION(this << ladder);
+    Ptr<Scheduler> next;
+    if (ladder)
+    {
+        next = CreateObject<LadderScheduler>();
+    }
+    else
+    {
+        next = CreateObject<DaryHeapScheduler>();
+    }
+    while (!m_scheduler->IsEmpty())
+    {
+        next->Insert(m_scheduler->RemoveNext());
+    }
+    NS_LOG_INFO("moved " << m_size << " events from " << m_scheduler->GetInstanceTypeId()
+                         << " to " << next->GetInstanceTypeId());
+    m_scheduler = next;
+    m_ladder = ladder;
+    m_nSwitches++;
+}
+
+void
+AdaptiveScheduler::Insert(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    m_scheduler->Insert(ev);
+    m_size++;
+    m_inserts++;
+    if (ev.key.m_ts == m_now)
+    {
+        m_sameTime++;
+    }
+    Sample();
+}
+
+bool
+AdaptiveScheduler::IsEmpty() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_size == 0;
+}
+
+Scheduler::Event
+AdaptiveScheduler::PeekNext() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_scheduler->PeekNext();
+}
+
+Scheduler::Event
+AdaptiveScheduler::RemoveNext()
+{
+    NS_LOG_FUNCTION(this);
+    Event ev = m_scheduler->RemoveNext();
+    m_size--;
+    m_now = ev.key.m_ts;
+    Sample();
+    return ev;
+}
+
+void
+AdaptiveScheduler::Remove(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    m_scheduler->Remove(ev);
+    m_size--;
+    Sample();
+}
+
+} // namespace ns3
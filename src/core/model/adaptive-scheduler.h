@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2023 UCSD WukLab, San Diego, USA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ADAPTIVE_SCHEDULER_H
+#define ADAPTIVE_SCHEDULER_H
+
+#include "ptr.h"
+#include "scheduler.h"
+
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::AdaptiveScheduler class.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief an event scheduler choosing between a d-ary heap and a ladder queue
+ *
+ * This class holds the events in a DaryHeapScheduler or a
+ * LadderScheduler, and samples the events over windows of Window
+ * operations to pick the better one:
+ *
+ * - a heap costs a logarithm of the number of events, a ladder queue
+ *   a constant which is larger than that of a small heap: the ladder is
+ *   used while the mean number of events exceeds Threshold, and until it
+ *   drops below half of it;
+ * - a ladder queue cannot split the events of a single time step, which
+ *   it sorts one by one: the heap is used while more than MaxSameTime of
+ *   the events are scheduled for the current time.
+ *
+ * Switching moves every event to the other scheduler. Since both order
+ * the events in the same way, this does not change the simulation.
+ *
+ * \par Time Complexity
+ *
+ * That of the scheduler in use, plus the occasional switch, linear in
+ * the number of events and spread over at least one window.
+ *
+ * \par Memory Complexity
+ *
+ * That of the scheduler in use.
+ *
+ */
+class AdaptiveScheduler : public Scheduler
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    AdaptiveScheduler();
+    /** Destructor. */
+    ~AdaptiveScheduler() override;
+
+    // Inherited
+    void Insert(const Scheduler::Event& ev) override;
+    bool IsEmpty() const override;
+    Scheduler::Event PeekNext() const override;
+    Scheduler::Event RemoveNext() override;
+    void Remove(const Scheduler::Event& ev) override;
+
+    /**
+     * Get the type of the scheduler in use.
+     *
+     * \returns The TypeId of the scheduler holding the events.
+     */
+    TypeId GetSchedulerType() const;
+    /**
+     * Get the number of switches so far.
+     *
+     * \returns The number of times the events moved to the other scheduler.
+     */
+    uint32_t GetNSwitches() const;
+
+  private:
+    /** Count an operation, and choose the scheduler at the end of a window. */
+    void Sample();
+    /**
+     * Move the events to a scheduler of the other kind.
+     *
+     * \param [in] ladder Whether to move them to a ladder queue.
+     */
+    void Switch(bool ladder);
+
+    /** The scheduler holding the events. */
+    Ptr<Scheduler> m_scheduler;
+    /** Whether m_scheduler is a ladder queue. */
+    bool m_ladder;
+    /** The number of events. */
+    uint64_t m_size;
+    /** The time of the last event removed. */
+    uint64_t m_now;
+    /** The number of operations of a window. */
+    uint32_t m_window;
+    /** The mean number of events above which the ladder queue is used. */
+    uint32_t m_threshold;
+    /** The fraction of events for the current time above which the heap is used. */
+    double m_maxSameTime;
+    /** The operations of the window so far. */
+    uint32_t m_ops;
+    /** The sum of the number of events at each operation of the window. */
+    uint64_t m_populationSum;
+    /** The events inserted during the window. */
+    uint32_t m_inserts;
+    /** The events inserted for the current time during the window. */
+    uint32_t m_sameTime;
+    /** The number of switches. */
+    uint32_t m_nSwitches;
+
+}; // class AdaptiveScheduler
+
+} // namespace ns3
+
+#endif /* ADAPTIVE_SCHEDULER_H */
@@ -29,6 +29,8 @@
 
 #include <functional>
 #include <memory>
+#include <tuple>
+#include <type_traits>
 #include <typeinfo>
 #include <utility>
 #include <vector>
@@ -239,6 +241,11 @@ typedef std::vector<std::shared_ptr<CallbackComponentBase>> CallbackComponentVec
  * \ingroup callbackimpl
  * CallbackImpl class with varying numbers of argument types
  *
+ * This is the interface of the implementations of the Callbacks with a
+ * given signature. Each implementation, a CallbackFunctorImpl, stores the
+ * callable object and the bound arguments in place, and calls the former
+ * directly.
+ *
  * \tparam R \explicit The return type of the Callback.
  * \tparam UArgs \explicit The types of any arguments to the Callback.
  */
@@ -247,34 +254,24 @@ class CallbackImpl : public CallbackImplBase
 {
   public:
     /**
-     * Constructor.
-     *
-     * \param func the callable object
-     * \param components the callback components (callable object and bound arguments)
-     */
-    CallbackImpl(std::function<R(UArgs...)> func, const CallbackComponentVector& components)
-        : m_func(func),
-          m_components(components)
-    {
-    }
-
-    /**
-     * Get the stored function.
-     * \return A const reference to the stored function.
+     * Get a function calling this implementation.
+     * \return A function holding a reference to this implementation.
      */
-    const std::function<R(UArgs...)>& GetFunction() const
+    std::function<R(UArgs...)> GetFunction() const
     {
-        return m_func;
+        Ptr<const CallbackImpl> impl(this);
+        return [impl](UArgs... uargs) -> R { return (*impl)(std::forward<UArgs>(uargs)...); };
     }
 
     /**
      * Get the vector of callback components.
-     * \return A const reference to the vector of callback components.
+     *
+     * The components are built on demand, since they are only needed to
+     * compare callbacks.
+     *
+     * \return The callable object and the bound arguments.
      */
-    const CallbackComponentVector& GetComponents() const
-    {
-        return m_components;
-    }
+    virtual CallbackComponentVector GetComponents() const = 0;
 
     /**
      * Function call operator.
@@ -282,10 +279,7 @@ class CallbackImpl : public CallbackImplBase
      * \param uargs The arguments to the Callback.
      * \return Callback value
      */
-    R operator()(UArgs... uargs) const
-    {
-        return m_func(uargs...);
-    }
+    virtual R operator()(UArgs... uargs) const = 0;
 
     bool IsEqual(Ptr<const CallbackImplBase> other) const override
     {
@@ -297,25 +291,20 @@ class CallbackImpl : public CallbackImplBase
             return false;
         }
 
+        CallbackComponentVector components = GetComponents();
+        CallbackComponentVector otherComponents = otherDerived->GetComponents();
+
         // if the two callback implementations are made of a distinct number of
         // components, they are different
-        if (m_components.size() != otherDerived->GetComponents().size())
+        if (components.size() != otherComponents.size())
         {
             return false;
         }
 
-        // the two functions are equal if they compare equal or the shared pointers
-        // point to the same locations
-        if (!m_components.at(0)->IsEqual(otherDerived->GetComponents().at(0)) &&
-            m_components.at(0) != otherDerived->GetComponents().at(0))
+        // check if the components are equal one by one
+        for (std::size_t i = 0; i < components.size(); i++)
         {
-            return false;
-        }
-
-        // check if the remaining components are equal one by one
-        for (std::size_t i = 1; i < m_components.size(); i++)
-        {
-            if (!m_components.at(i)->IsEqual(otherDerived->GetComponents().at(i)))
+            if (!components.at(i)->IsEqual(otherComponents.at(i)))
             {
                 return false;
             }
@@ -347,13 +336,6 @@ class CallbackImpl : public CallbackImplBase
 
         return id;
     }
-
-  private:
-    /// Stores the callable object associated with this callback (as a lambda)
-    std::function<R(UArgs...)> m_func;
-
-    /// Stores the original callable object and the bound arguments, if any
-    std::vector<std::shared_ptr<CallbackComponentBase>> m_components;
 };
 
 /**
@@ -388,6 +370,112 @@ class CallbackBase
     Ptr<CallbackImplBase> m_impl; //!< the pimpl
 };
 
+/**
+ * \ingroup callbackimpl
+ * CallbackFunctorImpl class, declared for the partial specialization below.
+ *
+ * \tparam T \explicit The type of the callable object.
+ * \tparam R \explicit The return type of the Callback.
+ * \tparam BArgsTuple \explicit A std::tuple of the types of the bound arguments.
+ * \tparam UArgs \explicit The types of any arguments to the Callback.
+ */
+template <typename T, typename R, typename BArgsTuple, typename... UArgs>
+class CallbackFunctorImpl;
+
+/**
+ * \ingroup callbackimpl
+ * Implementation of a Callback, holding the callable object and the
+ * values of the bound arguments.
+ *
+ * Both are stored in this object, which is the only allocation of a
+ * Callback, and the callable object is called without going through a
+ * std::function. The callable object is a function pointer, a pointer
+ * to a member function, whose object is then the first bound argument,
+ * any other callable object such as a lambda, or a Callback to which
+ * arguments are bound.
+ *
+ * \tparam T \explicit The type of the callable object.
+ * \tparam R \explicit The return type of the Callback.
+ * \tparam BArgs \explicit The types of the bound arguments.
+ * \tparam UArgs \explicit The types of any arguments to the Callback.
+ */
+template <typename T, typename R, typename... BArgs, typename... UArgs>
+class CallbackFunctorImpl<T, R, std::tuple<BArgs...>, UArgs...> final
+    : public CallbackImpl<R, UArgs...>
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * \param func the callable object
+     * \param bargs the values of the bound arguments
+     */
+    CallbackFunctorImpl(T func, BArgs... bargs)
+        : m_func(std::move(func)),
+          m_bargs(std::move(bargs)...)
+    {
+    }
+
+    R operator()(UArgs... uargs) const override
+    {
+        return std::apply(
+            [this, &uargs...](const BArgs&... bargs) -> R {
+                if constexpr (std::is_invocable_v<T&, const BArgs&..., UArgs...>)
+                {
+                    return static_cast<R>(
+                        std::invoke(m_func, bargs..., std::forward<UArgs>(uargs)...));
+                }
+                else
+                {
+                    // the function takes a bound argument by rvalue reference:
+                    // pass it a copy, as std::function would
+                    return static_cast<R>(
+                        std::invoke(m_func, BArgs(bargs)..., std::forward<UArgs>(uargs)...));
+                }
+            },
+            m_bargs);
+    }
+
+    CallbackComponentVector GetComponents() const override
+    {
+        // The original function is comparable if it is a function pointer or
+        // a pointer to a member function or a pointer to a member data.
+        constexpr bool isComp =
+            std::is_function_v<std::remove_pointer_t<T>> || std::is_member_pointer_v<T>;
+
+        CallbackComponentVector components;
+        if constexpr (std::is_base_of_v<CallbackBase, T>)
+        {
+            // the components of the callback come first
+            components = static_cast<const CallbackImpl<R, BArgs..., UArgs...>*>(
+                             PeekPointer(m_func.GetImpl()))
+                             ->GetComponents();
+        }
+        else if constexpr (isComp)
+        {
+            components.push_back(std::make_shared<CallbackComponent<T>>(m_func));
+        }
+        else
+        {
+            // a callable object which cannot be compared is only equal to
+            // itself, as shared by the copies of the callback
+            components.push_back(std::make_shared<CallbackComponent<const void*>>(&m_func));
+        }
+        std::apply(
+            [&components](const BArgs&... bargs) {
+                (components.push_back(std::make_shared<CallbackComponent<BArgs>>(bargs)), ...);
+            },
+            m_bargs);
+        return components;
+    }
+
+  private:
+    /// The callable object, which may be a lambda with a mutable state
+    mutable T m_func;
+    /// The values of the bound arguments
+    std::tuple<BArgs...> m_bargs;
+};
+
 /**
  * \ingroup callback
  * \brief Callback template class
@@ -423,6 +511,10 @@ class CallbackBase
  *   - the pimpl idiom: the Callback class is passed around by
  *     value and delegates the crux of the work to its pimpl
  *     pointer.
+ *   - a single pimpl, CallbackFunctorImpl, holding the callable
+ *     object and the bound arguments in place, so that making a
+ *     Callback allocates once, copying it only increments a
+ *     reference count and invoking it makes one virtual call.
  *   - a reference list implementation to implement the Callback's
  *     value semantics.
  *
@@ -466,17 +558,13 @@ class Callback : public CallbackBase
     template <typename... BArgs>
     Callback(const CallbackBase& cb, BArgs... bargs)
     {
-        auto cbDerived =
-            static_cast<const CallbackImpl<R, BArgs..., UArgs...>*>(PeekPointer(cb.GetImpl()));
+        Callback<R, BArgs..., UArgs...> inner(Ptr<CallbackImpl<R, BArgs..., UArgs...>>(
+            static_cast<CallbackImpl<R, BArgs..., UArgs...>*>(PeekPointer(cb.GetImpl()))));
 
-        std::function<R(BArgs..., UArgs...)> f(cbDerived->GetFunction());
-
-        CallbackComponentVector components(cbDerived->GetComponents());
-        components.insert(components.end(), {std::make_shared<CallbackComponent<BArgs>>(bargs)...});
-
-        m_impl = Create<CallbackImpl<R, UArgs...>>(
-            [f, bargs...](UArgs... uargs) -> R { return f(bargs..., uargs...); },
-            components);
+        m_impl = Create<CallbackFunctorImpl<Callback<R, BArgs..., UArgs...>,
+                                            R,
+                                            std::tuple<BArgs...>,
+                                            UArgs...>>(std::move(inner), std::move(bargs)...);
     }
 
     /**
@@ -496,20 +584,9 @@ class Callback : public CallbackBase
               typename... BArgs>
     Callback(T func, BArgs... bargs)
     {
-        // store the function in a std::function object
-        std::function<R(BArgs..., UArgs...)> f(func);
-
-        // The original function is comparable if it is a function pointer or
-        // a pointer to a member function or a pointer to a member data.
-        constexpr bool isComp =
-            std::is_function_v<std::remove_pointer_t<T>> || std::is_member_pointer_v<T>;
-
-        CallbackComponentVector components({std::make_shared<CallbackComponent<T, isComp>>(func),
-                                            std::make_shared<CallbackComponent<BArgs>>(bargs)...});
-
-        m_impl = Create<CallbackImpl<R, UArgs...>>(
-            [f, bargs...](UArgs... uargs) -> R { return f(bargs..., uargs...); },
-            components);
+        m_impl = Create<CallbackFunctorImpl<T, R, std::tuple<BArgs...>, UArgs...>>(
+            std::move(func),
+            std::move(bargs)...);
     }
 
   private:
@@ -572,7 +649,7 @@ class Callback : public CallbackBase
      */
     R operator()(UArgs... uargs) const
     {
-        return (*(DoPeekImpl()))(uargs...);
+        return (*(DoPeekImpl()))(std::forward<UArgs>(uargs)...);
     }
 
     /**
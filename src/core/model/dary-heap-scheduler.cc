@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2023 UCSD WukLab, San Diego, USA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "dary-heap-scheduler.h"
+
+#include "abort.h"
+#include "assert.h"
+#include "event-impl.h"
+#include "log.h"
+#include "uinteger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::DaryHeapScheduler class.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("DaryHeapScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED(DaryHeapScheduler);
+
+/** The size of a cache line, the alignment of the key array. */
+static constexpr std::size_t CACHE_LINE = 64;
+
+static_assert(sizeof(Scheduler::EventKey) == 16, "the keys are expected to take 16 bytes");
+
+TypeId
+DaryHeapScheduler::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::DaryHeapScheduler")
+            .SetParent<Scheduler>()
+            .SetGroupName("Core")
+            .AddConstructor<DaryHeapScheduler>()
+            .AddAttribute("Arity",
+                          "The number of children of a node: with 4 or 8 they fill whole "
+                          "cache lines.",
+                          UintegerValue(4),
+                          MakeUintegerAccessor(&DaryHeapScheduler::SetArity,
+                                               &DaryHeapScheduler::GetArity),
+                          MakeUintegerChecker<uint32_t>(2, 16));
+    return tid;
+}
+
+DaryHeapScheduler::DaryHeapScheduler()
+    : m_keyArray(nullptr),
+      m_keys(nullptr),
+      m_impls(nullptr),
+      m_size(0),
+      m_capacity(0),
+      m_arity(4)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+DaryHeapScheduler::~DaryHeapScheduler()
+{
+    NS_LOG_FUNCTION(this);
+    Free();
+}
+
+void
+DaryHeapScheduler::SetArity(uint32_t arity)
+{
+    NS_LOG_FUNCTION(this << arity);
+    NS_ABORT_MSG_IF(m_size > 0, "the arity of a heap holding events cannot change");
+    // the root offset depends on the arity
+    Free();
+    m_arity = arity;
+}
+
+uint32_t
+DaryHeapScheduler::GetArity() const
+{
+    return m_arity;
+}
+
+void
+DaryHeapScheduler::Free()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_keyArray != nullptr)
+    {
+        ::operator delete(m_keyArray, std::align_val_t(CACHE_LINE));
+        delete[] m_impls;
+    }
+    m_keyArray = nullptr;
+    m_keys = nullptr;
+    m_impls = nullptr;
+    m_capacity = 0;
+}
+
+void
+DaryHeapScheduler::Reserve(std::size_t capacity)
+{
+    NS_LOG_FUNCTION(this << capacity);
+    NS_ASSERT(capacity >= m_size);
+    // the root is stored at Arity - 1 so that the first child of a node,
+    // at Arity * (i + 1), starts a cache line
+    std::size_t offset = m_arity - 1;
+    auto keyArray = static_cast<Scheduler::EventKey*>(
+        ::operator new((capacity + offset) * sizeof(Scheduler::EventKey),
+                       std::align_val_t(CACHE_LINE)));
+    auto impls = new EventImpl*[capacity];
+    if (m_size > 0)
+    {
+        std::memcpy(keyArray + offset, m_keys, m_size * sizeof(Scheduler::EventKey));
+        std::memcpy(impls, m_impls, m_size * sizeof(EventImpl*));
+    }
+    Free();
+    m_keyArray = keyArray;
+    m_keys = keyArray + offset;
+    m_impls = impls;
+    m_capacity = capacity;
+}
+
+void
+DaryHeapScheduler::SiftUp(std::size_t hole, const Scheduler::EventKey& key, EventImpl* impl)
+{
+    while (hole > 0)
+    {
+        std::size_t parent = (hole - 1) / m_arity;
+        if (!(key < m_keys[parent]))
+        {
+            break;
+        }
+        m_keys[hole] = m_keys[parent];
+        m_impls[hole] = m_impls[parent];
+        hole = parent;
+    }
+    m_keys[hole] = key;
+    m_impls[hole] = impl;
+}
+
+void
+DaryHeapScheduler::SiftDown(std::size_t hole, const Scheduler::EventKey& key, EventImpl* impl)
+{
+    while (true)
+    {
+        std::size_t first = m_arity * hole + 1;
+        if (first >= m_size)
+        {
+            break;
+        }
+        std::size_t last = std::min(first + m_arity, m_size);
+        std::size_t smallest = first;
+        for (std::size_t child = first + 1; child < last; ++child)
+        {
+            if (m_keys[child] < m_keys[smallest])
+            {
+                smallest = child;
+            }
+        }
+        if (!(m_keys[smallest] < key))
+        {
+            break;
+        }
+        m_keys[hole] = m_keys[smallest];
+        m_impls[hole] = m_impls[smallest];
+        hole = smallest;
+    }
+    m_keys[hole] = key;
+    m_impls[hole] = impl;
+}
+
+void
+DaryHeapScheduler::Insert(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    if (m_size == m_capacity)
+    {
+        Reserve(m_capacity == 0 ? 1024 : 2 * m_capacity);
+    }
+    m_size++;
+    SiftUp(m_size - 1, ev.key, ev.impl);
+}
+
+bool
+DaryHeapScheduler::IsEmpty() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_size == 0;
+}
+
+Scheduler::Event
+DaryHeapScheduler::PeekNext() const
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    return Event{m_impls[0], m_keys[0]};
+}
+
+Scheduler::Event
+DaryHeapScheduler::RemoveNext()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    Event next{m_impls[0], m_keys[0]};
+    m_size--;
+    if (m_size > 0)
+    {
+        SiftDown(0, m_keys[m_size], m_impls[m_size]);
+    }
+    return next;
+}
+
+void
+DaryHeapScheduler::Remove(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    std::size_t i = 0;
+    while (i < m_size && m_keys[i].m_uid != ev.key.m_uid)
+    {
+        ++i;
+    }
+    NS_ASSERT_MSG(i < m_size, "event " << ev.key.m_uid << " not found");
+    m_size--;
+    if (i == m_size)
+    {
+        return;
+    }
+    Scheduler::EventKey key = m_keys[m_size];
+    EventImpl* impl = m_impls[m_size];
+    if (i > 0 && key < m_keys[(i - 1) / m_arity])
+    {
+        SiftUp(i, key, impl);
+    }
+    else
+    {
+        SiftDown(i, key, impl);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2023 UCSD WukLab, San Diego, USA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DARY_HEAP_SCHEDULER_H
+#define DARY_HEAP_SCHEDULER_H
+
+#include "scheduler.h"
+
+#include <cstddef>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::DaryHeapScheduler class.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief a d-ary heap event scheduler
+ *
+ * This class implements a heap in which every node has Arity children,
+ * 4 by default. The 16-byte event keys are stored contiguously, apart
+ * from the event implementation pointers, in an array aligned on a
+ * cache line and shifted so that the children of a node start a line:
+ * with an arity of 4 they fill one cache line, with 8 two, and finding
+ * the smallest of them touches no other memory. The tree is also half
+ * (arity 4) or a third (arity 8) as deep as a binary heap.
+ *
+ * \par Time Complexity
+ *
+ * Operation    | Amortized %Time  | Reason
+ * :----------- | :--------------- | :-----
+ * Insert()     | Logarithmic      | Sift up
+ * IsEmpty()    | Constant         | Explicit queue size
+ * PeekNext()   | Constant         | Root of the heap
+ * Remove()     | Linear           | Search, then sift
+ * RemoveNext() | Logarithmic      | Sift down, Arity comparisons per level
+ *
+ * \par Memory Complexity
+ *
+ * Category  | Memory                           | Reason
+ * :-------- | :------------------------------- | :-----
+ * Overhead  | 6 x `sizeof (*)`<br/>(48 bytes)  | Arrays, size, capacity and arity
+ * Per Event | 0                                | Key and pointer stored in arrays
+ *
+ */
+class DaryHeapScheduler : public Scheduler
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    DaryHeapScheduler();
+    /** Destructor. */
+    ~DaryHeapScheduler() override;
+
+    // Inherited
+    void Insert(const Scheduler::Event& ev) override;
+    bool IsEmpty() const override;
+    Scheduler::Event PeekNext() const override;
+    Scheduler::Event RemoveNext() override;
+    void Remove(const Scheduler::Event& ev) override;
+
+  private:
+    /**
+     * Set the number of children of a node.
+     *
+     * \param [in] arity The number of children.
+     */
+    void SetArity(uint32_t arity);
+    /**
+     * Get the number of children of a node.
+     *
+     * \returns The number of children.
+     */
+    uint32_t GetArity() const;
+    /**
+     * Allocate the arrays for more events, keeping the ones stored.
+     *
+     * \param [in] capacity The number of events to make room for.
+     */
+    void Reserve(std::size_t capacity);
+    /** Free the arrays. */
+    void Free();
+    /**
+     * Move an event up from a free slot until its parent is smaller.
+     *
+     * \param [in] hole The free slot.
+     * \param [in] key The key of the event.
+     * \param [in] impl The implementation of the event.
+     */
+    void SiftUp(std::size_t hole, const Scheduler::EventKey& key, EventImpl* impl);
+    /**
+     * Move an event down from a free slot until its children are larger.
+     *
+     * \param [in] hole The free slot.
+     * \param [in] key The key of the event.
+     * \param [in] impl The implementation of the event.
+     */
+    void SiftDown(std::size_t hole, const Scheduler::EventKey& key, EventImpl* impl);
+
+    /** The allocated key array, aligned on a cache line. */
+    Scheduler::EventKey* m_keyArray;
+    /** The key of the root, Arity - 1 slots into the key array. */
+    Scheduler::EventKey* m_keys;
+    /** The event implementations, in the order of the keys. */
+    EventImpl** m_impls;
+    /** The number of events in the heap. */
+    std::size_t m_size;
+    /** The number of events the arrays can hold. */
+    std::size_t m_capacity;
+    /** The number of children of a node. */
+    uint32_t m_arity;
+
+}; // class DaryHeapScheduler
+
+} // namespace ns3
+
+#endif /* DARY_HEAP_SCHEDULER_H */
@@ -42,6 +42,9 @@ NS_LOG_COMPONENT_DEFINE("DefaultSimulatorImpl");
 
 NS_OBJECT_ENSURE_REGISTERED(DefaultSimulatorImpl);
 
+/** The number of slots of the ring of events from other threads, a power of two. */
+static constexpr uint64_t EVENTS_WITH_CONTEXT_SLOTS = 4096;
+
 TypeId
 DefaultSimulatorImpl::GetTypeId()
 {
@@ -53,6 +56,7 @@ DefaultSimulatorImpl::GetTypeId()
 }
 
 DefaultSimulatorImpl::DefaultSimulatorImpl()
+    : m_eventsWithContext(EVENTS_WITH_CONTEXT_SLOTS)
 {
     NS_LOG_FUNCTION(this);
     m_stop = false;
@@ -62,7 +66,13 @@ DefaultSimulatorImpl::DefaultSimulatorImpl()
     m_currentContext = Simulator::NO_CONTEXT;
     m_unscheduledEvents = 0;
     m_eventCount = 0;
-    m_eventsWithContextEmpty = true;
+    for (uint64_t i = 0; i < EVENTS_WITH_CONTEXT_SLOTS; ++i)
+    {
+        m_eventsWithContext[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    m_eventsWithContextTail.store(0, std::memory_order_relaxed);
+    m_eventsWithContextHead = 0;
+    m_eventsWithContextOverflowSize.store(0, std::memory_order_relaxed);
     m_mainThreadId = std::this_thread::get_id();
 }
 
@@ -156,22 +166,41 @@ DefaultSimulatorImpl::IsFinished() const
 void
 DefaultSimulatorImpl::ProcessEventsWithContext()
 {
-    if (m_eventsWithContextEmpty)
+    if (m_eventsWithContextHead == m_eventsWithContextTail.load(std::memory_order_relaxed))
     {
         return;
     }
 
-    // swap queues
-    EventsWithContext eventsWithContext;
-    {
-        std::unique_lock lock{m_eventsWithContextMutex};
-        m_eventsWithContext.swap(eventsWithContext);
-        m_eventsWithContextEmpty = true;
-    }
-    while (!eventsWithContext.empty())
+    // move the events in ticket order, up to the first one not yet written
+    while (true)
     {
-        EventWithContext event = eventsWithContext.front();
-        eventsWithContext.pop_front();
+        uint64_t ticket = m_eventsWithContextHead;
+        EventSlot& slot = m_eventsWithContext[ticket & (EVENTS_WITH_CONTEXT_SLOTS - 1)];
+        EventWithContext event;
+        if (slot.sequence.load(std::memory_order_acquire) == ticket + 1)
+        {
+            event = slot.event;
+        }
+        else if (m_eventsWithContextOverflowSize.load(std::memory_order_acquire) > 0)
+        {
+            std::unique_lock lock{m_eventsWithContextMutex};
+            auto it = m_eventsWithContextOverflow.find(ticket);
+            if (it == m_eventsWithContextOverflow.end())
+            {
+                break;
+            }
+            event = it->second;
+            m_eventsWithContextOverflow.erase(it);
+            m_eventsWithContextOverflowSize.fetch_sub(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            break;
+        }
+        // free the slot for the ticket of the next lap
+        slot.sequence.store(ticket + EVENTS_WITH_CONTEXT_SLOTS, std::memory_order_release);
+        m_eventsWithContextHead++;
+
         Scheduler::Event ev;
         ev.impl = event.event;
         ev.key.m_ts = m_currentTs + event.timestamp;
@@ -264,10 +293,19 @@ DefaultSimulatorImpl::ScheduleWithContext(uint32_t context, const Time& delay, E
         // Current time added in ProcessEventsWithContext()
         ev.timestamp = delay.GetTimeStep();
         ev.event = event;
+        uint64_t ticket = m_eventsWithContextTail.fetch_add(1, std::memory_order_relaxed);
+        EventSlot& slot = m_eventsWithContext[ticket & (EVENTS_WITH_CONTEXT_SLOTS - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) == ticket)
+        {
+            slot.event = ev;
+            slot.sequence.store(ticket + 1, std::memory_order_release);
+        }
+        else
         {
+            // the main thread has not taken the event of the previous lap yet
             std::unique_lock lock{m_eventsWithContextMutex};
-            m_eventsWithContext.push_back(ev);
-            m_eventsWithContextEmpty = false;
+            m_eventsWithContextOverflow[ticket] = ev;
+            m_eventsWithContextOverflowSize.fetch_add(1, std::memory_order_release);
         }
     }
 }
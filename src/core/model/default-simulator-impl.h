@@ -22,9 +22,12 @@
 
 #include "simulator-impl.h"
 
+#include <atomic>
 #include <list>
+#include <map>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 /**
  * \file
@@ -42,6 +45,16 @@ class Scheduler;
  * \ingroup simulator
  *
  * The default single process simulator implementation.
+ *
+ * Events scheduled with ScheduleWithContext() by other threads than the
+ * main one, like the readers of the emulation devices, go through a
+ * bounded ring which the producers share without locking: each claims a
+ * ticket with an atomic increment and writes the event in the slot of
+ * the ticket. The main thread moves every event ready in the ring to the
+ * scheduler after each event it runs, in ticket order. Should a slot
+ * still hold an event of the previous lap, its ticket goes to a map
+ * guarded by a mutex instead, so that the producers never wait and no
+ * event overtakes another from the same thread.
  */
 class DefaultSimulatorImpl : public SimulatorImpl
 {
@@ -96,16 +109,28 @@ class DefaultSimulatorImpl : public SimulatorImpl
         /** The event implementation. */
         EventImpl* event;
     };
-    /** Container type for the events from a different context. */
-    typedef std::list<struct EventWithContext> EventsWithContext;
-    /** The container of events from a different context. */
-    EventsWithContext m_eventsWithContext;
-    /**
-     * Flag \c true if all events with context have been moved to the
-     * primary event queue.
-     */
-    bool m_eventsWithContextEmpty;
-    /** Mutex to control access to the list of events with context. */
+    /** A slot of the ring of events from a different context. */
+    struct EventSlot
+    {
+        /**
+         * The ticket the slot is ready for, plus one once the event of
+         * the ticket is written.
+         */
+        std::atomic<uint64_t> sequence;
+        /** The event. */
+        EventWithContext event;
+    };
+    /** The ring of events from a different context. */
+    std::vector<EventSlot> m_eventsWithContext;
+    /** The ticket of the next event from a different context. */
+    alignas(64) std::atomic<uint64_t> m_eventsWithContextTail;
+    /** The ticket of the next event to move to the scheduler, main thread only. */
+    alignas(64) uint64_t m_eventsWithContextHead;
+    /** The events whose slot was not free, by ticket. */
+    std::map<uint64_t, EventWithContext> m_eventsWithContextOverflow;
+    /** The number of events in m_eventsWithContextOverflow. */
+    std::atomic<uint32_t> m_eventsWithContextOverflowSize;
+    /** Mutex to control access to m_eventsWithContextOverflow. */
     std::mutex m_eventsWithContextMutex;
 
     /** Container type for the events to run at Simulator::Destroy() */
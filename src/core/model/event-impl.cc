@@ -21,6 +21,8 @@
 
 #include "log.h"
 
+#include <new>
+
 /**
  * \file
  * \ingroup events
@@ -32,6 +34,67 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("EventImpl");
 
+namespace
+{
+
+/// Granularity of the size classes, which is also the alignment of new.
+constexpr std::size_t EVENT_POOL_GRANULARITY = 16;
+/// Number of size classes, the larger events always come from the heap.
+constexpr std::size_t EVENT_POOL_CLASSES = 16;
+/// Events kept in a free list at most, the others go back to the heap.
+constexpr uint32_t EVENT_POOL_MAX_LENGTH = 4096;
+
+/**
+ * \ingroup events
+ * The free lists of a thread.
+ *
+ * It has no destructor so that it stays usable while the other thread
+ * local and static objects are destroyed: the events they free then go
+ * back to the heap.
+ */
+struct EventPool
+{
+    void* heads[EVENT_POOL_CLASSES];     //!< first free event of each size class
+    uint32_t lengths[EVENT_POOL_CLASSES]; //!< length of each free list
+    uint64_t heapAllocations;             //!< number of events taken from the heap
+    bool registered;                      //!< whether the cleaner was constructed
+    bool destroyed;                       //!< whether the cleaner was destroyed
+};
+
+/** The free lists of the calling thread. */
+thread_local EventPool g_eventPool;
+
+/**
+ * \ingroup events
+ * Frees the events left in the free lists when its thread exits.
+ */
+struct EventPoolCleaner
+{
+    /** Destructor. */
+    ~EventPoolCleaner()
+    {
+        for (std::size_t c = 0; c < EVENT_POOL_CLASSES; ++c)
+        {
+            while (g_eventPool.heads[c] != nullptr)
+            {
+                void* p = g_eventPool.heads[c];
+                g_eventPool.heads[c] = *static_cast<void**>(p);
+                ::operator delete(p);
+            }
+            g_eventPool.lengths[c] = 0;
+        }
+        g_eventPool.destroyed = true;
+    }
+};
+
+/** The cleaner of the free lists of the calling thread. */
+thread_local EventPoolCleaner g_eventPoolCleaner;
+
+/** Whether the events are recycled. */
+bool g_eventPoolEnabled = true;
+
+} // unnamed namespace
+
 EventImpl::~EventImpl()
 {
     NS_LOG_FUNCTION(this);
@@ -67,4 +130,61 @@ EventImpl::IsCancelled()
     return m_cancel;
 }
 
+void*
+EventImpl::operator new(std::size_t size)
+{
+    // no logging: the logging itself may schedule events
+    std::size_t c = (size - 1) / EVENT_POOL_GRANULARITY;
+    if (c >= EVENT_POOL_CLASSES)
+    {
+        g_eventPool.heapAllocations++;
+        return ::operator new(size);
+    }
+    void* p = g_eventPool.heads[c];
+    if (g_eventPoolEnabled && p != nullptr)
+    {
+        g_eventPool.heads[c] = *static_cast<void**>(p);
+        g_eventPool.lengths[c]--;
+        return p;
+    }
+    // the whole size class, so that the memory may later be reused for
+    // any event of the class
+    g_eventPool.heapAllocations++;
+    return ::operator new((c + 1) * EVENT_POOL_GRANULARITY);
+}
+
+void
+EventImpl::operator delete(void* p, std::size_t size)
+{
+    std::size_t c = (size - 1) / EVENT_POOL_GRANULARITY;
+    if (!g_eventPoolEnabled || c >= EVENT_POOL_CLASSES || g_eventPool.destroyed ||
+        g_eventPool.lengths[c] >= EVENT_POOL_MAX_LENGTH)
+    {
+        ::operator delete(p);
+        return;
+    }
+    if (!g_eventPool.registered)
+    {
+        // constructs the cleaner of this thread
+        (void)&g_eventPoolCleaner;
+        g_eventPool.registered = true;
+    }
+    *static_cast<void**>(p) = g_eventPool.heads[c];
+    g_eventPool.heads[c] = p;
+    g_eventPool.lengths[c]++;
+}
+
+void
+EventImpl::SetPoolEnabled(bool enabled)
+{
+    // no logging: called by Simulator::GetImpl()
+    g_eventPoolEnabled = enabled;
+}
+
+uint64_t
+EventImpl::GetNHeapAllocations()
+{
+    return g_eventPool.heapAllocations;
+}
+
 } // namespace ns3
@@ -21,6 +21,7 @@
 
 #include "simple-ref-count.h"
 
+#include <cstddef>
 #include <stdint.h>
 
 /**
@@ -41,6 +42,12 @@ namespace ns3
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * Since an event is allocated for nearly every one scheduled, the
+ * small ones are recycled through free lists, one per size class and
+ * per thread, instead of going back to the heap. The
+ * \ref GlobalValueEventPoolEnabled "EventPoolEnabled" global value
+ * turns this off, so that memory checkers see every event.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -67,6 +74,37 @@ class EventImpl : public SimpleRefCount<EventImpl>
      */
     bool IsCancelled();
 
+    /**
+     * Allocate the memory of an event, from the free list of the calling
+     * thread when possible.
+     *
+     * \param [in] size The size of the event.
+     * \returns The memory of the event.
+     */
+    static void* operator new(std::size_t size);
+    /**
+     * Free the memory of an event, to the free list of the calling thread
+     * unless it is full or pooling is disabled.
+     *
+     * \param [in] p The memory of the event.
+     * \param [in] size The size of the event.
+     */
+    static void operator delete(void* p, std::size_t size);
+    /**
+     * Enable or disable the recycling of the events.
+     *
+     * Set from \ref GlobalValueEventPoolEnabled "EventPoolEnabled" when the
+     * simulator is created.
+     *
+     * \param [in] enabled Whether to recycle the events.
+     */
+    static void SetPoolEnabled(bool enabled);
+    /**
+     * \returns The number of times the calling thread took the memory of
+     * an event from the heap.
+     */
+    static uint64_t GetNHeapAllocations();
+
   protected:
     /**
      * Implementation for Invoke().
@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2023 UCSD WukLab, San Diego, USA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+
+#include "assert.h"
+#include "event-impl.h"
+#include "log.h"
+#include "uinteger.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::LadderScheduler class.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED(LadderScheduler);
+
+/** The maximum number of rungs, after which the buckets go to Bottom whatever their size. */
+static constexpr std::size_t MAX_RUNGS = 8;
+/** The maximum number of buckets of a rung. */
+static constexpr std::size_t MAX_BUCKETS = 1 << 16;
+
+TypeId
+LadderScheduler::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::LadderScheduler")
+            .SetParent<Scheduler>()
+            .SetGroupName("Core")
+            .AddConstructor<LadderScheduler>()
+            .AddAttribute("Threshold",
+                          "The number of events of a bucket, or of Bottom, above which they "
+                          "are spread on a new rung.",
+                          UintegerValue(50),
+                          MakeUintegerAccessor(&LadderScheduler::m_threshold),
+                          MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+LadderScheduler::LadderScheduler()
+    : m_topMin(std::numeric_limits<uint64_t>::max()),
+      m_topMax(0),
+      m_topStart(0),
+      m_rungs(MAX_RUNGS),
+      m_nRungs(0),
+      m_size(0),
+      m_threshold(50)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+LadderScheduler::~LadderScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+uint64_t
+LadderScheduler::CurrentStart(const Rung& rung)
+{
+    return rung.start + rung.current * rung.width;
+}
+
+void
+LadderScheduler::InsertInRung(Rung& rung, const Event& ev)
+{
+    std::size_t i = (ev.key.m_ts - rung.start) / rung.width;
+    NS_ASSERT(i >= rung.current && i < rung.buckets.size());
+    rung.buckets[i].push_back(ev);
+    rung.count++;
+}
+
+void
+LadderScheduler::AddRung(Bucket& events, uint64_t start, uint64_t range)
+{
+    NS_LOG_FUNCTION(this << events.size() << start << range);
+    NS_ASSERT(m_nRungs < MAX_RUNGS && range > 0);
+    Rung& rung = m_rungs[m_nRungs++];
+    uint64_t n = std::min<uint64_t>({events.size(), MAX_BUCKETS, range});
+    rung.width = range / n + (range % n != 0 ? 1 : 0);
+    rung.start = start;
+    rung.current = 0;
+    rung.count = 0;
+    rung.buckets.resize(range / rung.width + (range % rung.width != 0 ? 1 : 0));
+    for (const auto& ev : events)
+    {
+        InsertInRung(rung, ev);
+    }
+}
+
+void
+LadderScheduler::InsertInBottom(const Event& ev)
+{
+    auto it = std::upper_bound(m_bottom.begin(), m_bottom.end(), ev, std::greater<Event>());
+    m_bottom.insert(it, ev);
+    if (m_bottom.size() > m_threshold && m_nRungs < MAX_RUNGS)
+    {
+        // the events of Bottom come before the ladder, or Top
+        uint64_t end = m_nRungs > 0 ? CurrentStart(m_rungs[m_nRungs - 1]) : m_topStart;
+        uint64_t start = m_bottom.back().key.m_ts;
+        if (end - start > 1)
+        {
+            AddRung(m_bottom, start, end - start);
+            m_bottom.clear();
+        }
+    }
+}
+
+void
+LadderScheduler::FillBottom()
+{
+    while (m_bottom.empty() && m_size > 0)
+    {
+        if (m_nRungs == 0)
+        {
+            NS_ASSERT(!m_top.empty());
+            AddRung(m_top, m_topMin, m_topMax - m_topMin + 1);
+            m_top.clear();
+            const Rung& rung = m_rungs[0];
+            m_topStart = rung.start + rung.buckets.size() * rung.width;
+            continue;
+        }
+        Rung& rung = m_rungs[m_nRungs - 1];
+        if (rung.count == 0)
+        {
+            m_nRungs--;
+            continue;
+        }
+        while (rung.buckets[rung.current].empty())
+        {
+            rung.current++;
+        }
+        Bucket& bucket = rung.buckets[rung.current];
+        uint64_t start = CurrentStart(rung);
+        rung.current++;
+        rung.count -= bucket.size();
+        if (bucket.size() > m_threshold && rung.width > 1 && m_nRungs < MAX_RUNGS)
+        {
+            AddRung(bucket, start, rung.width);
+            bucket.clear();
+        }
+        else
+        {
+            // Bottom is empty: the bucket takes its memory
+            m_bottom.swap(bucket);
+            std::sort(m_bottom.begin(), m_bottom.end(), std::greater<Event>());
+        }
+    }
+}
+
+void
+LadderScheduler::RemoveFrom(Bucket& events, const Event& ev)
+{
+    auto it = std::find_if(events.begin(), events.end(), [&ev](const Event& e) {
+        return e.key.m_uid == ev.key.m_uid;
+    });
+    NS_ASSERT_MSG(it != events.end(), "event " << ev.key.m_uid << " not found");
+    *it = events.back();
+    events.pop_back();
+}
+
+void
+LadderScheduler::Insert(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    m_size++;
+    uint64_t ts = ev.key.m_ts;
+    if (ts >= m_topStart)
+    {
+        if (m_top.empty())
+        {
+            m_topMin = ts;
+            m_topMax = ts;
+        }
+        m_topMin = std::min(m_topMin, ts);
+        m_topMax = std::max(m_topMax, ts);
+        m_top.push_back(ev);
+    }
+    else
+    {
+        std::size_t i = 0;
+        while (i < m_nRungs && ts < CurrentStart(m_rungs[i]))
+        {
+            ++i;
+        }
+        if (i < m_nRungs)
+        {
+            InsertInRung(m_rungs[i], ev);
+        }
+        else
+        {
+            InsertInBottom(ev);
+        }
+    }
+    FillBottom();
+}
+
+bool
+LadderScheduler::IsEmpty() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_size == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext() const
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    return m_bottom.back();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    Event ev = m_bottom.back();
+    m_bottom.pop_back();
+    m_size--;
+    FillBottom();
+    return ev;
+}
+
+void
+LadderScheduler::Remove(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    m_size--;
+    // the event is where Insert() would put it now
+    uint64_t ts = ev.key.m_ts;
+    if (ts >= m_topStart)
+    {
+        RemoveFrom(m_top, ev);
+    }
+    else
+    {
+        std::size_t i = 0;
+        while (i < m_nRungs && ts < CurrentStart(m_rungs[i]))
+        {
+            ++i;
+        }
+        if (i < m_nRungs)
+        {
+            Rung& rung = m_rungs[i];
+            RemoveFrom(rung.buckets[(ts - rung.start) / rung.width], ev);
+            rung.count--;
+        }
+        else
+        {
+            auto it =
+                std::lower_bound(m_bottom.begin(), m_bottom.end(), ev, std::greater<Event>());
+            NS_ASSERT_MSG(it != m_bottom.end() && it->key.m_uid == ev.key.m_uid,
+                          "event " << ev.key.m_uid << " not found");
+            m_bottom.erase(it);
+        }
+    }
+    FillBottom();
+}
+
+} // namespace ns3
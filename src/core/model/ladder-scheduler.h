@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2023 UCSD WukLab, San Diego, USA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::LadderScheduler class.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This class implements the ladder queue of Tang, Goh and Thng
+ * ("Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation", ACM TOMACS, 2005). The events are kept in
+ * three tiers:
+ *
+ * - Top, an unsorted array of the events beyond the ladder, of which only
+ *   the earliest and latest times are tracked;
+ * - the ladder, a stack of rungs of buckets: when the ladder is empty the
+ *   events of Top are spread on a first rung with one bucket per event,
+ *   and a bucket holding more than Threshold events is spread in turn on
+ *   a new, finer rung below;
+ * - Bottom, a sorted array of the events of the earliest bucket, which
+ *   are the ones removed next.
+ *
+ * No tier is ever sorted but Bottom, which only holds the few events of
+ * one bucket, so the cost of an event does not depend on the number of
+ * events, however skewed their times are: a burst of events close in
+ * time merely makes for a deeper ladder. Only the events of a single
+ * time step, which no bucket can separate, fall back to sorted insertion
+ * in Bottom.
+ *
+ * \par Time Complexity
+ *
+ * Operation    | Amortized %Time  | Reason
+ * :----------- | :--------------- | :-----
+ * Insert()     | Constant         | Append to Top or to a bucket
+ * IsEmpty()    | Constant         | Explicit queue size
+ * PeekNext()   | Constant         | Last event of Bottom
+ * Remove()     | Linear           | Search in Top or in a bucket
+ * RemoveNext() | Constant         | Each event moves down a bounded number of tiers
+ *
+ * \par Memory Complexity
+ *
+ * Category  | Memory                           | Reason
+ * :-------- | :------------------------------- | :-----
+ * Overhead  | Bucket arrays of the rungs       | Kept from one rung to the next
+ * Per Event | 0                                | Events stored in `std::vector` directly
+ *
+ */
+class LadderScheduler : public Scheduler
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    LadderScheduler();
+    /** Destructor. */
+    ~LadderScheduler() override;
+
+    // Inherited
+    void Insert(const Scheduler::Event& ev) override;
+    bool IsEmpty() const override;
+    Scheduler::Event PeekNext() const override;
+    Scheduler::Event RemoveNext() override;
+    void Remove(const Scheduler::Event& ev) override;
+
+  private:
+    /** A bucket, holding the events of a time interval in no order. */
+    typedef std::vector<Scheduler::Event> Bucket;
+
+    /** A rung of the ladder, a series of buckets of the same width. */
+    struct Rung
+    {
+        uint64_t start;              //!< time of the start of the first bucket
+        uint64_t width;              //!< time interval of a bucket
+        std::size_t current;         //!< first bucket not yet moved down
+        std::size_t count;           //!< events in the buckets
+        std::vector<Bucket> buckets; //!< the buckets
+    };
+
+    /**
+     * Get the start of the first bucket of a rung not yet moved down:
+     * the rung holds the events from then on.
+     *
+     * \param [in] rung The rung.
+     * \returns The start of the current bucket.
+     */
+    static uint64_t CurrentStart(const Rung& rung);
+    /**
+     * Spread events on a new rung at the bottom of the ladder.
+     *
+     * \param [in] events The events.
+     * \param [in] start The time of the earliest event, or of the start of
+     *             the bucket holding them.
+     * \param [in] range The time interval covered by the events.
+     */
+    void AddRung(Bucket& events, uint64_t start, uint64_t range);
+    /**
+     * Put an event in its bucket of a rung.
+     *
+     * \param [in] rung The rung.
+     * \param [in] ev The event.
+     */
+    void InsertInRung(Rung& rung, const Scheduler::Event& ev);
+    /**
+     * Put an event in Bottom, at its place.
+     *
+     * \param [in] ev The event.
+     */
+    void InsertInBottom(const Scheduler::Event& ev);
+    /** Move the events of the earliest bucket to Bottom, if it is empty. */
+    void FillBottom();
+    /**
+     * Remove an event from an unsorted array.
+     *
+     * \param [in] events The array.
+     * \param [in] ev The event.
+     */
+    static void RemoveFrom(Bucket& events, const Scheduler::Event& ev);
+
+    /** The events beyond the ladder. */
+    Bucket m_top;
+    /** The time of the earliest event of Top. */
+    uint64_t m_topMin;
+    /** The time of the latest event of Top. */
+    uint64_t m_topMax;
+    /** The events from that time on go to Top. */
+    uint64_t m_topStart;
+    /** The rungs, only the first m_nRungs of which are in use. */
+    std::vector<Rung> m_rungs;
+    /** The number of rungs in use. */
+    std::size_t m_nRungs;
+    /** The earliest events, sorted latest first. */
+    Bucket m_bottom;
+    /** The number of events. */
+    std::size_t m_size;
+    /** The number of events of a bucket from which it gets its own rung. */
+    uint32_t m_threshold;
+
+}; // class LadderScheduler
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
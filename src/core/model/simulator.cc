@@ -19,6 +19,7 @@
 #include "simulator.h"
 
 #include "assert.h"
+#include "boolean.h"
 #include "des-metrics.h"
 #include "event-impl.h"
 #include "global-value.h"
@@ -80,6 +81,19 @@ static GlobalValue g_schedTypeImpl =
                 TypeIdValue(MapScheduler::GetTypeId()),
                 MakeTypeIdChecker());
 
+/**
+ * \ingroup events
+ * \anchor GlobalValueEventPoolEnabled
+ * Whether the events are recycled through per-thread free lists.
+ *
+ * Disabling it lets memory checkers follow every event.
+ */
+static GlobalValue g_eventPoolEnabled =
+    GlobalValue("EventPoolEnabled",
+                "Recycle the memory of the events instead of returning it to the heap",
+                BooleanValue(true),
+                MakeBooleanChecker());
+
 /**
  * \ingroup simulator
  * \brief Get the static SimulatorImpl instance.
@@ -122,6 +136,11 @@ GetImpl()
             factory.SetTypeId(s.Get());
             (*pimpl)->SetScheduler(factory);
         }
+        {
+            BooleanValue enabled;
+            g_eventPoolEnabled.GetValue(enabled);
+            EventImpl::SetPoolEnabled(enabled.Get());
+        }
 
         //
         // Note: we call LogSetTimePrinter _after_ creating the implementation
@@ -18,7 +18,12 @@
 #include "ns3/callback.h"
 #include "ns3/test.h"
 
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
 #include <stdint.h>
+#include <string>
 
 using namespace ns3;
 
@@ -1178,6 +1183,102 @@ MakeCallbackTemplatesTestCase::DoRun()
     that.CheckParentalRights();
 }
 
+/**
+ * \ingroup callback-tests
+ *
+ * Object with a reference count, target of the callbacks of
+ * CallbackStorageTestCase.
+ */
+class CallbackStorageTarget : public SimpleRefCount<CallbackStorageTarget>
+{
+  public:
+    /**
+     * Target function.
+     * \param a first argument
+     * \param b second argument
+     * \return the sum of the arguments
+     */
+    int Add(int a, int b) const
+    {
+        return a + b;
+    }
+};
+
+/**
+ * Target function taking a bound argument by const reference.
+ *
+ * \param prefix first argument
+ * \param s second argument
+ * \return the concatenation of the arguments
+ */
+std::string
+CallbackStorageConcat(const std::string& prefix, std::string s)
+{
+    return prefix + s;
+}
+
+/**
+ * \ingroup callback-tests
+ *
+ * Check that a Callback holds the callable object and the bound arguments,
+ * and that its copies share them.
+ */
+class CallbackStorageTestCase : public TestCase
+{
+  public:
+    CallbackStorageTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+CallbackStorageTestCase::CallbackStorageTestCase()
+    : TestCase("Check the storage of Callback copies and bound arguments")
+{
+}
+
+void
+CallbackStorageTestCase::DoRun()
+{
+    //
+    // Make sure that copies of a callback share its implementation.
+    //
+    Ptr<CallbackStorageTarget> target = Create<CallbackStorageTarget>();
+    Callback<int, int, int> add = MakeCallback(&CallbackStorageTarget::Add, target);
+    Callback<int, int, int> copy = add;
+    NS_TEST_ASSERT_MSG_EQ(PeekPointer(copy.GetImpl()),
+                          PeekPointer(add.GetImpl()),
+                          "Copy did not share the implementation");
+
+    //
+    // Make sure that a callback keeps the object of a member function alive.
+    //
+    CallbackStorageTarget* raw = PeekPointer(target);
+    target = nullptr;
+    NS_TEST_ASSERT_MSG_EQ(raw->GetReferenceCount(), 1, "Callback does not hold the object");
+    NS_TEST_ASSERT_MSG_EQ(copy(1, 2), 3, "Callback returned a wrong value");
+    add = Callback<int, int, int>();
+    NS_TEST_ASSERT_MSG_EQ(copy.Bind(3)(4), 7, "Bound callback returned a wrong value");
+
+    //
+    // Make sure that a mutable lambda keeps its state, shared by the copies.
+    //
+    Callback<int> counter([n = 0]() mutable { return ++n; });
+    Callback<int> counterCopy = counter;
+    counter();
+    NS_TEST_ASSERT_MSG_EQ(counterCopy(), 2, "Copy did not share the state of the lambda");
+
+    //
+    // Make sure that bound arguments are stored by value.
+    //
+    std::string prefix("bound ");
+    Callback<std::string, std::string> concat = MakeBoundCallback(&CallbackStorageConcat, prefix);
+    prefix = "changed ";
+    NS_TEST_ASSERT_MSG_EQ(concat("argument"),
+                          "bound argument",
+                          "Bound argument was not stored by value");
+}
+
 /**
  * \ingroup callback-tests
  *
@@ -1198,6 +1299,153 @@ CallbackTestSuite::CallbackTestSuite()
     AddTestCase(new CallbackEqualityTestCase, TestCase::QUICK);
     AddTestCase(new NullifyCallbackTestCase, TestCase::QUICK);
     AddTestCase(new MakeCallbackTemplatesTestCase, TestCase::QUICK);
+    AddTestCase(new CallbackStorageTestCase, TestCase::QUICK);
 }
 
 static CallbackTestSuite g_gallbackTestSuite; //!< Static variable for test initialization
+
+/**
+ * \ingroup callback-tests
+ *
+ * Performance test: measure the average cost of making, copying and
+ * invoking a Callback, against a std::function wrapping the same call.
+ */
+class CallbackCostTestCase : public TestCase
+{
+  public:
+    CallbackCostTestCase();
+
+    /**
+     * Target function, adding its argument to a sum.
+     * \param a an argument
+     * \return the argument
+     */
+    int Target(int a)
+    {
+        m_sum += a;
+        return a;
+    }
+
+  private:
+    void DoRun() override;
+    /**
+     * Report the performance test results.
+     * \param what The operation measured.
+     * \param start The time of the start of the measure.
+     */
+    void Report(const std::string& what, std::chrono::steady_clock::time_point start) const;
+
+    enum
+    {
+        REPETITIONS = 1000000
+    };
+
+    int64_t m_sum; //!< the sum of the arguments of Target
+};
+
+CallbackCostTestCase::CallbackCostTestCase()
+    : TestCase("Measure the average cost of Callback operations"),
+      m_sum(0)
+{
+}
+
+void
+CallbackCostTestCase::Report(const std::string& what,
+                             std::chrono::steady_clock::time_point start) const
+{
+    std::chrono::duration<double, std::nano> delta = std::chrono::steady_clock::now() - start;
+    std::cout << "callback-perf: " << std::left << std::setw(30) << what << std::right
+              << std::setw(8) << delta.count() / REPETITIONS << " ns" << std::endl;
+}
+
+void
+CallbackCostTestCase::DoRun()
+{
+    std::cout << "callback-perf: " << GetName() << ", reps: " << REPETITIONS << std::endl;
+
+    Callback<int, int> cb = MakeCallback(&CallbackCostTestCase::Target, this);
+    std::function<int(int)> fn = [this](int a) { return Target(a); };
+    Callback<int> bound = MakeCallback(&CallbackCostTestCase::Target, this, 1);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < REPETITIONS; ++i)
+    {
+        Target(i);
+    }
+    Report("invoke direct", start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < REPETITIONS; ++i)
+    {
+        cb(i);
+    }
+    Report("invoke Callback", start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < REPETITIONS; ++i)
+    {
+        bound();
+    }
+    Report("invoke bound Callback", start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < REPETITIONS; ++i)
+    {
+        fn(i);
+    }
+    Report("invoke std::function", start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < REPETITIONS; ++i)
+    {
+        Callback<int, int> copy = cb;
+        m_sum += copy.IsNull();
+    }
+    Report("copy Callback", start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < REPETITIONS; ++i)
+    {
+        std::function<int(int)> copy = fn;
+        m_sum += copy == nullptr;
+    }
+    Report("copy std::function", start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < REPETITIONS; ++i)
+    {
+        Callback<int, int> made = MakeCallback(&CallbackCostTestCase::Target, this);
+        m_sum += made.IsNull();
+    }
+    Report("make Callback", start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < REPETITIONS; ++i)
+    {
+        Callback<int> made = MakeCallback(&CallbackCostTestCase::Target, this, i);
+        m_sum += made.IsNull();
+    }
+    Report("make bound Callback", start);
+
+    NS_TEST_ASSERT_MSG_NE(m_sum, 0, "Callbacks were not invoked");
+}
+
+/**
+ * \ingroup callback-tests
+ *
+ * \brief The callback performance Test Suite.
+ */
+class CallbackPerformanceSuite : public TestSuite
+{
+  public:
+    CallbackPerformanceSuite();
+};
+
+CallbackPerformanceSuite::CallbackPerformanceSuite()
+    : TestSuite("callback-perf", PERFORMANCE)
+{
+    AddTestCase(new CallbackCostTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization.
+static CallbackPerformanceSuite g_callbackPerformanceSuite;
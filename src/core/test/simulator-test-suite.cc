@@ -16,13 +16,22 @@
  *
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
+#include "ns3/adaptive-scheduler.h"
+#include "ns3/boolean.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/dary-heap-scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/global-value.h"
 #include "ns3/heap-scheduler.h"
+#include "ns3/ladder-scheduler.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/priority-queue-scheduler.h"
 #include "ns3/simulator.h"
 #include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <map>
 
 using namespace ns3;
 
@@ -717,6 +726,187 @@ SimulatorTemplateTestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check that the events are recycled unless EventPoolEnabled is false.
+ */
+class SimulatorEventPoolTestCase : public TestCase
+{
+  public:
+    SimulatorEventPoolTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Run a chain of events, each scheduling the next one.
+     * \param [in] pool Whether the events are recycled.
+     * \returns The number of events taken from the heap.
+     */
+    uint64_t RunChain(bool pool);
+    /**
+     * Schedule the next event of the chain.
+     * \param [in] left The number of events still to schedule.
+     */
+    void Next(uint32_t left);
+};
+
+SimulatorEventPoolTestCase::SimulatorEventPoolTestCase()
+    : TestCase("Event pooling")
+{
+}
+
+void
+SimulatorEventPoolTestCase::Next(uint32_t left)
+{
+    if (left > 0)
+    {
+        Simulator::Schedule(NanoSeconds(1), &SimulatorEventPoolTestCase::Next, this, left - 1);
+    }
+}
+
+uint64_t
+SimulatorEventPoolTestCase::RunChain(bool pool)
+{
+    GlobalValue::Bind("EventPoolEnabled", BooleanValue(pool));
+    Simulator::Schedule(NanoSeconds(1), &SimulatorEventPoolTestCase::Next, this, 1000);
+    uint64_t allocations = EventImpl::GetNHeapAllocations();
+    Simulator::Run();
+    allocations = EventImpl::GetNHeapAllocations() - allocations;
+    Simulator::Destroy();
+    return allocations;
+}
+
+void
+SimulatorEventPoolTestCase::DoRun()
+{
+    NS_TEST_EXPECT_MSG_EQ(RunChain(false), 1000, "events not taken from the heap");
+    NS_TEST_EXPECT_MSG_LT(RunChain(true), 10, "events not recycled");
+    GlobalValue::Bind("EventPoolEnabled", BooleanValue(true));
+}
+
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check that a scheduler gives the events in the order of the
+ * MapScheduler.
+ *
+ * The events come in the patterns of packet simulations: bursts at the
+ * current time, many short delays, a few long ones, and some removals.
+ * The number of events first grows to several thousands, then falls to
+ * none.
+ */
+class SchedulerOrderTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param schedulerFactory Factory of the scheduler to check.
+     */
+    SchedulerOrderTestCase(ObjectFactory schedulerFactory);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * A linear congruential generator, not to disturb the random streams.
+     * \returns The next pseudo-random number.
+     */
+    uint64_t Next();
+
+    ObjectFactory m_schedulerFactory; //!< Factory of the scheduler to check.
+    uint64_t m_state;                 //!< State of the generator.
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase(ObjectFactory schedulerFactory)
+    : TestCase("Check the order of the events of " + schedulerFactory.GetTypeId().GetName()),
+      m_schedulerFactory(schedulerFactory),
+      m_state(1)
+{
+}
+
+uint64_t
+SchedulerOrderTestCase::Next()
+{
+    m_state = m_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return m_state >> 33;
+}
+
+void
+SchedulerOrderTestCase::DoRun()
+{
+    Ptr<Scheduler> reference = CreateObject<MapScheduler>();
+    Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler>();
+    std::map<uint32_t, Scheduler::Event> live;
+    uint64_t now = 0;
+    uint32_t uid = 0;
+    for (uint32_t op = 0; op < 200000; ++op)
+    {
+        uint64_t r = Next() % 100;
+        // more insertions first, more removals then
+        bool insert = live.empty() || r < (op < 100000 ? 55 : 45);
+        if (insert)
+        {
+            uint64_t kind = Next() % 10;
+            uint64_t delay = 0;
+            if (kind >= 3 && kind < 8)
+            {
+                delay = Next() % 100;
+            }
+            else if (kind == 8)
+            {
+                delay = Next() % 1000000;
+            }
+            else if (kind == 9)
+            {
+                delay = Next() % 10;
+            }
+            Scheduler::Event ev = {nullptr, {now + delay, uid++, 0}};
+            reference->Insert(ev);
+            scheduler->Insert(ev);
+            live[ev.key.m_uid] = ev;
+        }
+        else if (r < 5)
+        {
+            auto it = live.lower_bound(Next() % uid);
+            if (it == live.end())
+            {
+                it = live.begin();
+            }
+            reference->Remove(it->second);
+            scheduler->Remove(it->second);
+            live.erase(it);
+        }
+        else
+        {
+            NS_TEST_ASSERT_MSG_EQ(scheduler->PeekNext().key.m_uid,
+                                  reference->PeekNext().key.m_uid,
+                                  "wrong next event at operation " << op);
+            Scheduler::Event ev = scheduler->RemoveNext();
+            NS_TEST_ASSERT_MSG_EQ(ev.key.m_uid,
+                                  reference->RemoveNext().key.m_uid,
+                                  "wrong event removed at operation " << op);
+            now = ev.key.m_ts;
+            live.erase(ev.key.m_uid);
+        }
+        NS_TEST_ASSERT_MSG_EQ(scheduler->IsEmpty(), live.empty(), "wrong emptiness");
+    }
+    while (!reference->IsEmpty())
+    {
+        NS_TEST_ASSERT_MSG_EQ(scheduler->RemoveNext().key.m_uid,
+                              reference->RemoveNext().key.m_uid,
+                              "wrong event removed at the end");
+    }
+    NS_TEST_EXPECT_MSG_EQ(scheduler->IsEmpty(), true, "events left");
+
+    Ptr<AdaptiveScheduler> adaptive = DynamicCast<AdaptiveScheduler>(scheduler);
+    if (adaptive)
+    {
+        NS_TEST_EXPECT_MSG_GT(adaptive->GetNSwitches(), 1, "the scheduler never switched back");
+    }
+}
+
 /**
  * \ingroup simulator-tests
  *
@@ -740,6 +930,24 @@ class SimulatorTestSuite : public TestSuite
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
         factory.SetTypeId(PriorityQueueScheduler::GetTypeId());
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
+        factory.SetTypeId(DaryHeapScheduler::GetTypeId());
+        AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
+        factory.SetTypeId(LadderScheduler::GetTypeId());
+        AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
+        factory.SetTypeId(AdaptiveScheduler::GetTypeId());
+        AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
+        AddTestCase(new SimulatorEventPoolTestCase(), TestCase::QUICK);
+
+        factory = ObjectFactory("ns3::DaryHeapScheduler");
+        AddTestCase(new SchedulerOrderTestCase(factory), TestCase::QUICK);
+        factory.Set("Arity", UintegerValue(8));
+        AddTestCase(new SchedulerOrderTestCase(factory), TestCase::QUICK);
+        factory = ObjectFactory("ns3::LadderScheduler");
+        AddTestCase(new SchedulerOrderTestCase(factory), TestCase::QUICK);
+        factory = ObjectFactory("ns3::AdaptiveScheduler");
+        factory.Set("Threshold", UintegerValue(1000));
+        factory.Set("Window", UintegerValue(256));
+        AddTestCase(new SchedulerOrderTestCase(factory), TestCase::QUICK);
     }
 };
 
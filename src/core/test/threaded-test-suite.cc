@@ -30,6 +30,7 @@
 #include <list>
 #include <thread> // sleep_for
 #include <utility>
+#include <vector>
 
 using namespace ns3;
 
@@ -278,6 +279,142 @@ ThreadedSimulatorEventsTestCase::DoRun()
     NS_TEST_EXPECT_MSG_EQ(m_a, m_d, "Bad scheduling");
 }
 
+/**
+ * \ingroup threaded-tests
+ *
+ * \brief Check that the events scheduled by other threads all run, in the
+ * order each thread scheduled them.
+ *
+ * Each thread schedules more events than the DefaultSimulatorImpl ring
+ * holds, either before the simulation or while it runs.
+ */
+class ThreadedInjectionOrderTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * \param [in] concurrent Whether the threads schedule their events
+     *             while the simulation runs.
+     */
+    ThreadedInjectionOrderTestCase(bool concurrent);
+
+  private:
+    void DoSetup() override;
+    void DoRun() override;
+
+    /**
+     * Body of a thread, scheduling its events.
+     *
+     * \param [in] producer The index of the thread.
+     */
+    void Produce(uint32_t producer);
+    /**
+     * Event scheduled by a thread.
+     *
+     * \param [in] producer The index of the thread.
+     * \param [in] sequence The index of the event for that thread.
+     */
+    void Injected(uint32_t producer, uint32_t sequence);
+    /** Event keeping the simulation alive until all the events ran. */
+    void KeepAlive();
+
+    static constexpr uint32_t PRODUCERS = 8; //!< The number of threads.
+    static constexpr uint32_t EVENTS = 3000; //!< The events of each thread.
+    bool m_concurrent;                       //!< Whether to schedule during the run.
+    std::vector<uint32_t> m_next;            //!< The next event expected of each thread.
+    uint32_t m_count;                        //!< The events run so far.
+    uint32_t m_disorders;                    //!< The events run out of order.
+};
+
+ThreadedInjectionOrderTestCase::ThreadedInjectionOrderTestCase(bool concurrent)
+    : TestCase(std::string("Check the order of events scheduled by other threads ") +
+               (concurrent ? "during" : "before") + " the run"),
+      m_concurrent(concurrent),
+      m_count(0),
+      m_disorders(0)
+{
+}
+
+void
+ThreadedInjectionOrderTestCase::DoSetup()
+{
+    Config::SetGlobal("SimulatorImplementationType", StringValue("ns3::DefaultSimulatorImpl"));
+    m_next.assign(PRODUCERS, 0);
+    m_count = 0;
+    m_disorders = 0;
+}
+
+void
+ThreadedInjectionOrderTestCase::Produce(uint32_t producer)
+{
+    for (uint32_t i = 0; i < EVENTS; ++i)
+    {
+        Simulator::ScheduleWithContext(producer,
+                                       Seconds(0),
+                                       &ThreadedInjectionOrderTestCase::Injected,
+                                       this,
+                                       producer,
+                                       i);
+    }
+}
+
+void
+ThreadedInjectionOrderTestCase::Injected(uint32_t producer, uint32_t sequence)
+{
+    if (m_next[producer] != sequence)
+    {
+        m_disorders++;
+    }
+    m_next[producer] = sequence + 1;
+    m_count++;
+}
+
+void
+ThreadedInjectionOrderTestCase::KeepAlive()
+{
+    if (m_count < PRODUCERS * EVENTS)
+    {
+        Simulator::Schedule(NanoSeconds(1), &ThreadedInjectionOrderTestCase::KeepAlive, this);
+    }
+}
+
+void
+ThreadedInjectionOrderTestCase::DoRun()
+{
+    // create the simulator in this thread, which makes it the main one
+    Simulator::Now();
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < PRODUCERS; ++i)
+    {
+        threads.emplace_back(&ThreadedInjectionOrderTestCase::Produce, this, i);
+    }
+    if (m_concurrent)
+    {
+        Simulator::Schedule(NanoSeconds(1), &ThreadedInjectionOrderTestCase::KeepAlive, this);
+    }
+    else
+    {
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+    Simulator::Run();
+    for (auto& thread : threads)
+    {
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+    Simulator::Destroy();
+
+    NS_TEST_EXPECT_MSG_EQ(m_count, PRODUCERS * EVENTS, "Events lost");
+    NS_TEST_EXPECT_MSG_EQ(m_disorders, 0, "Events run out of order");
+}
+
 /**
  * \ingroup threaded-tests
  *
@@ -310,6 +447,8 @@ class ThreadedSimulatorTestSuite : public TestSuite
                 }
             }
         }
+        AddTestCase(new ThreadedInjectionOrderTestCase(false), TestCase::QUICK);
+        AddTestCase(new ThreadedInjectionOrderTestCase(true), TestCase::QUICK);
     }
 };
 
@@ -6,24 +6,22 @@
 
 #include "snic-header.h"
 
+#include "ipv4-header.h"
+
 #include "ns3/address-utils.h"
 
+#include <cstring>
+
 namespace ns3
 {
 
 NS_OBJECT_ENSURE_REGISTERED(SnicRte);
 
 SnicRte::SnicRte()
-    : m_tag(0),
-      m_prefix("127.0.0.1"),
-      m_subnetMask("0.0.0.0"),
-      m_nextHop("0.0.0.0"),
-      m_interfaceNum(-1),
-      m_leftDevice(0),
-      m_rightDevice(0),
+    : m_nextHop("0.0.0.0"),
+      m_port(0),
       m_leftVertex(0),
-      m_rightVertex(0),
-      m_processed(false)
+      m_rightVertex(0)
 {
 }
 
@@ -46,180 +44,115 @@ SnicRte::GetInstanceTypeId() const
 void
 SnicRte::Print(std::ostream& os) const
 {
-    os << " rtep= " << m_processed << " interfaceNum=" << m_interfaceNum << " ldev= 0x" << std::hex
-       << m_leftDevice << " rdev= 0x" << m_rightDevice << std::dec;
+    os << " port=" << m_port << " vertices=" << m_leftVertex << "->" << m_rightVertex
+       << " nextHop=" << m_nextHop;
 }
 
 uint32_t
 SnicRte::GetSerializedSize() const
 {
-    return 53;
+    return 14;
 }
 
 void
 SnicRte::Serialize(Buffer::Iterator i) const
 {
-    i.WriteHtonU16(2);
-    i.WriteHtonU16(m_tag);
-
-    i.WriteHtonU32(m_prefix.Get());
-    i.WriteHtonU32(m_subnetMask.Get());
     i.WriteHtonU32(m_nextHop.Get());
-    i.WriteHtonU32(m_interfaceNum);
-    i.WriteHtonU64(m_leftDevice);
-    i.WriteHtonU64(m_rightDevice);
-
-    i.WriteHtonU64(m_rightVertex);
-    i.WriteHtonU64(m_leftVertex);
-    i.WriteU8(m_processed);
+    i.WriteHtonU16(m_port);
+    i.WriteHtonU32(m_leftVertex);
+    i.WriteHtonU32(m_rightVertex);
 }
 
 uint32_t
 SnicRte::Deserialize(Buffer::Iterator i)
 {
-    uint16_t tmp;
-
-    tmp = i.ReadNtohU16();
-    if (tmp != 2)
-    {
-        return 0;
-    }
-
-    m_tag = i.ReadNtohU16();
-    m_prefix.Set(i.ReadNtohU32());
-    m_subnetMask.Set(i.ReadNtohU32());
     m_nextHop.Set(i.ReadNtohU32());
-
-    m_interfaceNum = i.ReadNtohU32();
-    m_leftDevice = i.ReadNtohU64();
-    m_rightDevice = i.ReadNtohU64();
-    m_leftVertex = i.ReadNtohU64();
-    m_rightVertex = i.ReadNtohU64();
-    m_processed = i.ReadU8();
+    m_port = i.ReadNtohU16();
+    m_leftVertex = i.ReadNtohU32();
+    m_rightVertex = i.ReadNtohU32();
 
     return GetSerializedSize();
 }
 
 void
-SnicRte::SetPrefix(Ipv4Address prefix)
+SnicRte::SetNextHop(Ipv4Address nextHop)
 {
-    m_prefix = prefix;
+    m_nextHop = nextHop;
 }
 
 Ipv4Address
-SnicRte::GetPrefix() const
-{
-    return m_prefix;
-}
-
-void
-SnicRte::SetSubnetMask(Ipv4Mask subnetMask)
-{
-    m_subnetMask = subnetMask;
-}
-
-Ipv4Mask
-SnicRte::GetSubnetMask() const
+SnicRte::GetNextHop() const
 {
-    return m_subnetMask;
+    return m_nextHop;
 }
 
 void
-SnicRte::SetRouteTag(uint16_t routeTag)
+SnicRte::SetPort(uint16_t port)
 {
-    m_tag = routeTag;
+    m_port = port;
 }
 
 uint16_t
-SnicRte::GetRouteTag() const
-{
-    return m_tag;
-}
-
-void
-SnicRte::SetInterfaceNum(int32_t num)
+SnicRte::GetPort() const
 {
-    m_interfaceNum = num;
-}
-
-int32_t
-SnicRte::GetInterfaceNum() const
-{
-    return m_interfaceNum;
+    return m_port;
 }
 
 void
-SnicRte::SetNextHop(Ipv4Address nextHop)
+SnicRte::SetVertices(uint32_t l, uint32_t r)
 {
-    m_nextHop = nextHop;
-}
-
-Ipv4Address
-SnicRte::GetNextHop() const
-{
-    return m_nextHop;
+    m_leftVertex = l;
+    m_rightVertex = r;
 }
 
-void
-SnicRte::SetLDevice(Ptr<NetDevice> dev)
+uint32_t
+SnicRte::GetLVertex() const
 {
-    m_leftDevice = (uint64_t)GetPointer(dev);
+    return m_leftVertex;
 }
 
-void
-SnicRte::SetRDevice(Ptr<NetDevice> dev)
+uint32_t
+SnicRte::GetRVertex() const
 {
-    m_rightDevice = (uint64_t)GetPointer(dev);
+    return m_rightVertex;
 }
 
-Ptr<NetDevice>
-SnicRte::GetLDevice() const
+std::ostream&
+operator<<(std::ostream& os, const SnicRte& h)
 {
-    return (Ptr<NetDevice>)(NetDevice*)m_leftDevice;
+    h.Print(os);
+    return os;
 }
 
-Ptr<NetDevice>
-SnicRte::GetRDevice() const
+SnicRoute::SnicRoute()
+    : m_n(0)
 {
-    return (Ptr<NetDevice>)(NetDevice*)m_rightDevice;
 }
 
 void
-SnicRte::SetVertices(uint64_t l, uint64_t r)
-{
-    m_leftVertex = l;
-    m_rightVertex = r;
-}
-
-uint64_t
-SnicRte::GetLVertex() const
+SnicRoute::Add(const SnicRte& rte)
 {
-    return m_leftVertex;
-}
-
-uint64_t
-SnicRte::GetRVertex() const
-{
-    return m_rightVertex;
+    NS_ASSERT_MSG(m_n < MAX_HOPS, "route is too long");
+    m_rtes[m_n++] = rte;
 }
 
 void
-SnicRte::SetProcessed(bool p)
+SnicRoute::Clear()
 {
-    m_processed = p;
+    m_n = 0;
 }
 
-bool
-SnicRte::GetProcessed() const
+uint8_t
+SnicRoute::GetN() const
 {
-    return m_processed;
+    return m_n;
 }
 
-std::ostream&
-operator<<(std::ostream& os, const SnicRte& h)
+const SnicRte&
+SnicRoute::Get(uint8_t n) const
 {
-    h.Print(os);
-    return os;
+    NS_ASSERT_MSG(n < m_n, "no such hop");
+    return m_rtes[n];
 }
 
 NS_LOG_COMPONENT_DEFINE("SnicHeader");
@@ -243,10 +176,10 @@ SnicHeader::SnicHeader()
       m_tput(0),
       m_flowId(0),
       m_useRouting(true),
-      //  m_numRtes(0),
       m_checksum(0),
       m_calcChecksum(false),
       m_goodChecksum(true),
+      m_hop(0),
       m_delay(0)
 {
 }
@@ -264,11 +197,11 @@ SnicHeader::SnicHeader(const SnicHeader& a)
       m_tput(a.m_tput),
       m_flowId(a.m_flowId),
       m_useRouting(a.m_useRouting),
-      //  m_numRtes(0),
       m_checksum(a.m_checksum),
       m_calcChecksum(a.m_calcChecksum),
       m_goodChecksum(a.m_goodChecksum),
-      m_rteList(a.m_rteList),
+      m_route(a.m_route),
+      m_hop(a.m_hop),
       m_delay(a.m_delay)
 {
 }
@@ -569,9 +502,10 @@ SnicHeader::Print(std::ostream& os) const
        << " last= " << m_isLastInFlow << " seenSnic: " << m_hasSeenNic << " snic_nt: " << m_nt
        << ", payload: " << m_payload << ", snic_length: " << m_payloadSize + GetSerializedSize()
        << " " << m_sourcePort << " > " << m_destinationPort;
-    for (auto iter = m_rteList.begin(); iter != m_rteList.end(); ++iter)
+    os << ", hop: " << (uint32_t)m_hop;
+    for (uint8_t n = 0; n < m_route.GetN(); ++n)
     {
-        os << "\n" << *iter;
+        os << "\n" << m_route.Get(n);
     }
 }
 
@@ -579,7 +513,7 @@ uint32_t
 SnicHeader::GetSerializedSize() const
 {
     SnicRte rte;
-    return 41 + m_rteList.size() * rte.GetSerializedSize();
+    return 42 + m_route.GetN() * rte.GetSerializedSize();
 }
 
 void
@@ -600,7 +534,8 @@ SnicHeader::Serialize(Buffer::Iterator start) const
     i.Write((uint8_t*)&m_tput, 8);
     i.WriteHtonU64(m_flowId);
     i.WriteU8(m_useRouting);
-    i.WriteU8(m_rteList.size());
+    i.WriteU8(m_route.GetN());
+    i.WriteU8(m_hop);
     if (m_payloadSize == 0)
     {
         i.WriteHtonU16(start.GetSize());
@@ -632,12 +567,11 @@ SnicHeader::Serialize(Buffer::Iterator start) const
         i.WriteU16(m_checksum);
     }
 
-    for (std::list<SnicRte>::const_iterator iter = m_rteList.begin(); iter != m_rteList.end();
-         ++iter)
+    for (uint8_t n = 0; n < m_route.GetN(); ++n)
     {
-        NS_LOG_DEBUG("serializing rte");
-        iter->Serialize(i);
-        i.Next(iter->GetSerializedSize());
+        const SnicRte& rte = m_route.Get(n);
+        rte.Serialize(i);
+        i.Next(rte.GetSerializedSize());
     }
 }
 
@@ -659,6 +593,7 @@ SnicHeader::Deserialize(Buffer::Iterator start)
     m_flowId = i.ReadNtohU64();
     m_useRouting = i.ReadU8();
     uint8_t numRtes = i.ReadU8();
+    m_hop = i.ReadU8();
     m_payloadSize = i.ReadNtohU16();
     m_checksum = i.ReadU16();
 
@@ -676,11 +611,19 @@ SnicHeader::Deserialize(Buffer::Iterator start)
     // uint8_t rteNumber = i.GetRemainingSize() / rte.GetSerializedSize();
     // NS_LOG_DEBUG("remaining=" << i.GetRemainingSize());
 
+    m_route.Clear();
+    if (numRtes > SnicRoute::MAX_HOPS)
+    {
+        // malformed: the header is dropped like a corrupted one
+        NS_LOG_WARN("header claims " << +numRtes << " rtes, dropping them");
+        m_goodChecksum = false;
+        i.Next(numRtes * rte.GetSerializedSize());
+        return i.GetDistanceFrom(start);
+    }
     for (uint8_t n = 0; n < numRtes; n++)
     {
         i.Next(rte.Deserialize(i));
-        m_rteList.push_back(rte);
-        NS_LOG_DEBUG("doing it ");
+        m_route.Add(rte);
     }
     // m_payloadSize -= GetSerializedSize();
     NS_LOG_DEBUG("deserial2 m_newFlow=" << m_newFlow);
@@ -695,33 +638,54 @@ SnicHeader::GetChecksum()
 }
 
 void
-SnicHeader::AddRte(SnicRte rte)
+SnicHeader::AddRte(const SnicRte& rte)
 {
-    m_rteList.push_back(rte);
+    m_route.Add(rte);
 }
 
 void
 SnicHeader::ClearRtes()
 {
-    m_rteList.clear();
+    m_route.Clear();
+    m_hop = 0;
 }
 
 uint16_t
 SnicHeader::GetRteNumber() const
 {
-    return m_rteList.size();
+    return m_route.GetN();
 }
 
-std::list<SnicRte>
-SnicHeader::GetRteList() const
+const SnicRte&
+SnicHeader::GetRte(uint8_t n) const
 {
-    return m_rteList;
+    return m_route.Get(n);
+}
+
+const SnicRoute&
+SnicHeader::GetRoute() const
+{
+    return m_route;
+}
+
+void
+SnicHeader::SetRoute(const SnicRoute& route)
+{
+    m_route = route;
+    m_hop = 0;
+}
+
+uint8_t
+SnicHeader::GetHop() const
+{
+    return m_hop;
 }
 
 void
-SnicHeader::SetRteList(std::list<SnicRte> rteList)
+SnicHeader::SetHop(uint8_t hop)
 {
-    m_rteList = rteList;
+    NS_ASSERT_MSG(hop <= m_route.GetN(), "hop past the end of the route");
+    m_hop = hop;
 }
 
 std::ostream&
@@ -731,4 +695,279 @@ operator<<(std::ostream& os, const SnicHeader& h)
     return os;
 }
 
+namespace
+{
+
+/**
+ * Header made of already serialized bytes. It reports the TypeId of the
+ * header the bytes belong to so that packet metadata stays consistent.
+ */
+class SerializedHeader : public Header
+{
+  public:
+    SerializedHeader(const uint8_t* data, uint32_t size, TypeId tid)
+        : m_data(data),
+          m_size(size),
+          m_tid(tid)
+    {
+    }
+
+    TypeId GetInstanceTypeId() const override
+    {
+        return m_tid;
+    }
+
+    void Print(std::ostream& os) const override
+    {
+        os << "serialized " << m_tid.GetName() << " (" << m_size << " bytes)";
+    }
+
+    uint32_t GetSerializedSize() const override
+    {
+        return m_size;
+    }
+
+    void Serialize(Buffer::Iterator start) const override
+    {
+        start.Write(m_data, m_size);
+    }
+
+    uint32_t Deserialize(Buffer::Iterator start) override
+    {
+        NS_FATAL_ERROR("SerializedHeader can only be added to a packet");
+        return 0;
+    }
+
+  private:
+    const uint8_t* m_data;
+    uint32_t m_size;
+    TypeId m_tid;
+};
+
+uint16_t
+ReadU16(const uint8_t* p)
+{
+    return (uint16_t(p[0]) << 8) | p[1];
+}
+
+uint32_t
+ReadU32(const uint8_t* p)
+{
+    return (uint32_t(ReadU16(p)) << 16) | ReadU16(p + 2);
+}
+
+uint64_t
+ReadU64(const uint8_t* p)
+{
+    return (uint64_t(ReadU32(p)) << 32) | ReadU32(p + 4);
+}
+
+} // namespace
+
+SnicHeaderView::SnicHeaderView(Ptr<Packet> packet)
+    : m_packet(packet),
+      m_ipv4Size(0),
+      m_snicSize(0),
+      m_dirty(false),
+      m_malformed(false)
+{
+    // routes are bounded, so both headers of a well formed packet fit in m_data
+    uint32_t size = packet->CopyData(m_data, MAX_SIZE);
+    m_ipv4Size = size > 0 ? (m_data[0] & 0x0f) * 4 : 0;
+    m_snicSize = SNIC_FIXED_SIZE;
+    if (m_ipv4Size < 20 || size < m_ipv4Size + SNIC_FIXED_SIZE)
+    {
+        NS_LOG_WARN("packet of " << size << " bytes with a " << m_ipv4Size
+                                 << " bytes Ipv4Header holds no SnicHeader, malformed");
+        // the fields read as zero rather than whatever was left in m_data
+        std::memset(m_data, 0, MAX_SIZE);
+        m_malformed = true;
+        return;
+    }
+    uint8_t numRtes = m_data[m_ipv4Size + SNIC_RTE_NUMBER];
+    if (numRtes > SnicRoute::MAX_HOPS || size < m_ipv4Size + m_snicSize + numRtes * RTE_SIZE)
+    {
+        NS_LOG_WARN("header claims " << +numRtes << " rtes, malformed");
+        m_malformed = true;
+        return;
+    }
+    m_snicSize += numRtes * RTE_SIZE;
+}
+
+SnicHeaderView::~SnicHeaderView()
+{
+}
+
+bool
+SnicHeaderView::PeekNT(Ptr<const Packet> packet, uint16_t& nt)
+{
+    uint8_t data[60 + SNIC_NT + 2];
+    uint32_t size = packet->CopyData(data, sizeof(data));
+    if (size == 0)
+    {
+        return false;
+    }
+    uint32_t ipv4Size = (data[0] & 0x0f) * 4;
+    if (ipv4Size < 20 || size < ipv4Size + SNIC_NT + 2)
+    {
+        return false;
+    }
+    nt = ReadU16(data + ipv4Size + SNIC_NT);
+    return true;
+}
+
+const uint8_t*
+SnicHeaderView::Snic() const
+{
+    return m_data + m_ipv4Size;
+}
+
+uint8_t*
+SnicHeaderView::Snic()
+{
+    return m_data + m_ipv4Size;
+}
+
+const uint8_t*
+SnicHeaderView::Rte(uint16_t n) const
+{
+    NS_ASSERT_MSG(n < GetRteNumber(), "no such RTE");
+    return Snic() + SNIC_FIXED_SIZE + n * RTE_SIZE;
+}
+
+Ipv4Address
+SnicHeaderView::GetSource() const
+{
+    return Ipv4Address(ReadU32(m_data + 12));
+}
+
+Ipv4Address
+SnicHeaderView::GetDestination() const
+{
+    return Ipv4Address(ReadU32(m_data + 16));
+}
+
+uint16_t
+SnicHeaderView::GetSourcePort() const
+{
+    return ReadU16(Snic() + SNIC_SOURCE_PORT);
+}
+
+uint16_t
+SnicHeaderView::GetDestinationPort() const
+{
+    return ReadU16(Snic() + SNIC_DESTINATION_PORT);
+}
+
+uint16_t
+SnicHeaderView::GetNT() const
+{
+    return ReadU16(Snic() + SNIC_NT);
+}
+
+uint16_t
+SnicHeaderView::GetPacketType() const
+{
+    return ReadU16(Snic() + SNIC_PACKET_TYPE);
+}
+
+bool
+SnicHeaderView::HasSeenNic() const
+{
+    return Snic()[SNIC_HAS_SEEN_NIC];
+}
+
+bool
+SnicHeaderView::IsNewFlow() const
+{
+    return Snic()[SNIC_NEW_FLOW];
+}
+
+bool
+SnicHeaderView::IsLastInFlow() const
+{
+    return Snic()[SNIC_LAST_IN_FLOW];
+}
+
+double
+SnicHeaderView::GetTput() const
+{
+    // written as raw bytes, see SnicHeader::Serialize()
+    double tput;
+    std::memcpy(&tput, Snic() + SNIC_TPUT, sizeof(tput));
+    return tput;
+}
+
+uint64_t
+SnicHeaderView::GetFlowId() const
+{
+    return ReadU64(Snic() + SNIC_FLOW_ID);
+}
+
+bool
+SnicHeaderView::GetUseRouting() const
+{
+    return Snic()[SNIC_USE_ROUTING];
+}
+
+bool
+SnicHeaderView::IsMalformed() const
+{
+    return m_malformed;
+}
+
+uint16_t
+SnicHeaderView::GetRteNumber() const
+{
+    NS_ASSERT_MSG(!m_malformed, "malformed header");
+    return Snic()[SNIC_RTE_NUMBER];
+}
+
+uint16_t
+SnicHeaderView::GetHop() const
+{
+    return Snic()[SNIC_HOP];
+}
+
+uint16_t
+SnicHeaderView::GetRtePort(uint16_t n) const
+{
+    return ReadU16(Rte(n) + RTE_PORT);
+}
+
+void
+SnicHeaderView::SetHasSeenNic()
+{
+    Snic()[SNIC_HAS_SEEN_NIC] = 1;
+    m_dirty = true;
+}
+
+uint16_t
+SnicHeaderView::AdvanceRte()
+{
+    uint16_t n = GetHop();
+    if (n < GetRteNumber())
+    {
+        Snic()[SNIC_HOP] = n + 1;
+        m_dirty = true;
+    }
+    return n;
+}
+
+void
+SnicHeaderView::Commit()
+{
+    if (!m_dirty)
+    {
+        return;
+    }
+    NS_ASSERT_MSG(!m_malformed, "malformed header");
+    // removing from the front only moves the start of the buffer, so adding
+    // the same amount of bytes back reuses the space in place
+    m_packet->RemoveAtStart(m_ipv4Size + m_snicSize);
+    m_packet->AddHeader(SerializedHeader(Snic(), m_snicSize, SnicHeader::GetTypeId()));
+    m_packet->AddHeader(SerializedHeader(m_data, m_ipv4Size, Ipv4Header::GetTypeId()));
+    m_dirty = false;
+}
+
 } // namespace ns3
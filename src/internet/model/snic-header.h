@@ -12,6 +12,7 @@
 #include "ns3/ipv6-address.h"
 #include "ns3/net-device.h"
 #include "ns3/nstime.h"
+#include "ns3/packet.h"
 
 #include <stdint.h>
 #include <string>
@@ -19,6 +20,13 @@
 namespace ns3
 {
 
+/**
+ * \brief One hop of a source route computed by the sNIC scheduler.
+ *
+ * A hop only carries small indices, so a route is meaningful in any process
+ * that built the same topology: the index of the sNIC port the hop leaves
+ * from and the scheduler indices of the vertices at both ends of the hop.
+ */
 class SnicRte : public Header
 {
   public:
@@ -58,91 +66,70 @@ class SnicRte : public Header
     uint32_t Deserialize(Buffer::Iterator start) override;
 
     /**
-     * \brief Set the prefix.
-     * \param prefix The prefix.
+     * \brief Set the next hop.
+     * \param nextHop The next hop.
      */
-    void SetPrefix(Ipv4Address prefix);
+    void SetNextHop(Ipv4Address nextHop);
 
     /**
-     * \brief Get the prefix.
-     * \returns The prefix.
+     * \brief Get the next hop.
+     * \returns The next hop.
      */
-    Ipv4Address GetPrefix() const;
+    Ipv4Address GetNextHop() const;
 
     /**
-     * \brief Set the subnet mask.
-     * \param subnetMask The subnet mask.
+     * \param port index of the sNIC port the hop leaves from, as in
+     *        SnicNetDevice::GetSnicPort()
      */
-    void SetSubnetMask(Ipv4Mask subnetMask);
+    void SetPort(uint16_t port);
+    uint16_t GetPort() const;
 
     /**
-     * \brief Get the subnet mask.
-     * \returns The subnet mask.
+     * \param l scheduler index of the vertex the hop leaves from
+     * \param r scheduler index of the vertex the hop goes to
      */
-    Ipv4Mask GetSubnetMask() const;
+    void SetVertices(uint32_t l, uint32_t r);
+    uint32_t GetLVertex() const;
+    uint32_t GetRVertex() const;
 
-    /**
-     * \brief Set the route tag.
-     * \param routeTag The route tag.
-     */
-    void SetRouteTag(uint16_t routeTag);
+  private:
+    Ipv4Address m_nextHop; //!< Next hop.
+    uint16_t m_port;
+    uint32_t m_leftVertex;
+    uint32_t m_rightVertex;
+};
 
-    /**
-     * \brief Get the route tag.
-     * \returns The route tag.
-     */
-    uint16_t GetRouteTag() const;
+/**
+ * \brief A source route: the hops of a flow, kept inline.
+ */
+class SnicRoute
+{
+  public:
+    /// the longest route a SnicHeader can carry
+    static const uint8_t MAX_HOPS = 16;
 
-    /**
-     * \brief Set the route metric.
-     * \param routeMetric The route metric.
-     */
-    void SetInterfaceNum(int32_t num);
+    SnicRoute();
 
     /**
-     * \brief Get the route metric.
-     * \returns The route metric.
+     * \param rte the hop to append
      */
-    int32_t GetInterfaceNum() const;
+    void Add(const SnicRte& rte);
+    void Clear();
 
     /**
-     * \brief Set the next hop.
-     * \param nextHop The next hop.
+     * \return the number of hops
      */
-    void SetNextHop(Ipv4Address nextHop);
-
-    void SetLDevice(Ptr<NetDevice> dev);
-    void SetRDevice(Ptr<NetDevice> dev);
-    Ptr<NetDevice> GetLDevice() const;
-    Ptr<NetDevice> GetRDevice() const;
+    uint8_t GetN() const;
 
-    void SetVertices(uint64_t l, uint64_t r);
-    // void SetRDevice(Ptr<NetDevice> dev);
-    uint64_t GetLVertex() const;
-    uint64_t GetRVertex() const;
     /**
-     * \brief Get the next hop.
-     * \returns The next hop.
+     * \param n index of the hop
+     * \return the hop
      */
-    Ipv4Address GetNextHop() const;
-
-    void SetProcessed(bool p);
-    bool GetProcessed() const;
+    const SnicRte& Get(uint8_t n) const;
 
   private:
-    uint16_t m_tag;        //!< Route tag.
-    Ipv4Address m_prefix;  //!< Advertised prefix.
-    Ipv4Mask m_subnetMask; //!< Subnet mask.
-    Ipv4Address m_nextHop; //!< Next hop.
-    // uint32_t m_metric;     //!< Route metric.
-
-    int32_t m_interfaceNum;
-    uint64_t m_leftDevice;
-    uint64_t m_rightDevice;
-
-    uint64_t m_leftVertex;
-    uint64_t m_rightVertex;
-    bool m_processed;
+    uint8_t m_n;
+    SnicRte m_rtes[MAX_HOPS];
 };
 
 std::ostream& operator<<(std::ostream& os, const SnicRte& h);
@@ -267,7 +254,8 @@ class SnicHeader : public Header
 
     /**
      * \brief Is the SNIC checksum correct ?
-     * \returns true if the checksum is correct, false otherwise.
+     * \returns true if the checksum is correct, false otherwise, or if the
+     *          header holds more RTEs than a SnicRoute.
      */
     bool IsChecksumOk() const;
 
@@ -313,14 +301,15 @@ class SnicHeader : public Header
         ALLOCATION_RESPONSE = 2,
         ALLOCATION_RELEASE = 3,
         RECONFIG_REQUEST,
-        RECONFIG_RESPONSE
+        RECONFIG_RESPONSE,
+        ALLOCATION_REJECT
     };
 
     /**
      * \brief Add a RTE to the message
      * \param rte the RTE
      */
-    void AddRte(SnicRte rte);
+    void AddRte(const SnicRte& rte);
 
     /**
      * \brief Clear all the RTEs from the header
@@ -334,12 +323,27 @@ class SnicHeader : public Header
     uint16_t GetRteNumber() const;
 
     /**
-     * \brief Get the list of the RTEs included in the message
-     * \returns the list of the RTEs in the message
+     * \param n index of the RTE
+     * \returns the RTE
+     */
+    const SnicRte& GetRte(uint8_t n) const;
+
+    /**
+     * \returns the route carried by the message
+     */
+    const SnicRoute& GetRoute() const;
+
+    /**
+     * \param route the route to carry, the hop cursor is reset
      */
-    std::list<SnicRte> GetRteList() const;
+    void SetRoute(const SnicRoute& route);
 
-    void SetRteList(std::list<SnicRte> rteList);
+    /**
+     * \returns the index of the next RTE to take, GetRteNumber() once the
+     *          packet reached the last sNIC of the route
+     */
+    uint8_t GetHop() const;
+    void SetHop(uint8_t hop);
 
   private:
     bool m_isOffloaded;
@@ -369,7 +373,8 @@ class SnicHeader : public Header
     uint16_t m_checksum;   //!< Forced Checksum value
     bool m_calcChecksum;   //!< Flag to calculate checksum
     bool m_goodChecksum;   //!< Flag to indicate that checksum is correct
-    std::list<SnicRte> m_rteList;
+    SnicRoute m_route;
+    uint8_t m_hop;
 
     // NOTE Not serialized
     Time m_delay;
@@ -377,5 +382,117 @@ class SnicHeader : public Header
 
 std::ostream& operator<<(std::ostream& os, const SnicHeader& h);
 
+/**
+ * \brief In place view of the Ipv4Header and SnicHeader at the front of a packet.
+ *
+ * Only the bytes of the two headers are copied out of the packet, and fields
+ * are decoded on access, so inspecting a packet does not deserialize the RTE
+ * list. Modifications are kept in the view until Commit() writes the header
+ * bytes back in front of the payload.
+ *
+ * The SNIC checksum is not updated by Commit().
+ */
+class SnicHeaderView
+{
+  public:
+    /**
+     * \param packet a packet starting with an Ipv4Header followed by a SnicHeader
+     */
+    SnicHeaderView(Ptr<Packet> packet);
+    ~SnicHeaderView();
+
+    /**
+     * \brief Read the NT of a packet without copying the rest of its headers.
+     * \param packet a packet starting with an Ipv4Header followed by a SnicHeader
+     * \param nt set to the NT of the packet
+     * \return false if the packet is too short to hold it
+     */
+    static bool PeekNT(Ptr<const Packet> packet, uint16_t& nt);
+
+    Ipv4Address GetSource() const;
+    Ipv4Address GetDestination() const;
+
+    uint16_t GetSourcePort() const;
+    uint16_t GetDestinationPort() const;
+    uint16_t GetNT() const;
+    uint16_t GetPacketType() const;
+    bool HasSeenNic() const;
+    bool IsNewFlow() const;
+    bool IsLastInFlow() const;
+    double GetTput() const;
+    uint64_t GetFlowId() const;
+    bool GetUseRouting() const;
+
+    /**
+     * \return true if the packet is too short for an Ipv4Header and a
+     *         SnicHeader, its Ipv4Header is shorter than 20 bytes, or it holds
+     *         more RTEs than a SnicRoute or less than its header claims; only
+     *         the fixed fields of a header with a bad RTE count can be read
+     */
+    bool IsMalformed() const;
+    uint16_t GetRteNumber() const;
+
+    /**
+     * \return the index of the next RTE to take, see SnicHeader::GetHop()
+     */
+    uint16_t GetHop() const;
+
+    /**
+     * \param n index of the RTE
+     * \return the sNIC port the RTE leaves from, see SnicRte::GetPort()
+     */
+    uint16_t GetRtePort(uint16_t n) const;
+
+    void SetHasSeenNic();
+
+    /**
+     * \brief Move the hop cursor past the next RTE.
+     * \return the index of the RTE, or GetRteNumber() if there was none left
+     */
+    uint16_t AdvanceRte();
+
+    /**
+     * \brief Write the modified header bytes back into the packet.
+     *
+     * Does nothing if the view was not modified.
+     */
+    void Commit();
+
+  private:
+    /// offsets of the SnicHeader fields, see SnicHeader::Serialize()
+    enum Offsets
+    {
+        SNIC_SOURCE_PORT = 0,
+        SNIC_DESTINATION_PORT = 2,
+        SNIC_NT = 4,
+        SNIC_HAS_SEEN_NIC = 14,
+        SNIC_PACKET_TYPE = 15,
+        SNIC_NEW_FLOW = 17,
+        SNIC_LAST_IN_FLOW = 18,
+        SNIC_TPUT = 19,
+        SNIC_FLOW_ID = 27,
+        SNIC_USE_ROUTING = 35,
+        SNIC_RTE_NUMBER = 36,
+        SNIC_HOP = 37,
+        SNIC_FIXED_SIZE = 42,
+        RTE_PORT = 4,
+        RTE_SIZE = 14
+    };
+
+    /// the largest Ipv4Header followed by the largest SnicHeader
+    static constexpr uint32_t MAX_SIZE = 60 + SNIC_FIXED_SIZE + SnicRoute::MAX_HOPS * RTE_SIZE;
+
+    const uint8_t* Snic() const;
+    uint8_t* Snic();
+    const uint8_t* Rte(uint16_t n) const;
+
+    Ptr<Packet> m_packet;
+    uint32_t m_ipv4Size;
+    uint32_t m_snicSize;
+    uint8_t m_data[MAX_SIZE];
+    bool m_dirty;
+    bool m_malformed;
+};
+
 } // namespace ns3
 #endif // SNIC_HEADER_H
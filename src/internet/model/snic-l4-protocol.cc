@@ -453,9 +453,12 @@ SnicL4Protocol::Send(Ptr<Packet> packet,
     packet->RemoveHeader(snicHeader);
     NS_LOG_DEBUG("after removeheader: " << snicHeader.GetNT());
 
-    std::ostringstream coll;
-    packet->PrintPacketTags(coll);
-    NS_LOG_DEBUG("pkt tags removeheader: " << coll.str());
+    if (g_log.IsEnabled(LOG_DEBUG))
+    {
+        std::ostringstream coll;
+        packet->PrintPacketTags(coll);
+        NS_LOG_DEBUG("pkt tags removeheader: " << coll.str());
+    }
 
     // SnicHeader snicHeader;
     if (Node::ChecksumEnabled())
@@ -0,0 +1,804 @@
+/**
+ * \file
+ * \ingroup mtp
+ * Implementation of class ns3::MultithreadedSimulatorImpl.
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/channel-list.h"
+#include "ns3/channel.h"
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <thread>
+
+namespace ns3
+{
+
+// Note: as in DefaultSimulatorImpl, logging is avoided on the paths taken
+// by every event
+NS_LOG_COMPONENT_DEFINE("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED(MultithreadedSimulatorImpl);
+
+/// Timestamp of the events which never come
+static const uint64_t NEVER = std::numeric_limits<uint64_t>::max();
+/// Number of times a thread checks the barrier before yielding its core
+static const uint32_t BARRIER_SPINS = 1024;
+
+thread_local MultithreadedSimulatorImpl::Partition*
+    MultithreadedSimulatorImpl::g_currentPartition = nullptr;
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::MultithreadedSimulatorImpl")
+            .SetParent<SimulatorImpl>()
+            .SetGroupName("Mtp")
+            .AddConstructor<MultithreadedSimulatorImpl>()
+            .AddAttribute("MaxThreads",
+                          "The maximum number of threads, one per core if 0. "
+                          "There are never more threads than groups of nodes.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&MultithreadedSimulatorImpl::m_maxThreads),
+                          MakeUintegerChecker<uint32_t>());
+    return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl()
+    : m_maxThreads(0),
+      m_lookahead(NEVER),
+      m_windowEnd(0),
+      m_nWindows(0),
+      m_parity(0),
+      m_running(false),
+      m_finished(false),
+      m_stop(false)
+{
+    NS_LOG_FUNCTION(this);
+    m_partitions.push_back(CreatePartition(0, 0));
+    m_global = m_partitions.back().get();
+    m_mainThreadId = std::this_thread::get_id();
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    for (auto& partition : m_partitions)
+    {
+        for (auto& outbox : partition->outbox)
+        {
+            for (auto& box : outbox)
+            {
+                for (auto& ev : box)
+                {
+                    ev.impl->Unref();
+                }
+                box.clear();
+            }
+        }
+        while (partition->events && !partition->events->IsEmpty())
+        {
+            Scheduler::Event next = partition->events->RemoveNext();
+            next.impl->Unref();
+        }
+        partition->events = nullptr;
+    }
+    {
+        std::unique_lock lock{m_externalEventsMutex};
+        for (auto& ev : m_externalEvents)
+        {
+            ev.event->Unref();
+        }
+        m_externalEvents.clear();
+    }
+    SimulatorImpl::DoDispose();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy()
+{
+    NS_LOG_FUNCTION(this);
+    while (!m_destroyEvents.empty())
+    {
+        Ptr<EventImpl> ev = m_destroyEvents.front().PeekEventImpl();
+        m_destroyEvents.pop_front();
+        NS_LOG_LOGIC("handle destroy " << ev);
+        if (!ev->IsCancelled())
+        {
+            ev->Invoke();
+        }
+    }
+}
+
+std::unique_ptr<MultithreadedSimulatorImpl::Partition>
+MultithreadedSimulatorImpl::CreatePartition(uint32_t index, uint32_t nPartitions) const
+{
+    auto partition = std::make_unique<Partition>();
+    partition->index = index;
+    if (m_schedulerFactory.IsTypeIdSet())
+    {
+        partition->events = m_schedulerFactory.Create<Scheduler>();
+    }
+    partition->currentTs = 0;
+    partition->currentContext = Simulator::NO_CONTEXT;
+    partition->currentUid = EventId::UID::INVALID;
+    partition->uid = EventId::UID::VALID;
+    partition->eventCount = 0;
+    partition->unscheduledEvents = 0;
+    partition->outbox[0].resize(nPartitions + 1);
+    partition->outbox[1].resize(nPartitions + 1);
+    partition->minOutboxTs = NEVER;
+    return partition;
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler(ObjectFactory schedulerFactory)
+{
+    NS_LOG_FUNCTION(this << schedulerFactory);
+    m_schedulerFactory = schedulerFactory;
+    for (auto& partition : m_partitions)
+    {
+        Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler>();
+        if (partition->events)
+        {
+            while (!partition->events->IsEmpty())
+            {
+                scheduler->Insert(partition->events->RemoveNext());
+            }
+        }
+        partition->events = scheduler;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::DoPartition()
+{
+    NS_LOG_FUNCTION(this);
+    uint32_t nNodes = NodeList::GetNNodes();
+    uint32_t nThreads = m_maxThreads;
+    if (nThreads == 0)
+    {
+        nThreads = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    // the nodes of a channel without a delay go together
+    std::vector<uint32_t> parent(nNodes);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto root = [&parent](uint32_t node) {
+        while (parent[node] != node)
+        {
+            parent[node] = parent[parent[node]];
+            node = parent[node];
+        }
+        return node;
+    };
+    std::vector<std::pair<uint64_t, std::vector<uint32_t>>> channels;
+    for (auto i = ChannelList::Begin(); i != ChannelList::End(); ++i)
+    {
+        Ptr<Channel> channel = *i;
+        TimeValue delay;
+        uint64_t ts = 0;
+        if (channel->GetAttributeFailSafe("Delay", delay) && delay.Get().IsStrictlyPositive())
+        {
+            ts = delay.Get().GetTimeStep();
+        }
+        std::vector<uint32_t> nodes;
+        for (std::size_t j = 0; j < channel->GetNDevices(); ++j)
+        {
+            Ptr<NetDevice> device = channel->GetDevice(j);
+            if (device && device->GetNode())
+            {
+                nodes.push_back(device->GetNode()->GetId());
+            }
+        }
+        if (ts == 0)
+        {
+            for (std::size_t j = 1; j < nodes.size(); ++j)
+            {
+                parent[root(nodes[j])] = root(nodes[0]);
+            }
+        }
+        channels.emplace_back(ts, std::move(nodes));
+    }
+
+    std::vector<uint32_t> size(nNodes, 0);
+    uint32_t nGroups = 0;
+    for (uint32_t node = 0; node < nNodes; ++node)
+    {
+        if (size[root(node)]++ == 0)
+        {
+            nGroups++;
+        }
+    }
+
+    // cut the groups, in the order of their first node, into partitions of
+    // about the same number of nodes
+    uint32_t nPartitions = std::max(1U, std::min(nThreads, nGroups));
+    uint32_t target = (nNodes + nPartitions - 1) / nPartitions;
+    std::vector<uint32_t> groupPartition(nNodes, nPartitions);
+    m_nodePartition.assign(nNodes, 0);
+    uint32_t current = 0;
+    uint32_t load = 0;
+    for (uint32_t node = 0; node < nNodes; ++node)
+    {
+        uint32_t group = root(node);
+        if (groupPartition[group] == nPartitions)
+        {
+            if (load >= target && current + 1 < nPartitions)
+            {
+                current++;
+                load = 0;
+            }
+            groupPartition[group] = current;
+            load += size[group];
+        }
+        m_nodePartition[node] = groupPartition[group];
+    }
+    nPartitions = current + 1;
+
+    m_lookahead = NEVER;
+    for (const auto& channel : channels)
+    {
+        const std::vector<uint32_t>& nodes = channel.second;
+        for (std::size_t j = 1; j < nodes.size(); ++j)
+        {
+            if (m_nodePartition[nodes[j]] != m_nodePartition[nodes[0]])
+            {
+                m_lookahead = std::min(m_lookahead, channel.first);
+                break;
+            }
+        }
+    }
+
+    // the global partition goes last, with the events which have no node
+    std::unique_ptr<Partition> global = std::move(m_partitions.back());
+    m_partitions.clear();
+    for (uint32_t i = 0; i < nPartitions; ++i)
+    {
+        m_partitions.push_back(CreatePartition(i, nPartitions));
+        m_partitions.back()->currentTs = global->currentTs;
+        m_partitions.back()->uid = global->uid;
+    }
+    global->index = nPartitions;
+    global->outbox[0].resize(nPartitions + 1);
+    global->outbox[1].resize(nPartitions + 1);
+    m_partitions.push_back(std::move(global));
+
+    std::vector<Scheduler::Event> events;
+    while (!m_global->events->IsEmpty())
+    {
+        events.push_back(m_global->events->RemoveNext());
+    }
+    for (const auto& ev : events)
+    {
+        Partition* partition = GetPartitionOf(ev.key.m_context);
+        partition->events->Insert(ev);
+        if (partition != m_global)
+        {
+            partition->unscheduledEvents++;
+            m_global->unscheduledEvents--;
+        }
+    }
+
+    NS_LOG_INFO("split " << nNodes << " nodes in " << nGroups << " groups into " << nPartitions
+                         << " partitions, lookahead " << GetLookahead().As(Time::NS));
+}
+
+MultithreadedSimulatorImpl::Partition*
+MultithreadedSimulatorImpl::GetPartitionOf(uint32_t context) const
+{
+    if (context < m_nodePartition.size())
+    {
+        return m_partitions[m_nodePartition[context]].get();
+    }
+    return m_global;
+}
+
+MultithreadedSimulatorImpl::Partition*
+MultithreadedSimulatorImpl::GetCurrentPartition() const
+{
+    return g_currentPartition != nullptr ? g_currentPartition : m_global;
+}
+
+// System ID for non-distributed simulation is always zero
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId() const
+{
+    return 0;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetNPartitions() const
+{
+    return m_partitions.size() - 1;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartition(uint32_t nodeId) const
+{
+    NS_ASSERT_MSG(nodeId < m_nodePartition.size(), "node " << nodeId << " is not partitioned");
+    return m_nodePartition[nodeId];
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookahead() const
+{
+    if (m_lookahead == NEVER)
+    {
+        return GetMaximumSimulationTime();
+    }
+    return TimeStep(m_lookahead);
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetNWindows() const
+{
+    return m_nWindows;
+}
+
+EventId
+MultithreadedSimulatorImpl::Insert(Partition* partition,
+                                   uint64_t ts,
+                                   uint32_t context,
+                                   EventImpl* event)
+{
+    Scheduler::Event ev;
+    ev.impl = event;
+    ev.key.m_ts = ts;
+    ev.key.m_context = context;
+    ev.key.m_uid = partition->uid;
+    partition->uid++;
+    partition->unscheduledEvents++;
+    partition->events->Insert(ev);
+    return EventId(event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+void
+MultithreadedSimulatorImpl::Receive(std::vector<Scheduler::Event>& box, Partition* receiver)
+{
+    for (auto& ev : box)
+    {
+        ev.key.m_uid = receiver->uid;
+        receiver->uid++;
+        receiver->unscheduledEvents++;
+        receiver->events->Insert(ev);
+    }
+    box.clear();
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent(Partition* partition)
+{
+    Scheduler::Event next = partition->events->RemoveNext();
+
+    PreEventHook(EventId(next.impl, next.key.m_ts, next.key.m_context, next.key.m_uid));
+
+    NS_ASSERT(next.key.m_ts >= partition->currentTs);
+    partition->unscheduledEvents--;
+    partition->eventCount++;
+
+    partition->currentTs = next.key.m_ts;
+    partition->currentContext = next.key.m_context;
+    partition->currentUid = next.key.m_uid;
+    next.impl->Invoke();
+    next.impl->Unref();
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished() const
+{
+    if (m_stop)
+    {
+        return true;
+    }
+    for (const auto& partition : m_partitions)
+    {
+        if (!partition->events->IsEmpty() || partition->minOutboxTs != NEVER)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+MultithreadedSimulatorImpl::Run()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ABORT_MSG_IF(GetNPartitions() > 0 && NodeList::GetNNodes() != m_nodePartition.size(),
+                    "MultithreadedSimulatorImpl: nodes were created after the first Run()");
+    if (GetNPartitions() == 0)
+    {
+        DoPartition();
+    }
+    uint32_t nPartitions = GetNPartitions();
+
+    m_mainThreadId = std::this_thread::get_id();
+    m_stop = false;
+    m_finished = false;
+    m_running = true;
+    m_barrier.Reset(nPartitions);
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < nPartitions; ++i)
+    {
+        threads.emplace_back(&MultithreadedSimulatorImpl::RunPartition, this, i);
+    }
+    RunPartition(0);
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    m_running = false;
+
+    // deliver what a stop left in the mailboxes, the time of the simulation
+    // is the one of the partition which went the furthest
+    for (uint32_t i = 0; i < nPartitions; ++i)
+    {
+        Partition* partition = m_partitions[i].get();
+        for (auto& outbox : partition->outbox)
+        {
+            for (uint32_t j = 0; j <= nPartitions; ++j)
+            {
+                Receive(outbox[j], m_partitions[j].get());
+            }
+        }
+        partition->minOutboxTs = NEVER;
+        m_global->currentTs = std::max(m_global->currentTs, partition->currentTs);
+    }
+
+    // If the simulator stopped naturally by lack of events, make a
+    // consistency test to check that we didn't lose any events along the way.
+    NS_ASSERT(m_stop ||
+              std::all_of(m_partitions.begin(), m_partitions.end(), [](const auto& partition) {
+                  return partition->unscheduledEvents == 0;
+              }));
+}
+
+void
+MultithreadedSimulatorImpl::RunPartition(uint32_t index)
+{
+    g_currentPartition = m_partitions[index].get();
+    bool sense = false;
+    while (true)
+    {
+        m_barrier.Wait(sense);
+        if (index == 0)
+        {
+            Synchronize();
+        }
+        m_barrier.Wait(sense);
+        if (m_finished)
+        {
+            break;
+        }
+        ProcessWindow(index);
+    }
+    g_currentPartition = nullptr;
+}
+
+void
+MultithreadedSimulatorImpl::ProcessWindow(uint32_t index)
+{
+    Partition* partition = m_partitions[index].get();
+    for (uint32_t i = 0; i < GetNPartitions(); ++i)
+    {
+        Receive(m_partitions[i]->outbox[m_parity ^ 1][index], partition);
+    }
+    partition->minOutboxTs = NEVER;
+    while (!partition->events->IsEmpty() && partition->events->PeekNext().key.m_ts < m_windowEnd)
+    {
+        ProcessOneEvent(partition);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Synchronize()
+{
+    uint32_t nPartitions = GetNPartitions();
+    for (uint32_t i = 0; i < nPartitions; ++i)
+    {
+        Receive(m_partitions[i]->outbox[m_parity][nPartitions], m_global);
+    }
+    {
+        std::unique_lock lock{m_externalEventsMutex};
+        uint64_t now = std::max(m_windowEnd, m_global->currentTs);
+        for (const auto& ev : m_externalEvents)
+        {
+            Insert(GetPartitionOf(ev.context), now + ev.delay, ev.context, ev.event);
+        }
+        m_externalEvents.clear();
+    }
+
+    g_currentPartition = m_global;
+    while (true)
+    {
+        if (m_stop)
+        {
+            m_finished = true;
+            break;
+        }
+        uint64_t next = NEVER;
+        for (uint32_t i = 0; i < nPartitions; ++i)
+        {
+            Partition* partition = m_partitions[i].get();
+            if (!partition->events->IsEmpty())
+            {
+                next = std::min(next, partition->events->PeekNext().key.m_ts);
+            }
+            next = std::min(next, partition->minOutboxTs);
+        }
+        uint64_t nextGlobal =
+            m_global->events->IsEmpty() ? NEVER : m_global->events->PeekNext().key.m_ts;
+        if (next == NEVER && nextGlobal == NEVER)
+        {
+            m_finished = true;
+            break;
+        }
+        if (nextGlobal <= next)
+        {
+            // every partition got there, the event may touch any node
+            ProcessOneEvent(m_global);
+            continue;
+        }
+        m_windowEnd = next < NEVER - m_lookahead ? next + m_lookahead : NEVER;
+        m_windowEnd = std::min(m_windowEnd, nextGlobal);
+        m_parity ^= 1;
+        m_nWindows++;
+        break;
+    }
+    g_currentPartition = m_partitions[0].get();
+}
+
+void
+MultithreadedSimulatorImpl::Stop()
+{
+    NS_LOG_FUNCTION(this);
+    m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop(const Time& delay)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep());
+    Simulator::Schedule(delay, &Simulator::Stop);
+}
+
+EventId
+MultithreadedSimulatorImpl::Schedule(const Time& delay, EventImpl* event)
+{
+    NS_ASSERT_MSG(g_currentPartition != nullptr || !m_running ||
+                      m_mainThreadId == std::this_thread::get_id(),
+                  "Simulator::Schedule Thread-unsafe invocation!");
+    NS_ASSERT_MSG(delay.IsPositive(), "MultithreadedSimulatorImpl::Schedule(): Negative delay");
+    Partition* partition = GetCurrentPartition();
+    return Insert(partition,
+                  partition->currentTs + delay.GetTimeStep(),
+                  partition->currentContext,
+                  event);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext(uint32_t context,
+                                                const Time& delay,
+                                                EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << context << delay.GetTimeStep() << event);
+    Partition* current = g_currentPartition;
+    if (current == nullptr)
+    {
+        if (m_running && m_mainThreadId != std::this_thread::get_id())
+        {
+            // a thread of its own, like the reader of an emulated device
+            std::unique_lock lock{m_externalEventsMutex};
+            uint64_t ts = delay.GetTimeStep();
+            m_externalEvents.push_back({context, ts, event});
+            return;
+        }
+        current = m_global;
+    }
+
+    uint64_t ts = current->currentTs + delay.GetTimeStep();
+    Partition* target = GetPartitionOf(context);
+    if (target == current || current == m_global || !m_running)
+    {
+        // the other threads wait at the barrier while the global events run
+        Insert(target, ts, context, event);
+        return;
+    }
+
+    NS_ABORT_MSG_IF(ts < m_windowEnd,
+                    "MultithreadedSimulatorImpl: node "
+                        << current->currentContext << " scheduled an event on node " << context
+                        << " of another partition " << TimeStep(ts - current->currentTs).As()
+                        << " later, before the end of the window at "
+                        << TimeStep(m_windowEnd).As() << "; the lookahead is "
+                        << GetLookahead().As());
+    Scheduler::Event ev;
+    ev.impl = event;
+    ev.key.m_ts = ts;
+    ev.key.m_context = context;
+    ev.key.m_uid = 0; // given by the receiver
+    current->outbox[m_parity][target->index].push_back(ev);
+    if (target != m_global)
+    {
+        current->minOutboxTs = std::min(current->minOutboxTs, ts);
+    }
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow(EventImpl* event)
+{
+    return Schedule(Time(0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy(EventImpl* event)
+{
+    NS_ASSERT_MSG(m_mainThreadId == std::this_thread::get_id(),
+                  "Simulator::ScheduleDestroy Thread-unsafe invocation!");
+
+    EventId id(Ptr<EventImpl>(event, false),
+               m_global->currentTs,
+               Simulator::NO_CONTEXT,
+               EventId::UID::DESTROY);
+    m_destroyEvents.push_back(id);
+    return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now() const
+{
+    // Do not add function logging here, to avoid stack overflow
+    return TimeStep(GetCurrentPartition()->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft(const EventId& id) const
+{
+    if (IsExpired(id))
+    {
+        return TimeStep(0);
+    }
+    return TimeStep(id.GetTs() - GetPartitionOf(id.GetContext())->currentTs);
+}
+
+void
+MultithreadedSimulatorImpl::Remove(const EventId& id)
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        // destroy events.
+        for (auto i = m_destroyEvents.begin(); i != m_destroyEvents.end(); i++)
+        {
+            if (*i == id)
+            {
+                m_destroyEvents.erase(i);
+                break;
+            }
+        }
+        return;
+    }
+    if (IsExpired(id))
+    {
+        return;
+    }
+    Partition* partition = GetPartitionOf(id.GetContext());
+    NS_ASSERT_MSG(!m_running || partition == GetCurrentPartition(),
+                  "MultithreadedSimulatorImpl: cannot remove an event of another partition");
+    Scheduler::Event event;
+    event.impl = id.PeekEventImpl();
+    event.key.m_ts = id.GetTs();
+    event.key.m_context = id.GetContext();
+    event.key.m_uid = id.GetUid();
+    partition->events->Remove(event);
+    event.impl->Cancel();
+    // whenever we remove an event from the event list, we have to unref it.
+    event.impl->Unref();
+
+    partition->unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel(const EventId& id)
+{
+    if (!IsExpired(id))
+    {
+        id.PeekEventImpl()->Cancel();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired(const EventId& id) const
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        if (id.PeekEventImpl() == nullptr || id.PeekEventImpl()->IsCancelled())
+        {
+            return true;
+        }
+        // destroy events.
+        for (auto i = m_destroyEvents.begin(); i != m_destroyEvents.end(); i++)
+        {
+            if (*i == id)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    const Partition* partition = GetPartitionOf(id.GetContext());
+    return id.PeekEventImpl() == nullptr || id.GetTs() < partition->currentTs ||
+           (id.GetTs() == partition->currentTs && id.GetUid() <= partition->currentUid) ||
+           id.PeekEventImpl()->IsCancelled();
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime() const
+{
+    return TimeStep(0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext() const
+{
+    return GetCurrentPartition()->currentContext;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount() const
+{
+    uint64_t eventCount = 0;
+    for (const auto& partition : m_partitions)
+    {
+        eventCount += partition->eventCount;
+    }
+    return eventCount;
+}
+
+void
+MultithreadedSimulatorImpl::Barrier::Reset(uint32_t n)
+{
+    m_n = n;
+    m_count = n;
+    m_sense = false;
+}
+
+void
+MultithreadedSimulatorImpl::Barrier::Wait(bool& sense)
+{
+    sense = !sense;
+    if (m_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        m_count.store(m_n, std::memory_order_relaxed);
+        m_sense.store(sense, std::memory_order_release);
+        return;
+    }
+    for (uint32_t spins = 0; m_sense.load(std::memory_order_acquire) != sense; spins++)
+    {
+        if (spins >= BARRIER_SPINS)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+} // namespace ns3
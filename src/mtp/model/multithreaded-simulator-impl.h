@@ -0,0 +1,259 @@
+/**
+ * \file
+ * \ingroup mtp
+ * Declaration of class ns3::MultithreadedSimulatorImpl.
+ */
+
+#ifndef NS3_MULTITHREADED_SIMULATOR_IMPL_H
+#define NS3_MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/event-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/ptr.h"
+#include "ns3/scheduler.h"
+#include "ns3/simulator-impl.h"
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * \defgroup mtp Multithreaded simulation
+ *
+ * Runs a simulation on the threads of a single machine, without MPI.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup mtp
+ * \brief Simulator implementation running the nodes on several threads.
+ *
+ * Selected with
+ * \code
+ *   GlobalValue::Bind("SimulatorImplementationType",
+ *                     StringValue("ns3::MultithreadedSimulatorImpl"));
+ * \endcode
+ * in a build configured with NS3_MTP, which makes the reference counts, the
+ * packets and the random stream numbering safe to share between threads.
+ *
+ * The first Run() splits the nodes into as many partitions as there are
+ * threads. The nodes attached to a channel without a positive "Delay"
+ * attribute, like a bridge or a wireless channel, always end up together;
+ * the rest is cut into runs of consecutive node ids of about the same size,
+ * since the helpers create neighbouring nodes one after the other. The
+ * smallest delay of a channel between two partitions is the lookahead:
+ * an event of a node cannot cause one on a node of another partition
+ * sooner than that.
+ *
+ * The simulation then advances by windows. A window goes from the earliest
+ * pending event to that time plus the lookahead, and every partition
+ * processes its events of the window on its own thread, with the main thread
+ * running the first partition. An event scheduled for a node of another
+ * partition is put in a mailbox of the sending partition, one per receiving
+ * partition, and the receiver takes it out at the start of the next window.
+ * Each mailbox has a single writer and the windows are separated by
+ * barriers, so no lock is ever taken. Since the mailboxes are emptied in
+ * partition order, a simulation gives the same results whatever the timing
+ * of the threads.
+ *
+ * The events without a node context, like the ones scheduled by the main
+ * program with Simulator::Schedule(), are global: they run on the main
+ * thread between two windows, when all the partitions have reached their
+ * time, and may touch any node. Simulator::Stop() called from an event
+ * takes effect at the end of the current window.
+ *
+ * The nodes may only interact through channels, or through events scheduled
+ * far enough in the future: scheduling an event on another partition before
+ * the end of the current window aborts the simulation. Nodes may not be
+ * created after the first Run().
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Default constructor. */
+    MultithreadedSimulatorImpl();
+    /** Destructor. */
+    ~MultithreadedSimulatorImpl() override;
+
+    // Inherited
+    void Destroy() override;
+    bool IsFinished() const override;
+    void Stop() override;
+    void Stop(const Time& delay) override;
+    EventId Schedule(const Time& delay, EventImpl* event) override;
+    void ScheduleWithContext(uint32_t context, const Time& delay, EventImpl* event) override;
+    EventId ScheduleNow(EventImpl* event) override;
+    EventId ScheduleDestroy(EventImpl* event) override;
+    void Remove(const EventId& id) override;
+    void Cancel(const EventId& id) override;
+    bool IsExpired(const EventId& id) const override;
+    void Run() override;
+    Time Now() const override;
+    Time GetDelayLeft(const EventId& id) const override;
+    Time GetMaximumSimulationTime() const override;
+    void SetScheduler(ObjectFactory schedulerFactory) override;
+    uint32_t GetSystemId() const override;
+    uint32_t GetContext() const override;
+    uint64_t GetEventCount() const override;
+
+    /** \return the number of partitions, 0 before the first Run() */
+    uint32_t GetNPartitions() const;
+    /**
+     * \param nodeId the id of a node
+     * \return the partition of the node
+     */
+    uint32_t GetPartition(uint32_t nodeId) const;
+    /** \return the lookahead, the maximum time if no channel crosses partitions */
+    Time GetLookahead() const;
+    /** \return the number of windows run so far */
+    uint64_t GetNWindows() const;
+
+  private:
+    void DoDispose() override;
+
+    /// The events, the time and the mailboxes of a group of nodes.
+    struct Partition
+    {
+        uint32_t index;          //!< index of the partition, the global one is the last
+        Ptr<Scheduler> events;   //!< the events of the nodes of the partition
+        uint64_t currentTs;      //!< timestamp of the current event
+        uint32_t currentContext; //!< context of the current event
+        uint32_t currentUid;     //!< uid of the current event
+        uint32_t uid;            //!< uid of the next event
+        uint64_t eventCount;     //!< number of events processed
+        int unscheduledEvents;   //!< number of events in the scheduler
+        /**
+         * The events sent to the other partitions, one list per receiver and
+         * per window parity, so that the mailboxes filled during a window are
+         * not the ones emptied at its start.
+         */
+        std::vector<std::vector<Scheduler::Event>> outbox[2];
+        uint64_t minOutboxTs; //!< earliest event sent during the window
+    };
+
+    /// A spinning barrier for the threads of the partitions.
+    class Barrier
+    {
+      public:
+        /**
+         * \param n the number of threads to wait for
+         */
+        void Reset(uint32_t n);
+        /**
+         * \brief Wait until all the threads got there
+         * \param sense the sense of the barrier as seen by the thread, flipped
+         */
+        void Wait(bool& sense);
+
+      private:
+        uint32_t m_n;                  //!< number of threads
+        std::atomic<uint32_t> m_count; //!< number of threads still to arrive
+        std::atomic<bool> m_sense;     //!< flipped by the last thread to arrive
+    };
+
+    /// An event scheduled by a thread which runs no partition.
+    struct ExternalEvent
+    {
+        uint32_t context; //!< the context of the event
+        uint64_t delay;   //!< the delay, counted from the end of the window
+        EventImpl* event; //!< the event
+    };
+
+    /**
+     * \brief Create an empty partition
+     * \param index the index of the partition
+     * \param nPartitions the number of partitions of the nodes
+     * \return the partition
+     */
+    std::unique_ptr<Partition> CreatePartition(uint32_t index, uint32_t nPartitions) const;
+    /** Split the nodes into partitions and compute the lookahead. */
+    void DoPartition();
+    /**
+     * \param context the context of an event
+     * \return the partition running it, the global one if not a node
+     */
+    Partition* GetPartitionOf(uint32_t context) const;
+    /** \return the partition of the calling thread, the global one if none */
+    Partition* GetCurrentPartition() const;
+    /**
+     * \brief Insert an event in the scheduler of a partition
+     * \param partition the partition
+     * \param ts the timestamp of the event
+     * \param context the context of the event
+     * \param event the event
+     * \return the id of the event
+     */
+    EventId Insert(Partition* partition, uint64_t ts, uint32_t context, EventImpl* event);
+    /**
+     * \brief Process the next event of a partition
+     * \param partition the partition
+     */
+    void ProcessOneEvent(Partition* partition);
+    /**
+     * \brief Run a partition on the calling thread until the simulation ends
+     * \param index the index of the partition
+     */
+    void RunPartition(uint32_t index);
+    /**
+     * \brief Process the events of a partition in the current window
+     * \param index the index of the partition
+     */
+    void ProcessWindow(uint32_t index);
+    /**
+     * \brief Run the global events due before the next window, then set it
+     *
+     * Runs on the main thread while the others wait at the barrier.
+     */
+    void Synchronize();
+    /**
+     * \brief Move the events of a mailbox in the scheduler of its receiver
+     * \param box the mailbox
+     * \param receiver the receiving partition
+     */
+    void Receive(std::vector<Scheduler::Event>& box, Partition* receiver);
+
+    /// The partitions of the nodes followed by the global one.
+    std::vector<std::unique_ptr<Partition>> m_partitions;
+    /// The partition running the events which belong to no node.
+    Partition* m_global;
+    /// The partition of each node.
+    std::vector<uint32_t> m_nodePartition;
+    /// The factory creating the scheduler of each partition.
+    ObjectFactory m_schedulerFactory;
+
+    uint32_t m_maxThreads;          //!< maximum number of threads, 0 for one per core
+    uint64_t m_lookahead;           //!< the lookahead, in time steps
+    uint64_t m_windowEnd;           //!< end of the current window, excluded
+    uint64_t m_nWindows;            //!< number of windows run
+    int m_parity;                   //!< parity of the current window
+    bool m_running;                 //!< whether Run() is running
+    bool m_finished;                //!< set by Synchronize() when Run() must return
+    std::atomic<bool> m_stop;       //!< set by Stop()
+    Barrier m_barrier;              //!< the barrier separating the windows
+    std::thread::id m_mainThreadId; //!< the thread calling Run()
+
+    /// The events scheduled by threads which run no partition.
+    std::list<ExternalEvent> m_externalEvents;
+    std::mutex m_externalEventsMutex; //!< protects m_externalEvents
+
+    typedef std::list<EventId> DestroyEvents; //!< container for the destroy events
+    DestroyEvents m_destroyEvents;            //!< the events to run at Destroy()
+
+    /// The partition run by the calling thread.
+    static thread_local Partition* g_currentPartition;
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_SIMULATOR_IMPL_H */
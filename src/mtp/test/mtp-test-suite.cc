@@ -0,0 +1,265 @@
+#include "ns3/config.h"
+#include "ns3/global-value.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/network-module.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <vector>
+
+/**
+ * \file
+ * \ingroup mtp-tests
+ * Multithreaded simulator implementation test suite
+ */
+
+/**
+ * \ingroup mtp
+ * \defgroup mtp-tests Multithreaded simulation tests
+ */
+
+using namespace ns3;
+
+/**
+ * \ingroup mtp-tests
+ *
+ * \brief Check that the nodes are split across the threads along the
+ * channel delays.
+ *
+ * Eight nodes in a ring of 1us channels, plus a channel without delay
+ * between the nodes 1 and 6, run on four threads.
+ */
+class MtpPartitionTestCase : public TestCase
+{
+  public:
+    MtpPartitionTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+MtpPartitionTestCase::MtpPartitionTestCase()
+    : TestCase("Split the nodes into partitions and compute the lookahead")
+{
+}
+
+void
+MtpPartitionTestCase::DoRun()
+{
+    GlobalValue::Bind("SimulatorImplementationType",
+                      StringValue("ns3::MultithreadedSimulatorImpl"));
+    Config::SetDefault("ns3::MultithreadedSimulatorImpl::MaxThreads", UintegerValue(4));
+
+    NodeContainer nodes;
+    nodes.Create(8);
+    SimpleNetDeviceHelper helper;
+    helper.SetChannelAttribute("Delay", TimeValue(MicroSeconds(1)));
+    for (uint32_t i = 0; i < nodes.GetN(); ++i)
+    {
+        helper.Install(NodeContainer(nodes.Get(i), nodes.Get((i + 1) % nodes.GetN())));
+    }
+    helper.SetChannelAttribute("Delay", TimeValue(Seconds(0)));
+    helper.Install(NodeContainer(nodes.Get(1), nodes.Get(6)));
+
+    Simulator::Run();
+    Ptr<MultithreadedSimulatorImpl> impl =
+        DynamicCast<MultithreadedSimulatorImpl>(Simulator::GetImplementation());
+    NS_TEST_ASSERT_MSG_NE(impl, nullptr, "not a multithreaded simulation");
+    NS_TEST_EXPECT_MSG_EQ(impl->GetNPartitions(), 4, "one partition per thread");
+    NS_TEST_EXPECT_MSG_EQ(impl->GetPartition(1),
+                          impl->GetPartition(6),
+                          "the nodes of a channel without delay are together");
+    NS_TEST_EXPECT_MSG_EQ(impl->GetPartition(0), 0, "the partitions follow the node ids");
+    NS_TEST_EXPECT_MSG_EQ(impl->GetPartition(7), 3, "the partitions follow the node ids");
+    NS_TEST_EXPECT_MSG_EQ(impl->GetLookahead(), MicroSeconds(1), "lookahead");
+    Simulator::Destroy();
+
+    Config::SetDefault("ns3::MultithreadedSimulatorImpl::MaxThreads", UintegerValue(0));
+    GlobalValue::Bind("SimulatorImplementationType", StringValue("ns3::DefaultSimulatorImpl"));
+}
+
+/**
+ * \ingroup mtp-tests
+ *
+ * \brief Check that a simulation gives the same results on several threads
+ * as on one.
+ *
+ * Every node of a ring sends a packet to both its neighbours, which, after
+ * a processing delay of their own, send it on until its hop count runs out.
+ * A global event counts the packets received at some point. The times at
+ * which every node received its packets, the count and the time of the end
+ * must match the ones of DefaultSimulatorImpl.
+ */
+class MtpRingTestCase : public TestCase
+{
+  public:
+    MtpRingTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Run the ring
+     * \param simulatorType the simulator implementation
+     */
+    void RunRing(const std::string& simulatorType);
+    /**
+     * \brief Send a packet to both neighbours
+     * \param node the sending node
+     * \param hops the number of hops left
+     */
+    void Send(uint32_t node, uint32_t hops);
+    /**
+     * \brief Receive a packet, the size of which is the hop count
+     * \param device the receiving device
+     * \param packet the packet
+     * \param protocol the protocol
+     * \param from the sender
+     * \return true
+     */
+    bool Receive(Ptr<NetDevice> device,
+                 Ptr<const Packet> packet,
+                 uint16_t protocol,
+                 const Address& from);
+    /** Count the packets received so far. */
+    void Count();
+
+    NodeContainer m_nodes;                       //!< the ring
+    std::vector<std::vector<int64_t>> m_times;   //!< when each node received a packet
+    uint64_t m_count;                            //!< packets counted by the global event
+    Time m_end;                                  //!< time at the end of the simulation
+    uint64_t m_windows;                          //!< windows run by the multithreaded one
+};
+
+MtpRingTestCase::MtpRingTestCase()
+    : TestCase("Multithreaded simulation gives the results of the sequential one")
+{
+}
+
+void
+MtpRingTestCase::Send(uint32_t node, uint32_t hops)
+{
+    Ptr<Node> n = m_nodes.Get(node);
+    for (uint32_t i = 0; i < n->GetNDevices(); ++i)
+    {
+        Ptr<NetDevice> device = n->GetDevice(i);
+        device->Send(Create<Packet>(hops), device->GetBroadcast(), 0x800);
+    }
+}
+
+bool
+MtpRingTestCase::Receive(Ptr<NetDevice> device,
+                         Ptr<const Packet> packet,
+                         uint16_t protocol,
+                         const Address& from)
+{
+    uint32_t node = device->GetNode()->GetId();
+    m_times[node].push_back(Simulator::Now().GetNanoSeconds());
+    if (packet->GetSize() > 1)
+    {
+        Simulator::Schedule(NanoSeconds(10 * (node + 1)),
+                            &MtpRingTestCase::Send,
+                            this,
+                            node,
+                            packet->GetSize() - 1);
+    }
+    return true;
+}
+
+void
+MtpRingTestCase::Count()
+{
+    m_count = 0;
+    for (const auto& times : m_times)
+    {
+        m_count += times.size();
+    }
+}
+
+void
+MtpRingTestCase::RunRing(const std::string& simulatorType)
+{
+    GlobalValue::Bind("SimulatorImplementationType", StringValue(simulatorType));
+    Config::SetDefault("ns3::MultithreadedSimulatorImpl::MaxThreads", UintegerValue(4));
+
+    m_nodes = NodeContainer();
+    m_nodes.Create(8);
+    SimpleNetDeviceHelper helper;
+    helper.SetChannelAttribute("Delay", TimeValue(MicroSeconds(1)));
+    for (uint32_t i = 0; i < m_nodes.GetN(); ++i)
+    {
+        NetDeviceContainer devices =
+            helper.Install(NodeContainer(m_nodes.Get(i), m_nodes.Get((i + 1) % m_nodes.GetN())));
+        for (uint32_t j = 0; j < devices.GetN(); ++j)
+        {
+            devices.Get(j)->SetReceiveCallback(MakeCallback(&MtpRingTestCase::Receive, this));
+        }
+    }
+    m_times.assign(m_nodes.GetN(), std::vector<int64_t>());
+    m_count = 0;
+    m_windows = 0;
+
+    for (uint32_t i = 0; i < m_nodes.GetN(); ++i)
+    {
+        Simulator::ScheduleWithContext(i, NanoSeconds(i), &MtpRingTestCase::Send, this, i, 6);
+    }
+    Simulator::Schedule(NanoSeconds(3500), &MtpRingTestCase::Count, this);
+    Simulator::Stop(MicroSeconds(5));
+    Simulator::Run();
+
+    m_end = Simulator::Now();
+    Ptr<MultithreadedSimulatorImpl> impl =
+        DynamicCast<MultithreadedSimulatorImpl>(Simulator::GetImplementation());
+    if (impl)
+    {
+        m_windows = impl->GetNWindows();
+    }
+    Simulator::Destroy();
+
+    Config::SetDefault("ns3::MultithreadedSimulatorImpl::MaxThreads", UintegerValue(0));
+    GlobalValue::Bind("SimulatorImplementationType", StringValue("ns3::DefaultSimulatorImpl"));
+}
+
+void
+MtpRingTestCase::DoRun()
+{
+    RunRing("ns3::DefaultSimulatorImpl");
+    std::vector<std::vector<int64_t>> times = m_times;
+    uint64_t count = m_count;
+    Time end = m_end;
+
+    RunRing("ns3::MultithreadedSimulatorImpl");
+    NS_TEST_EXPECT_MSG_GT(m_windows, 1, "the simulation did not advance by windows");
+    NS_TEST_EXPECT_MSG_GT(count, 0, "the global event counted no packet");
+    NS_TEST_EXPECT_MSG_EQ(m_count, count, "the global event saw another state");
+    NS_TEST_EXPECT_MSG_EQ(m_end, end, "the simulation did not stop at the same time");
+    for (uint32_t i = 0; i < times.size(); ++i)
+    {
+        NS_TEST_ASSERT_MSG_EQ(m_times[i].size(), times[i].size(), "node " << i);
+        for (uint32_t j = 0; j < times[i].size(); ++j)
+        {
+            NS_TEST_EXPECT_MSG_EQ(m_times[i][j], times[i][j], "node " << i << " packet " << j);
+        }
+    }
+}
+
+/**
+ * \ingroup mtp-tests
+ *
+ * \brief The multithreaded simulation test suite.
+ */
+class MtpTestSuite : public TestSuite
+{
+  public:
+    MtpTestSuite()
+        : TestSuite("mtp", UNIT)
+    {
+        AddTestCase(new MtpPartitionTestCase(), TestCase::QUICK);
+        AddTestCase(new MtpRingTestCase(), TestCase::QUICK);
+    }
+};
+
+/// Static variable for test initialization.
+static MtpTestSuite g_mtpTestSuite;
@@ -54,7 +54,23 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("Buffer");
 
+/**
+ * Whether a buffer may write in place in front of or after the data it shares
+ * with other buffers, as long as none of them wrote there before. The other
+ * buffers may belong to packets of another thread, which could claim the same
+ * bytes at the same time, when the simulation runs on several threads.
+ */
+#ifdef NS3_MTP
+static const bool g_shareDirtyArea = false;
+#else
+static const bool g_shareDirtyArea = true;
+#endif
+
+#ifdef NS3_MTP
+thread_local uint32_t Buffer::g_recommendedStart = 0;
+#else
 uint32_t Buffer::g_recommendedStart = 0;
+#endif
 #ifdef BUFFER_FREE_LIST
 /* The following macros are pretty evil but they are needed to allow us to
  * keep track of 3 possible states for the g_freeList variable:
@@ -263,8 +279,7 @@ Buffer::operator=(const Buffer& o)
     if (m_data != o.m_data)
     {
         // not assignment to self.
-        m_data->m_count--;
-        if (m_data->m_count == 0)
+        if (--m_data->m_count == 0)
         {
             Recycle(m_data);
         }
@@ -286,8 +301,7 @@ Buffer::~Buffer()
     NS_LOG_FUNCTION(this);
     NS_ASSERT(CheckInternalState());
     g_recommendedStart = std::max(g_recommendedStart, m_maxZeroAreaStart);
-    m_data->m_count--;
-    if (m_data->m_count == 0)
+    if (--m_data->m_count == 0)
     {
         Recycle(m_data);
     }
@@ -312,7 +326,7 @@ Buffer::AddAtStart(uint32_t start)
 {
     NS_LOG_FUNCTION(this << start);
     NS_ASSERT(CheckInternalState());
-    bool isDirty = m_data->m_count > 1 && m_start > m_data->m_dirtyStart;
+    bool isDirty = m_data->m_count > 1 && (!g_shareDirtyArea || m_start > m_data->m_dirtyStart);
     if (m_start >= start && !isDirty)
     {
         /* enough space in the buffer and not dirty.
@@ -330,8 +344,7 @@ Buffer::AddAtStart(uint32_t start)
         uint32_t newSize = GetInternalSize() + start;
         struct Buffer::Data* newData = Buffer::Create(newSize);
         memcpy(newData->m_data + start, m_data->m_data + m_start, GetInternalSize());
-        m_data->m_count--;
-        if (m_data->m_count == 0)
+        if (--m_data->m_count == 0)
         {
             Buffer::Recycle(m_data);
         }
@@ -358,7 +371,7 @@ Buffer::AddAtEnd(uint32_t end)
 {
     NS_LOG_FUNCTION(this << end);
     NS_ASSERT(CheckInternalState());
-    bool isDirty = m_data->m_count > 1 && m_end < m_data->m_dirtyEnd;
+    bool isDirty = m_data->m_count > 1 && (!g_shareDirtyArea || m_end < m_data->m_dirtyEnd);
     if (GetInternalEnd() + end <= m_data->m_size && !isDirty)
     {
         /* enough space in buffer and not dirty
@@ -376,8 +389,7 @@ Buffer::AddAtEnd(uint32_t end)
         uint32_t newSize = GetInternalSize() + end;
         struct Buffer::Data* newData = Buffer::Create(newSize);
         memcpy(newData->m_data, m_data->m_data + m_start, GetInternalSize());
-        m_data->m_count--;
-        if (m_data->m_count == 0)
+        if (--m_data->m_count == 0)
         {
             Buffer::Recycle(m_data);
         }
@@ -24,8 +24,15 @@
 #include <ostream>
 #include <stdint.h>
 #include <vector>
+#ifdef NS3_MTP
+#include <atomic>
+#endif
 
+// the data of a packet may be released by another thread than the one which
+// created it when the simulation runs on several threads
+#ifndef NS3_MTP
 #define BUFFER_FREE_LIST 1
+#endif
 
 namespace ns3
 {
@@ -665,7 +672,11 @@ class Buffer
          * The reference count of an instance of this data structure.
          * Each buffer which references an instance holds a count.
          */
+#ifdef NS3_MTP
+        std::atomic<uint32_t> m_count;
+#else
         uint32_t m_count;
+#endif
         /**
          * the size of the m_data field below.
          */
@@ -769,7 +780,11 @@ class Buffer
      * writing data. i.e., m_start should be initialized to this
      * value.
      */
+#ifdef NS3_MTP
+    static thread_local uint32_t g_recommendedStart;
+#else
     static uint32_t g_recommendedStart;
+#endif
 
     /**
      * offset to the start of the virtual zero area from the start
@@ -23,8 +23,15 @@
 #include <cstring>
 #include <limits>
 #include <vector>
+#ifdef NS3_MTP
+#include <atomic>
+#endif
 
+// the tags of a packet may be released by another thread than the one which
+// created them when the simulation runs on several threads
+#ifndef NS3_MTP
 #define USE_FREE_LIST 1
+#endif
 #define FREE_LIST_SIZE 1000
 #define OFFSET_MAX (std::numeric_limits<int32_t>::max())
 
@@ -33,6 +40,17 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("ByteTagList");
 
+/**
+ * Whether a list may append in place to the tags it shares with other lists,
+ * as long as none of them appended there before. The other lists may belong
+ * to packets of another thread when the simulation runs on several threads.
+ */
+#ifdef NS3_MTP
+static const bool g_shareDirtyArea = false;
+#else
+static const bool g_shareDirtyArea = true;
+#endif
+
 /**
  * \ingroup packet
  *
@@ -43,7 +61,11 @@ NS_LOG_COMPONENT_DEFINE("ByteTagList");
 struct ByteTagListData
 {
     uint32_t size;   //!< size of the data
+#ifdef NS3_MTP
+    std::atomic<uint32_t> count; //!< use counter (for smart deallocation)
+#else
     uint32_t count;  //!< use counter (for smart deallocation)
+#endif
     uint32_t dirty;  //!< number of bytes actually in use
     uint8_t data[4]; //!< data
 };
@@ -211,7 +233,8 @@ ByteTagList::Add(TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
         m_data = Allocate(spaceNeeded);
         m_used = 0;
     }
-    else if (m_data->size < spaceNeeded || (m_data->count != 1 && m_data->dirty != m_used))
+    else if (m_data->size < spaceNeeded ||
+             (m_data->count != 1 && (!g_shareDirtyArea || m_data->dirty != m_used)))
     {
         struct ByteTagListData* newData = Allocate(spaceNeeded);
         std::memcpy(&newData->data, &m_data->data, m_used);
@@ -386,8 +409,7 @@ ByteTagList::Deallocate(struct ByteTagListData* data)
         return;
     }
     g_maxSize = std::max(g_maxSize, data->size);
-    data->count--;
-    if (data->count == 0)
+    if (--data->count == 0)
     {
         if (g_freeList.size() > FREE_LIST_SIZE || data->size < g_maxSize)
         {
@@ -423,8 +445,7 @@ ByteTagList::Deallocate(struct ByteTagListData* data)
     {
         return;
     }
-    data->count--;
-    if (data->count == 0)
+    if (--data->count == 0)
     {
         uint8_t* buffer = (uint8_t*)data;
         delete[] buffer;
@@ -34,11 +34,29 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("PacketMetadata");
 
+/**
+ * Whether an item may be appended in place to the data shared with other
+ * metadata, as long as none of them appended there before. The other
+ * metadata may belong to packets of another thread when the simulation runs
+ * on several threads.
+ */
+#ifdef NS3_MTP
+static const bool g_shareDirtyEnd = false;
+#else
+static const bool g_shareDirtyEnd = true;
+#endif
+
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
+#ifdef NS3_MTP
+std::atomic<bool> PacketMetadata::m_metadataSkipped = false;
+thread_local uint32_t PacketMetadata::m_maxSize = 0;
+std::atomic<uint16_t> PacketMetadata::m_chunkUid = 0;
+#else
 bool PacketMetadata::m_metadataSkipped = false;
 uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
+#endif
 PacketMetadata::DataFreeList PacketMetadata::m_freeList;
 
 PacketMetadata::DataFreeList::~DataFreeList()
@@ -80,8 +98,7 @@ PacketMetadata::ReserveCopy(uint32_t size)
     struct PacketMetadata::Data* newData = PacketMetadata::Create(m_used + size);
     memcpy(newData->m_data, m_data->m_data, m_used);
     newData->m_dirtyEnd = m_used;
-    m_data->m_count--;
-    if (m_data->m_count == 0)
+    if (--m_data->m_count == 0)
     {
         PacketMetadata::Recycle(m_data);
     }
@@ -105,7 +122,8 @@ PacketMetadata::Reserve(uint32_t size)
     NS_LOG_FUNCTION(this << size);
     NS_ASSERT(m_data != nullptr);
     if (m_data->m_size >= m_used + size &&
-        (m_head == 0xffff || m_data->m_count == 1 || m_data->m_dirtyEnd == m_used))
+        (m_head == 0xffff || m_data->m_count == 1 ||
+         (g_shareDirtyEnd && m_data->m_dirtyEnd == m_used)))
     {
         /* enough room, not dirty. */
     }
@@ -385,7 +403,8 @@ PacketMetadata::AddSmall(const struct PacketMetadata::SmallItem* item)
     uint32_t sizeSize = GetUleb128Size(item->size);
     uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2;
     if (m_used + n > m_data->m_size ||
-        (m_head != 0xffff && m_data->m_count != 1 && m_used != m_data->m_dirtyEnd))
+        (m_head != 0xffff && m_data->m_count != 1 &&
+         (!g_shareDirtyEnd || m_used != m_data->m_dirtyEnd)))
     {
         ReserveCopy(n);
     }
@@ -422,7 +441,8 @@ PacketMetadata::AddBig(uint32_t next,
     uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
 
     if (m_used + n > m_data->m_size ||
-        (m_head != 0xffff && m_data->m_count != 1 && m_used != m_data->m_dirtyEnd))
+        (m_head != 0xffff && m_data->m_count != 1 &&
+         (!g_shareDirtyEnd || m_used != m_data->m_dirtyEnd)))
     {
         ReserveCopy(n);
     }
@@ -593,7 +613,14 @@ void
 PacketMetadata::Recycle(struct PacketMetadata::Data* data)
 {
     NS_LOG_FUNCTION(data);
-    if (!m_enable)
+#ifdef NS3_MTP
+    // the data may have been created by another thread, each one would need
+    // a free list of its own
+    bool recycle = false;
+#else
+    bool recycle = m_enable;
+#endif
+    if (!recycle)
     {
         PacketMetadata::Deallocate(data);
         return;
@@ -671,8 +698,7 @@ PacketMetadata::DoAddHeader(uint32_t uid, uint32_t size)
     item.prev = 0xffff;
     item.typeUid = uid;
     item.size = size;
-    item.chunkUid = m_chunkUid;
-    m_chunkUid++;
+    item.chunkUid = m_chunkUid++;
     uint16_t written = AddSmall(&item);
     UpdateHead(written);
 }
@@ -739,8 +765,7 @@ PacketMetadata::AddTrailer(const Trailer& trailer, uint32_t size)
     item.prev = m_tail;
     item.typeUid = uid;
     item.size = size;
-    item.chunkUid = m_chunkUid;
-    m_chunkUid++;
+    item.chunkUid = m_chunkUid++;
     uint16_t written = AddSmall(&item);
     UpdateTail(written);
     NS_ASSERT(IsStateOk());
@@ -37,6 +37,30 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("PacketTagList");
 
+/**
+ * Drop the link of a list to a merge it has just linked around.
+ *
+ * The merge is normally still held by the other lists, but when the
+ * simulation runs on several threads they may have released it in the
+ * meantime. The last link then frees it, its successor being still linked
+ * from the list.
+ *
+ * \param [in] cur The merge.
+ */
+static void
+UnmergeTagData(PacketTagList::TagData* cur)
+{
+    if (--cur->count == 0)
+    {
+        if (cur->next != nullptr)
+        {
+            cur->next->count--;
+        }
+        cur->~TagData();
+        std::free(cur);
+    }
+}
+
 PacketTagList::TagData*
 PacketTagList::CreateTagData(size_t dataSize)
 {
@@ -45,7 +69,7 @@ PacketTagList::CreateTagData(size_t dataSize)
                                             << std::numeric_limits<decltype(TagData::size)>::max());
 
     void* p = std::malloc(sizeof(TagData) + dataSize - 1);
-    // The matching frees are in RemoveAll and RemoveWriter
+    // The matching frees are in RemoveAll, RemoveWriter and UnmergeTagData
 
     TagData* tag = new (p) TagData;
     tag->size = dataSize;
@@ -150,7 +174,6 @@ PacketTagList::COWTraverse(Tag& tag, PacketTagList::COWWriter Writer)
     {
         NS_ASSERT(cur != nullptr);
         NS_ASSERT(cur->count > 1);
-        cur->count--; // unmerge cur
         struct TagData* copy = CreateTagData(cur->size);
         copy->tid = cur->tid;
         copy->count = 1;
@@ -160,6 +183,7 @@ PacketTagList::COWTraverse(Tag& tag, PacketTagList::COWWriter Writer)
         copy->next->count++;    // mark new merge
         *prevNext = copy;       // point prior list at copy
         prevNext = &copy->next; // advance
+        UnmergeTagData(cur);
         cur = copy->next;
     }
     // Sanity check:
@@ -201,13 +225,13 @@ PacketTagList::RemoveWriter(Tag& tag,
     else
     {
         // cur is always a merge at this point
-        // unmerge cur, since we linked around it already
-        cur->count--;
         if (cur->next != nullptr)
         {
             // there's a next, so make it a merge
             cur->next->count++;
         }
+        // unmerge cur, since we linked around it already
+        UnmergeTagData(cur);
     }
     return found;
 }
@@ -243,7 +267,6 @@ PacketTagList::ReplaceWriter(Tag& tag,
     {
         // cur is always a merge at this point
         // need to copy, replace, and link past cur
-        cur->count--; // unmerge cur
         struct TagData* copy = CreateTagData(tag.GetSerializedSize());
         copy->tid = tag.GetInstanceTypeId();
         copy->count = 1;
@@ -253,7 +276,8 @@ PacketTagList::ReplaceWriter(Tag& tag,
         {
             copy->next->count++; // mark new merge
         }
-        *prevNext = copy; // point prior list at copy
+        *prevNext = copy;    // point prior list at copy
+        UnmergeTagData(cur); // unmerge cur
     }
     return found;
 }
@@ -28,6 +28,9 @@
 
 #include <ostream>
 #include <stdint.h>
+#ifdef NS3_MTP
+#include <atomic>
+#endif
 
 namespace ns3
 {
@@ -142,7 +145,11 @@ class PacketTagList
     struct TagData
     {
         struct TagData* next; //!< Pointer to next in list
+#ifdef NS3_MTP
+        std::atomic<uint32_t> count; //!< Number of incoming links
+#else
         uint32_t count;       //!< Number of incoming links
+#endif
         TypeId tid;           //!< Type of the tag serialized into #data
         uint32_t size;        //!< Size of the \c data buffer
         uint8_t data[1];      //!< Serialization buffer
@@ -358,8 +365,7 @@ PacketTagList::RemoveAll()
     struct TagData* prev = nullptr;
     for (struct TagData* cur = m_next; cur != nullptr; cur = cur->next)
     {
-        cur->count--;
-        if (cur->count > 0)
+        if (--cur->count > 0)
         {
             break;
         }
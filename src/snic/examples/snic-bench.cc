@@ -47,6 +47,18 @@ SchedTrace(Ptr<const SnicNetDevice> dev, Ptr<const Packet> pkt)
 int
 main(int argc, char* argv[])
 {
+    uint32_t workers = 0;
+    std::string outputDirectory = "single-flow";
+    std::string trace = "trace.txt";
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("workers", "Experiments run at once, 0 for one per core", workers);
+    cmd.AddValue("outputDirectory",
+                 "Where the experiments run; experiments already done there are skipped",
+                 outputDirectory);
+    cmd.AddValue("trace", "Arrival trace replayed by the clients", trace);
+    cmd.Parse(argc, argv);
+
     Time::SetResolution(Time::NS);
     // LogComponentEnable("SnicExample", LOG_LEVEL_LOGIC);
     // LogComponentEnable("Benchmark", LOG_LEVEL_LOGIC);
@@ -58,10 +70,13 @@ main(int argc, char* argv[])
     values.push_back(Create<UintegerValue>(400));
     values.push_back(Create<UintegerValue>(500));
     auto v = ExperimentVariable("PacketSize", MakeUintegerChecker<uint32_t>(), values);
-    benchmark.AddVariable("PacketSize", v);
+    benchmark.AddVariable(v);
+    benchmark.SetNumWorkers(workers);
+    benchmark.SetOutputDirectory(outputDirectory);
+    benchmark.SetArrivalTraceFile(trace);
 
     benchmark.Initialize();
-    benchmark.Run();
-    NS_LOG_INFO("Benchmark done.");
-    return 0;
+    uint32_t failed = benchmark.Run();
+    NS_LOG_INFO("Benchmark done, " << failed << " experiments failed.");
+    return failed > 0;
 }
@@ -0,0 +1,161 @@
+#include "ns3/applications-module.h"
+#include "ns3/cluster-topology.h"
+#include "ns3/core-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/snic-helper.h"
+#include "ns3/snic-net-device.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("SnicClusterScale");
+
+/*
+ * Builds a fat-tree, leaf-spine or torus cluster of sNICs and prints its
+ * size, the wall clock time and the memory its construction took, then runs
+ * a workload from the last host to the first one, behind the scheduler sNIC,
+ * and prints the simulator events per wall clock second along with the mean
+ * time the scheduler took to answer and what its decisions cost.
+ *
+ *   --topology=fattree --k=8
+ *   --topology=leafspine --leaves=32 --spines=8 --hosts=4
+ *   --topology=torus --rows=16 --columns=16 --hosts=1
+ *
+ * --maxPackets=0 only builds the cluster. --threads=N runs the simulation on
+ * N threads with the multithreaded simulator, in a build configured with
+ * --enable-mtp.
+ */
+
+// the trace may fire on several threads at once
+static std::atomic<uint64_t> g_allocations(0);
+static std::atomic<int64_t> g_allocationLatency(0);
+
+static void
+AllocationLatency(Time latency, uint32_t batchSize)
+{
+    g_allocations++;
+    g_allocationLatency += latency.GetTimeStep();
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string topology = "fattree";
+    uint32_t k = 4;
+    uint32_t nLeaves = 8;
+    uint32_t nSpines = 4;
+    uint32_t nRows = 4;
+    uint32_t nColumns = 4;
+    uint32_t nHosts = 0;
+    uint32_t maxPackets = 2000;
+    uint32_t nThreads = 0;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("topology", "fattree, leafspine or torus", topology);
+    cmd.AddValue("k", "Number of ports of a fat-tree switch", k);
+    cmd.AddValue("leaves", "Number of leaf sNICs", nLeaves);
+    cmd.AddValue("spines", "Number of spine sNICs", nSpines);
+    cmd.AddValue("rows", "Number of rows of the torus", nRows);
+    cmd.AddValue("columns", "Number of columns of the torus", nColumns);
+    cmd.AddValue("hosts", "Hosts behind each edge sNIC, k/2 or 1 if 0", nHosts);
+    cmd.AddValue("maxPackets", "Number of packets sent by the client", maxPackets);
+    cmd.AddValue("threads",
+                 "Threads of the multithreaded simulator, 0 to run sequentially",
+                 nThreads);
+    cmd.Parse(argc, argv);
+
+    if (nThreads > 0)
+    {
+        TypeId tid;
+        NS_ABORT_MSG_UNLESS(TypeId::LookupByNameFailSafe("ns3::MultithreadedSimulatorImpl", &tid),
+                            "--threads needs a build configured with --enable-mtp");
+        GlobalValue::Bind("SimulatorImplementationType", StringValue(tid.GetName()));
+        Config::SetDefault("ns3::MultithreadedSimulatorImpl::MaxThreads",
+                           UintegerValue(nThreads));
+    }
+
+    Time::SetResolution(Time::NS);
+    // the first packets of the client wait for an ARP reply that crosses the
+    // whole cluster, none of them may be dropped in the meantime
+    Config::SetDefault("ns3::ArpCache::PendingQueueSize", UintegerValue(maxPackets));
+
+    std::unique_ptr<ClusterTopologyHelper> cluster;
+    if (topology == "fattree")
+    {
+        cluster.reset(new FatTreeTopologyHelper(k, nHosts));
+    }
+    else if (topology == "leafspine")
+    {
+        cluster.reset(new LeafSpineTopologyHelper(nLeaves, nSpines, nHosts ? nHosts : 1));
+    }
+    else if (topology == "torus")
+    {
+        cluster.reset(new TorusTopologyHelper(nRows, nColumns, nHosts ? nHosts : 1));
+    }
+    else
+    {
+        NS_FATAL_ERROR("unknown topology " << topology);
+    }
+    std::cout << "topology=" << topology << " ";
+    cluster->PrintStatistics(std::cout);
+    std::cout << std::endl;
+
+    if (maxPackets == 0)
+    {
+        Simulator::Destroy();
+        return 0;
+    }
+
+    NodeContainer terminals = cluster->GetTerminals();
+    Ipv4InterfaceContainer interfaces = cluster->GetInterfaces();
+    uint32_t last = terminals.GetN() - 1;
+
+    SnicWorkloadServerHelper workloadServer(9);
+    ApplicationContainer serverApps = workloadServer.Install(terminals.Get(0));
+    serverApps.Start(Seconds(1.0));
+    serverApps.Stop(Seconds(8.0));
+
+    SnicWorkloadClientHelper workloadClient(interfaces.GetAddress(0), 9);
+    workloadClient.SetAttribute("MaxPackets", UintegerValue(maxPackets));
+    workloadClient.SetAttribute("Interval", TimeValue(NanoSeconds(4.0)));
+    workloadClient.SetAttribute("PacketSize", UintegerValue(450));
+    workloadClient.SetAttribute("UseFlow", BooleanValue(true));
+    workloadClient.SetAttribute("FlowSize", UintegerValue(900));
+    workloadClient.SetAttribute("FlowPktCount", UintegerValue(2));
+
+    ApplicationContainer clientApps = workloadClient.Install(terminals.Get(last));
+    clientApps.Start(Seconds(2.0));
+    clientApps.Stop(Seconds(8.0));
+
+    Config::ConnectWithoutContext("/NodeList/*/DeviceList/*/$ns3::SnicNetDevice/AllocationLatency",
+                                  MakeCallback(&AllocationLatency));
+
+    auto start = std::chrono::steady_clock::now();
+    Simulator::Run();
+    auto end = std::chrono::steady_clock::now();
+
+    double elapsed = std::chrono::duration<double>(end - start).count();
+    uint64_t events = Simulator::GetEventCount();
+    std::ostringstream schedulerStatistics;
+    DynamicCast<SnicNetDevice>(cluster->GetSchedulers().Get(0))->GetScheduler()->PrintStatistics(
+        schedulerStatistics);
+    uint64_t received = DynamicCast<SnicWorkloadServer>(serverApps.Get(0))->GetNumReceived();
+    Simulator::Destroy();
+
+    std::cout << "received=" << received << " events=" << events << " seconds=" << elapsed
+              << " events/s=" << events / elapsed << std::endl;
+    if (g_allocations > 0)
+    {
+        std::cout << "allocations=" << g_allocations << " meanLatency="
+                  << (TimeStep(g_allocationLatency) / g_allocations.load()).As(Time::NS)
+                  << std::endl;
+    }
+    std::cout << schedulerStatistics.str();
+    return 0;
+}
@@ -0,0 +1,208 @@
+#include "ns3/core-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/ring-topology.h"
+#include "ns3/snic-placement-policy.h"
+#include "ns3/snic-scheduler.h"
+
+#include <chrono>
+#include <iomanip>
+#include <queue>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("SnicPlacementBench");
+
+/*
+ * Replays the same flow trace against a SnicScheduler once per placement
+ * policy, without simulating any packet, and reports for each policy:
+ *
+ * - the fraction of the flows that were admitted;
+ * - the link utilization, averaged over the edges and over time;
+ * - the wall clock time the scheduler took per decision.
+ *
+ * Flows arrive as a Poisson process between random terminals of a ring and
+ * hold their bandwidth for an exponential time. --batchSize hands that many
+ * consecutive arrivals to the scheduler at once, which is where the greedy
+ * batch policy differs from best-fit.
+ */
+
+struct TraceFlow
+{
+    double arrival;  //!< in us
+    double duration; //!< in us
+    uint32_t src;    //!< terminal index
+    uint32_t dst;    //!< terminal index
+    double gbps;
+};
+
+struct Departure
+{
+    double time;
+    SnicSchedulerHeader flow;
+
+    bool operator>(const Departure& other) const
+    {
+        return time > other.time;
+    }
+};
+
+/// fraction of the capacity of all edges in use
+static double
+GetUtilization(Ptr<SnicScheduler> scheduler)
+{
+    uint64_t capacity = 0;
+    uint64_t used = 0;
+    for (uint32_t e = 0; e < scheduler->GetNEdges(); ++e)
+    {
+        capacity += scheduler->GetEdgeCapacity(e);
+        used += scheduler->GetEdgeCapacity(e) - scheduler->GetRemainingBandwidth(e);
+    }
+    return capacity > 0 ? (double)used / capacity : 0;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t numSnics = 8;
+    uint32_t numFlows = 5000;
+    uint32_t batchSize = 1;
+    uint32_t maxPaths = 8;
+    double interarrival = 1;
+    double duration = 50;
+    double minGbps = 1;
+    double maxGbps = 40;
+    std::string policies = "ns3::SnicPlacementPolicy,ns3::SnicBestFitPolicy,"
+                           "ns3::SnicLeastLoadedPolicy,ns3::SnicPowerOfTwoPolicy,"
+                           "ns3::SnicGreedyBatchPolicy";
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("numSnics", "Number of sNICs in the ring", numSnics);
+    cmd.AddValue("flows", "Number of flows in the trace", numFlows);
+    cmd.AddValue("batchSize", "Arrivals handed to the scheduler at once", batchSize);
+    cmd.AddValue("maxPaths", "Candidate paths kept per pair of sNICs", maxPaths);
+    cmd.AddValue("interarrival", "Mean time between two arrivals in us", interarrival);
+    cmd.AddValue("duration", "Mean duration of a flow in us", duration);
+    cmd.AddValue("minGbps", "Smallest flow demand in Gbps", minGbps);
+    cmd.AddValue("maxGbps", "Largest flow demand in Gbps", maxGbps);
+    cmd.AddValue("policies", "Comma separated placement policy TypeIds", policies);
+    cmd.Parse(argc, argv);
+
+    NS_ABORT_MSG_IF(numSnics < 2, "need at least two sNICs");
+    NS_ABORT_MSG_IF(batchSize == 0, "batchSize must be at least 1");
+
+    RingTopologyHelper ringHelper = RingTopologyHelper(numSnics, 1, 0);
+    Ipv4InterfaceContainer interfaces = ringHelper.GetInterfaces();
+
+    // the trace is drawn once and replayed for every policy
+    Ptr<ExponentialRandomVariable> gap = CreateObject<ExponentialRandomVariable>();
+    gap->SetAttribute("Mean", DoubleValue(interarrival));
+    gap->SetStream(1);
+    Ptr<ExponentialRandomVariable> hold = CreateObject<ExponentialRandomVariable>();
+    hold->SetAttribute("Mean", DoubleValue(duration));
+    hold->SetStream(2);
+    Ptr<UniformRandomVariable> pick = CreateObject<UniformRandomVariable>();
+    pick->SetStream(3);
+
+    std::vector<TraceFlow> trace;
+    double now = 0;
+    for (uint32_t i = 0; i < numFlows; ++i)
+    {
+        TraceFlow flow;
+        now += gap->GetValue();
+        flow.arrival = now;
+        flow.duration = hold->GetValue();
+        flow.src = pick->GetInteger(0, numSnics - 1);
+        flow.dst = pick->GetInteger(0, numSnics - 2);
+        if (flow.dst >= flow.src)
+        {
+            flow.dst++;
+        }
+        flow.gbps = pick->GetValue(minGbps, maxGbps);
+        trace.push_back(flow);
+    }
+
+    std::cout << std::left << std::setw(30) << "policy" << std::setw(12) << "accepted"
+              << std::setw(14) << "utilization"
+              << "us/decision" << std::endl;
+
+    std::stringstream policyList(policies);
+    std::string policyName;
+    while (std::getline(policyList, policyName, ','))
+    {
+        ObjectFactory factory(policyName);
+        Ptr<SnicPlacementPolicy> policy = factory.Create<SnicPlacementPolicy>();
+        Ptr<SnicPowerOfTwoPolicy> powerOfTwo = DynamicCast<SnicPowerOfTwoPolicy>(policy);
+        if (powerOfTwo)
+        {
+            powerOfTwo->AssignStreams(4);
+        }
+        Ptr<SnicScheduler> scheduler = CreateObject<SnicScheduler>();
+        scheduler->SetAttribute("MaxPaths", UintegerValue(maxPaths));
+        scheduler->SetAttribute("PlacementPolicy", PointerValue(policy));
+
+        std::priority_queue<Departure, std::vector<Departure>, std::greater<Departure>> departures;
+        uint32_t admitted = 0;
+        double busyTime = 0;
+        double last = 0;
+        double utilization = 0;
+        std::chrono::duration<double> elapsed(0);
+
+        for (uint32_t first = 0; first < trace.size(); first += batchSize)
+        {
+            uint32_t end = std::min<uint32_t>(first + batchSize, trace.size());
+            double time = trace[end - 1].arrival;
+
+            // give back what ended before the batch, integrating the utilization
+            while (!departures.empty() && departures.top().time <= time)
+            {
+                Departure departure = departures.top();
+                departures.pop();
+                busyTime += utilization * (departure.time - last);
+                last = departure.time;
+                SnicHeader snicHeader;
+                scheduler->Release(snicHeader, departure.flow);
+                utilization = GetUtilization(scheduler);
+            }
+            busyTime += utilization * (time - last);
+            last = time;
+
+            std::vector<SnicSchedulerHeader> flows;
+            for (uint32_t i = first; i < end; ++i)
+            {
+                SnicSchedulerHeader flow(interfaces.GetAddress(trace[i].src),
+                                         1000,
+                                         interfaces.GetAddress(trace[i].dst),
+                                         9,
+                                         17,
+                                         i);
+                flow.SetBandwidthDemand(trace[i].gbps);
+                flows.push_back(flow);
+            }
+            std::vector<SnicHeader> snicHeaders;
+            std::vector<bool> accepted;
+            auto start = std::chrono::steady_clock::now();
+            admitted += scheduler->ScheduleBatch(flows, snicHeaders, accepted);
+            elapsed += std::chrono::steady_clock::now() - start;
+
+            for (uint32_t i = 0; i < flows.size(); ++i)
+            {
+                if (accepted[i])
+                {
+                    departures.push({time + trace[first + i].duration, flows[i]});
+                }
+            }
+            utilization = GetUtilization(scheduler);
+        }
+
+        std::cout << std::left << std::setw(30) << policyName << std::setw(12)
+                  << (double)admitted / trace.size() << std::setw(14)
+                  << (last > 0 ? busyTime / last : 0) << elapsed.count() * 1e6 / trace.size()
+                  << std::endl;
+        scheduler->Dispose();
+    }
+
+    Simulator::Destroy();
+    return 0;
+}
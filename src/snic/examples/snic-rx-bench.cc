@@ -0,0 +1,113 @@
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/ring-topology.h"
+#include "ns3/snic-helper.h"
+#include "ns3/snic-net-device.h"
+
+#include <chrono>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("SnicRxBench");
+
+/*
+ * Measures how many simulator events per wall clock second a small ring
+ * workload runs at. Run it once as is and once with --printPackets=true to
+ * see the cost of printing every packet received by the sNICs.
+ *
+ * --batchSize and --batchWindow coalesce the allocation requests sent to the
+ * scheduler; the mean time from a request to its response is printed along
+ * with the mean number of flows per response.
+ *
+ * --shards splits the ring in segments that each have their own scheduler.
+ *
+ * The cost of the decisions of the first scheduler is printed last.
+ */
+
+static uint64_t g_allocations = 0;
+static Time g_allocationLatency;
+static uint64_t g_batchedFlows = 0;
+
+static void
+AllocationLatency(Time latency, uint32_t batchSize)
+{
+    g_allocations++;
+    g_allocationLatency += latency;
+    g_batchedFlows += batchSize;
+}
+
+int
+main(int argc, char* argv[])
+{
+    bool printPackets = false;
+    uint32_t numSnics = 4;
+    uint32_t maxPackets = 2000;
+    uint32_t nShards = 1;
+    uint32_t batchSize = 1;
+    Time batchWindow = MicroSeconds(1);
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("printPackets", "Print every packet received by the sNICs", printPackets);
+    cmd.AddValue("numSnics", "Number of sNICs in the ring", numSnics);
+    cmd.AddValue("maxPackets", "Number of packets sent by the client", maxPackets);
+    cmd.AddValue("shards", "Number of scheduler shards", nShards);
+    cmd.AddValue("batchSize", "Allocation requests per scheduler packet", batchSize);
+    cmd.AddValue("batchWindow", "Longest wait for an allocation batch to fill up", batchWindow);
+    cmd.Parse(argc, argv);
+
+    Time::SetResolution(Time::NS);
+    Config::SetDefault("ns3::SnicNetDevice::PrintPackets", BooleanValue(printPackets));
+    Config::SetDefault("ns3::SnicNetDevice::AllocationBatchSize", UintegerValue(batchSize));
+    Config::SetDefault("ns3::SnicNetDevice::AllocationBatchWindow", TimeValue(batchWindow));
+
+    RingTopologyHelper ringHelper = RingTopologyHelper(numSnics, 1, 0, nShards);
+    NodeContainer terminals = ringHelper.GetTerminals();
+    Ipv4InterfaceContainer interfaces = ringHelper.GetInterfaces();
+
+    SnicWorkloadServerHelper workloadServer(9);
+    ApplicationContainer serverApps = workloadServer.Install(terminals.Get(0));
+    serverApps.Start(Seconds(1.0));
+    serverApps.Stop(Seconds(8.0));
+
+    SnicWorkloadClientHelper workloadClient(interfaces.GetAddress(0), 9);
+    workloadClient.SetAttribute("MaxPackets", UintegerValue(maxPackets));
+    workloadClient.SetAttribute("Interval", TimeValue(NanoSeconds(4.0)));
+    workloadClient.SetAttribute("PacketSize", UintegerValue(450));
+    workloadClient.SetAttribute("UseFlow", BooleanValue(true));
+    workloadClient.SetAttribute("FlowSize", UintegerValue(900));
+    workloadClient.SetAttribute("FlowPktCount", UintegerValue(2));
+
+    ApplicationContainer clientApps = workloadClient.Install(terminals.Get(1));
+    clientApps.Start(Seconds(2.0));
+    clientApps.Stop(Seconds(8.0));
+
+    Config::ConnectWithoutContext("/NodeList/*/DeviceList/*/$ns3::SnicNetDevice/AllocationLatency",
+                                  MakeCallback(&AllocationLatency));
+
+    auto start = std::chrono::steady_clock::now();
+    Simulator::Run();
+    auto end = std::chrono::steady_clock::now();
+
+    double elapsed = std::chrono::duration<double>(end - start).count();
+    uint64_t events = Simulator::GetEventCount();
+    std::ostringstream schedulerStatistics;
+    DynamicCast<SnicNetDevice>(ringHelper.GetSchedulers().Get(0))->GetScheduler()->PrintStatistics(
+        schedulerStatistics);
+    Simulator::Destroy();
+
+    std::cout << "printPackets=" << printPackets << " events=" << events
+              << " seconds=" << elapsed << " events/s=" << events / elapsed << std::endl;
+    if (g_allocations > 0)
+    {
+        std::cout << "batchSize=" << batchSize << " allocations=" << g_allocations
+                  << " meanLatency=" << (g_allocationLatency / g_allocations).As(Time::NS)
+                  << " meanFlowsPerResponse=" << (double)g_batchedFlows / g_allocations
+                  << std::endl;
+    }
+    std::cout << schedulerStatistics.str();
+    return 0;
+}
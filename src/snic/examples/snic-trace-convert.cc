@@ -0,0 +1,35 @@
+#include "ns3/arrival-trace.h"
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("SnicTraceConvert");
+
+/*
+ * Converts a text arrival trace (the number of intervals, their average,
+ * then one interval in nanoseconds per line) to the binary format that
+ * PacketArrivalRateTraceGen memory-maps, and prints what the binary trace
+ * holds.
+ */
+int
+main(int argc, char* argv[])
+{
+    std::string input = "trace.txt";
+    std::string output = "";
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("input", "Text trace to convert", input);
+    cmd.AddValue("output", "Binary trace to write, input.bin by default", output);
+    cmd.Parse(argc, argv);
+
+    if (output.empty())
+    {
+        output = input + ".bin";
+    }
+    ArrivalTrace::Convert(input, output);
+
+    Ptr<ArrivalTrace> trace = ArrivalTrace::Open(output);
+    std::cout << output << ": " << trace->GetNIntervals() << " intervals, average "
+              << trace->GetAverage() << "ns" << std::endl;
+    return 0;
+}
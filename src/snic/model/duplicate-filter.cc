@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2023 UCSD WukLab, San Diego, USA
+ */
+
+#include "duplicate-filter.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("DuplicateFilter");
+
+DuplicateFilter::DuplicateFilter(uint32_t capacity, Time window)
+{
+    Reset(capacity, window);
+}
+
+void
+DuplicateFilter::Reset(uint32_t capacity, Time window)
+{
+    NS_LOG_FUNCTION(this << capacity << window);
+    NS_ASSERT_MSG(capacity > 0, "the filter must remember at least one uid");
+    NS_ASSERT_MSG(capacity <= (1u << 30), "capacity too large");
+    // at most half of the slots are used so probe sequences stay short
+    uint32_t bits = 1;
+    while ((1u << bits) < 2 * capacity)
+    {
+        bits++;
+    }
+    m_ring.assign(capacity, Record{0, Time()});
+    m_slots.assign(1u << bits, EMPTY);
+    m_oldest = 0;
+    m_size = 0;
+    m_shift = 32 - bits;
+    m_window = window;
+    m_nDuplicates = 0;
+    m_nEvictions = 0;
+}
+
+bool
+DuplicateFilter::IsDuplicate(uint32_t uid, Time now)
+{
+    NS_LOG_FUNCTION(this << uid);
+    if (m_window.IsStrictlyPositive())
+    {
+        while (m_size > 0 && now - m_ring[m_oldest].seen >= m_window)
+        {
+            PopOldest();
+        }
+    }
+    uint32_t slot = FindSlot(uid);
+    if (m_slots[slot] != EMPTY)
+    {
+        m_nDuplicates++;
+        return true;
+    }
+    if (m_size == m_ring.size())
+    {
+        PopOldest();
+        m_nEvictions++;
+        // removing the oldest uid may have moved the slot of the new one
+        slot = FindSlot(uid);
+    }
+    uint32_t index = (m_oldest + m_size) % m_ring.size();
+    m_ring[index] = Record{uid, now};
+    m_slots[slot] = index;
+    m_size++;
+    return false;
+}
+
+uint32_t
+DuplicateFilter::GetSize() const
+{
+    return m_size;
+}
+
+uint32_t
+DuplicateFilter::GetCapacity() const
+{
+    return m_ring.size();
+}
+
+uint64_t
+DuplicateFilter::GetNDuplicates() const
+{
+    return m_nDuplicates;
+}
+
+uint64_t
+DuplicateFilter::GetNEvictions() const
+{
+    return m_nEvictions;
+}
+
+uint32_t
+DuplicateFilter::FindSlot(uint32_t uid) const
+{
+    // fibonacci hashing, uids are mostly consecutive
+    uint32_t mask = m_slots.size() - 1;
+    uint32_t slot = (uid * 2654435769u) >> m_shift;
+    while (m_slots[slot] != EMPTY && m_ring[m_slots[slot]].uid != uid)
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void
+DuplicateFilter::PopOldest()
+{
+    uint32_t mask = m_slots.size() - 1;
+    uint32_t hole = FindSlot(m_ring[m_oldest].uid);
+    NS_ASSERT(m_slots[hole] == m_oldest);
+    m_oldest = (m_oldest + 1) % m_ring.size();
+    m_size--;
+
+    // backward shift deletion: move up every uid of the probe sequence that
+    // would no longer be reachable through the hole
+    for (uint32_t next = (hole + 1) & mask; m_slots[next] != EMPTY; next = (next + 1) & mask)
+    {
+        uint32_t home = (m_ring[m_slots[next]].uid * 2654435769u) >> m_shift;
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            m_slots[hole] = m_slots[next];
+            hole = next;
+        }
+    }
+    m_slots[hole] = EMPTY;
+}
+
+} // namespace ns3
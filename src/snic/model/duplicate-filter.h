@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2023 UCSD WukLab, San Diego, USA
+ */
+
+#ifndef SNIC_DUPLICATE_FILTER_H
+#define SNIC_DUPLICATE_FILTER_H
+
+#include "ns3/nstime.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup snic
+ * \brief Remembers the packet uids seen recently, in bounded memory.
+ *
+ * The uids are kept in arrival order in a ring of Capacity records, indexed
+ * by an open-addressing hash table of twice as many slots. A uid is
+ * forgotten once it is older than the window, or when the ring is full and
+ * a new uid takes its record, so the memory used never grows past what the
+ * constructor allocates.
+ */
+class DuplicateFilter
+{
+  public:
+    /**
+     * \param capacity number of uids remembered at most
+     * \param window time a uid is remembered, zero to only bound by capacity
+     */
+    DuplicateFilter(uint32_t capacity = 4096, Time window = Seconds(0));
+
+    /**
+     * \brief Drop every uid and resize the filter.
+     * \param capacity number of uids remembered at most
+     * \param window time a uid is remembered, zero to only bound by capacity
+     */
+    void Reset(uint32_t capacity, Time window);
+
+    /**
+     * \param uid the uid of a packet
+     * \param now the current time
+     * \return true if the uid was seen within the window, false if it is new,
+     *         in which case it is remembered from now on
+     */
+    bool IsDuplicate(uint32_t uid, Time now);
+
+    /// \return the number of uids remembered
+    uint32_t GetSize() const;
+    /// \return the number of uids remembered at most
+    uint32_t GetCapacity() const;
+    /// \return the number of calls to IsDuplicate() that returned true
+    uint64_t GetNDuplicates() const;
+    /// \return the number of uids forgotten to make room before their window was over
+    uint64_t GetNEvictions() const;
+
+  private:
+    static constexpr uint32_t EMPTY = 0xffffffff;
+
+    /// a uid and the time it was first seen
+    struct Record
+    {
+        uint32_t uid;
+        Time seen;
+    };
+
+    /// \return the slot holding the uid, or the empty slot it would go in
+    uint32_t FindSlot(uint32_t uid) const;
+    /// forget the oldest uid
+    void PopOldest();
+
+    std::vector<Record> m_ring;    //!< uids in arrival order
+    std::vector<uint32_t> m_slots; //!< index in m_ring of each hashed uid, or EMPTY
+    uint32_t m_oldest;             //!< index in m_ring of the oldest uid
+    uint32_t m_size;               //!< number of uids in m_ring
+    uint32_t m_shift;              //!< 32 - log2(number of slots)
+    Time m_window;
+    uint64_t m_nDuplicates;
+    uint64_t m_nEvictions;
+};
+
+} // namespace ns3
+
+#endif // SNIC_DUPLICATE_FILTER_H
@@ -6,6 +6,10 @@
 
 #include "network-task.h"
 
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+
 namespace ns3
 {
 
@@ -17,7 +21,37 @@ NetworkTask::GetTypeId(){
     static TypeId tid = TypeId("ns3::NetworkTask")
                             .SetParent<Object>()
                             .SetGroupName("Snic")
-                            .AddConstructor<NetworkTask>();
+                            .AddConstructor<NetworkTask>()
+                            .AddAttribute("PipelineSize",
+                                          "Number of packets the pipeline can hold at once.",
+                                          UintegerValue(16),
+                                          MakeUintegerAccessor(&NetworkTask::m_pipelineSize),
+                                          MakeUintegerChecker<uint32_t>(1))
+                            .AddAttribute("Delay",
+                                          "Time a packet spends in the pipeline once admitted.",
+                                          TimeValue(NanoSeconds(100)),
+                                          MakeTimeAccessor(&NetworkTask::m_delay),
+                                          MakeTimeChecker())
+                            .AddAttribute("IngressRate",
+                                          "Rate at which the pipeline admits packets.",
+                                          DataRateValue(DataRate("100Gbps")),
+                                          MakeDataRateAccessor(&NetworkTask::m_ingressBps),
+                                          MakeDataRateChecker())
+                            .AddAttribute("EgressRate",
+                                          "Rate at which the pipeline emits packets.",
+                                          DataRateValue(DataRate("100Gbps")),
+                                          MakeDataRateAccessor(&NetworkTask::m_egressBps),
+                                          MakeDataRateChecker())
+                            .AddAttribute("FpgaFabric",
+                                          "Fraction of the FPGA fabric of an sNIC the NT takes.",
+                                          DoubleValue(0.25),
+                                          MakeDoubleAccessor(&NetworkTask::m_fpgaFabric),
+                                          MakeDoubleChecker<double>(0, 1))
+                            .AddAttribute("MemoryRequirement",
+                                          "sNIC memory the NT takes, in bytes.",
+                                          DoubleValue(1e9),
+                                          MakeDoubleAccessor(&NetworkTask::m_memoryRequirement),
+                                          MakeDoubleChecker<double>(0));
     //.AddAttribute("Mtu",
     //"The MAC-level Maximum Transmission Unit",
     // UintegerValue(DEFAULT_MTU),
@@ -27,6 +61,13 @@ NetworkTask::GetTypeId(){
 }
 
 NetworkTask::NetworkTask()
+    : m_id(0),
+      m_ntType(0),
+      m_fpgaFabric(0),
+      m_memoryRequirement(0),
+      m_pipelineSize(16),
+      m_ready(false),
+      m_performingReconfig(false)
 {
 }
 
@@ -40,5 +81,47 @@ NetworkTask::ProcessHeader(SnicHeader& header)
     NS_FATAL_ERROR("shell NTs can't process packets");
 }
 
+uint32_t
+NetworkTask::GetPipelineSize() const
+{
+    return m_pipelineSize;
+}
+
+Time
+NetworkTask::GetDelay() const
+{
+    return m_delay;
+}
+
+DataRate
+NetworkTask::GetIngressRate() const
+{
+    return m_ingressBps;
+}
+
+DataRate
+NetworkTask::GetEgressRate() const
+{
+    return m_egressBps;
+}
+
+double
+NetworkTask::GetFpgaFabric() const
+{
+    return m_fpgaFabric;
+}
+
+double
+NetworkTask::GetMemoryRequirement() const
+{
+    return m_memoryRequirement;
+}
+
+Time
+NetworkTask::GetServiceTime(uint32_t bytes) const
+{
+    return m_ingressBps.CalculateBytesTxTime(bytes);
+}
+
 } // namespace ns3
 
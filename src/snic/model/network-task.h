@@ -25,6 +25,42 @@ class NetworkTask : public Object
 
     virtual void ProcessHeader(SnicHeader& header);
 
+    /**
+     * \return the number of packets the NT pipeline can hold at once
+     */
+    uint32_t GetPipelineSize() const;
+
+    /**
+     * \return the time a packet spends in the NT pipeline once admitted
+     */
+    Time GetDelay() const;
+
+    /**
+     * \return the rate at which the NT pipeline admits packets
+     */
+    DataRate GetIngressRate() const;
+
+    /**
+     * \return the rate at which the NT pipeline emits packets
+     */
+    DataRate GetEgressRate() const;
+
+    /**
+     * \return the fraction of the FPGA fabric of an sNIC the NT takes
+     */
+    double GetFpgaFabric() const;
+
+    /**
+     * \return the sNIC memory the NT takes, in bytes
+     */
+    double GetMemoryRequirement() const;
+
+    /**
+     * \param bytes size of the packet
+     * \return the time the pipeline ingress is busy with the packet
+     */
+    Time GetServiceTime(uint32_t bytes) const;
+
   private:
     uint32_t m_id;
     uint32_t m_ntType;
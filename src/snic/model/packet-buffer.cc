@@ -10,6 +10,8 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 
+#include <algorithm>
+
 namespace ns3
 {
 NS_LOG_COMPONENT_DEFINE("PacketBuffer");
@@ -23,11 +25,10 @@ PacketBuffer::GetTypeId()
                             .SetParent<Object>()
                             .SetGroupName("Snic")
                             .AddAttribute("WaitReplyTimeout",
-                                          "When this timeout expires, "
-                                          "the buffer entries will be scanned and "
-                                          "entries in WaitReply state will resend ArpRequest "
-                                          "unless MaxRetries has been exceeded, "
-                                          "in which case the entry is marked dead",
+                                          "Longest time a flow waits for the scheduler. "
+                                          "Flows that waited for longer are handed to the "
+                                          "wait reply timeout callback, or rejected if there "
+                                          "is none.",
                                           TimeValue(Seconds(5)),
                                           MakeTimeAccessor(&PacketBuffer::m_waitReplyTimeout),
                                           MakeTimeChecker())
@@ -38,15 +39,60 @@ PacketBuffer::GetTypeId()
                                           MakeUintegerAccessor(&PacketBuffer::m_maxRetries),
                                           MakeUintegerChecker<uint32_t>())
                             .AddAttribute("PendingQueueSize",
-                                          "The size of the queue for packets pending an arp reply.",
+                                          "Number of packets a flow holds while it waits for "
+                                          "the scheduler. Packets past it are not queued.",
                                           UintegerValue(1900),
                                           MakeUintegerAccessor(&PacketBuffer::m_pendingQueueSize),
-                                          MakeUintegerChecker<uint32_t>());
+                                          MakeUintegerChecker<uint32_t>())
+                            .AddAttribute("MaxFlows",
+                                          "The maximum number of flows tracked. Adding a flow "
+                                          "past it evicts the least recently seen of a few "
+                                          "neighbouring flows.",
+                                          UintegerValue(65536),
+                                          MakeUintegerAccessor(&PacketBuffer::m_maxFlows),
+                                          MakeUintegerChecker<uint32_t>(1))
+                            .AddAttribute("IdleTimeout",
+                                          "Active flows that have not been seen for this long "
+                                          "are removed.",
+                                          TimeValue(Seconds(1)),
+                                          MakeTimeAccessor(&PacketBuffer::m_idleTimeout),
+                                          MakeTimeChecker())
+                            .AddTraceSource("Hit",
+                                            "A lookup found its flow.",
+                                            MakeTraceSourceAccessor(&PacketBuffer::m_hitTrace),
+                                            "ns3::PacketBuffer::FlowTracedCallback")
+                            .AddTraceSource("Miss",
+                                            "A lookup did not find its flow.",
+                                            MakeTraceSourceAccessor(&PacketBuffer::m_missTrace),
+                                            "ns3::PacketBuffer::FlowTracedCallback")
+                            .AddTraceSource("Eviction",
+                                            "A flow was removed because it was idle or "
+                                            "to make room for a new one.",
+                                            MakeTraceSourceAccessor(&PacketBuffer::m_evictionTrace),
+                                            "ns3::PacketBuffer::FlowTracedCallback")
+                            .AddTraceSource("PendingOverflow",
+                                            "A packet did not fit in the pending queue of "
+                                            "its flow.",
+                                            MakeTraceSourceAccessor(
+                                                &PacketBuffer::m_pendingOverflowTrace),
+                                            "ns3::Packet::TracedCallback")
+                            .AddTraceSource("PendingDrop",
+                                            "A pending packet was dropped because its flow waited "
+                                            "for the scheduler for too long or was "
+                                            "evicted.",
+                                            MakeTraceSourceAccessor(
+                                                &PacketBuffer::m_pendingDropTrace),
+                                            "ns3::Packet::TracedCallback");
     return tid;
 }
 
 PacketBuffer::PacketBuffer()
-    : m_device(nullptr)
+    : m_device(nullptr),
+      m_slots(64, nullptr),
+      m_nFlows(0),
+      m_nHits(0),
+      m_nMisses(0),
+      m_nEvictions(0)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -61,10 +107,14 @@ PacketBuffer::DoDispose()
 {
     NS_LOG_FUNCTION(this);
     m_device = nullptr;
-    if (!m_waitReplyTimer.IsRunning())
-    {
-        m_waitReplyTimer.Cancel();
-    }
+    m_waitReplyTimeoutCallback = MakeNullCallback<void, const FlowId&>();
+    m_evictionCallback = MakeNullCallback<void, const FlowId&, uint16_t>();
+    m_waitReplyTimer.Cancel();
+    m_expireTimer.Cancel();
+    m_slots.clear();
+    m_nFlows = 0;
+    m_freeList.clear();
+    m_entryPool.clear();
     Object::DoDispose();
 }
 
@@ -110,41 +160,279 @@ PacketBuffer::StartWaitReplyTimer()
     }
 }
 
+void
+PacketBuffer::SetWaitReplyTimeoutCallback(Callback<void, const FlowId&> cb)
+{
+    NS_LOG_FUNCTION(this);
+    m_waitReplyTimeoutCallback = cb;
+}
+
+void
+PacketBuffer::SetEvictionCallback(Callback<void, const FlowId&, uint16_t> cb)
+{
+    NS_LOG_FUNCTION(this);
+    m_evictionCallback = cb;
+}
+
 PacketBuffer::Entry*
 PacketBuffer::Add(const FlowId& flowId)
 {
-    NS_LOG_FUNCTION(this);
-    NS_ASSERT(m_packetBuffer.find(flowId) == m_packetBuffer.end());
+    NS_LOG_FUNCTION(this << flowId.GetId());
+    uint64_t hash = flowId.GetHash();
+    NS_ASSERT_MSG(m_slots[FindSlot(flowId, hash)] == nullptr, "flow is already tracked");
 
-    PacketBuffer::Entry* entry = new PacketBuffer::Entry(this);
-    m_packetBuffer[flowId] = entry;
+    if (m_nFlows >= m_maxFlows)
+    {
+        EvictOne(hash);
+    }
+    // keep the load factor at or below one half
+    if ((m_nFlows + 1) * 2 > m_slots.size())
+    {
+        Grow();
+    }
+
+    Entry* entry;
+    if (m_freeList.empty())
+    {
+        m_entryPool.emplace_back(this);
+        entry = &m_entryPool.back();
+    }
+    else
+    {
+        entry = m_freeList.back();
+        m_freeList.pop_back();
+    }
+    entry->Reset(flowId);
+    entry->m_hash = hash;
+
+    m_slots[FindSlot(flowId, hash)] = entry;
+    m_nFlows++;
+    StartExpireTimer();
     return entry;
 }
 
-void
+bool
 PacketBuffer::Delete(const FlowId& flowId)
 {
-    NS_LOG_FUNCTION(this);
-    // NS_ASSERT(m_packetBuffer.find(flowId) == m_packetBuffer.end());
-    //  NS_ASSERT_MSG(m_pending.empty(), "trying to delete an entry with remaining pending
-    //  packets");
-    NS_ASSERT_MSG(m_packetBuffer.count(flowId) > 0,
-                  "trying to delete an entry that does not exist");
-
-    m_packetBuffer.erase(flowId);
+    NS_LOG_FUNCTION(this << flowId.GetId());
+    uint32_t slot = FindSlot(flowId, flowId.GetHash());
+    if (m_slots[slot] == nullptr)
+    {
+        NS_LOG_LOGIC("flow " << flowId.GetId() << " is not tracked");
+        return false;
+    }
+    RemoveSlot(slot);
+    return true;
 }
 
 PacketBuffer::Entry*
 PacketBuffer::Lookup(const FlowId& flowId)
+{
+    NS_LOG_FUNCTION(this << flowId.GetId());
+    Entry* entry = m_slots[FindSlot(flowId, flowId.GetHash())];
+    if (entry == nullptr)
+    {
+        m_nMisses++;
+        m_missTrace(flowId);
+        return nullptr;
+    }
+    m_nHits++;
+    m_hitTrace(flowId);
+    entry->m_lastSeen = Simulator::Now();
+    return entry;
+}
+
+void
+PacketBuffer::ExpireIdle()
 {
     NS_LOG_FUNCTION(this);
+    Time now = Simulator::Now();
+    std::vector<FlowId> expired;
+    for (uint32_t i = 0; i < m_slots.size(); ++i)
+    {
+        Entry* entry = m_slots[i];
+        if (entry != nullptr && !entry->IsWaitReply() &&
+            now - entry->m_lastSeen >= m_idleTimeout)
+        {
+            expired.push_back(entry->m_flowId);
+        }
+    }
+    for (auto it = expired.begin(); it != expired.end(); ++it)
+    {
+        uint32_t slot = FindSlot(*it, it->GetHash());
+        if (m_slots[slot] == nullptr)
+        {
+            // deleted by the eviction callback of an earlier flow
+            continue;
+        }
+        NS_LOG_LOGIC("flow " << it->GetId() << " expired");
+        Evict(slot);
+    }
+}
+
+uint32_t
+PacketBuffer::GetNFlows() const
+{
+    return m_nFlows;
+}
 
-    BufferI it = m_packetBuffer.find(flowId);
-    if (it != m_packetBuffer.end())
+uint64_t
+PacketBuffer::GetNHits() const
+{
+    return m_nHits;
+}
+
+uint64_t
+PacketBuffer::GetNMisses() const
+{
+    return m_nMisses;
+}
+
+uint64_t
+PacketBuffer::GetNEvictions() const
+{
+    return m_nEvictions;
+}
+
+uint32_t
+PacketBuffer::FindSlot(const FlowId& flowId, uint64_t hash) const
+{
+    uint32_t mask = m_slots.size() - 1;
+    uint32_t slot = hash & mask;
+    while (m_slots[slot] != nullptr &&
+           (m_slots[slot]->m_hash != hash || m_slots[slot]->m_flowId != flowId))
     {
-        return it->second;
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void
+PacketBuffer::RemoveSlot(uint32_t slot)
+{
+    Entry* entry = m_slots[slot];
+    entry->Reset(FlowId());
+    m_freeList.push_back(entry);
+    m_nFlows--;
+
+    // backward shift deletion: move up every entry of the probe sequence that
+    // would no longer be reachable through the hole
+    uint32_t mask = m_slots.size() - 1;
+    uint32_t hole = slot;
+    for (uint32_t next = (hole + 1) & mask; m_slots[next] != nullptr; next = (next + 1) & mask)
+    {
+        uint32_t home = m_slots[next]->m_hash & mask;
+        // distance from home is larger than the distance from the hole
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            m_slots[hole] = m_slots[next];
+            hole = next;
+        }
+    }
+    m_slots[hole] = nullptr;
+}
+
+void
+PacketBuffer::Grow()
+{
+    NS_LOG_FUNCTION(this << m_slots.size());
+    std::vector<Entry*> old(m_slots.size() * 2, nullptr);
+    old.swap(m_slots);
+    uint32_t mask = m_slots.size() - 1;
+    for (auto it = old.begin(); it != old.end(); ++it)
+    {
+        if (*it == nullptr)
+        {
+            continue;
+        }
+        uint32_t slot = (*it)->m_hash & mask;
+        while (m_slots[slot] != nullptr)
+        {
+            slot = (slot + 1) & mask;
+        }
+        m_slots[slot] = *it;
+    }
+}
+
+void
+PacketBuffer::EvictOne(uint64_t hash)
+{
+    NS_LOG_FUNCTION(this);
+    // sample a few entries around where the new flow lands, prefer flows that
+    // are not waiting for the scheduler and among them the least recently seen
+    static const uint32_t SAMPLES = 8;
+    uint32_t mask = m_slots.size() - 1;
+    uint32_t victim = m_slots.size();
+    uint32_t samples = std::min(SAMPLES, m_nFlows);
+    uint32_t seen = 0;
+    for (uint32_t slot = hash & mask; seen < samples; slot = (slot + 1) & mask)
+    {
+        Entry* entry = m_slots[slot];
+        if (entry == nullptr)
+        {
+            continue;
+        }
+        seen++;
+        if (victim == m_slots.size())
+        {
+            victim = slot;
+            continue;
+        }
+        Entry* best = m_slots[victim];
+        if ((best->IsWaitReply() && !entry->IsWaitReply()) ||
+            (best->IsWaitReply() == entry->IsWaitReply() && entry->m_lastSeen < best->m_lastSeen))
+        {
+            victim = slot;
+        }
+    }
+    NS_ASSERT(victim < m_slots.size());
+
+    NS_LOG_LOGIC("evicting flow " << m_slots[victim]->m_flowId.GetId());
+    Evict(victim);
+}
+
+void
+PacketBuffer::Evict(uint32_t slot)
+{
+    Entry* entry = m_slots[slot];
+    FlowId flowId = entry->m_flowId;
+    uint16_t protocol = entry->m_protocol;
+    bool allocated = entry->IsActive();
+    // a flow still waiting for the scheduler loses its pending packets
+    for (Ptr<Packet> p = entry->DequeuePending(); p; p = entry->DequeuePending())
+    {
+        m_pendingDropTrace(p);
+    }
+    RemoveSlot(slot);
+    m_nEvictions++;
+    m_evictionTrace(flowId);
+    // the flow is gone before the callback runs, which may well add or delete
+    // others
+    if (allocated && !m_evictionCallback.IsNull())
+    {
+        m_evictionCallback(flowId, protocol);
+    }
+}
+
+void
+PacketBuffer::StartExpireTimer()
+{
+    if (!m_expireTimer.IsRunning() && m_idleTimeout.IsStrictlyPositive())
+    {
+        m_expireTimer =
+            Simulator::Schedule(m_idleTimeout, &PacketBuffer::HandleExpireTimer, this);
+    }
+}
+
+void
+PacketBuffer::HandleExpireTimer()
+{
+    NS_LOG_FUNCTION(this);
+    ExpireIdle();
+    if (m_nFlows > 0)
+    {
+        StartExpireTimer();
     }
-    return nullptr;
 }
 
 void
@@ -152,43 +440,41 @@ PacketBuffer::HandleWaitReplyTimeout()
 {
     NS_LOG_FUNCTION(this);
 
-    PacketBuffer::Entry* entry;
+    // the timer runs for the whole buffer, flows that started waiting after
+    // it was armed get another period
+    Time now = Simulator::Now();
+    std::vector<FlowId> timedOut;
     bool restartWaitReplyTimer = false;
-    for (BufferI i = m_packetBuffer.begin(); i != m_packetBuffer.end(); i++)
+    for (auto i = m_slots.begin(); i != m_slots.end(); i++)
     {
-        entry = (*i).second;
-        if (entry != nullptr && entry->IsWaitReply())
+        Entry* entry = *i;
+        if (entry == nullptr || !entry->IsWaitReply())
+        {
+            continue;
+        }
+        if (now - entry->m_created >= m_waitReplyTimeout)
         {
-            NS_FATAL_ERROR("timed OUT");
-            /*
-              if (entry->GetRetries() < m_maxRetries)
-              {
-                  NS_LOG_LOGIC("node=" << m_device->GetNode()->GetId() << ", BufferWaitTimeout for "
-                                       << entry->GetIpv4Address()
-                                       << " expired -- retransmitting arp request since retries = "
-                                       << entry->GetRetries());
-                  m_arpRequestCallback(this, entry->GetIpv4Address());
-                  restartWaitReplyTimer = true;
-                  entry->IncrementRetries();
-              }
-              else
-              {
-                  NS_LOG_LOGIC("node=" << m_device->GetNode()->GetId() << ", wait reply for "
-                                       << entry->GetIpv4Address()
-                                       << " expired -- drop since max retries exceeded: "
-                                       << entry->GetRetries());
-                  entry->MarkDead();
-                  entry->ClearRetries();
-                  Ipv4PayloadHeaderPair pending = entry->DequeuePending();
-                  while (pending.first)
-                  {
-                      // add the Ipv4 header for tracing purposes
-                      pending.first->AddHeader(pending.second);
-                      m_dropTrace(pending.first);
-                      pending = entry->DequeuePending();
-                  }
-              }*/
+            timedOut.push_back(entry->m_flowId);
         }
+        else
+        {
+            restartWaitReplyTimer = true;
+        }
+    }
+    for (auto it = timedOut.begin(); it != timedOut.end(); ++it)
+    {
+        NS_LOG_LOGIC("flow " << it->GetId() << " timed out waiting for the scheduler");
+        if (!m_waitReplyTimeoutCallback.IsNull())
+        {
+            m_waitReplyTimeoutCallback(*it);
+            continue;
+        }
+        Entry* entry = m_slots[FindSlot(*it, it->GetHash())];
+        for (Ptr<Packet> p = entry->DequeuePending(); p; p = entry->DequeuePending())
+        {
+            m_pendingDropTrace(p);
+        }
+        entry->MarkRejected();
     }
     if (restartWaitReplyTimer)
     {
@@ -201,17 +487,42 @@ PacketBuffer::HandleWaitReplyTimeout()
 PacketBuffer::Entry::Entry(PacketBuffer* buffer)
     : m_packetBuffer(buffer),
       m_state(WAIT_REPLY),
-      m_retries(0)
+      m_protocol(0),
+      m_retries(0),
+      m_hash(0)
 {
     NS_LOG_FUNCTION(this << buffer);
 }
 
 void
+PacketBuffer::Entry::Reset(const FlowId& flowId)
+{
+    m_state = WAIT_REPLY;
+    m_pending.clear();
+    m_incomingPort = nullptr;
+    m_protocol = 0;
+    m_src = Address();
+    m_dst = Address();
+    m_retries = 0;
+    m_route.Clear();
+    m_flowId = flowId;
+    m_lastSeen = Simulator::Now();
+    m_created = m_lastSeen;
+}
+
+bool
 PacketBuffer::Entry::EnqueuePending(Ptr<Packet> packet)
 {
     NS_LOG_FUNCTION(this << packet);
     NS_ASSERT(m_state == WAIT_REPLY);
+    if (m_pending.size() >= m_packetBuffer->m_pendingQueueSize)
+    {
+        NS_LOG_LOGIC("pending queue of flow " << m_flowId.GetId() << " is full");
+        m_packetBuffer->m_pendingOverflowTrace(packet);
+        return false;
+    }
     m_pending.push_back(packet);
+    return true;
 }
 
 Ptr<Packet>
@@ -253,6 +564,15 @@ PacketBuffer::Entry::MarkWaitReply()
     m_packetBuffer->StartWaitReplyTimer();
 }
 
+void
+PacketBuffer::Entry::MarkRejected()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    NS_ASSERT(m_state == WAIT_REPLY);
+    NS_ASSERT(m_pending.empty());
+    m_state = REJECTED;
+}
+
 bool
 PacketBuffer::Entry::IsDone() const
 {
@@ -274,6 +594,13 @@ PacketBuffer::Entry::IsWaitReply() const
     return (m_state == WAIT_REPLY);
 }
 
+bool
+PacketBuffer::Entry::IsRejected() const
+{
+    NS_LOG_FUNCTION(this);
+    return (m_state == REJECTED);
+}
+
 bool
 PacketBuffer::Entry::IsExpired() const
 {
@@ -330,15 +657,33 @@ PacketBuffer::Entry::GetDst() const
 }
 
 void
-PacketBuffer::Entry::SetRoute(std::list<SnicRte> route)
+PacketBuffer::Entry::SetRoute(const SnicRoute& route)
 {
-    m_rteList = route;
+    m_route = route;
 }
 
-std::list<SnicRte>
+const SnicRoute&
 PacketBuffer::Entry::GetRoute() const
 {
-    return m_rteList;
+    return m_route;
+}
+
+const FlowId&
+PacketBuffer::Entry::GetFlowId() const
+{
+    return m_flowId;
+}
+
+Time
+PacketBuffer::Entry::GetLastSeen() const
+{
+    return m_lastSeen;
+}
+
+Time
+PacketBuffer::Entry::GetCreationTime() const
+{
+    return m_created;
 }
 
 } // namespace ns3
@@ -11,14 +11,28 @@
 #include "ns3/ptr.h"
 #include "ns3/simulator.h"
 #include "ns3/snic-header.h"
+#include "ns3/traced-callback.h"
 
-#include <map>
+#include <deque>
 #include <stdint.h>
+#include <vector>
 
 namespace ns3
 {
 class SnicHeader;
 
+/**
+ * \ingroup snic
+ * \brief Per-flow state of a sNIC: the route handed out by the scheduler and
+ * the packets waiting for it.
+ *
+ * Flows are kept in an open-addressing hash table keyed on the full 5-tuple
+ * and the flow id. Entries come from a pool owned by the buffer, so a deleted
+ * entry is reused by the next flow instead of being freed. Active flows that
+ * have not been looked up for IdleTimeout are expired by a periodic sweep,
+ * and when MaxFlows flows are tracked adding a new one evicts the least
+ * recently seen of a few neighbouring entries.
+ */
 class PacketBuffer : public Object
 {
   public:
@@ -37,12 +51,65 @@ class PacketBuffer : public Object
     Time GetWaitReplyTimeout() const;
     void StartWaitReplyTimer();
 
+    /**
+     * \brief Set what is done with flows that waited WaitReplyTimeout for the
+     * scheduler.
+     * \param cb called with each such flow, which is still tracked and
+     *        waiting. Without a callback their pending packets are dropped and
+     *        the flows are marked rejected.
+     */
+    void SetWaitReplyTimeoutCallback(Callback<void, const FlowId&> cb);
+
+    /**
+     * \brief Set what is done with the allocation of flows removed because
+     * they were idle or to make room.
+     * \param cb called, once the flow is no longer tracked, with each such
+     *        flow that held an allocation of the scheduler and the protocol
+     *        of its packets
+     */
+    void SetEvictionCallback(Callback<void, const FlowId&, uint16_t> cb);
+
+    /**
+     * \brief Start tracking a flow.
+     * \param flowId the flow, which must not be tracked yet
+     * \return the entry of the flow, valid until the flow is deleted or evicted
+     */
     Entry* Add(const FlowId& flowId);
 
-    void Delete(const FlowId& flowId);
-
+    /**
+     * \brief Stop tracking a flow and return its entry to the pool.
+     * \param flowId the flow
+     * \return false if the flow was not tracked, e.g. because it was evicted
+     */
+    bool Delete(const FlowId& flowId);
+
+    /**
+     * \param flowId the flow
+     * \return the entry of the flow or nullptr
+     */
     Entry* Lookup(const FlowId& flowId);
 
+    /**
+     * \brief Remove every active flow that has been idle for IdleTimeout.
+     */
+    void ExpireIdle();
+
+    /// \return the number of flows tracked
+    uint32_t GetNFlows() const;
+    /// \return the number of lookups that found their flow
+    uint64_t GetNHits() const;
+    /// \return the number of lookups that did not find their flow
+    uint64_t GetNMisses() const;
+    /// \return the number of flows removed because they were idle or to make room
+    uint64_t GetNEvictions() const;
+
+    /**
+     * TracedCallback signature for flow table events.
+     *
+     * \param [in] flowId the flow
+     */
+    typedef void (*FlowTracedCallback)(const FlowId& flowId);
+
     // typedef std::pair<Ptr<Packet>, Ipv4Header> Ipv4PayloadHeaderPair;
 
     class Entry
@@ -51,11 +118,19 @@ class PacketBuffer : public Object
         Entry(PacketBuffer* packetBuffer);
         void MarkActive(/* allocation */);
         void MarkWaitReply();
-        void EnqueuePending(Ptr<Packet>);
+        /// the scheduler turned the flow down, its packets go without offload
+        void MarkRejected();
+        /**
+         * \param packet a packet of the flow, with its headers
+         * \return false if the pending queue of the flow is full, in which
+         *         case the packet is not queued
+         */
+        bool EnqueuePending(Ptr<Packet> packet);
         Ptr<Packet> DequeuePending();
         bool IsDone() const;
         bool IsActive() const;
         bool IsWaitReply() const;
+        bool IsRejected() const;
         bool IsExpired() const;
 
         void SetIncomingPort(Ptr<NetDevice> incomingPort);
@@ -68,8 +143,13 @@ class PacketBuffer : public Object
         Address GetSrc() const;
         Address GetDst() const;
 
-        void SetRoute(std::list<SnicRte> route);
-        std::list<SnicRte> GetRoute() const;
+        const FlowId& GetFlowId() const;
+        Time GetLastSeen() const;
+        /// \return the time the flow was added
+        Time GetCreationTime() const;
+
+        void SetRoute(const SnicRoute& route);
+        const SnicRoute& GetRoute() const;
 
       private:
         enum PacketBufferEntryState_e
@@ -77,11 +157,17 @@ class PacketBuffer : public Object
             ACTIVE,
             WAIT_REPLY,
             DONE,
-            EXPIRED
+            EXPIRED,
+            REJECTED
         };
 
+        friend class PacketBuffer;
+
         Time GetTimeout() const;
 
+        /// bring a pooled entry back to its initial state for a new flow
+        void Reset(const FlowId& flowId);
+
         // Time m_lastSeen; //!< last moment a packet from that address has been seen
         PacketBuffer* m_packetBuffer;
         PacketBufferEntryState_e m_state;
@@ -93,24 +179,58 @@ class PacketBuffer : public Object
         Address m_dst;
 
         uint32_t m_retries;               //!< rerty counter
-        std::list<SnicRte> m_rteList;
+        SnicRoute m_route;
+        FlowId m_flowId;
+        Time m_lastSeen; //!< last time the flow was added or looked up
+        Time m_created;  //!< time the flow was added
+        uint64_t m_hash; //!< cached FlowId::GetHash()
     };
 
-    typedef std::map<FlowId, PacketBuffer::Entry*> Buffer;
-    typedef std::map<FlowId, PacketBuffer::Entry*>::iterator BufferI;
-
+  private:
     void DoDispose() override;
+
+    /// \return the slot holding the flow, or the empty slot it would go in
+    uint32_t FindSlot(const FlowId& flowId, uint64_t hash) const;
+    /// remove the entry in a slot, shifting the following ones back
+    void RemoveSlot(uint32_t slot);
+    /// double the number of slots
+    void Grow();
+    /// evict the least recently seen entry close to where a hash lands
+    void EvictOne(uint64_t hash);
+    /// remove the entry in a slot because it was idle or to make room
+    void Evict(uint32_t slot);
+    void StartExpireTimer();
+    void HandleExpireTimer();
+
     Ptr<NetDevice> m_device;
     Time m_waitReplyTimeout; //!< cache reply state timeout
     EventId m_waitReplyTimer; //!< cache alive state timer
-    Buffer m_packetBuffer; //!< the packet cache
+
+    std::vector<Entry*> m_slots;    //!< open-addressing table, nullptr when empty
+    uint32_t m_nFlows;              //!< number of used slots
+    std::deque<Entry> m_entryPool;  //!< storage of every entry ever allocated
+    std::vector<Entry*> m_freeList; //!< entries of the pool not in use
+    uint32_t m_maxFlows;            //!< flows tracked before evicting
+    Time m_idleTimeout;             //!< idle time after which active flows expire
+    EventId m_expireTimer;          //!< idle expiry sweep
+
+    uint64_t m_nHits;
+    uint64_t m_nMisses;
+    uint64_t m_nEvictions;
+    TracedCallback<const FlowId&> m_hitTrace;
+    TracedCallback<const FlowId&> m_missTrace;
+    TracedCallback<const FlowId&> m_evictionTrace;
+    TracedCallback<Ptr<const Packet>> m_pendingOverflowTrace;
+    TracedCallback<Ptr<const Packet>> m_pendingDropTrace;
+    Callback<void, const FlowId&> m_waitReplyTimeoutCallback;
+    Callback<void, const FlowId&, uint16_t> m_evictionCallback;
     // Callback<void, Ptr<const ArpCache>, Ipv4Address>
     // m_arpRequestCallback; //!< reply timeout callback
 
     uint32_t m_maxRetries;    //!< max retries for a resolution
                               //
     void HandleWaitReplyTimeout();
-    uint32_t m_pendingQueueSize; //!< number of packets waiting for a resolution
+    uint32_t m_pendingQueueSize; //!< packets each flow can hold while waiting
                                  //
 };
 
@@ -9,6 +9,8 @@
 #include "network-task.h"
 
 #include "ns3/boolean.h"
+#include "ns3/data-rate.h"
+#include "ns3/double.h"
 #include "ns3/flow.h"
 #include "ns3/ipv4-l3-protocol.h"
 #include "ns3/log.h"
@@ -47,8 +49,128 @@ SnicNetDevice::GetTypeId()
             .AddAttribute("ExpirationTime",
                           "Time it takes for learned MAC state entry to expire.",
                           TimeValue(Seconds(300)),
-                          MakeTimeAccessor(&SnicNetDevice::m_expirationTime),
+                          MakeTimeAccessor(&SnicNetDevice::SetExpirationTime,
+                                           &SnicNetDevice::GetExpirationTime),
                           MakeTimeChecker())
+            .AddAttribute("PrintPackets",
+                          "Print every received packet to the log. This enables packet "
+                          "metadata for the whole simulation and is meant for debugging only.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&SnicNetDevice::SetPrintPackets,
+                                              &SnicNetDevice::GetPrintPackets),
+                          MakeBooleanChecker())
+            .AddAttribute("Scheduler",
+                          "The scheduler used when this sNIC is the cluster scheduler.",
+                          PointerValue(),
+                          MakePointerAccessor(&SnicNetDevice::m_scheduler),
+                          MakePointerChecker<SnicScheduler>())
+            .AddAttribute("PacketBuffer",
+                          "The per-flow table holding routes and packets waiting for one.",
+                          PointerValue(),
+                          MakePointerAccessor(&SnicNetDevice::m_packetBuffer),
+                          MakePointerChecker<PacketBuffer>())
+            .AddAttribute("AllocationBatchSize",
+                          "Number of allocation requests (and releases) coalesced into one "
+                          "packet to the scheduler. 1 sends each of them on its own.",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&SnicNetDevice::m_allocationBatchSize),
+                          MakeUintegerChecker<uint32_t>(1, 0xffff))
+            .AddAttribute("AllocationBatchWindow",
+                          "Longest time the first request (or release) of a batch waits "
+                          "for the batch to fill up.",
+                          TimeValue(MicroSeconds(1)),
+                          MakeTimeAccessor(&SnicNetDevice::m_allocationBatchWindow),
+                          MakeTimeChecker())
+            .AddAttribute("PipelineSize",
+                          "Number of packets the processing pipeline holds at once when "
+                          "they don't use one of the NTs of this sNIC. 0 processes them at "
+                          "infinite speed.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&SnicNetDevice::m_pipelineSize),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("PipelineDelay",
+                          "Time a packet spends in the processing pipeline once admitted.",
+                          TimeValue(NanoSeconds(0)),
+                          MakeTimeAccessor(&SnicNetDevice::m_pipelineDelay),
+                          MakeTimeChecker())
+            .AddAttribute("PipelineRate",
+                          "Rate at which the processing pipeline admits packets.",
+                          DataRateValue(DataRate("100Gbps")),
+                          MakeDataRateAccessor(&SnicNetDevice::m_pipelineRate),
+                          MakeDataRateChecker())
+            .AddAttribute("PipelineQueueSize",
+                          "Number of packets waiting for a full pipeline before new ones "
+                          "are dropped.",
+                          UintegerValue(1024),
+                          MakeUintegerAccessor(&SnicNetDevice::m_pipelineQueueSize),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("FpgaCapacity",
+                          "FPGA fabric of this sNIC the scheduler can place NTs on, 1 being "
+                          "the whole fabric.",
+                          DoubleValue(1),
+                          MakeDoubleAccessor(&SnicNetDevice::m_fpgaCapacity),
+                          MakeDoubleChecker<double>(0))
+            .AddAttribute("MemoryCapacity",
+                          "Memory of this sNIC the scheduler can give to NTs, in bytes.",
+                          DoubleValue(8e9),
+                          MakeDoubleAccessor(&SnicNetDevice::m_memoryCapacity),
+                          MakeDoubleChecker<double>(0))
+            .AddAttribute("IngressCapacity",
+                          "Traffic the NTs of this sNIC can take in, over all of them.",
+                          DataRateValue(DataRate("100Gbps")),
+                          MakeDataRateAccessor(&SnicNetDevice::m_ingressCapacity),
+                          MakeDataRateChecker())
+            .AddAttribute("EgressCapacity",
+                          "Traffic the NTs of this sNIC can send out, over all of them.",
+                          DataRateValue(DataRate("100Gbps")),
+                          MakeDataRateAccessor(&SnicNetDevice::m_egressCapacity),
+                          MakeDataRateChecker())
+            .AddAttribute("AdmissionQueueSize",
+                          "Number of flows the scheduler keeps waiting for resources. When "
+                          "it is full the flow that would be served last is rejected.",
+                          UintegerValue(1024),
+                          MakeUintegerAccessor(&SnicNetDevice::m_admissionQueueSize),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("AdmissionQueueTimeout",
+                          "Longest time a flow waits for resources at the scheduler before "
+                          "it is rejected.",
+                          TimeValue(MilliSeconds(1)),
+                          MakeTimeAccessor(&SnicNetDevice::m_admissionQueueTimeout),
+                          MakeTimeChecker())
+            .AddAttribute("AdmissionOrder",
+                          "Order in which the scheduler retries the flows waiting for resources.",
+                          EnumValue(SnicNetDevice::ADMIT_FIFO),
+                          MakeEnumAccessor(&SnicNetDevice::m_admissionOrder),
+                          MakeEnumChecker(SnicNetDevice::ADMIT_FIFO,
+                                          "Fifo",
+                                          SnicNetDevice::ADMIT_SMALLEST_FIRST,
+                                          "SmallestFirst"))
+            .AddAttribute("FallbackToHost",
+                          "Send the packets of rejected flows, and those that don't fit in "
+                          "the pending queue of their flow, to their host without offload. "
+                          "They are dropped otherwise.",
+                          BooleanValue(true),
+                          MakeBooleanAccessor(&SnicNetDevice::m_fallbackToHost),
+                          MakeBooleanChecker())
+            .AddAttribute("BroadcastFilterSize",
+                          "Number of broadcast packets remembered to drop the copies that "
+                          "come back around the ring.",
+                          UintegerValue(4096),
+                          MakeUintegerAccessor(&SnicNetDevice::SetBroadcastFilterSize,
+                                               &SnicNetDevice::GetBroadcastFilterSize),
+                          MakeUintegerChecker<uint32_t>(1, 1u << 30))
+            .AddAttribute("BroadcastFilterWindow",
+                          "Time a broadcast packet is remembered. 0 remembers the last "
+                          "BroadcastFilterSize ones whatever their age.",
+                          TimeValue(MilliSeconds(100)),
+                          MakeTimeAccessor(&SnicNetDevice::SetBroadcastFilterWindow,
+                                           &SnicNetDevice::GetBroadcastFilterWindow),
+                          MakeTimeChecker())
+            .AddTraceSource("AllocationLatency",
+                            "Time from the allocation request of a flow to its response, "
+                            "with the number of flows the response carried.",
+                            MakeTraceSourceAccessor(&SnicNetDevice::m_allocationLatencyTrace),
+                            "ns3::SnicNetDevice::AllocationLatencyTracedCallback")
             .AddTraceSource("SchedTrace",
                             "Number of scheduler requests made by this NIC",
                             MakeTraceSourceAccessor(&SnicNetDevice::m_schedTrace),
@@ -56,7 +178,49 @@ SnicNetDevice::GetTypeId()
             .AddTraceSource("NumL4Packets",
                             "Number of L4 packets seen by this NIC",
                             MakeTraceSourceAccessor(&SnicNetDevice::m_numL4Packets),
-                            "ns3::TracedValueCallback::UInt64");
+                            "ns3::TracedValueCallback::UInt64")
+            .AddTraceSource("PipelineOccupancy",
+                            "Number of packets in the processing pipelines of this NIC",
+                            MakeTraceSourceAccessor(&SnicNetDevice::m_numInPipeline),
+                            "ns3::TracedValueCallback::Uint32")
+            .AddTraceSource("PipelineBacklog",
+                            "Number of packets waiting for a full processing pipeline",
+                            MakeTraceSourceAccessor(&SnicNetDevice::m_pipelineLength),
+                            "ns3::TracedValueCallback::Uint32")
+            .AddTraceSource("QueueingDelay",
+                            "Time a packet waited before entering a processing pipeline",
+                            MakeTraceSourceAccessor(&SnicNetDevice::m_queueingDelayTrace),
+                            "ns3::SnicNetDevice::QueueingDelayTracedCallback")
+            .AddTraceSource("PipelineDrop",
+                            "A packet dropped because its pipeline queue was full",
+                            MakeTraceSourceAccessor(&SnicNetDevice::m_pipelineDropTrace),
+                            "ns3::Packet::TracedCallback")
+            .AddTraceSource("BroadcastSuppressed",
+                            "A copy of a broadcast packet this NIC has already seen was dropped",
+                            MakeTraceSourceAccessor(&SnicNetDevice::m_broadcastSuppressedTrace),
+                            "ns3::Packet::TracedCallback")
+            .AddTraceSource("AdmissionReject",
+                            "The scheduler turned down a flow",
+                            MakeTraceSourceAccessor(&SnicNetDevice::m_admissionRejectTrace),
+                            "ns3::PacketBuffer::FlowTracedCallback")
+            .AddTraceSource("AdmissionQueueDelay",
+                            "Time a flow waited at the scheduler before it was admitted",
+                            MakeTraceSourceAccessor(&SnicNetDevice::m_admissionQueueDelayTrace),
+                            "ns3::Time::TracedCallback")
+            .AddTraceSource("AdmissionQueueLength",
+                            "Number of flows waiting at the scheduler for resources",
+                            MakeTraceSourceAccessor(&SnicNetDevice::m_admissionQueueLength),
+                            "ns3::TracedValueCallback::Uint32")
+            .AddTraceSource("FlowRejected",
+                            "A flow of this NIC goes without offload, because the scheduler "
+                            "rejected it or did not answer in time",
+                            MakeTraceSourceAccessor(&SnicNetDevice::m_flowRejectedTrace),
+                            "ns3::PacketBuffer::FlowTracedCallback")
+            .AddTraceSource("OffloadDrop",
+                            "A packet dropped because it could not be offloaded and "
+                            "FallbackToHost is off",
+                            MakeTraceSourceAccessor(&SnicNetDevice::m_offloadDropTrace),
+                            "ns3::Packet::TracedCallback");
     //.AddAttribute("InterframeGap",
     //"The time to wait between packet (frame) transmissions",
     // TimeValue(Seconds(0.0)),
@@ -71,11 +235,26 @@ SnicNetDevice::SnicNetDevice()
       m_node(nullptr),
       m_ifIndex(0),
       m_mtu(0xffff),
+      m_printPackets(false),
       m_isScheduler(false),
-      m_currentFlowId(0)
+      m_allocationBatchSize(1),
+      m_currentFlowId(0),
+      m_fpgaCapacity(1),
+      m_memoryCapacity(8e9),
+      m_pipelineSize(0),
+      m_pipelineQueueSize(1024),
+      m_admissionQueueSize(1024),
+      m_admissionOrder(ADMIT_FIFO),
+      m_fallbackToHost(true),
+      m_broadcastFilterSize(4096),
+      m_broadcastFilterWindow(MilliSeconds(100)),
+      m_broadcastFilter(m_broadcastFilterSize, m_broadcastFilterWindow)
 {
     NS_LOG_FUNCTION_NOARGS();
     m_channel = CreateObject<BridgeChannel>();
+    m_scheduler = CreateObject<SnicScheduler>();
+    m_scheduler->SetDevice(this);
+    m_packetBuffer = CreateObject<PacketBuffer>();
 
     // time_init(); // OFSI's clock; needed to use the buffer storage system.
 }
@@ -133,6 +312,7 @@ SnicNetDevice::AddSnicPort(Ptr<NetDevice> snicPort, bool isPeerSnic)
                                     0,
                                     snicPort,
                                     true);
+    m_portIndex[snicPort] = m_ports.size();
     m_ports.push_back(snicPort);
     m_channel->AddChannel(snicPort->GetChannel());
 }
@@ -209,7 +389,12 @@ Ptr<NetworkTask>
 SnicNetDevice::GetNT(uint32_t id)
 {
     NS_LOG_FUNCTION(this << id);
-    return m_nts[id];
+    auto it = m_nts.find(id);
+    if (it == m_nts.end())
+    {
+        return nullptr;
+    }
+    return it->second;
 }
 
 uint32_t
@@ -219,6 +404,42 @@ SnicNetDevice::GetNumNT()
     return m_nts.size();
 }
 
+std::vector<uint32_t>
+SnicNetDevice::GetNTIds() const
+{
+    std::vector<uint32_t> ids;
+    ids.reserve(m_nts.size());
+    for (auto it = m_nts.begin(); it != m_nts.end(); ++it)
+    {
+        ids.push_back(it->first);
+    }
+    return ids;
+}
+
+double
+SnicNetDevice::GetFpgaCapacity() const
+{
+    return m_fpgaCapacity;
+}
+
+double
+SnicNetDevice::GetMemoryCapacity() const
+{
+    return m_memoryCapacity;
+}
+
+DataRate
+SnicNetDevice::GetIngressCapacity() const
+{
+    return m_ingressCapacity;
+}
+
+DataRate
+SnicNetDevice::GetEgressCapacity() const
+{
+    return m_egressCapacity;
+}
+
 uint64_t
 SnicNetDevice::GetNumSchedReqs() const
 {
@@ -235,7 +456,6 @@ SnicNetDevice::AllocationRequest(Ptr<NetDevice> incomingPort,
     NS_LOG_FUNCTION_NOARGS();
     Ptr<Packet> copy = packet->Copy();
 
-    Ptr<Packet> request = Create<Packet>();
     Ipv4Header ipv4Header;
     SnicHeader snicHeader;
     copy->RemoveHeader(ipv4Header);
@@ -247,42 +467,37 @@ SnicNetDevice::AllocationRequest(Ptr<NetDevice> incomingPort,
 
     schedHeader.SetBandwidthDemand(snicHeader.GetTput());
     // schedHeader.SetBandwidthDemand(20.55);
-    schedHeader.SetResourceDemand(5);
-    schedHeader.AddNT(5);
+    schedHeader.AddNT(snicHeader.GetNT());
     schedHeader.SetPacketType(SnicSchedulerHeader::ALLOCATION_REQUEST);
     schedHeader.SetFlowId(snicHeader.GetFlowId());
     schedHeader.SetSourceIp(ipv4Header.GetSource());
     schedHeader.SetDestinationIp(ipv4Header.GetDestination());
     schedHeader.SetSourcePort(snicHeader.GetSourcePort());
     schedHeader.SetDestinationPort(snicHeader.GetDestinationPort());
-    schedHeader.SetProtocol(snicHeader.GetProtocol());
+    schedHeader.SetProtocol(ipv4Header.GetProtocol());
 
     ipv4Header.SetDestination(m_schedulerAddress);
     ipv4Header.SetSource(m_ipAddress);
 
     snicHeader.SetPacketType(SnicHeader::ALLOCATION_REQUEST);
 
-    request->AddHeader(schedHeader);
-    request->AddHeader(snicHeader);
-    request->AddHeader(ipv4Header);
     NS_LOG_DEBUG("flowid in snicheader: " << snicHeader.GetFlowId());
     NS_LOG_DEBUG("flowid in schedheader: " << schedHeader.GetFlowId());
     // create new flow to track packets
     FlowId flowId(schedHeader);
     // make the flow known to the packet cache
-    PacketBuffer::Entry* entry = m_packetBuffer.Add(flowId);
+    PacketBuffer::Entry* entry = m_packetBuffer->Add(flowId);
     entry->SetIncomingPort(incomingPort);
     entry->SetProtocol(protocol);
     entry->SetSrc(src);
     entry->SetDst(dst);
 
-    m_packetBuffer.SetWaitReplyTimeout(Seconds(5));
     entry->MarkWaitReply();
     entry->EnqueuePending(packet);
     //  newentry = flowid;
     //  m_packetBuffer.EnqueuePending(flowid, packet);
     //  m_packetBuffer.EnqueuePending(flowid, packet);
-    m_rxCallback(this, request, protocol, m_address);
+    SendToScheduler(m_requestBatch, ipv4Header, snicHeader, schedHeader, protocol);
 }
 
 void
@@ -296,7 +511,6 @@ SnicNetDevice::AllocationRelease(Ptr<NetDevice> incomingPort,
 
     Ptr<Packet> copy = packet->Copy();
 
-    Ptr<Packet> request = Create<Packet>();
     Ipv4Header ipv4Header;
     SnicHeader snicHeader;
     copy->RemoveHeader(ipv4Header);
@@ -318,29 +532,181 @@ SnicNetDevice::AllocationRelease(Ptr<NetDevice> incomingPort,
     schedHeader.SetDestinationIp(ipv4Header.GetDestination());
     schedHeader.SetSourcePort(snicHeader.GetSourcePort());
     schedHeader.SetDestinationPort(snicHeader.GetDestinationPort());
-    schedHeader.SetProtocol(snicHeader.GetProtocol());
+    schedHeader.SetProtocol(ipv4Header.GetProtocol());
 
     ipv4Header.SetDestination(m_schedulerAddress);
     ipv4Header.SetSource(m_ipAddress);
 
     snicHeader.SetPacketType(SnicHeader::ALLOCATION_RELEASE);
 
-    request->AddHeader(schedHeader);
-    request->AddHeader(snicHeader);
-    request->AddHeader(ipv4Header);
     NS_LOG_DEBUG("flowid in snicheader: " << snicHeader.GetFlowId());
     NS_LOG_DEBUG("flowid in schedheader: " << schedHeader.GetFlowId());
     // create new flow to track packets
     FlowId flowId(schedHeader);
 
     // NOTE maybe wait for response?
-    m_packetBuffer.Delete(flowId);
+    m_packetBuffer->Delete(flowId);
 
     // NS_ASSERT_MSG(false, "sending release req");
 
+    SendToScheduler(m_releaseBatch, ipv4Header, snicHeader, schedHeader, protocol);
+}
+
+void
+SnicNetDevice::ReleaseAllocation(const SnicSchedulerHeader& flow, uint16_t protocol)
+{
+    NS_LOG_FUNCTION(this << flow.GetFlowId());
+    SnicSchedulerHeader schedHeader(flow);
+    schedHeader.SetPacketType(SnicSchedulerHeader::ALLOCATION_RELEASE);
+
+    SnicHeader snicHeader;
+    snicHeader.SetPacketType(SnicHeader::ALLOCATION_RELEASE);
+    snicHeader.SetFlowId(flow.GetFlowId());
+    snicHeader.SetSourcePort(flow.GetSourcePort());
+    snicHeader.SetDestinationPort(flow.GetDestinationPort());
+    snicHeader.SetSourceIp(flow.GetSourceIp());
+    snicHeader.SetDestinationIp(flow.GetDestinationIp());
+    snicHeader.SetIsLastInFlow(true);
+
+    Ipv4Header ipv4Header;
+    ipv4Header.SetSource(m_ipAddress);
+    ipv4Header.SetDestination(m_schedulerAddress);
+    ipv4Header.SetProtocol(flow.GetProtocol());
+    ipv4Header.SetPayloadSize(snicHeader.GetSerializedSize() + schedHeader.GetSerializedSize());
+
+    SendToScheduler(m_releaseBatch, ipv4Header, snicHeader, schedHeader, protocol);
+}
+
+void
+SnicNetDevice::ReleaseEvictedFlow(const FlowId& flowId, uint16_t protocol)
+{
+    NS_LOG_FUNCTION(this << flowId.GetId());
+    SnicSchedulerHeader flow;
+    flow.SetFlowId(flowId.GetId());
+    flow.SetSourceIp(flowId.GetSourceIp());
+    flow.SetDestinationIp(flowId.GetDestinationIp());
+    flow.SetSourcePort(flowId.GetSourcePort());
+    flow.SetDestinationPort(flowId.GetDestinationPort());
+    flow.SetProtocol(flowId.GetProtocol());
+    ReleaseAllocation(flow, protocol);
+}
+
+void
+SnicNetDevice::SendToScheduler(AllocationBatch& batch,
+                               const Ipv4Header& ipv4Header,
+                               const SnicHeader& snicHeader,
+                               const SnicSchedulerHeader& schedHeader,
+                               uint16_t protocol)
+{
+    NS_LOG_FUNCTION(this << schedHeader.GetFlowId());
+    if (m_allocationBatchSize > 1)
+    {
+        QueueAllocation(batch, ipv4Header, snicHeader, schedHeader, protocol);
+        return;
+    }
+    Ptr<Packet> request = Create<Packet>();
+    request->AddHeader(schedHeader);
+    request->AddHeader(snicHeader);
+    request->AddHeader(ipv4Header);
     m_rxCallback(this, request, protocol, m_address);
 }
 
+void
+SnicNetDevice::QueueAllocation(AllocationBatch& batch,
+                               const Ipv4Header& ipv4Header,
+                               const SnicHeader& snicHeader,
+                               const SnicSchedulerHeader& flow,
+                               uint16_t protocol)
+{
+    NS_LOG_FUNCTION(this << flow.GetFlowId());
+    if (batch.schedHeader.GetNFlows() == 0)
+    {
+        // the first flow of the batch provides the headers of the request
+        batch.ipv4Header = ipv4Header;
+        batch.snicHeader = snicHeader;
+        batch.protocol = protocol;
+        batch.schedHeader.SetPacketType(flow.GetPacketType());
+        batch.timer = Simulator::Schedule(m_allocationBatchWindow,
+                                          &SnicNetDevice::FlushAllocationBatch,
+                                          this,
+                                          &batch);
+    }
+    batch.schedHeader.AddFlow(flow);
+    if (batch.schedHeader.GetNFlows() >= m_allocationBatchSize)
+    {
+        batch.timer.Cancel();
+        FlushAllocationBatch(&batch);
+    }
+}
+
+void
+SnicNetDevice::FlushAllocationBatch(AllocationBatch* batch)
+{
+    NS_LOG_FUNCTION(this << batch->schedHeader.GetNFlows());
+    if (batch->schedHeader.GetNFlows() == 0)
+    {
+        return;
+    }
+    Ptr<Packet> request = Create<Packet>();
+    request->AddHeader(batch->schedHeader);
+    request->AddHeader(batch->snicHeader);
+    batch->ipv4Header.SetPayloadSize(request->GetSize());
+    request->AddHeader(batch->ipv4Header);
+    batch->schedHeader = SnicSchedulerHeader();
+    m_rxCallback(this, request, batch->protocol, m_address);
+}
+
+void
+SnicNetDevice::SetBroadcastFilterSize(uint32_t size)
+{
+    NS_LOG_FUNCTION(this << size);
+    m_broadcastFilterSize = size;
+}
+
+uint32_t
+SnicNetDevice::GetBroadcastFilterSize() const
+{
+    return m_broadcastFilterSize;
+}
+
+void
+SnicNetDevice::SetBroadcastFilterWindow(Time window)
+{
+    NS_LOG_FUNCTION(this << window);
+    m_broadcastFilterWindow = window;
+}
+
+Time
+SnicNetDevice::GetBroadcastFilterWindow() const
+{
+    return m_broadcastFilterWindow;
+}
+
+void
+SnicNetDevice::SetExpirationTime(Time expirationTime)
+{
+    NS_LOG_FUNCTION(this << expirationTime);
+    m_learnTable.SetExpirationTime(expirationTime);
+}
+
+Time
+SnicNetDevice::GetExpirationTime() const
+{
+    return m_learnTable.GetExpirationTime();
+}
+
+uint64_t
+SnicNetDevice::GetNSuppressedBroadcasts() const
+{
+    return m_broadcastFilter.GetNDuplicates();
+}
+
+uint64_t
+SnicNetDevice::GetNBroadcastFilterEvictions() const
+{
+    return m_broadcastFilter.GetNEvictions();
+}
+
 void
 SnicNetDevice::SetSchedulerAddress(Ipv4Address schedulerAddress)
 {
@@ -367,6 +733,29 @@ SnicNetDevice::IsScheduler() const
     return m_isScheduler;
 }
 
+Ptr<SnicScheduler>
+SnicNetDevice::GetScheduler() const
+{
+    return m_scheduler;
+}
+
+void
+SnicNetDevice::SetPrintPackets(bool printPackets)
+{
+    NS_LOG_FUNCTION(this << printPackets);
+    if (printPackets)
+    {
+        Packet::EnablePrinting();
+    }
+    m_printPackets = printPackets;
+}
+
+bool
+SnicNetDevice::GetPrintPackets() const
+{
+    return m_printPackets;
+}
+
 void
 SnicNetDevice::SetIpAddress(Ipv4Address address)
 {
@@ -402,12 +791,41 @@ SnicNetDevice::DoDispose()
     {
         *iter = nullptr;
     }
+    m_portIndex.clear();
     m_node = nullptr;
     m_channel = nullptr;
     m_currentPkt = nullptr;
+    m_scheduler->Dispose();
+    m_scheduler = nullptr;
+    m_packetBuffer->Dispose();
+    m_packetBuffer = nullptr;
+    m_requestBatch.timer.Cancel();
+    m_releaseBatch.timer.Cancel();
+    m_admissionTimer.Cancel();
+    m_admissionQueue.clear();
+    for (auto it = m_pipelines.begin(); it != m_pipelines.end(); ++it)
+    {
+        for (auto event = it->second.events.begin(); event != it->second.events.end(); ++event)
+        {
+            event->Cancel();
+        }
+    }
+    m_pipelines.clear();
     NetDevice::DoDispose();
 }
 
+void
+SnicNetDevice::DoInitialize()
+{
+    NS_LOG_FUNCTION(this);
+    // flows the scheduler never answered go without offload, as if rejected
+    m_packetBuffer->SetWaitReplyTimeoutCallback(MakeCallback(&SnicNetDevice::RejectFlow, this));
+    m_packetBuffer->SetEvictionCallback(MakeCallback(&SnicNetDevice::ReleaseEvictedFlow, this));
+    // the attributes are all set by now
+    m_broadcastFilter.Reset(m_broadcastFilterSize, m_broadcastFilterWindow);
+    NetDevice::DoInitialize();
+}
+
 void
 SnicNetDevice::HandleIpv4Packet(Ptr<NetDevice> incomingPort,
                                 Ptr<Packet> packet,
@@ -421,17 +839,21 @@ SnicNetDevice::HandleIpv4Packet(Ptr<NetDevice> incomingPort,
     Mac48Address dst48 = Mac48Address::ConvertFrom(dst);
     bool addressedToUs = (dst48 == m_address);
 
+    // packets we only pass along are inspected in place, the headers are
+    // only deserialized when we need all of them
+    SnicHeaderView view(packet);
+    if (view.IsMalformed())
+    {
+        NS_LOG_WARN("malformed SnicHeader, dropping");
+        return;
+    }
     Ipv4Header ipv4Header;
     SnicHeader snicHeader;
-    packet->RemoveHeader(ipv4Header);
-    packet->RemoveHeader(snicHeader);
-    // snicHeader.ClearRtes();
-    NS_LOG_DEBUG("\tseen nic?: " << snicHeader.HasSeenNic());
+    NS_LOG_DEBUG("\tseen nic?: " << view.HasSeenNic());
     NS_LOG_DEBUG("\tis Scheduler?: " << IsScheduler());
-    NS_LOG_DEBUG("\tpackettype?: " << snicHeader.GetPacketType());
-    // packet->AddHeader(
+    NS_LOG_DEBUG("\tpackettype?: " << view.GetPacketType());
 
-    switch (snicHeader.GetPacketType())
+    switch (view.GetPacketType())
     {
     case SnicHeader::L4_PACKET: {
         m_numL4Packets++;
@@ -441,23 +863,16 @@ SnicNetDevice::HandleIpv4Packet(Ptr<NetDevice> incomingPort,
         }
         else
         {
-            if (snicHeader.HasSeenNic())
+            if (view.HasSeenNic())
             {
                 NS_LOG_DEBUG("FOWARDING");
-
-                packet->AddHeader(snicHeader);
-                packet->AddHeader(ipv4Header);
-                // ForwardUnicast(incomingPort, packet, protocol, src48, dst48);
                 Forward(incomingPort, packet, protocol, src48, dst48);
-                // if (snicHeader.IsLastInFlow())
-                //{
-                // AllocationRelease(incomingPort, packet, protocol, src, dst);
-                //}
-
                 return;
             }
             // this means the packet has been through one of the directly attached
             // sNICs
+            packet->RemoveHeader(ipv4Header);
+            packet->RemoveHeader(snicHeader);
             snicHeader.SetHasSeenNic();
             if (IsScheduler())
             {
@@ -479,7 +894,7 @@ SnicNetDevice::HandleIpv4Packet(Ptr<NetDevice> incomingPort,
                 FlowId flowId(ipv4Header, snicHeader);
                 NS_LOG_DEBUG("req sched ============" << snicHeader.GetFlowId());
                 NS_LOG_DEBUG("req sched ============" << flowId.GetId());
-                PacketBuffer::Entry* entry = m_packetBuffer.Lookup(flowId);
+                PacketBuffer::Entry* entry = m_packetBuffer->Lookup(flowId);
                 // we have an entry here already, then we can set the sseensnic
                 // flag and forward the packet
                 //
@@ -491,14 +906,34 @@ SnicNetDevice::HandleIpv4Packet(Ptr<NetDevice> incomingPort,
                     {
                         packet->AddHeader(snicHeader);
                         packet->AddHeader(ipv4Header);
-                        entry->EnqueuePending(packet);
                         NS_LOG_DEBUG("flow waitreply, enqueue");
-                        // FIXME handle last packet in flow while waiting for
-                        // scheduler response
+                        if (!entry->EnqueuePending(packet))
+                        {
+                            // the last packet releases the allocation, it
+                            // takes the place of the oldest pending one
+                            if (snicHeader.IsLastInFlow())
+                            {
+                                Ptr<Packet> oldest = entry->DequeuePending();
+                                entry->EnqueuePending(packet);
+                                packet = oldest;
+                            }
+                            SendWithoutOffload(incomingPort, packet, protocol, src48, dst48);
+                        }
+                    }
+                    else if (entry->IsRejected())
+                    {
+                        packet->AddHeader(snicHeader);
+                        packet->AddHeader(ipv4Header);
+                        NS_LOG_DEBUG("flow rejected, no offload");
+                        SendWithoutOffload(incomingPort, packet, protocol, src48, dst48);
+                        if (snicHeader.IsLastInFlow())
+                        {
+                            m_packetBuffer->Delete(flowId);
+                        }
                     }
                     else
                     {
-                        snicHeader.SetRteList(entry->GetRoute());
+                        snicHeader.SetRoute(entry->GetRoute());
                         packet->AddHeader(snicHeader);
                         packet->AddHeader(ipv4Header);
                         NS_LOG_DEBUG("flow not waitreply forward");
@@ -510,6 +945,14 @@ SnicNetDevice::HandleIpv4Packet(Ptr<NetDevice> incomingPort,
                         }
                     }
                 }
+                else if (!snicHeader.IsNewFlow())
+                {
+                    // the flow was evicted, its allocation went with it
+                    packet->AddHeader(snicHeader);
+                    packet->AddHeader(ipv4Header);
+                    NS_LOG_DEBUG("flow not found mid-flow, no offload");
+                    SendWithoutOffload(incomingPort, packet, protocol, src48, dst48);
+                }
                 else
                 {
                     NS_LOG_DEBUG("flow not found, requesting");
@@ -529,11 +972,11 @@ SnicNetDevice::HandleIpv4Packet(Ptr<NetDevice> incomingPort,
         if (!addressedToUs)
         {
             NS_LOG_DEBUG("req not addressed to us");
-            packet->AddHeader(snicHeader);
-            packet->AddHeader(ipv4Header);
             ForwardUnicast(incomingPort, packet, protocol, src48, dst48);
             return;
         }
+        packet->RemoveHeader(ipv4Header);
+        packet->RemoveHeader(snicHeader);
         m_numSchedReqs++;
         m_schedTrace(this, packet);
         SnicSchedulerHeader schedHeader;
@@ -546,46 +989,64 @@ SnicNetDevice::HandleIpv4Packet(Ptr<NetDevice> incomingPort,
         // NS_FATAL_ERROR("");
         //}
         NS_LOG_DEBUG("running sched");
-        if (m_scheduler.Schedule(snicHeader, schedHeader) == false)
+        if (schedHeader.GetNFlows() > 0)
+        {
+            // the placement policy decides in which order the batch is served
+            std::vector<SnicSchedulerHeader> flows;
+            for (uint16_t n = 0; n < schedHeader.GetNFlows(); ++n)
+            {
+                flows.push_back(schedHeader.GetFlow(n));
+            }
+            std::vector<SnicHeader> flowSnicHeaders;
+            std::vector<bool> admitted;
+            m_scheduler->ScheduleBatch(flows, flowSnicHeaders, admitted);
+            // the response only carries the admitted flows, the others wait
+            SnicSchedulerHeader responseSchedHeader;
+            for (uint16_t n = 0; n < flows.size(); ++n)
+            {
+                if (!admitted[n])
+                {
+                    QueueForAdmission(flows[n], ipv4Header, snicHeader, protocol, dst);
+                    continue;
+                }
+                responseSchedHeader.AddFlow(flows[n]);
+                responseSchedHeader.SetFlowRoute(responseSchedHeader.GetNFlows() - 1,
+                                                 flowSnicHeaders[n].GetRoute());
+            }
+            if (responseSchedHeader.GetNFlows() > 0)
+            {
+                SendAllocationReply(SnicHeader::ALLOCATION_RESPONSE,
+                                    ipv4Header,
+                                    snicHeader,
+                                    responseSchedHeader,
+                                    protocol,
+                                    dst);
+            }
+            break;
+        }
+        if (!m_scheduler->Schedule(snicHeader, schedHeader))
         {
-            NS_FATAL_ERROR("out of resource");
+            QueueForAdmission(schedHeader, ipv4Header, snicHeader, protocol, dst);
+            break;
         }
         NS_LOG_DEBUG("done running sched");
         NS_LOG_DEBUG(snicHeader);
-        //  reply
-        Ptr<Packet> response = Create<Packet>();
-        SnicSchedulerHeader responseSchedHeader(ipv4Header, snicHeader);
-        SnicHeader responseSnicHeader(snicHeader);
-        Ipv4Header responseIpv4Header(ipv4Header);
-        responseSnicHeader.SetPacketType(SnicHeader::ALLOCATION_RESPONSE);
-
-        responseSnicHeader.SetSourcePort(snicHeader.GetDestinationPort());
-        responseSnicHeader.SetDestinationPort(snicHeader.GetSourcePort());
-        responseSnicHeader.SetSourceIp(snicHeader.GetDestinationIp());
-        responseSnicHeader.SetDestinationIp(snicHeader.GetSourceIp());
-
-        responseIpv4Header.SetSource(ipv4Header.GetDestination());
-        responseIpv4Header.SetDestination(ipv4Header.GetSource());
-        NS_LOG_DEBUG("creating response");
-        // NS_ASSERT_MSG(false, "debugging scheduler");
-        NS_LOG_DEBUG("old src: " << ipv4Header.GetSource());
-        NS_LOG_DEBUG("old dest: " << ipv4Header.GetDestination());
-        NS_LOG_DEBUG(responseSnicHeader);
-
-        response->AddHeader(responseSchedHeader);
-        response->AddHeader(responseSnicHeader);
-        response->AddHeader(responseIpv4Header);
-        m_rxCallback(this, response, protocol, dst);
+        SendAllocationReply(SnicHeader::ALLOCATION_RESPONSE,
+                            ipv4Header,
+                            snicHeader,
+                            schedHeader,
+                            protocol,
+                            dst);
         break;
     }
     case SnicHeader::ALLOCATION_RESPONSE: {
         if (!addressedToUs)
         {
-            packet->AddHeader(snicHeader);
-            packet->AddHeader(ipv4Header);
             ForwardUnicast(incomingPort, packet, protocol, src48, dst48);
             return;
         }
+        packet->RemoveHeader(ipv4Header);
+        packet->RemoveHeader(snicHeader);
         HandleAllocationResponse(ipv4Header,
                                  snicHeader,
                                  incomingPort,
@@ -598,11 +1059,11 @@ SnicNetDevice::HandleIpv4Packet(Ptr<NetDevice> incomingPort,
     case SnicHeader::ALLOCATION_RELEASE: {
         if (!addressedToUs)
         {
-            packet->AddHeader(snicHeader);
-            packet->AddHeader(ipv4Header);
             ForwardUnicast(incomingPort, packet, protocol, src48, dst48);
             return;
         }
+        packet->RemoveHeader(ipv4Header);
+        packet->RemoveHeader(snicHeader);
         HandleAllocationRelease(ipv4Header,
                                 snicHeader,
                                 incomingPort,
@@ -614,6 +1075,23 @@ SnicNetDevice::HandleIpv4Packet(Ptr<NetDevice> incomingPort,
         NS_LOG_DEBUG("got release");
         break;
     }
+    case SnicHeader::ALLOCATION_REJECT: {
+        if (!addressedToUs)
+        {
+            ForwardUnicast(incomingPort, packet, protocol, src48, dst48);
+            return;
+        }
+        packet->RemoveHeader(ipv4Header);
+        packet->RemoveHeader(snicHeader);
+        HandleAllocationReject(ipv4Header,
+                               snicHeader,
+                               incomingPort,
+                               packet,
+                               protocol,
+                               src48,
+                               dst48);
+        break;
+    }
     default:
         NS_FATAL_ERROR("unhandled snic packet type");
     }
@@ -649,7 +1127,6 @@ SnicNetDevice::ReceiveFromDevice(Ptr<NetDevice> incomingPort,
                                  const Address& dst,
                                  PacketType packetType)
 {
-    Packet::EnablePrinting();
     NS_LOG_FUNCTION(this << incomingPort << protocol);
     NS_LOG_DEBUG("uid " << packet->GetUid());
     NS_LOG_DEBUG("snic id: " << GetSnicId());
@@ -661,19 +1138,12 @@ SnicNetDevice::ReceiveFromDevice(Ptr<NetDevice> incomingPort,
     // NS_LOG_DEBUG("mac dest is " << dst48);
     // NS_LOG_DEBUG("m_address is " << m_address);
     // NS_LOG_DEBUG("packetType is " << packetType);
-    SnicHeader snicHeader;
-    Ptr<Packet> copypkt = packet->Copy();
-    // NS_LOG_DEBUG("test2");
-    // copypkt->RemoveHeader(snicHeader);
-    // packet->PeekHeader(snicHeader);
-    // NS_LOG_DEBUG("test");
-    std::ostringstream coll;
-
-    packet->Print(coll);
-    // snicHeader.Print(coll);
-
-    NS_LOG_DEBUG("header is " << coll.str());
-    // NS_LOG_DEBUG("header nt is " << snicHeader.GetNT());
+    if (m_printPackets)
+    {
+        std::ostringstream coll;
+        packet->Print(coll);
+        NS_LOG_DEBUG("header is " << coll.str());
+    }
 
     if (!m_promiscRxCallback.IsNull())
     {
@@ -697,15 +1167,15 @@ SnicNetDevice::ReceiveFromDevice(Ptr<NetDevice> incomingPort,
     case PACKET_BROADCAST:
     case PACKET_MULTICAST:
         NS_LOG_DEBUG("packetType PACKET_MULTICAST ");
-        if (m_broadcastedPackets.count(packet->GetUid()) > 0)
+        if (m_broadcastFilter.IsDuplicate(packet->GetUid(), Simulator::Now()))
         {
             NS_LOG_DEBUG("packetType PACKET_MULTICAST already seen == dropping");
+            m_broadcastSuppressedTrace(packet);
             break;
         }
         // if (protocol != ArpL3Protocol::PROT_NUMBER)
         m_rxCallback(this, packet, protocol, src);
         // warp snic header
-        m_broadcastedPackets[packet->GetUid()] = 1;
         ForwardBroadcast(incomingPort, packet, protocol, src48, dst48);
         break;
 
@@ -786,7 +1256,7 @@ SnicNetDevice::ProcessPacket(Ptr<NetDevice> incomingPort,
 
 void
 SnicNetDevice::ForwardUnicast(Ptr<NetDevice> incomingPort,
-                              Ptr<const Packet> packet,
+                              Ptr<Packet> packet,
                               uint16_t protocol,
                               Mac48Address src,
                               Mac48Address dst)
@@ -796,18 +1266,26 @@ SnicNetDevice::ForwardUnicast(Ptr<NetDevice> incomingPort,
                  << incomingPort->GetInstanceTypeId().GetName() << ", packet=" << packet
                  << ", protocol=" << protocol << ", src=" << src << ", dst=" << dst << ")");
 
-    Learn(src, incomingPort);
-    Ptr<NetDevice> outPort = GetLearnedState(dst);
-    if (outPort && outPort != incomingPort)
+    // one clock read and no reference counting for both table accesses
+    uint32_t inPort = GetPortIndex(incomingPort);
+    uint32_t outPort = MacLearningTable::NO_PORT;
+    if (m_enableLearning)
+    {
+        Time now = Simulator::Now();
+        m_learnTable.Learn(src, inPort, now);
+        outPort = m_learnTable.Lookup(dst, now);
+    }
+    if (outPort != MacLearningTable::NO_PORT && outPort != inPort)
     {
         NS_LOG_LOGIC("Learning bridge state says to use port `"
-                     << outPort->GetInstanceTypeId().GetName() << "'");
-        PipelinedSendFrom(outPort, packet->Copy(), src, dst, protocol);
-        // outPort->SendFrom(packet->Copy(), src, dst, protocol);
+                     << m_ports[outPort]->GetInstanceTypeId().GetName() << "'");
+        PipelinedSendFrom(m_ports[outPort], packet, src, dst, protocol);
     }
     else
     {
         NS_LOG_LOGIC("No learned state: send through all ports");
+        // every port but the last one gets its own copy
+        Ptr<NetDevice> lastPort = nullptr;
         for (std::vector<Ptr<NetDevice>>::iterator iter = m_ports.begin(); iter != m_ports.end();
              iter++)
         {
@@ -819,10 +1297,17 @@ SnicNetDevice::ForwardUnicast(Ptr<NetDevice> incomingPort,
                              << "): " << incomingPort->GetInstanceTypeId().GetName() << " --> "
                              << port->GetInstanceTypeId().GetName() << " (UID " << packet->GetUid()
                              << ").");
-                // port->SendFrom(packet->Copy(), src, dst, protocol);
-                PipelinedSendFrom(port, packet->Copy(), src, dst, protocol);
+                if (lastPort)
+                {
+                    PipelinedSendFrom(lastPort, packet->Copy(), src, dst, protocol);
+                }
+                lastPort = port;
             }
         }
+        if (lastPort)
+        {
+            PipelinedSendFrom(lastPort, packet, src, dst, protocol);
+        }
     }
 }
 
@@ -835,91 +1320,30 @@ SnicNetDevice::Forward(Ptr<NetDevice> incomingPort,
 {
     NS_LOG_FUNCTION(this);
 
-    Ipv4Header ipv4Header;
-    SnicHeader snicHeader;
-    packet->RemoveHeader(ipv4Header);
-    packet->RemoveHeader(snicHeader);
-    std::list<SnicRte> rteList = snicHeader.GetRteList();
-
-    bool hasUnprocessedRte = false;
-
-    Ptr<NetDevice> nextDevice = nullptr;
+    SnicHeaderView view(packet);
 
-    NS_LOG_DEBUG("rte size=" << rteList.size());
-    if (snicHeader.GetUseRouting() && rteList.size() > 0)
+    NS_LOG_DEBUG("rte size=" << view.GetRteNumber());
+    if (!view.GetUseRouting() || view.GetRteNumber() == 0)
     {
-        // find next rte entry.
-        for (auto it = rteList.begin(); it != rteList.end(); ++it)
-        {
-            SnicRte& rte = *it;
-            // NS_LOG_DEBUG("proc= " << rte.GetProcessed());
-            // NS_LOG_DEBUG("l= " << rte.GetLDevice());
-            // NS_LOG_DEBUG("r= " << rte.GetRDevice());
-            // NS_LOG_DEBUG("this= " << this);
-            // NS_LOG_DEBUG("======");
-            //  if ((*it).GetLDevice() == this)
-            //{
-            //  NS_LOG_DEBUG("found ourself in rte list");
-            // }
-
-            // skip processed rte
-            if (rte.GetProcessed())
-            {
-                continue;
-            }
-            hasUnprocessedRte = true;
-            NS_LOG_DEBUG("Not processed rte");
-            for (std::vector<Ptr<NetDevice>>::iterator iter = m_ports.begin();
-                 iter != m_ports.end();
-                 iter++)
-            {
-                Ptr<NetDevice> port = *iter;
-                if (port == (*it).GetRDevice())
-                {
-                    NS_LOG_DEBUG("found in imp list");
-                    rte.SetProcessed(true);
-                    nextDevice = port;
-
-                    snicHeader.SetRteList(rteList);
-                    break;
-                }
-            }
-            if (nextDevice)
-            {
-                break;
-            }
-            else
-            {
-                NS_ASSERT_MSG(false, "didn't find a device for unprocessed rte");
-            }
-        }
-
-        packet->AddHeader(snicHeader);
-        packet->AddHeader(ipv4Header);
-        if (hasUnprocessedRte == false)
-        {
-            NS_LOG_DEBUG("last hop");
-            ForwardUnicast(incomingPort, packet, protocol, src, dst);
-            return;
-        }
-        else if (nextDevice)
-        {
-            PipelinedSendFrom(nextDevice, packet->Copy(), src, dst, protocol);
-            return;
-        }
-        else
-        {
-            NS_ASSERT_MSG(false, "didn't find rte");
-        }
-        NS_ASSERT_MSG(false, "shouldn't be reached");
+        NS_LOG_DEBUG("no rteList");
+        ForwardUnicast(incomingPort, packet, protocol, src, dst);
+        return;
     }
-    else
+
+    // the hop cursor points at the rte that leaves from us
+    uint16_t next = view.AdvanceRte();
+    if (next == view.GetRteNumber())
     {
-        NS_ASSERT("no rteList");
-        packet->AddHeader(snicHeader);
-        packet->AddHeader(ipv4Header);
+        NS_LOG_DEBUG("last hop");
         ForwardUnicast(incomingPort, packet, protocol, src, dst);
+        return;
     }
+
+    uint16_t port = view.GetRtePort(next);
+    NS_LOG_DEBUG("rte " << next << " leaves from port " << port);
+    NS_ASSERT_MSG(port < m_ports.size(), "didn't find a device for rte");
+    view.Commit();
+    PipelinedSendFrom(m_ports[port], packet, src, dst, protocol);
 }
 
 void
@@ -957,9 +1381,7 @@ SnicNetDevice::Learn(Mac48Address source, Ptr<NetDevice> port)
     NS_LOG_FUNCTION_NOARGS();
     if (m_enableLearning)
     {
-        LearnedState& state = m_learnState[source];
-        state.associatedPort = port;
-        state.expirationTime = Simulator::Now() + m_expirationTime;
+        m_learnTable.Learn(source, GetPortIndex(port), Simulator::Now());
     }
 }
 
@@ -969,24 +1391,26 @@ SnicNetDevice::GetLearnedState(Mac48Address source)
     NS_LOG_FUNCTION_NOARGS();
     if (m_enableLearning)
     {
-        Time now = Simulator::Now();
-        std::map<Mac48Address, LearnedState>::iterator iter = m_learnState.find(source);
-        if (iter != m_learnState.end())
+        uint32_t port = m_learnTable.Lookup(source, Simulator::Now());
+        if (port != MacLearningTable::NO_PORT)
         {
-            LearnedState& state = iter->second;
-            if (state.expirationTime > now)
-            {
-                return state.associatedPort;
-            }
-            else
-            {
-                m_learnState.erase(iter);
-            }
+            return m_ports[port];
         }
     }
     return nullptr;
 }
 
+uint32_t
+SnicNetDevice::GetPortIndex(const Ptr<NetDevice>& port) const
+{
+    auto it = m_portIndex.find(port);
+    if (it == m_portIndex.end())
+    {
+        NS_FATAL_ERROR("not a port of this sNIC");
+    }
+    return it->second;
+}
+
 void
 SnicNetDevice::HandleAllocationRequest(Ipv4Header& ipv4Header,
                                        SnicHeader& snicHeader,
@@ -1012,25 +1436,155 @@ SnicNetDevice::HandleAllocationResponse(Ipv4Header& ipv4Header,
     SnicSchedulerHeader schedHeader;
     packet->PeekHeader(schedHeader);
     NS_LOG_DEBUG("got response");
-    // get flowid from response packet
-    FlowId flowId(schedHeader);
+    if (schedHeader.GetNFlows() == 0)
+    {
+        if (!CompleteAllocation(FlowId(schedHeader),
+                                snicHeader.GetRoute(),
+                                1,
+                                incomingPort,
+                                protocol,
+                                src,
+                                dst))
+        {
+            ReleaseAllocation(schedHeader, protocol);
+        }
+        return;
+    }
+    for (uint16_t n = 0; n < schedHeader.GetNFlows(); ++n)
+    {
+        if (!CompleteAllocation(FlowId(schedHeader.GetFlow(n)),
+                                schedHeader.GetFlowRoute(n),
+                                schedHeader.GetNFlows(),
+                                incomingPort,
+                                protocol,
+                                src,
+                                dst))
+        {
+            ReleaseAllocation(schedHeader.GetFlow(n), protocol);
+        }
+    }
+}
+
+void
+SnicNetDevice::HandleAllocationReject(Ipv4Header& ipv4Header,
+                                      SnicHeader& snicHeader,
+                                      Ptr<NetDevice> incomingPort,
+                                      Ptr<Packet> packet,
+                                      uint16_t protocol,
+                                      Mac48Address src,
+                                      Mac48Address dst)
+{
+    NS_LOG_FUNCTION(this);
+
+    SnicSchedulerHeader schedHeader;
+    packet->RemoveHeader(schedHeader);
+    if (schedHeader.GetNFlows() == 0)
+    {
+        RejectFlow(FlowId(schedHeader));
+        return;
+    }
+    for (uint16_t n = 0; n < schedHeader.GetNFlows(); ++n)
+    {
+        RejectFlow(FlowId(schedHeader.GetFlow(n)));
+    }
+}
+
+void
+SnicNetDevice::RejectFlow(const FlowId& flowId)
+{
+    NS_LOG_FUNCTION(this << flowId.GetId());
+    PacketBuffer::Entry* entry = m_packetBuffer->Lookup(flowId);
+    if (!entry || !entry->IsWaitReply())
+    {
+        NS_LOG_DEBUG("flow " << flowId.GetId() << " no longer waits, ignoring rejection");
+        return;
+    }
+    std::vector<Ptr<Packet>> pendings;
+    for (Ptr<Packet> p = entry->DequeuePending(); p; p = entry->DequeuePending())
+    {
+        pendings.push_back(p);
+    }
+    Mac48Address src48 = Mac48Address::ConvertFrom(entry->GetSrc());
+    Mac48Address dst48 = Mac48Address::ConvertFrom(entry->GetDst());
+    Ptr<NetDevice> entryPort = entry->GetIncomingPort();
+    uint16_t entryProtocol = entry->GetProtocol();
+    entry->MarkRejected();
+    m_flowRejectedTrace(flowId);
+
+    bool done = false;
+    for (auto it = pendings.begin(); it != pendings.end(); ++it)
+    {
+        done = done || SnicHeaderView(*it).IsLastInFlow();
+        SendWithoutOffload(entryPort, *it, entryProtocol, src48, dst48);
+    }
+    if (done)
+    {
+        m_packetBuffer->Delete(flowId);
+    }
+}
+
+void
+SnicNetDevice::SendWithoutOffload(Ptr<NetDevice> incomingPort,
+                                  Ptr<Packet> packet,
+                                  uint16_t protocol,
+                                  Mac48Address src,
+                                  Mac48Address dst)
+{
+    NS_LOG_FUNCTION(this << packet);
+    if (!m_fallbackToHost)
+    {
+        m_offloadDropTrace(packet);
+        return;
+    }
+    // without a route the packet is bridged to its host like any other frame
+    Forward(incomingPort, packet, protocol, src, dst);
+}
+
+bool
+SnicNetDevice::CompleteAllocation(const FlowId& flowId,
+                                  const SnicRoute& route,
+                                  uint32_t batchSize,
+                                  Ptr<NetDevice> incomingPort,
+                                  uint16_t protocol,
+                                  Mac48Address src,
+                                  Mac48Address dst)
+{
+    NS_LOG_FUNCTION(this << flowId.GetId() << batchSize);
 
     // save route to use in other packets of the flow.
     //
     // find entry in packet buffer
-    PacketBuffer::Entry* entry = m_packetBuffer.Lookup(flowId);
-    if (entry)
+    PacketBuffer::Entry* entry = m_packetBuffer->Lookup(flowId);
+    if (!entry)
+    {
+        NS_LOG_DEBUG("flow " << flowId.GetId() << " was evicted, giving it back");
+        return false;
+    }
+    if (!entry->IsWaitReply())
+    {
+        NS_LOG_DEBUG("flow " << flowId.GetId() << " went without offload, giving it back");
+        return false;
+    }
+    NS_LOG_DEBUG("found entry");
+    entry->SetRoute(route);
+    m_allocationLatencyTrace(Simulator::Now() - entry->GetCreationTime(), batchSize);
+    // releasing the flow on its last packet gives the entry back to the
+    // buffer, so take everything we need out of it before forwarding
+    std::vector<Ptr<Packet>> pendings;
+    for (Ptr<Packet> p = entry->DequeuePending(); p; p = entry->DequeuePending())
     {
-        NS_LOG_DEBUG("found entry");
-        entry->SetRoute(snicHeader.GetRteList());
+        pendings.push_back(p);
     }
+    Mac48Address src48 = Mac48Address::ConvertFrom(entry->GetSrc());
+    Mac48Address dst48 = Mac48Address::ConvertFrom(entry->GetDst());
+    Ptr<NetDevice> entryPort = entry->GetIncomingPort();
+    uint16_t entryProtocol = entry->GetProtocol();
+    entry->MarkActive();
 
-    Ptr<Packet> pending = entry->DequeuePending();
-    while (pending)
+    for (auto it = pendings.begin(); it != pendings.end(); ++it)
     {
         // send
-        Mac48Address src48 = Mac48Address::ConvertFrom(entry->GetSrc());
-        Mac48Address dst48 = Mac48Address::ConvertFrom(entry->GetDst());
+        Ptr<Packet> pending = *it;
         NS_LOG_DEBUG("dequeue uid " << pending->GetUid());
         // packet->AddHeader(snicHeader);
         // packet->AddHeader(ipv4Header);
@@ -1038,21 +1592,20 @@ SnicNetDevice::HandleAllocationResponse(Ipv4Header& ipv4Header,
         SnicHeader pendingSnicHeader;
         pending->RemoveHeader(pendingIpv4Header);
         pending->RemoveHeader(pendingSnicHeader);
-        pendingSnicHeader.SetRteList(snicHeader.GetRteList());
+        pendingSnicHeader.SetRoute(route);
 
         pending->AddHeader(pendingSnicHeader);
         pending->AddHeader(pendingIpv4Header);
 
         // NS_LOG_DEBUG(pendingSnicHeader);
 
-        Forward(entry->GetIncomingPort(), pending, entry->GetProtocol(), src48, dst48);
+        Forward(entryPort, pending, entryProtocol, src48, dst48);
         if (pendingSnicHeader.IsLastInFlow())
         {
             AllocationRelease(incomingPort, pending, protocol, src, dst);
         }
-        pending = entry->DequeuePending();
     }
-    entry->MarkActive();
+    return true;
 }
 
 void
@@ -1069,7 +1622,206 @@ SnicNetDevice::HandleAllocationRelease(Ipv4Header& ipv4Header,
 
     SnicSchedulerHeader schedHeader;
     packet->RemoveHeader(schedHeader);
-    m_scheduler.Release(snicHeader, schedHeader);
+    std::map<uint32_t, Ptr<SnicScheduler>> shards;
+    std::vector<Ptr<SnicScheduler>> released;
+    for (uint16_t n = 0; n < schedHeader.GetNFlows(); ++n)
+    {
+        SnicSchedulerHeader flow = schedHeader.GetFlow(n);
+        released = m_scheduler->Release(snicHeader, flow);
+        for (auto it = released.begin(); it != released.end(); ++it)
+        {
+            shards[(*it)->GetShard()] = *it;
+        }
+    }
+    if (schedHeader.GetNFlows() == 0)
+    {
+        released = m_scheduler->Release(snicHeader, schedHeader);
+        for (auto it = released.begin(); it != released.end(); ++it)
+        {
+            shards[(*it)->GetShard()] = *it;
+        }
+    }
+    RetryAdmission();
+    // flows waiting at the shards that own the other edges of the released
+    // paths may fit now
+    for (auto it = shards.begin(); it != shards.end(); ++it)
+    {
+        Ptr<SnicNetDevice> owner = DynamicCast<SnicNetDevice>(it->second->GetDevice());
+        if (owner)
+        {
+            owner->RetryAdmission();
+        }
+    }
+}
+
+void
+SnicNetDevice::SendAllocationReply(uint16_t packetType,
+                                   const Ipv4Header& ipv4Header,
+                                   const SnicHeader& snicHeader,
+                                   const SnicSchedulerHeader& schedHeader,
+                                   uint16_t protocol,
+                                   const Address& dst)
+{
+    NS_LOG_FUNCTION(this << packetType);
+    Ptr<Packet> response = Create<Packet>();
+    // echo the flow of the request so the sNIC can find its entry
+    SnicSchedulerHeader responseSchedHeader(schedHeader);
+    responseSchedHeader.SetPacketType(packetType == SnicHeader::ALLOCATION_REJECT
+                                          ? SnicSchedulerHeader::ALLOCATION_REJECT
+                                          : SnicSchedulerHeader::ALLOCATION_RESPONSE);
+    SnicHeader responseSnicHeader(snicHeader);
+    Ipv4Header responseIpv4Header(ipv4Header);
+    responseSnicHeader.SetPacketType(packetType);
+
+    responseSnicHeader.SetSourcePort(snicHeader.GetDestinationPort());
+    responseSnicHeader.SetDestinationPort(snicHeader.GetSourcePort());
+    responseSnicHeader.SetSourceIp(snicHeader.GetDestinationIp());
+    responseSnicHeader.SetDestinationIp(snicHeader.GetSourceIp());
+
+    responseIpv4Header.SetSource(ipv4Header.GetDestination());
+    responseIpv4Header.SetDestination(ipv4Header.GetSource());
+    NS_LOG_DEBUG("creating response");
+    NS_LOG_DEBUG("old src: " << ipv4Header.GetSource());
+    NS_LOG_DEBUG("old dest: " << ipv4Header.GetDestination());
+    NS_LOG_DEBUG(responseSnicHeader);
+
+    response->AddHeader(responseSchedHeader);
+    response->AddHeader(responseSnicHeader);
+    // the response carries routes and is larger than the request
+    responseIpv4Header.SetPayloadSize(response->GetSize());
+    response->AddHeader(responseIpv4Header);
+    m_rxCallback(this, response, protocol, dst);
+}
+
+bool
+SnicNetDevice::AdmitsBefore(const WaitingFlow& a, const WaitingFlow& b) const
+{
+    if (m_admissionOrder == ADMIT_SMALLEST_FIRST &&
+        a.flow.GetBandwidthDemandBps() != b.flow.GetBandwidthDemandBps())
+    {
+        return a.flow.GetBandwidthDemandBps() < b.flow.GetBandwidthDemandBps();
+    }
+    return a.arrival < b.arrival;
+}
+
+void
+SnicNetDevice::QueueForAdmission(const SnicSchedulerHeader& flow,
+                                 const Ipv4Header& ipv4Header,
+                                 const SnicHeader& snicHeader,
+                                 uint16_t protocol,
+                                 const Address& dst)
+{
+    NS_LOG_FUNCTION(this << flow.GetFlowId());
+    WaitingFlow waiting;
+    waiting.flow = flow;
+    waiting.flow.SetPacketType(SnicSchedulerHeader::ALLOCATION_REQUEST);
+    waiting.ipv4Header = ipv4Header;
+    waiting.snicHeader = snicHeader;
+    waiting.protocol = protocol;
+    waiting.dst = dst;
+    waiting.arrival = Simulator::Now();
+
+    auto pos = m_admissionQueue.begin();
+    while (pos != m_admissionQueue.end() && !AdmitsBefore(waiting, *pos))
+    {
+        ++pos;
+    }
+    if (m_admissionQueue.size() >= m_admissionQueueSize)
+    {
+        // a full queue turns down whichever flow comes last
+        if (pos == m_admissionQueue.end())
+        {
+            NS_LOG_DEBUG("admission queue full, rejecting flow " << flow.GetFlowId());
+            RejectAllocation(waiting);
+            return;
+        }
+        RejectAllocation(m_admissionQueue.back());
+        m_admissionQueue.pop_back();
+    }
+    NS_LOG_DEBUG("out of resource, flow " << flow.GetFlowId() << " waits");
+    m_admissionQueue.insert(pos, waiting);
+    m_admissionQueueLength = m_admissionQueue.size();
+    ScheduleAdmissionTimeout();
+}
+
+void
+SnicNetDevice::RejectAllocation(const WaitingFlow& waiting)
+{
+    NS_LOG_FUNCTION(this << waiting.flow.GetFlowId());
+    m_admissionRejectTrace(FlowId(waiting.flow));
+    SendAllocationReply(SnicHeader::ALLOCATION_REJECT,
+                        waiting.ipv4Header,
+                        waiting.snicHeader,
+                        waiting.flow,
+                        waiting.protocol,
+                        waiting.dst);
+}
+
+void
+SnicNetDevice::RetryAdmission()
+{
+    NS_LOG_FUNCTION(this << m_admissionQueue.size());
+    // a flow that still does not fit doesn't hold back smaller ones behind it
+    for (auto it = m_admissionQueue.begin(); it != m_admissionQueue.end();)
+    {
+        SnicHeader routed;
+        if (!m_scheduler->Schedule(routed, it->flow))
+        {
+            ++it;
+            continue;
+        }
+        m_admissionQueueDelayTrace(Simulator::Now() - it->arrival);
+        SnicHeader snicHeader(it->snicHeader);
+        snicHeader.SetRoute(routed.GetRoute());
+        SendAllocationReply(SnicHeader::ALLOCATION_RESPONSE,
+                            it->ipv4Header,
+                            snicHeader,
+                            it->flow,
+                            it->protocol,
+                            it->dst);
+        it = m_admissionQueue.erase(it);
+    }
+    m_admissionQueueLength = m_admissionQueue.size();
+    ScheduleAdmissionTimeout();
+}
+
+void
+SnicNetDevice::ScheduleAdmissionTimeout()
+{
+    m_admissionTimer.Cancel();
+    if (m_admissionQueue.empty())
+    {
+        return;
+    }
+    Time first = m_admissionQueue.front().arrival;
+    for (auto it = m_admissionQueue.begin(); it != m_admissionQueue.end(); ++it)
+    {
+        first = Min(first, it->arrival);
+    }
+    Time deadline = first + m_admissionQueueTimeout;
+    m_admissionTimer = Simulator::Schedule(Max(deadline - Simulator::Now(), Time(0)),
+                                           &SnicNetDevice::HandleAdmissionTimeout,
+                                           this);
+}
+
+void
+SnicNetDevice::HandleAdmissionTimeout()
+{
+    NS_LOG_FUNCTION(this);
+    Time now = Simulator::Now();
+    for (auto it = m_admissionQueue.begin(); it != m_admissionQueue.end();)
+    {
+        if (now - it->arrival < m_admissionQueueTimeout)
+        {
+            ++it;
+            continue;
+        }
+        NS_LOG_DEBUG("flow " << it->flow.GetFlowId() << " waited too long, rejecting");
+        RejectAllocation(*it);
+        it = m_admissionQueue.erase(it);
+    }
+    m_admissionQueueLength = m_admissionQueue.size();
+    ScheduleAdmissionTimeout();
 }
 
 void
@@ -1080,31 +1832,120 @@ SnicNetDevice::PipelinedSendFrom(Ptr<NetDevice> port,
                                  uint16_t protocol)
 {
     NS_LOG_FUNCTION(this);
-    Ipv4Header ipv4Header;
-    SnicHeader snicHeader;
-    // int size = packet->RemoveHeader(ipv4Header);
-    // NS_LOG_DEBUG("size: " << size);
-    //  packet->PeekHeader(ipv4Header);
-    // packet->AddHeader(ipv4Header);
-    //    Time delay = snicHeader.GetDelay();
 
-    // Time now = Simulator::Now();
+    uint32_t nt;
+    Pipeline* pipeline = GetPipeline(packet, protocol, nt);
+    if (!pipeline)
+    {
+        // no pipeline model, the sNIC processes packets at infinite speed
+        Simulator::Schedule(NanoSeconds(0), &NetDevice::SendFrom, port, packet, src, dst, protocol);
+        return;
+    }
 
-    // m_pipelineLength = 16;
-    // m_numInPipeline++;
-    //  NS_LOG_DEBUG("delay=" << delay << " inPipe=" << m_numInPipeline);
+    PipelinedPacket p;
+    p.port = port;
+    p.packet = packet;
+    p.src = src;
+    p.dst = dst;
+    p.protocol = protocol;
+    p.arrival = Simulator::Now();
 
-    // if (m_numInPipeline >= 16)
-    //{
-    //  NS_
-    //}
-    // port->SendFrom(packet, src, dst, protocol);
+    if (pipeline->inFlight < pipeline->size)
+    {
+        AdmitToPipeline(nt, *pipeline, p);
+    }
+    else if (pipeline->queue.size() < m_pipelineQueueSize)
+    {
+        NS_LOG_DEBUG("pipeline " << nt << " full, queueing behind " << pipeline->queue.size());
+        pipeline->queue.push_back(p);
+        m_pipelineLength++;
+    }
+    else
+    {
+        NS_LOG_DEBUG("pipeline " << nt << " queue full, dropping");
+        m_pipelineDropTrace(packet);
+    }
+}
 
-    // m_pipeline.push(
-    Time delay = NanoSeconds(0);
+SnicNetDevice::Pipeline*
+SnicNetDevice::GetPipeline(Ptr<Packet> packet, uint16_t protocol, uint32_t& nt)
+{
+    NS_LOG_FUNCTION(this << protocol);
 
-    NS_LOG_DEBUG("scheduling packet send in: " << delay);
-    Simulator::Schedule(delay, &NetDevice::SendFrom, port, packet, src, dst, protocol);
+    if (!m_nts.empty() && protocol == IPV4_PROT_NUMBER)
+    {
+        uint8_t buffer[10];
+        uint16_t id;
+        if (packet->CopyData(buffer, 10) == 10 && buffer[9] == SnicL4Protocol::PROT_NUMBER &&
+            SnicHeaderView::PeekNT(packet, id))
+        {
+            auto it = m_nts.find(id);
+            if (it != m_nts.end())
+            {
+                nt = it->first;
+                Pipeline& pipeline = m_pipelines[nt];
+                pipeline.size = it->second->GetPipelineSize();
+                pipeline.delay = it->second->GetDelay();
+                pipeline.rate = it->second->GetIngressRate();
+                return &pipeline;
+            }
+        }
+    }
+
+    if (m_pipelineSize == 0)
+    {
+        return nullptr;
+    }
+    nt = NO_NT;
+    Pipeline& pipeline = m_pipelines[nt];
+    pipeline.size = m_pipelineSize;
+    pipeline.delay = m_pipelineDelay;
+    pipeline.rate = m_pipelineRate;
+    return &pipeline;
+}
+
+void
+SnicNetDevice::AdmitToPipeline(uint32_t nt, Pipeline& pipeline, const PipelinedPacket& p)
+{
+    NS_LOG_FUNCTION(this << nt);
+
+    // the ingress takes one packet at a time at the pipeline rate, after
+    // that the packet only has to make its way through the stages
+    Time now = Simulator::Now();
+    Time start = std::max(now, pipeline.ingressFree);
+    pipeline.ingressFree = start + pipeline.rate.CalculateBytesTxTime(p.packet->GetSize());
+    pipeline.inFlight++;
+    m_numInPipeline++;
+    m_queueingDelayTrace(nt, start - p.arrival);
+
+    Time delay = pipeline.ingressFree + pipeline.delay - now;
+    NS_LOG_DEBUG("scheduling packet send in: " << delay << " inPipe=" << pipeline.inFlight);
+    pipeline.events.push_back(
+        Simulator::Schedule(delay, &SnicNetDevice::PipelineDone, this, nt, p));
+}
+
+void
+SnicNetDevice::PipelineDone(uint32_t nt, PipelinedPacket p)
+{
+    NS_LOG_FUNCTION(this << nt);
+
+    Pipeline& pipeline = m_pipelines[nt];
+    // packets leave in the order they went in unless the NT changed its delay
+    while (!pipeline.events.empty() && pipeline.events.front().IsExpired())
+    {
+        pipeline.events.pop_front();
+    }
+    pipeline.inFlight--;
+    m_numInPipeline--;
+    p.port->SendFrom(p.packet, p.src, p.dst, p.protocol);
+
+    if (!pipeline.queue.empty())
+    {
+        PipelinedPacket next = pipeline.queue.front();
+        pipeline.queue.pop_front();
+        m_pipelineLength--;
+        AdmitToPipeline(nt, pipeline, next);
+    }
 }
 
 void
@@ -12,11 +12,13 @@
 #include "ns3/arp-header.h"
 #include "ns3/arp-l3-protocol.h"
 #include "ns3/bridge-channel.h"
+#include "ns3/data-rate.h"
 #include "ns3/enum.h"
 #include "ns3/ethernet-header.h"
 #include "ns3/integer.h"
 #include "ns3/ipv4-l3-protocol.h"
 #include "ns3/log.h"
+#include "ns3/mac-learning-table.h"
 #include "ns3/mac48-address.h"
 #include "ns3/node.h"
 #include "ns3/nstime.h"
@@ -27,10 +29,13 @@
 #include "ns3/udp-header.h"
 #include "ns3/uinteger.h"
 
+#include <deque>
+#include <list>
 #include <map>
 #include <stdint.h>
 #include <string>
 #include <tuple>
+#include <vector>
 
 namespace ns3
 {
@@ -92,8 +97,31 @@ class SnicNetDevice : public NetDevice
 
     void AddNT(Ptr<NetworkTask> nt, uint32_t id);
     void RemoveNT(uint32_t id);
+    /**
+     * \param id id of the NT
+     * \return the NT installed under that id, nullptr if there is none
+     */
     Ptr<NetworkTask> GetNT(uint32_t id);
     uint32_t GetNumNT();
+    /// \return the ids of the NTs installed, in increasing order
+    std::vector<uint32_t> GetNTIds() const;
+
+    /**
+     * \return the fraction of the FPGA fabric NTs can be placed on
+     */
+    double GetFpgaCapacity() const;
+    /**
+     * \return the memory NTs can be given, in bytes
+     */
+    double GetMemoryCapacity() const;
+    /**
+     * \return the traffic all the NTs of this sNIC can take in
+     */
+    DataRate GetIngressCapacity() const;
+    /**
+     * \return the traffic all the NTs of this sNIC can send out
+     */
+    DataRate GetEgressCapacity() const;
     uint64_t GetNumSchedReqs() const;
 
     void AllocationRequest(Ptr<NetDevice> incomingPort,
@@ -108,11 +136,53 @@ class SnicNetDevice : public NetDevice
                            const Address& src,
                            const Address& dst);
 
+    /**
+     * \param size number of broadcast packets remembered to drop their copies,
+     *        applied when the device is initialized
+     */
+    void SetBroadcastFilterSize(uint32_t size);
+    uint32_t GetBroadcastFilterSize() const;
+    /**
+     * \param window time a broadcast packet is remembered, 0 for no limit,
+     *        applied when the device is initialized
+     */
+    void SetBroadcastFilterWindow(Time window);
+    Time GetBroadcastFilterWindow() const;
+    /**
+     * \return the number of copies of already seen broadcast packets dropped
+     */
+    uint64_t GetNSuppressedBroadcasts() const;
+    /**
+     * \return the number of broadcast packets forgotten to make room before
+     *         BroadcastFilterWindow was over, whose copies may get through
+     */
+    uint64_t GetNBroadcastFilterEvictions() const;
+
+    /**
+     * \param expirationTime time it takes for a learned address to expire
+     */
+    void SetExpirationTime(Time expirationTime);
+    Time GetExpirationTime() const;
+
     void SetSchedulerAddress(Ipv4Address schedulerAddress);
     Ipv4Address GetSchedulerAddress() const;
 
     void SetIsScheduler(bool isScheduler);
     bool IsScheduler() const;
+    /**
+     * \return the scheduler used when this sNIC is a scheduler
+     */
+    Ptr<SnicScheduler> GetScheduler() const;
+
+    /**
+     * \param printPackets true to print every received packet to the log.
+     *
+     * Packet metadata has to be enabled before the first packet is sent, so
+     * enabling this also enables packet printing for the whole simulation.
+     */
+    void SetPrintPackets(bool printPackets);
+    bool GetPrintPackets() const;
+
     void SetIpAddress(Ipv4Address address);
     Ipv4Address GetIpAddress() const;
 
@@ -165,6 +235,7 @@ class SnicNetDevice : public NetDevice
     void AddAddress(Mac48Address addr);
     bool IsOurAddress(Mac48Address addr) const;
     void DoDispose() override;
+    void DoInitialize() override;
 
     /**
      * Called when a packet is received on one of the switch's ports.
@@ -212,7 +283,7 @@ class SnicNetDevice : public NetDevice
      * \param dst the packet destination
      */
     void ForwardUnicast(Ptr<NetDevice> incomingPort,
-                        Ptr<const Packet> packet,
+                        Ptr<Packet> packet,
                         uint16_t protocol,
                         Mac48Address src,
                         Mac48Address dst);
@@ -251,6 +322,12 @@ class SnicNetDevice : public NetDevice
      */
     Ptr<NetDevice> GetLearnedState(Mac48Address source);
 
+    /**
+     * \param port one of the bridged ports
+     * \return the index of the port in m_ports
+     */
+    uint32_t GetPortIndex(const Ptr<NetDevice>& port) const;
+
     void HandleAllocationRequest(Ipv4Header& ipv4Header,
                                  SnicHeader& snicHeader,
                                  Ptr<NetDevice> incomingPort,
@@ -275,6 +352,14 @@ class SnicNetDevice : public NetDevice
                                  Mac48Address src,
                                  Mac48Address dst);
 
+    void HandleAllocationReject(Ipv4Header& ipv4Header,
+                                SnicHeader& snicHeader,
+                                Ptr<NetDevice> incomingPort,
+                                Ptr<Packet> packet,
+                                uint16_t protocol,
+                                Mac48Address src,
+                                Mac48Address dst);
+
     void PipelinedSendFrom(Ptr<NetDevice> port,
                            Ptr<Packet> packet,
                            const Address& src,
@@ -283,6 +368,29 @@ class SnicNetDevice : public NetDevice
 
     typedef void (*SchedTracedCallback)(Ptr<const SnicNetDevice>, Ptr<const Packet>);
 
+    /**
+     * TracedCallback signature for allocation latencies.
+     *
+     * \param [in] latency time from the allocation request to the response
+     * \param [in] batchSize number of flows carried by the response
+     */
+    typedef void (*AllocationLatencyTracedCallback)(Time latency, uint32_t batchSize);
+
+    /**
+     * TracedCallback signature for pipeline queueing delays.
+     *
+     * \param [in] nt the NT whose pipeline the packet entered
+     * \param [in] delay time the packet waited for the pipeline
+     */
+    typedef void (*QueueingDelayTracedCallback)(uint32_t nt, Time delay);
+
+    /// order in which the scheduler retries the flows waiting for resources
+    enum AdmissionOrder
+    {
+        ADMIT_FIFO,           //!< oldest first
+        ADMIT_SMALLEST_FIRST, //!< least bandwidth demand first, then oldest first
+    };
+
   private:
     static const uint16_t IPV4_PROT_NUMBER = 0x0800; //!< Protocol number (0x0800)
     uint16_t m_num_hosts_connected;
@@ -509,26 +617,192 @@ class SnicNetDevice : public NetDevice
     /**@}*/
 
     /**
-     * \ingroup bridge
-     * Structure holding the status of an address
+     * Allocation requests or releases waiting to be sent to the scheduler
+     * in a single packet.
+     */
+    struct AllocationBatch
+    {
+        Ipv4Header ipv4Header;            //!< headers of the first queued flow
+        SnicHeader snicHeader;            //!< headers of the first queued flow
+        SnicSchedulerHeader schedHeader;  //!< the queued flows
+        uint16_t protocol = 0;            //!< protocol of the first queued flow
+        EventId timer;                    //!< flushes the batch once the window is over
+    };
+
+    /**
+     * \brief Add a flow to a batch, sending the batch once it is full.
+     */
+    void QueueAllocation(AllocationBatch& batch,
+                         const Ipv4Header& ipv4Header,
+                         const SnicHeader& snicHeader,
+                         const SnicSchedulerHeader& flow,
+                         uint16_t protocol);
+    /**
+     * \brief Send the flows of a batch to the scheduler.
+     */
+    void FlushAllocationBatch(AllocationBatch* batch);
+
+    /**
+     * \brief Send a request or release to the scheduler, or add it to a batch.
+     */
+    void SendToScheduler(AllocationBatch& batch,
+                         const Ipv4Header& ipv4Header,
+                         const SnicHeader& snicHeader,
+                         const SnicSchedulerHeader& schedHeader,
+                         uint16_t protocol);
+
+    /**
+     * \brief Give back the allocation of a flow that no longer uses it.
+     * \param flow the flow, as a single flow header
+     * \param protocol protocol of the packets to the scheduler
+     */
+    void ReleaseAllocation(const SnicSchedulerHeader& flow, uint16_t protocol);
+
+    /**
+     * \brief Send the pending packets of a flow without offload and stop
+     * waiting for the scheduler.
+     * \param flowId the flow, ignored unless it waits for the scheduler
+     */
+    void RejectFlow(const FlowId& flowId);
+
+    /**
+     * \brief Give back the allocation of a flow the packet buffer evicted.
+     * \param flowId the flow
+     * \param protocol protocol of the packets of the flow
+     */
+    void ReleaseEvictedFlow(const FlowId& flowId, uint16_t protocol);
+
+    /**
+     * \brief Bridge a packet to its host without a route, or drop it if
+     * FallbackToHost is off.
      */
-    struct LearnedState
+    void SendWithoutOffload(Ptr<NetDevice> incomingPort,
+                            Ptr<Packet> packet,
+                            uint16_t protocol,
+                            Mac48Address src,
+                            Mac48Address dst);
+
+    /// an allocation request the scheduler could not serve when it came in
+    struct WaitingFlow
     {
-        Ptr<NetDevice> associatedPort; //!< port associated with the address
-        Time expirationTime;           //!< time it takes for learned MAC state to expire
+        SnicSchedulerHeader flow; //!< the flow, as a single flow header
+        Ipv4Header ipv4Header;    //!< headers of the request that carried it
+        SnicHeader snicHeader;    //!< headers of the request that carried it
+        uint16_t protocol = 0;
+        Address dst;  //!< address the request was received on
+        Time arrival; //!< time the flow started waiting
     };
 
+    /**
+     * \brief Answer an allocation request.
+     * \param packetType SnicHeader::ALLOCATION_RESPONSE or ALLOCATION_REJECT
+     */
+    void SendAllocationReply(uint16_t packetType,
+                             const Ipv4Header& ipv4Header,
+                             const SnicHeader& snicHeader,
+                             const SnicSchedulerHeader& schedHeader,
+                             uint16_t protocol,
+                             const Address& dst);
+
+    /// \return true if a is retried before b according to AdmissionOrder
+    bool AdmitsBefore(const WaitingFlow& a, const WaitingFlow& b) const;
+
+    /**
+     * \brief Make a flow wait for resources, or reject it if the queue is full.
+     */
+    void QueueForAdmission(const SnicSchedulerHeader& flow,
+                           const Ipv4Header& ipv4Header,
+                           const SnicHeader& snicHeader,
+                           uint16_t protocol,
+                           const Address& dst);
+
+    void RejectAllocation(const WaitingFlow& waiting);
+
+    /**
+     * \brief Schedule the waiting flows that fit, called when resources are
+     * released.
+     */
+    void RetryAdmission();
+
+    /// arm the timer for the first waiting flow to reach AdmissionQueueTimeout
+    void ScheduleAdmissionTimeout();
+    void HandleAdmissionTimeout();
+
+    /// pipeline key of the packets that don't use an NT of this sNIC
+    static const uint32_t NO_NT = 0xffffffff;
+
+    /// a packet waiting for, or going through, a processing pipeline
+    struct PipelinedPacket
+    {
+        Ptr<NetDevice> port; //!< port the packet leaves from
+        Ptr<Packet> packet;
+        Address src;
+        Address dst;
+        uint16_t protocol;
+        Time arrival; //!< time the packet reached the pipeline
+    };
+
+    /**
+     * Processing pipeline of an NT: at most size packets are in flight, the
+     * ingress takes them one at a time at rate and each one then spends
+     * delay in the pipeline. Packets that find it full wait in queue.
+     */
+    struct Pipeline
+    {
+        uint32_t size = 0;
+        Time delay;
+        DataRate rate;
+        uint32_t inFlight = 0;
+        Time ingressFree; //!< time the ingress can take the next packet
+        std::deque<PipelinedPacket> queue;
+        std::deque<EventId> events; //!< completions of the packets in flight
+    };
+
+    /**
+     * \brief Find the pipeline that processes a packet.
+     * \param packet the packet
+     * \param protocol protocol of the packet
+     * \param nt set to the key of the pipeline
+     * \return the pipeline, or nullptr if the packet isn't modeled
+     */
+    Pipeline* GetPipeline(Ptr<Packet> packet, uint16_t protocol, uint32_t& nt);
+
+    /**
+     * \brief Start processing a packet, the pipeline must have a free slot.
+     */
+    void AdmitToPipeline(uint32_t nt, Pipeline& pipeline, const PipelinedPacket& p);
+
+    /**
+     * \brief Send a processed packet and admit the next waiting one.
+     */
+    void PipelineDone(uint32_t nt, PipelinedPacket p);
+
+    /**
+     * \brief Install the route of a flow and release its pending packets.
+     * \param flowId the flow
+     * \param route the route given by the scheduler
+     * \param batchSize number of flows in the response
+     * \return false if the flow was evicted or went without offload in the
+     *         meantime and its allocation has to be given back
+     */
+    bool CompleteAllocation(const FlowId& flowId,
+                            const SnicRoute& route,
+                            uint32_t batchSize,
+                            Ptr<NetDevice> incomingPort,
+                            uint16_t protocol,
+                            Mac48Address src,
+                            Mac48Address dst);
+
     uint32_t m_snicId;
 
-    std::map<Mac48Address, LearnedState> m_learnState;   //!< Container for known address statuses
+    MacLearningTable m_learnTable;                       //!< port index of the known addresses
     Ptr<Node> m_node;                                    //!< Node owning this NetDevice
     Mac48Address m_address;                              //!< Mac48Address of this NetDevice
     std::map<Mac48Address, Mac48Address> m_addresses;    //!< All Mac48Addresses of this NetDevice
     Ipv4Address m_ipAddress;                             //!< Ipv4Address of this NetDevice
-    Time m_expirationTime; //!< time it takes for learned MAC state to expire
-                           //
     Ptr<BridgeChannel> m_channel;                        //!< virtual bridged channel
     std::vector<Ptr<NetDevice>> m_ports;                 //!< bridged ports
+    std::map<Ptr<NetDevice>, uint32_t> m_portIndex;      //!< index of each bridged port
     NetDevice::ReceiveCallback m_rxCallback;             //!< Receive callback
     NetDevice::PromiscReceiveCallback m_promiscRxCallback; //!< Receive callback
                            //   (promisc data)
@@ -547,6 +821,7 @@ class SnicNetDevice : public NetDevice
      */
     uint32_t m_mtu;
     bool m_enableLearning; //!< true if the bridge will learn the node status
+    bool m_printPackets;   //!< true if received packets are printed to the log
 
     /// PacketData type
     // typedef std::map<uint32_t, ofi::SwitchPacketMetadata> PacketData_t;
@@ -555,21 +830,55 @@ class SnicNetDevice : public NetDevice
     Ptr<Packet> m_currentPkt; //!< Current packet processed
     bool m_isScheduler;
     Ipv4Address m_schedulerAddress;
-    SnicScheduler m_scheduler;
+    Ptr<SnicScheduler> m_scheduler;
     std::vector<Address> m_connectedHosts;
     std::vector<Address> m_connectedSnics;
-    std::map<uint32_t, uint32_t> m_broadcastedPackets;
 
     TracedValue<uint64_t> m_numSchedReqs;
     TracedValue<uint64_t> m_numL4Packets;
     ns3::TracedCallback<Ptr<const SnicNetDevice>, Ptr<const Packet>> m_schedTrace;
 
-    PacketBuffer m_packetBuffer;
+    Ptr<PacketBuffer> m_packetBuffer;
+
+    uint32_t m_allocationBatchSize;  //!< flows per scheduler request
+    Time m_allocationBatchWindow;    //!< longest wait for a batch to fill up
+    AllocationBatch m_requestBatch;
+    AllocationBatch m_releaseBatch;
+    TracedCallback<Time, uint32_t> m_allocationLatencyTrace;
 
     uint64_t m_currentFlowId;
 
-    uint32_t m_numInPipeline = 0;
-    uint32_t m_pipelineLength = 0;
+    double m_fpgaCapacity;      //!< FPGA fabric available to NTs
+    double m_memoryCapacity;    //!< memory available to NTs, in bytes
+    DataRate m_ingressCapacity; //!< traffic the NTs can take in
+    DataRate m_egressCapacity;  //!< traffic the NTs can send out
+
+    uint32_t m_pipelineSize;              //!< slots of the default pipeline
+    Time m_pipelineDelay;                 //!< latency of the default pipeline
+    DataRate m_pipelineRate;              //!< rate of the default pipeline
+    uint32_t m_pipelineQueueSize;         //!< packets waiting per pipeline
+    std::map<uint32_t, Pipeline> m_pipelines;
+    TracedValue<uint32_t> m_numInPipeline;  //!< packets in flight in all pipelines
+    TracedValue<uint32_t> m_pipelineLength; //!< packets waiting for a pipeline
+    TracedCallback<uint32_t, Time> m_queueingDelayTrace;
+    TracedCallback<Ptr<const Packet>> m_pipelineDropTrace;
+
+    uint32_t m_admissionQueueSize;           //!< flows waiting at the scheduler
+    Time m_admissionQueueTimeout;            //!< longest wait at the scheduler
+    AdmissionOrder m_admissionOrder;         //!< order the waiting flows are retried in
+    std::list<WaitingFlow> m_admissionQueue; //!< in AdmissionOrder
+    EventId m_admissionTimer;                //!< rejects the flows that waited too long
+    bool m_fallbackToHost;                   //!< send unoffloaded packets instead of dropping
+    TracedValue<uint32_t> m_admissionQueueLength;
+    TracedCallback<const FlowId&> m_admissionRejectTrace;
+    TracedCallback<Time> m_admissionQueueDelayTrace;
+    TracedCallback<const FlowId&> m_flowRejectedTrace;
+    TracedCallback<Ptr<const Packet>> m_offloadDropTrace;
+
+    uint32_t m_broadcastFilterSize;    //!< broadcast packets remembered
+    Time m_broadcastFilterWindow;      //!< time a broadcast packet is remembered
+    DuplicateFilter m_broadcastFilter; //!< broadcast packets already forwarded
+    TracedCallback<Ptr<const Packet>> m_broadcastSuppressedTrace;
   };
 }
 #endif // SNIC_NET_DEVICE_H
@@ -0,0 +1,389 @@
+/*
+ * Copyright (c) 2023 UCSD WukLab, San Diego, USA
+ */
+
+#include "snic-path-engine.h"
+
+#include "snic-scheduler.h"
+
+#include "ns3/log.h"
+#include "ns3/snic-header.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SnicPathEngine");
+
+namespace
+{
+
+/**
+ * \param path a path
+ * \return true if a SnicRoute can carry the path, one hop per edge
+ */
+bool
+FitsInRoute(const SnicPathEngine::Path_t& path)
+{
+    return path.size() <= SnicRoute::MAX_HOPS + 1u;
+}
+
+} // namespace
+
+SnicPathEngine::SnicPathEngine()
+    : m_maxPaths(8),
+      m_remaining(nullptr),
+      m_visitEpoch(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+SnicPathEngine::~SnicPathEngine()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+SnicPathEngine::SetMaxPaths(uint32_t maxPaths)
+{
+    NS_LOG_FUNCTION(this << maxPaths);
+    NS_ASSERT_MSG(maxPaths > 0, "need at least one path per pair");
+    if (maxPaths < m_maxPaths)
+    {
+        Clear();
+    }
+    m_maxPaths = maxPaths;
+}
+
+uint32_t
+SnicPathEngine::GetMaxPaths() const
+{
+    return m_maxPaths;
+}
+
+void
+SnicPathEngine::SetRemainingBandwidth(const std::vector<uint64_t>* remaining)
+{
+    NS_LOG_FUNCTION(this << remaining);
+    m_remaining = remaining;
+}
+
+const SnicPathEngine::Path_t*
+SnicPathEngine::GetPath(SVertex* src, SVertex* dst, uint32_t n)
+{
+    NS_LOG_FUNCTION(this << src << dst << n);
+    if (n >= m_maxPaths)
+    {
+        return nullptr;
+    }
+
+    Pair_t pair(src, dst);
+    PairState& state = m_pairs[pair];
+    while (state.paths.size() <= n)
+    {
+        if (state.exhausted || !ComputeNextPath(pair, state))
+        {
+            return nullptr;
+        }
+    }
+    return &state.paths[n];
+}
+
+bool
+SnicPathEngine::FindFeasiblePath(SVertex* src, SVertex* dst, uint64_t minBps, Path_t& path) const
+{
+    NS_LOG_FUNCTION(this << src << dst << minBps);
+    // the path is a shortest one: if it is too long, all the others are
+    return ShortestPath(src, dst, minBps, std::set<SVertex*>(), std::set<SEdge*>(), path) &&
+           FitsInRoute(path);
+}
+
+void
+SnicPathEngine::NotifyEdgeChanged(SEdge* edge)
+{
+    NS_LOG_FUNCTION(this << edge);
+    bool saturated = GetRemaining(edge) == 0;
+    bool wasSaturated = m_saturatedEdges.count(edge) > 0;
+
+    if (saturated && !wasSaturated)
+    {
+        m_saturatedEdges.insert(edge);
+        auto it = m_edgeUsers.find(edge);
+        if (it != m_edgeUsers.end())
+        {
+            NS_LOG_DEBUG("edge saturated, invalidating " << it->second.size() << " pairs");
+            std::set<Pair_t> users;
+            users.swap(it->second);
+            m_edgeUsers.erase(it);
+            Invalidate(users);
+        }
+    }
+    else if (!saturated && wasSaturated)
+    {
+        m_saturatedEdges.erase(edge);
+        auto it = m_edgeExcluded.find(edge);
+        if (it != m_edgeExcluded.end())
+        {
+            NS_LOG_DEBUG("edge released, invalidating " << it->second.size() << " pairs");
+            std::set<Pair_t> excluded;
+            excluded.swap(it->second);
+            m_edgeExcluded.erase(it);
+            Invalidate(excluded);
+        }
+    }
+}
+
+void
+SnicPathEngine::Clear()
+{
+    NS_LOG_FUNCTION(this);
+    m_pairs.clear();
+    m_edgeUsers.clear();
+    m_edgeExcluded.clear();
+}
+
+uint32_t
+SnicPathEngine::GetNCachedPairs() const
+{
+    return m_pairs.size();
+}
+
+uint32_t
+SnicPathEngine::GetNCachedPaths() const
+{
+    uint32_t n = 0;
+    for (auto it = m_pairs.begin(); it != m_pairs.end(); ++it)
+    {
+        n += it->second.paths.size();
+    }
+    return n;
+}
+
+uint64_t
+SnicPathEngine::GetMemoryUsage() const
+{
+    // a node of a std::map or std::set holds its value, a color and 3 links
+    const uint64_t nodeOverhead = 4 * sizeof(void*);
+    uint64_t bytes = 0;
+    for (auto it = m_pairs.begin(); it != m_pairs.end(); ++it)
+    {
+        bytes += nodeOverhead + sizeof(*it);
+        const PairState& state = it->second;
+        bytes += (state.paths.capacity() + state.candidates.capacity()) * sizeof(Path_t);
+        for (auto path = state.paths.begin(); path != state.paths.end(); ++path)
+        {
+            bytes += path->capacity() * sizeof(SVertex*);
+        }
+        for (auto path = state.candidates.begin(); path != state.candidates.end(); ++path)
+        {
+            bytes += path->capacity() * sizeof(SVertex*);
+        }
+    }
+    for (auto index : {&m_edgeUsers, &m_edgeExcluded})
+    {
+        for (auto it = index->begin(); it != index->end(); ++it)
+        {
+            bytes += nodeOverhead + sizeof(*it);
+            bytes += it->second.size() * (nodeOverhead + sizeof(Pair_t));
+        }
+    }
+    bytes += m_saturatedEdges.size() * (nodeOverhead + sizeof(SEdge*));
+    bytes += m_parent.capacity() * sizeof(SVertex*) + m_visited.capacity() * sizeof(uint32_t) +
+             m_queue.capacity() * sizeof(SVertex*);
+    return bytes;
+}
+
+bool
+SnicPathEngine::ComputeNextPath(const Pair_t& pair, PairState& state)
+{
+    NS_LOG_FUNCTION(this << pair.first << pair.second << state.paths.size());
+
+    // whatever we compute now does not see the saturated edges
+    for (auto it = m_saturatedEdges.begin(); it != m_saturatedEdges.end(); ++it)
+    {
+        m_edgeExcluded[*it].insert(pair);
+    }
+
+    if (state.paths.empty())
+    {
+        Path_t path;
+        if (!ShortestPath(pair.first,
+                          pair.second,
+                          1,
+                          std::set<SVertex*>(),
+                          std::set<SEdge*>(),
+                          path) ||
+            !FitsInRoute(path))
+        {
+            state.exhausted = true;
+            return false;
+        }
+        RegisterPath(pair, path);
+        state.paths.push_back(path);
+        return true;
+    }
+
+    // Yen: deviate from every vertex of the last path found
+    const Path_t last = state.paths.back();
+    for (uint32_t i = 0; i + 1 < last.size(); ++i)
+    {
+        SVertex* spur = last[i];
+
+        std::set<SEdge*> bannedEdges;
+        for (auto p = state.paths.begin(); p != state.paths.end(); ++p)
+        {
+            if (p->size() > i + 1 && std::equal(last.begin(), last.begin() + i + 1, p->begin()))
+            {
+                bannedEdges.insert((*p)[i]->GetEdgeTo((*p)[i + 1]));
+            }
+        }
+        std::set<SVertex*> bannedVertices(last.begin(), last.begin() + i);
+
+        Path_t spurPath;
+        if (!ShortestPath(spur, pair.second, 1, bannedVertices, bannedEdges, spurPath))
+        {
+            continue;
+        }
+
+        Path_t candidate(last.begin(), last.begin() + i);
+        candidate.insert(candidate.end(), spurPath.begin(), spurPath.end());
+
+        if (FitsInRoute(candidate) &&
+            std::find(state.candidates.begin(), state.candidates.end(), candidate) ==
+                state.candidates.end() &&
+            std::find(state.paths.begin(), state.paths.end(), candidate) == state.paths.end())
+        {
+            RegisterPath(pair, candidate);
+            state.candidates.push_back(candidate);
+        }
+    }
+
+    if (state.candidates.empty())
+    {
+        state.exhausted = true;
+        return false;
+    }
+
+    // cheapest candidate, ties broken by discovery order
+    auto best = state.candidates.begin();
+    for (auto it = state.candidates.begin(); it != state.candidates.end(); ++it)
+    {
+        if (it->size() < best->size())
+        {
+            best = it;
+        }
+    }
+    state.paths.push_back(*best);
+    state.candidates.erase(best);
+
+    if (state.paths.size() >= m_maxPaths)
+    {
+        // no one will ever ask for them
+        state.candidates.clear();
+    }
+    return true;
+}
+
+bool
+SnicPathEngine::ShortestPath(SVertex* src,
+                             SVertex* dst,
+                             uint64_t minBps,
+                             const std::set<SVertex*>& bannedVertices,
+                             const std::set<SEdge*>& bannedEdges,
+                             Path_t& path) const
+{
+    NS_LOG_FUNCTION(this << src << dst << minBps);
+
+    // bumping the epoch forgets every previous visit without clearing
+    if (++m_visitEpoch == 0)
+    {
+        std::fill(m_visited.begin(), m_visited.end(), 0);
+        m_visitEpoch = 1;
+    }
+    Visit(src, nullptr);
+    m_queue.clear();
+    m_queue.push_back(src);
+    for (uint32_t head = 0; head < m_queue.size(); ++head)
+    {
+        SVertex* v = m_queue[head];
+        if (v == dst)
+        {
+            break;
+        }
+        for (auto it = v->m_edges.begin(); it != v->m_edges.end(); ++it)
+        {
+            SEdge* edge = *it;
+            SVertex* neighbor = edge->GetRVertex();
+            if (neighbor == v || IsVisited(neighbor) ||
+                neighbor->GetVertexType() == SVertex::VertexTypeHost ||
+                bannedVertices.count(neighbor) > 0 || bannedEdges.count(edge) > 0 ||
+                GetRemaining(edge) < minBps)
+            {
+                continue;
+            }
+            Visit(neighbor, v);
+            m_queue.push_back(neighbor);
+        }
+    }
+
+    if (!IsVisited(dst))
+    {
+        return false;
+    }
+
+    path.clear();
+    for (SVertex* v = dst; v != nullptr; v = m_parent[v->GetVertexIndex()])
+    {
+        path.push_back(v);
+    }
+    std::reverse(path.begin(), path.end());
+    return true;
+}
+
+void
+SnicPathEngine::Visit(SVertex* v, SVertex* parent) const
+{
+    uint32_t index = v->GetVertexIndex();
+    if (index >= m_visited.size())
+    {
+        m_visited.resize(index + 1, 0);
+        m_parent.resize(index + 1, nullptr);
+    }
+    m_visited[index] = m_visitEpoch;
+    m_parent[index] = parent;
+}
+
+bool
+SnicPathEngine::IsVisited(const SVertex* v) const
+{
+    uint32_t index = v->GetVertexIndex();
+    return index < m_visited.size() && m_visited[index] == m_visitEpoch;
+}
+
+uint64_t
+SnicPathEngine::GetRemaining(const SEdge* edge) const
+{
+    NS_ASSERT_MSG(m_remaining, "remaining bandwidth not set");
+    return (*m_remaining)[edge->GetEdgeId()];
+}
+
+void
+SnicPathEngine::RegisterPath(const Pair_t& pair, const Path_t& path)
+{
+    for (uint32_t i = 0; i + 1 < path.size(); ++i)
+    {
+        m_edgeUsers[path[i]->GetEdgeTo(path[i + 1])].insert(pair);
+    }
+}
+
+void
+SnicPathEngine::Invalidate(const std::set<Pair_t>& pairs)
+{
+    for (auto it = pairs.begin(); it != pairs.end(); ++it)
+    {
+        m_pairs.erase(*it);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2023 UCSD WukLab, San Diego, USA
+ */
+
+#ifndef SNIC_PATH_ENGINE_H
+#define SNIC_PATH_ENGINE_H
+
+#include <map>
+#include <set>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+class SVertex;
+class SEdge;
+
+/**
+ * \ingroup snic
+ * \brief Lazy k-shortest-path engine used by the SnicScheduler.
+ *
+ * Paths between a pair of sNIC vertices are computed on demand with Yen's
+ * algorithm over the residual topology, i.e. ignoring edges that have no
+ * bandwidth left.  The i-th cheapest path (in hops) of a pair is only
+ * computed the first time somebody asks for it, and every computed path is
+ * cached until one of the edges it depends on changes state:
+ *
+ * - when an edge becomes saturated, only the pairs that have a cached or
+ *   candidate path over that edge are dropped;
+ * - when a saturated edge gets bandwidth back, only the pairs that were
+ *   computed while that edge was excluded are dropped.
+ *
+ * Paths longer than a SnicRoute can carry (SnicRoute::MAX_HOPS edges) are
+ * never returned.
+ *
+ * The engine never owns vertices or edges; they belong to the scheduler.
+ */
+class SnicPathEngine
+{
+  public:
+    typedef std::vector<SVertex*> Path_t;
+
+    SnicPathEngine();
+    ~SnicPathEngine();
+
+    /**
+     * \param maxPaths the maximum number of paths kept per (src,dst) pair
+     */
+    void SetMaxPaths(uint32_t maxPaths);
+    uint32_t GetMaxPaths() const;
+
+    /**
+     * \param remaining the remaining bandwidth in bit/s of every edge,
+     *        indexed by edge id. It is owned by the caller and must outlive
+     *        the engine.
+     */
+    void SetRemainingBandwidth(const std::vector<uint64_t>* remaining);
+
+    /**
+     * \brief Get the n-th cheapest path between two vertices.
+     * \param src source vertex
+     * \param dst destination vertex
+     * \param n index of the path, 0 being the shortest one
+     * \return the path, or nullptr if there are less than n + 1 paths.
+     *
+     * The returned pointer is only valid until the next call into the engine.
+     */
+    const Path_t* GetPath(SVertex* src, SVertex* dst, uint32_t n);
+
+    /**
+     * \brief Find a shortest path whose edges all have at least minBps left.
+     * \param src source vertex
+     * \param dst destination vertex
+     * \param minBps the bandwidth every edge of the path must still have
+     * \param path filled with the path if one exists
+     * \return true if a path was found
+     *
+     * The result is not cached; it is used as a fallback when none of the
+     * cached paths can carry a given demand.
+     */
+    bool FindFeasiblePath(SVertex* src, SVertex* dst, uint64_t minBps, Path_t& path) const;
+
+    /**
+     * \brief Tell the engine the remaining bandwidth of an edge changed.
+     * \param edge the edge
+     */
+    void NotifyEdgeChanged(SEdge* edge);
+
+    /**
+     * \brief Drop every cached path.
+     */
+    void Clear();
+
+    /**
+     * \return the number of (src,dst) pairs that currently have a cache entry
+     */
+    uint32_t GetNCachedPairs() const;
+
+    /**
+     * \return the number of paths currently cached over all pairs
+     */
+    uint32_t GetNCachedPaths() const;
+
+    /**
+     * \return an estimate of the bytes held by the cache and its indexes,
+     *         the search scratch space included
+     */
+    uint64_t GetMemoryUsage() const;
+
+  private:
+    typedef std::pair<SVertex*, SVertex*> Pair_t;
+
+    /// Yen's algorithm state for one (src,dst) pair
+    struct PairState
+    {
+        std::vector<Path_t> paths;      //!< paths found so far, cheapest first
+        std::vector<Path_t> candidates; //!< Yen's candidate set
+        bool exhausted = false;         //!< no more paths exist
+    };
+
+    /**
+     * \brief Compute the next cheapest path of a pair.
+     * \return true if a new path was appended to state.paths
+     */
+    bool ComputeNextPath(const Pair_t& pair, PairState& state);
+
+    /**
+     * \brief Breadth first search over the residual topology.
+     * \param src source vertex
+     * \param dst destination vertex
+     * \param minBps minimum remaining bandwidth for an edge to be usable
+     * \param bannedVertices vertices that can't be part of the path
+     * \param bannedEdges edges that can't be part of the path
+     * \param path filled with the path if one exists
+     * \return true if a path was found
+     */
+    bool ShortestPath(SVertex* src,
+                      SVertex* dst,
+                      uint64_t minBps,
+                      const std::set<SVertex*>& bannedVertices,
+                      const std::set<SEdge*>& bannedEdges,
+                      Path_t& path) const;
+
+    /**
+     * \return the bandwidth still available on the edge in bit/s
+     */
+    uint64_t GetRemaining(const SEdge* edge) const;
+
+    /// mark a vertex as reached by the current search
+    void Visit(SVertex* v, SVertex* parent) const;
+    /// \return true if the current search already reached the vertex
+    bool IsVisited(const SVertex* v) const;
+
+    void RegisterPath(const Pair_t& pair, const Path_t& path);
+    void Invalidate(const std::set<Pair_t>& pairs);
+
+    uint32_t m_maxPaths;
+    const std::vector<uint64_t>* m_remaining;
+    std::map<Pair_t, PairState> m_pairs;
+    /// pairs with a cached or candidate path over the edge
+    std::map<SEdge*, std::set<Pair_t>> m_edgeUsers;
+    /// pairs computed while the (saturated) edge was excluded
+    std::map<SEdge*, std::set<Pair_t>> m_edgeExcluded;
+    std::set<SEdge*> m_saturatedEdges;
+
+    // search scratch space, indexed by SVertex::GetVertexIndex()
+    mutable std::vector<SVertex*> m_parent;
+    mutable std::vector<uint32_t> m_visited; //!< epoch of the last visit
+    mutable uint32_t m_visitEpoch;
+    mutable std::vector<SVertex*> m_queue;
+};
+
+} // namespace ns3
+
+#endif // SNIC_PATH_ENGINE_H
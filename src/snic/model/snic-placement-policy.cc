@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2023 UCSD WukLab, San Diego, USA
+ */
+
+#include "snic-placement-policy.h"
+
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SnicPlacementPolicy");
+
+NS_OBJECT_ENSURE_REGISTERED(SnicPlacementPolicy);
+NS_OBJECT_ENSURE_REGISTERED(SnicBestFitPolicy);
+NS_OBJECT_ENSURE_REGISTERED(SnicLeastLoadedPolicy);
+NS_OBJECT_ENSURE_REGISTERED(SnicPowerOfTwoPolicy);
+NS_OBJECT_ENSURE_REGISTERED(SnicGreedyBatchPolicy);
+
+TypeId
+SnicPlacementPolicy::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::SnicPlacementPolicy")
+                            .SetParent<Object>()
+                            .SetGroupName("Snic")
+                            .AddConstructor<SnicPlacementPolicy>();
+    return tid;
+}
+
+SnicPlacementPolicy::SnicPlacementPolicy()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+SnicPlacementPolicy::~SnicPlacementPolicy()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+bool
+SnicPlacementPolicy::NeedsAllCandidates() const
+{
+    return false;
+}
+
+uint32_t
+SnicPlacementPolicy::Select(const std::vector<Candidate>& candidates, uint64_t demand)
+{
+    NS_LOG_FUNCTION(this << candidates.size() << demand);
+    return 0;
+}
+
+std::vector<uint32_t>
+SnicPlacementPolicy::OrderBatch(const std::vector<uint64_t>& demands)
+{
+    std::vector<uint32_t> order(demands.size());
+    std::iota(order.begin(), order.end(), 0);
+    return order;
+}
+
+TypeId
+SnicBestFitPolicy::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::SnicBestFitPolicy")
+                            .SetParent<SnicPlacementPolicy>()
+                            .SetGroupName("Snic")
+                            .AddConstructor<SnicBestFitPolicy>();
+    return tid;
+}
+
+bool
+SnicBestFitPolicy::NeedsAllCandidates() const
+{
+    return true;
+}
+
+uint32_t
+SnicBestFitPolicy::Select(const std::vector<Candidate>& candidates, uint64_t demand)
+{
+    NS_LOG_FUNCTION(this << candidates.size() << demand);
+    // candidates are feasible, so bottleneck >= demand; ties go to the cheapest
+    uint32_t best = 0;
+    for (uint32_t i = 1; i < candidates.size(); ++i)
+    {
+        if (candidates[i].bottleneck < candidates[best].bottleneck)
+        {
+            best = i;
+        }
+    }
+    return best;
+}
+
+TypeId
+SnicLeastLoadedPolicy::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::SnicLeastLoadedPolicy")
+                            .SetParent<SnicPlacementPolicy>()
+                            .SetGroupName("Snic")
+                            .AddConstructor<SnicLeastLoadedPolicy>();
+    return tid;
+}
+
+bool
+SnicLeastLoadedPolicy::NeedsAllCandidates() const
+{
+    return true;
+}
+
+uint32_t
+SnicLeastLoadedPolicy::Select(const std::vector<Candidate>& candidates, uint64_t demand)
+{
+    NS_LOG_FUNCTION(this << candidates.size() << demand);
+    uint32_t best = 0;
+    for (uint32_t i = 1; i < candidates.size(); ++i)
+    {
+        if (candidates[i].load < candidates[best].load)
+        {
+            best = i;
+        }
+    }
+    return best;
+}
+
+TypeId
+SnicPowerOfTwoPolicy::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::SnicPowerOfTwoPolicy")
+                            .SetParent<SnicPlacementPolicy>()
+                            .SetGroupName("Snic")
+                            .AddConstructor<SnicPowerOfTwoPolicy>();
+    return tid;
+}
+
+SnicPowerOfTwoPolicy::SnicPowerOfTwoPolicy()
+{
+    NS_LOG_FUNCTION(this);
+    m_rng = CreateObject<UniformRandomVariable>();
+}
+
+bool
+SnicPowerOfTwoPolicy::NeedsAllCandidates() const
+{
+    return true;
+}
+
+uint32_t
+SnicPowerOfTwoPolicy::Select(const std::vector<Candidate>& candidates, uint64_t demand)
+{
+    NS_LOG_FUNCTION(this << candidates.size() << demand);
+    uint32_t n = candidates.size();
+    if (n == 1)
+    {
+        return 0;
+    }
+    uint32_t a = m_rng->GetInteger(0, n - 1);
+    // draw the second one among the n - 1 others
+    uint32_t b = m_rng->GetInteger(0, n - 2);
+    if (b >= a)
+    {
+        b++;
+    }
+    return candidates[b].load < candidates[a].load ? b : a;
+}
+
+int64_t
+SnicPowerOfTwoPolicy::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+    m_rng->SetStream(stream);
+    return 1;
+}
+
+TypeId
+SnicGreedyBatchPolicy::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::SnicGreedyBatchPolicy")
+                            .SetParent<SnicBestFitPolicy>()
+                            .SetGroupName("Snic")
+                            .AddConstructor<SnicGreedyBatchPolicy>();
+    return tid;
+}
+
+std::vector<uint32_t>
+SnicGreedyBatchPolicy::OrderBatch(const std::vector<uint64_t>& demands)
+{
+    std::vector<uint32_t> order = SnicPlacementPolicy::OrderBatch(demands);
+    std::stable_sort(order.begin(), order.end(), [&demands](uint32_t a, uint32_t b) {
+        return demands[a] > demands[b];
+    });
+    return order;
+}
+
+} // namespace ns3
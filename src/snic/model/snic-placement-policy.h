@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2023 UCSD WukLab, San Diego, USA
+ */
+
+#ifndef SNIC_PLACEMENT_POLICY_H
+#define SNIC_PLACEMENT_POLICY_H
+
+#include "ns3/object.h"
+#include "ns3/random-variable-stream.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup snic
+ * \brief Picks the path a flow gets among the ones that can carry it.
+ *
+ * The SnicScheduler hands the policy every cached candidate path of the
+ * (src,dst) pair that has enough bandwidth (and NT resources) left for the
+ * flow, cheapest first, and allocates the one the policy selects. For
+ * batched requests the policy also decides in which order the flows of the
+ * batch are scheduled.
+ *
+ * The base class is first-fit: the cheapest feasible path wins and the batch
+ * is scheduled in arrival order.
+ */
+class SnicPlacementPolicy : public Object
+{
+  public:
+    static TypeId GetTypeId();
+
+    SnicPlacementPolicy();
+    ~SnicPlacementPolicy() override;
+
+    /// a path able to carry the flow
+    struct Candidate
+    {
+        uint32_t index;      //!< index of the path in the scheduler's path cache
+        uint32_t hops;       //!< number of edges of the path
+        uint64_t bottleneck; //!< least bandwidth left on an edge of the path, in bit/s
+        double load;         //!< highest fraction of capacity in use on an edge of the path
+    };
+
+    /**
+     * \return true if Select() needs every feasible candidate, false if the
+     *         first feasible one is enough and the search can stop there
+     */
+    virtual bool NeedsAllCandidates() const;
+
+    /**
+     * \param candidates the feasible paths, cheapest first, never empty
+     * \param demand bandwidth of the flow in bit/s
+     * \return the position in candidates of the path to allocate
+     */
+    virtual uint32_t Select(const std::vector<Candidate>& candidates, uint64_t demand);
+
+    /**
+     * \param demands bandwidth of every flow of a batch in bit/s
+     * \return the positions in demands in the order the flows are scheduled
+     */
+    virtual std::vector<uint32_t> OrderBatch(const std::vector<uint64_t>& demands);
+};
+
+/**
+ * \ingroup snic
+ * \brief Take the path whose bottleneck is left with the least bandwidth.
+ */
+class SnicBestFitPolicy : public SnicPlacementPolicy
+{
+  public:
+    static TypeId GetTypeId();
+
+    bool NeedsAllCandidates() const override;
+    uint32_t Select(const std::vector<Candidate>& candidates, uint64_t demand) override;
+};
+
+/**
+ * \ingroup snic
+ * \brief Take the path whose busiest edge is the least loaded.
+ */
+class SnicLeastLoadedPolicy : public SnicPlacementPolicy
+{
+  public:
+    static TypeId GetTypeId();
+
+    bool NeedsAllCandidates() const override;
+    uint32_t Select(const std::vector<Candidate>& candidates, uint64_t demand) override;
+};
+
+/**
+ * \ingroup snic
+ * \brief Sample two candidates at random and take the least loaded one.
+ */
+class SnicPowerOfTwoPolicy : public SnicPlacementPolicy
+{
+  public:
+    static TypeId GetTypeId();
+
+    SnicPowerOfTwoPolicy();
+
+    bool NeedsAllCandidates() const override;
+    uint32_t Select(const std::vector<Candidate>& candidates, uint64_t demand) override;
+
+    /**
+     * \param stream first stream index to use
+     * \return the number of stream indices used
+     */
+    int64_t AssignStreams(int64_t stream);
+
+  private:
+    Ptr<UniformRandomVariable> m_rng;
+};
+
+/**
+ * \ingroup snic
+ * \brief Greedy batch optimizer.
+ *
+ * The flows of a batch are scheduled largest demand first, each one on the
+ * best fitting path, which packs a batch tighter than taking the flows in
+ * arrival order.
+ */
+class SnicGreedyBatchPolicy : public SnicBestFitPolicy
+{
+  public:
+    static TypeId GetTypeId();
+
+    std::vector<uint32_t> OrderBatch(const std::vector<uint64_t>& demands) override;
+};
+
+} // namespace ns3
+
+#endif // SNIC_PLACEMENT_POLICY_H
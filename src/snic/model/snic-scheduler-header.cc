@@ -8,6 +8,8 @@
 
 #include "ns3/address-utils.h"
 
+#include <algorithm>
+
 namespace ns3
 {
 
@@ -22,6 +24,8 @@ NS_OBJECT_ENSURE_REGISTERED(SnicSchedulerHeader);
 SnicSchedulerHeader::SnicSchedulerHeader()
     : m_bandwidthDemand(0),
       m_resourceDemand(0),
+      m_numNetworkTask(0),
+      m_nt(0),
       m_sourcePort(0xfffd),
       m_destinationPort(0xfffd),
       m_packetType(0),
@@ -39,6 +43,8 @@ SnicSchedulerHeader::SnicSchedulerHeader(Ipv4Address srcIp,
                                          uint64_t flowId)
     : m_bandwidthDemand(0),
       m_resourceDemand(0),
+      m_numNetworkTask(0),
+      m_nt(0),
       m_sourcePort(srcPort),
       m_destinationPort(dstPort),
       m_packetType(0),
@@ -55,6 +61,8 @@ SnicSchedulerHeader::SnicSchedulerHeader(Ipv4Address srcIp,
 SnicSchedulerHeader::SnicSchedulerHeader(Ipv4Header ipv4Header, SnicHeader snicHeader)
     : m_bandwidthDemand(0),
       m_resourceDemand(0),
+      m_numNetworkTask(0),
+      m_nt(0),
       m_sourcePort(snicHeader.GetSourcePort()),
       m_destinationPort(snicHeader.GetDestinationPort()),
       m_packetType(0),
@@ -84,6 +92,12 @@ SnicSchedulerHeader::GetBandwidthDemand() const
     return m_bandwidthDemand;
 }
 
+uint64_t
+SnicSchedulerHeader::GetBandwidthDemandBps() const
+{
+    return static_cast<uint64_t>(m_bandwidthDemand * 1e9 + 0.5);
+}
+
 void
 SnicSchedulerHeader::SetResourceDemand(uint32_t demand)
 {
@@ -117,7 +131,7 @@ SnicSchedulerHeader::AddNT(uint64_t nt)
 }
 
 uint64_t
-SnicSchedulerHeader::GetNT()
+SnicSchedulerHeader::GetNT() const
 {
     return m_nt;
 }
@@ -207,6 +221,61 @@ SnicSchedulerHeader::GetFlowId() const
     return m_flowId;
 }
 
+void
+SnicSchedulerHeader::AddFlow(const SnicSchedulerHeader& flow)
+{
+    NS_LOG_FUNCTION(this << flow.m_flowId);
+    NS_ASSERT_MSG(flow.m_flows.empty(), "can't batch a batch");
+    NS_ASSERT_MSG(m_flows.size() < 0xffff, "too many batched flows");
+    BatchedFlow batched;
+    batched.source = flow.m_source;
+    batched.destination = flow.m_destination;
+    batched.sourcePort = flow.m_sourcePort;
+    batched.destinationPort = flow.m_destinationPort;
+    batched.protocol = flow.m_protocol;
+    batched.flowId = flow.m_flowId;
+    batched.bandwidthDemand = flow.m_bandwidthDemand;
+    batched.nt = flow.m_nt;
+    m_flows.push_back(batched);
+}
+
+uint16_t
+SnicSchedulerHeader::GetNFlows() const
+{
+    return m_flows.size();
+}
+
+SnicSchedulerHeader
+SnicSchedulerHeader::GetFlow(uint16_t n) const
+{
+    NS_ASSERT_MSG(n < m_flows.size(), "no such batched flow");
+    const BatchedFlow& batched = m_flows[n];
+    SnicSchedulerHeader flow(batched.source,
+                             batched.sourcePort,
+                             batched.destination,
+                             batched.destinationPort,
+                             batched.protocol,
+                             batched.flowId);
+    flow.SetBandwidthDemand(batched.bandwidthDemand);
+    flow.AddNT(batched.nt);
+    flow.SetPacketType(m_packetType);
+    return flow;
+}
+
+void
+SnicSchedulerHeader::SetFlowRoute(uint16_t n, const SnicRoute& route)
+{
+    NS_ASSERT_MSG(n < m_flows.size(), "no such batched flow");
+    m_flows[n].route = route;
+}
+
+const SnicRoute&
+SnicSchedulerHeader::GetFlowRoute(uint16_t n) const
+{
+    NS_ASSERT_MSG(n < m_flows.size(), "no such batched flow");
+    return m_flows[n].route;
+}
+
 TypeId
 SnicSchedulerHeader::GetTypeId()
 {
@@ -227,6 +296,10 @@ void
 SnicSchedulerHeader::Print(std::ostream& os) const
 {
     os << "packetType: " << m_packetType;
+    if (!m_flows.empty())
+    {
+        os << " flows: " << m_flows.size();
+    }
 
     //<< " seenSnic: " << m_hasSeenNic << " snic_nt: " << m_nt
     //<< ", payload: " << m_payload << ", snic_length: " << m_payloadSize + GetSerializedSize()
@@ -236,7 +309,17 @@ SnicSchedulerHeader::Print(std::ostream& os) const
 uint32_t
 SnicSchedulerHeader::GetSerializedSize() const
 {
-    return 66;
+    if (m_flows.empty())
+    {
+        return FIXED_SIZE;
+    }
+    // the fixed fields take 39 bytes, the flow count and the flows follow them
+    uint32_t size = 39 + 2;
+    for (auto it = m_flows.begin(); it != m_flows.end(); ++it)
+    {
+        size += 32 + it->route.GetN() * SnicRte().GetSerializedSize();
+    }
+    return std::max(size, FIXED_SIZE);
 }
 
 void
@@ -259,6 +342,25 @@ SnicSchedulerHeader::Serialize(Buffer::Iterator start) const
     i.WriteHtonU32(m_destination.Get());
     i.WriteU8(m_protocol);
     i.WriteHtonU64(m_flowId);
+
+    i.WriteHtonU16(m_flows.size());
+    for (auto it = m_flows.begin(); it != m_flows.end(); ++it)
+    {
+        i.WriteHtonU32(it->source.Get());
+        i.WriteHtonU32(it->destination.Get());
+        i.WriteHtonU16(it->sourcePort);
+        i.WriteHtonU16(it->destinationPort);
+        i.WriteU8(it->protocol);
+        i.WriteHtonU64(it->flowId);
+        i.Write((const uint8_t*)&it->bandwidthDemand, 8);
+        i.WriteHtonU16(it->nt);
+        i.WriteU8(it->route.GetN());
+        for (uint8_t n = 0; n < it->route.GetN(); ++n)
+        {
+            it->route.Get(n).Serialize(i);
+            i.Next(it->route.Get(n).GetSerializedSize());
+        }
+    }
 }
 
 uint32_t
@@ -282,7 +384,39 @@ SnicSchedulerHeader::Deserialize(Buffer::Iterator start)
     m_protocol = i.ReadU8();            //!< Protocol number
     m_flowId = i.ReadNtohU64();
 
-    return GetSerializedSize();
+    m_flows.clear();
+    uint16_t nFlows = i.ReadNtohU16();
+    for (uint16_t f = 0; f < nFlows; ++f)
+    {
+        BatchedFlow batched;
+        batched.source.Set(i.ReadNtohU32());
+        batched.destination.Set(i.ReadNtohU32());
+        batched.sourcePort = i.ReadNtohU16();
+        batched.destinationPort = i.ReadNtohU16();
+        batched.protocol = i.ReadU8();
+        batched.flowId = i.ReadNtohU64();
+        i.Read((uint8_t*)&batched.bandwidthDemand, 8);
+        batched.nt = i.ReadNtohU16();
+        uint8_t nRtes = i.ReadU8();
+        if (nRtes > SnicRoute::MAX_HOPS)
+        {
+            // malformed: the flow is left without a route, i.e. not offloaded
+            NS_LOG_WARN("flow " << batched.flowId << " claims " << +nRtes
+                                << " rtes, dropping them");
+            i.Next(nRtes * SnicRte().GetSerializedSize());
+            nRtes = 0;
+        }
+        for (uint8_t n = 0; n < nRtes; ++n)
+        {
+            SnicRte rte;
+            i.Next(rte.Deserialize(i));
+            batched.route.Add(rte);
+        }
+        m_flows.push_back(batched);
+    }
+
+    // a malformed route took more bytes than GetSerializedSize() counts
+    return std::max(i.GetDistanceFrom(start), FIXED_SIZE);
 }
 
 } // namespace ns3
@@ -13,6 +13,7 @@
 
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 namespace ns3
 {
@@ -32,6 +33,10 @@ class SnicSchedulerHeader : public Header
 
     void SetBandwidthDemand(double demand);
     double GetBandwidthDemand() const;
+    /**
+     * \return the bandwidth demand, given in Gbps, converted to bit/s
+     */
+    uint64_t GetBandwidthDemandBps() const;
 
     void SetResourceDemand(uint32_t demand);
     uint32_t GetResourceDemand() const;
@@ -42,7 +47,7 @@ class SnicSchedulerHeader : public Header
     void AddNT(uint64_t nt);
 
     /* returns 0 if no NT */
-    uint64_t GetNT();
+    uint64_t GetNT() const;
 
     uint16_t GetPacketType() const;
     void SetPacketType(uint16_t packetType);
@@ -74,6 +79,35 @@ class SnicSchedulerHeader : public Header
     void SetFlowId(uint64_t flowId);
     uint64_t GetFlowId() const;
 
+    /**
+     * \brief Append a flow to a batched request, response or release.
+     * \param flow a single flow header; its 5-tuple, flow id and bandwidth
+     *        demand are carried
+     *
+     * A header with batched flows stands for all of them, its own 5-tuple
+     * and flow id are meaningless.
+     */
+    void AddFlow(const SnicSchedulerHeader& flow);
+    /**
+     * \return the number of batched flows, 0 for a single flow header
+     */
+    uint16_t GetNFlows() const;
+    /**
+     * \param n index of the batched flow
+     * \return a single flow header for it, with the packet type of the batch
+     */
+    SnicSchedulerHeader GetFlow(uint16_t n) const;
+    /**
+     * \param n index of the batched flow
+     * \param route the route allocated to it
+     */
+    void SetFlowRoute(uint16_t n, const SnicRoute& route);
+    /**
+     * \param n index of the batched flow
+     * \return the route allocated to it, empty in requests
+     */
+    const SnicRoute& GetFlowRoute(uint16_t n) const;
+
     /**
      * \brief Get the type ID.
      * \return the object TypeId
@@ -93,10 +127,28 @@ class SnicSchedulerHeader : public Header
         ALLOCATION_RELEASE = 3,
         NT_CONFIG_BEGIN,
         NT_CONFIG_COMFIRM,
-        NT_CONFIG_DONE
+        NT_CONFIG_DONE,
+        ALLOCATION_REJECT
     };
 
   private:
+    /// one flow of a batch
+    struct BatchedFlow
+    {
+        Ipv4Address source;
+        Ipv4Address destination;
+        uint16_t sourcePort;
+        uint16_t destinationPort;
+        uint8_t protocol;
+        uint64_t flowId;
+        double bandwidthDemand;
+        uint16_t nt;
+        SnicRoute route;
+    };
+
+    /// size of the single flow part of the header
+    static constexpr uint32_t FIXED_SIZE = 66;
+
     // bool m_isOffloaded;
     /**
      * \brief Calculate the header checksum
@@ -119,6 +171,8 @@ class SnicSchedulerHeader : public Header
 
     // uint32_t m_nt;
     uint32_t m_ntId;
+
+    std::vector<BatchedFlow> m_flows;
 };
 
 } // namespace ns3
@@ -6,9 +6,12 @@
 #include "ns3/csma-module.h"
 #include "ns3/loopback-net-device.h"
 #include "ns3/node-list.h"
+#include "ns3/pointer.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/uinteger.h"
 
-#include <queue>
-#include <stack>
+#include <algorithm>
+#include <chrono>
 
 namespace ns3
 {
@@ -20,17 +23,71 @@ NS_OBJECT_ENSURE_REGISTERED(SnicScheduler);
 TypeId
 SnicScheduler::GetTypeId()
 {
-    static TypeId tid = TypeId("ns3::SnicScheduler").SetParent<Object>().SetGroupName("Snic");
-    //.AddAttribute("WaitReplyTimeout",
+    static TypeId tid =
+        TypeId("ns3::SnicScheduler")
+            .SetParent<Object>()
+            .SetGroupName("Snic")
+            .AddConstructor<SnicScheduler>()
+            .AddAttribute("MaxPaths",
+                          "Maximum number of candidate paths kept for each pair of sNICs.",
+                          UintegerValue(8),
+                          MakeUintegerAccessor(&SnicScheduler::SetMaxPaths,
+                                               &SnicScheduler::GetMaxPaths),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("PlacementPolicy",
+                          "Picks the path of a flow among the candidates able to carry it.",
+                          PointerValue(),
+                          MakePointerAccessor(&SnicScheduler::m_policy),
+                          MakePointerChecker<SnicPlacementPolicy>())
+            .AddTraceSource("ScheduleDecision",
+                            "Wall clock time a flow took to schedule, with the candidate "
+                            "paths and the edges examined and whether it was allocated.",
+                            MakeTraceSourceAccessor(&SnicScheduler::m_scheduleTrace),
+                            "ns3::SnicScheduler::ScheduleTracedCallback")
+            .AddTraceSource("ReleaseDecision",
+                            "Wall clock time a flow took to release, with the number of "
+                            "edges it held.",
+                            MakeTraceSourceAccessor(&SnicScheduler::m_releaseTrace),
+                            "ns3::SnicScheduler::ReleaseTracedCallback")
+            .AddTraceSource("ActiveFlows",
+                            "Number of flows holding an allocation",
+                            MakeTraceSourceAccessor(&SnicScheduler::m_activeFlows),
+                            "ns3::TracedValueCallback::Uint32");
     return tid;
 }
 
+/// \return the steady clock in nanoseconds
+static uint64_t
+GetWallClock()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
 SnicScheduler::SnicScheduler()
     : m_device(nullptr),
       m_initialized(false),
-      m_allocationCount(0)
+      m_allocationCount(0),
+      m_shard(0),
+      m_nLocalAllocations(0),
+      m_nCrossShardAllocations(0),
+      m_nSchedules(0),
+      m_nAdmitted(0),
+      m_scheduleTime(0),
+      m_maxScheduleTime(0),
+      m_nReleases(0),
+      m_releaseTime(0),
+      m_maxReleaseTime(0),
+      m_nPathsExamined(0),
+      m_nEdgesChecked(0),
+      m_decisionPaths(0),
+      m_decisionEdges(0),
+      m_activeFlows(0)
 {
     NS_LOG_FUNCTION(this);
+    m_pathEngine.SetRemainingBandwidth(&m_edgeRemaining);
+    m_policy = CreateObject<SnicPlacementPolicy>();
 }
 
 SnicScheduler::~SnicScheduler()
@@ -38,11 +95,42 @@ SnicScheduler::~SnicScheduler()
     NS_LOG_FUNCTION(this);
 }
 
+void
+SnicScheduler::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_pathEngine.Clear();
+    for (auto it = m_edges.begin(); it != m_edges.end(); ++it)
+    {
+        delete *it;
+    }
+    for (auto it = m_vertices.begin(); it != m_vertices.end(); ++it)
+    {
+        delete *it;
+    }
+    m_edges.clear();
+    m_edgeCapacity.clear();
+    m_edgeRemaining.clear();
+    m_resourceAllocated.clear();
+    m_snicResources.clear();
+    m_vertices.clear();
+    m_nicVertices.clear();
+    m_hostVertices.clear();
+    m_addedNodes.clear();
+    m_ipToVertex.clear();
+    m_installedNts.clear();
+    m_shards.clear();
+    m_policy = nullptr;
+    m_device = nullptr;
+    Object::DoDispose();
+}
+
 void
 SnicScheduler::AddNode(Ptr<Node> node)
 {
     NS_LOG_FUNCTION(this << node);
-    if (m_addedNodes.count(node) == 1)
+    uint32_t nodeId = node->GetId();
+    if (nodeId < m_addedNodes.size() && m_addedNodes[nodeId])
     {
         NS_LOG_DEBUG("SKIPPING SEEARCHED NODE");
         return;
@@ -50,8 +138,13 @@ SnicScheduler::AddNode(Ptr<Node> node)
     // We need to create a new vertex if we have not processed this node yet
     SVertex* v = new SVertex();
     v->SetNode(node);
+    v->SetVertexIndex(m_vertices.size());
     m_vertices.push_back(v);
-    m_addedNodes[node] = v;
+    if (nodeId >= m_addedNodes.size())
+    {
+        m_addedNodes.resize(nodeId + 1, nullptr);
+    }
+    m_addedNodes[nodeId] = v;
 
     Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
     Ipv4Address ip;
@@ -128,7 +221,7 @@ SnicScheduler::AddNode(Ptr<Node> node)
                 Ptr<Node> nextNode = d->GetNode();
                 NS_LOG_DEBUG("\t\t csma node: " << nextNode);
                 AddNode(nextNode);
-                SVertex* nextVertex = m_addedNodes[nextNode];
+                SVertex* nextVertex = m_addedNodes[nextNode->GetId()];
 
                 SEdge* forwardEdge = new SEdge();
                 // SEdge* backwardEdge = new SEdge();
@@ -138,14 +231,28 @@ SnicScheduler::AddNode(Ptr<Node> node)
                 NS_LOG_DEBUG("dev=" << dev);
                 NS_LOG_DEBUG("d=" << d);
                 if (isSnicNode)
+                {
                     forwardEdge->SetLDevice(snicDev);
+                    for (uint32_t p = 0; p < snicDev->GetNSnicPorts(); ++p)
+                    {
+                        if (snicDev->GetSnicPort(p) == dev)
+                        {
+                            forwardEdge->SetLPort(p);
+                        }
+                    }
+                }
                 else
+                {
                     forwardEdge->SetLDevice(0);
+                }
                 // forwardEdge->Set
                 forwardEdge->SetRDevice(dev);
                 NS_LOG_DEBUG("sched: dev= " << d);
                 // backwardEdge->SetVertices(nextVertex, v);
+                forwardEdge->SetEdgeId(m_edges.size());
                 m_edges.push_back(forwardEdge);
+                m_edgeCapacity.push_back(forwardEdge->GetCapacity());
+                m_edgeRemaining.push_back(forwardEdge->GetCapacity());
                 // m_edges.push_back(backwardEdge);
                 v->AddEdge(forwardEdge, nextVertex);
                 // nextVertex->AddEdge(backwardEdge, v);
@@ -155,36 +262,11 @@ SnicScheduler::AddNode(Ptr<Node> node)
             // see if we are attached to other csma netdevs
         }
     }
-}
-
-void
-SnicScheduler::PopulateStaticRoutes()
-{
-    NS_LOG_FUNCTION_NOARGS();
 
-    // for (ListOfSVertex_t::iterator s_it = m_nicVertices.begin(); s_it != m_nicVertices.end();
-    //++s_it)
-    for (uint32_t srcIdx = 0; srcIdx < m_nicVertices.size(); srcIdx++)
+    // the vertex id is final once all of its devices are processed
+    if (v->GetVertexId() != Ipv4Address::GetBroadcast())
     {
-        SVertex* src = m_nicVertices[srcIdx];
-        if (m_allPaths.count(src) == 0)
-            m_allPaths[src] = std::map<SVertex*, std::vector<Path_t>>();
-        // for (ListOfSVertex_t::iterator d_it = m_nicVertices.begin(); d_it != m_nicVertices.end();
-        //++d_it)
-        for (uint32_t dstIdx = srcIdx; dstIdx < m_nicVertices.size(); dstIdx++)
-        {
-            // if ((*d_it)->GetVertexType() == SVertex::VertexTypeHost)
-            // continue;
-            if (srcIdx != dstIdx)
-            {
-                SVertex* dst = m_nicVertices[dstIdx];
-                NS_LOG_DEBUG("find routes between: ");
-                NS_LOG_DEBUG(*src);
-                NS_LOG_DEBUG(*dst);
-                // XXX
-                DepthFirstTraversal(src, dst, 10);
-            }
-        }
+        m_ipToVertex[v->GetVertexId()] = v;
     }
 }
 
@@ -197,7 +279,7 @@ SnicScheduler::Initialize()
 
     AddNode(*NodeList::Begin());
 
-    NS_LOG_DEBUG("m_addedNodes size: " << m_addedNodes.size());
+    NS_LOG_DEBUG("m_vertices size: " << m_vertices.size());
 
     // get all nodes
     int c = 0;
@@ -236,47 +318,63 @@ SnicScheduler::Initialize()
     // NS_ASSERT_MSG(m_vertices.size() == NodeList::GetNNodes(), "didnt get all the nodes");
 
     // NS_FATAL_ERROR("done init");
-    PopulateStaticRoutes();
+    // paths between sNICs are computed on the first request for each pair
 
     InitializeResources();
+
+    // shards look at the resources and edges of each other
+    for (auto it = m_shards.begin(); it != m_shards.end(); ++it)
+    {
+        if (!(*it)->m_initialized)
+        {
+            (*it)->Initialize();
+        }
+    }
 }
 
 void
 SnicScheduler::InitializeResources()
 {
     NS_LOG_FUNCTION_NOARGS();
-    m_resourceRemaining[FPGA] = 100;
-    m_resourceRemaining[INGRESS] = 100;
-    m_resourceRemaining[EGRESS] = 100;
-    m_resourceRemaining[MEMORY] = 100;
-
-    m_resourceConsumed[FPGA] = 0;
-    m_resourceConsumed[INGRESS] = 0;
-    m_resourceConsumed[EGRESS] = 0;
-    m_resourceConsumed[MEMORY] = 0;
+    m_snicResources.resize(m_vertices.size());
+    for (auto it = m_nicVertices.begin(); it != m_nicVertices.end(); ++it)
+    {
+        SnicResources& resources = m_snicResources[(*it)->GetVertexIndex()];
+        Ptr<Node> node = (*it)->GetNode();
+        for (uint32_t idx = 0; idx < node->GetNDevices() && !resources.snic; ++idx)
+        {
+            resources.snic = DynamicCast<SnicNetDevice>(node->GetDevice(idx));
+        }
+        NS_ASSERT_MSG(resources.snic, "sNIC vertex without an sNIC");
+        resources.capacity[FPGA] = resources.snic->GetFpgaCapacity();
+        resources.capacity[INGRESS] = resources.snic->GetIngressCapacity().GetBitRate();
+        resources.capacity[EGRESS] = resources.snic->GetEgressCapacity().GetBitRate();
+        resources.capacity[MEMORY] = resources.snic->GetMemoryCapacity();
+        for (uint32_t r = 0; r < RESOURCE_COUNT; ++r)
+        {
+            resources.remaining[r] = resources.capacity[r];
+        }
+        std::vector<uint32_t> nts = resources.snic->GetNTIds();
+        m_installedNts.insert(nts.begin(), nts.end());
+    }
 }
 
 SVertex*
 SnicScheduler::GetVertexFromIp(const Ipv4Address& ip) const
 {
-    NS_LOG_FUNCTION(this);
-    SVertex* res = nullptr;
-    for (ListOfSVertex_t::const_iterator it = m_vertices.begin(); it != m_vertices.end(); ++it)
+    NS_LOG_FUNCTION(this << ip);
+    auto it = m_ipToVertex.find(ip);
+    if (it == m_ipToVertex.end())
     {
-        SVertex* v = *it;
-        if (v->GetVertexId() == ip)
-        {
-            res = v;
-        }
+        return nullptr;
     }
-
-    return res;
+    return it->second;
 }
 
 bool
-SnicScheduler::PathIsValid(const SnicSchedulerHeader& header, Path_t path) const
+SnicScheduler::PathIsValid(uint64_t demand, const Path_t& path) const
 {
-    NS_LOG_FUNCTION(this);
+    NS_LOG_FUNCTION(this << demand);
     // typedef SVertex*
     NS_ASSERT_MSG(path.size() > 1, "path is too short");
 
@@ -285,13 +383,8 @@ SnicScheduler::PathIsValid(const SnicSchedulerHeader& header, Path_t path) const
         SVertex* v = path[i];
         // if (i + 1
         SEdge* nextEdge = v->GetEdgeTo(path[i + 1]);
-        double d = header.GetBandwidthDemand();
-        // NS_LOG_DEBUG("D: " << d);
-        DataRate demand = DataRate(std::to_string(d) + "Gbps");
-        NS_LOG_DEBUG(demand);
-        NS_LOG_DEBUG(nextEdge->GetRemainingBandwidth());
-        // if (nextEdge->GetRemainingBandwidth() >= DataRate(std::to_string(d) + "Gbps"))
-        if (nextEdge->GetRemainingBandwidth() < demand)
+        m_decisionEdges++;
+        if (GetEdgeRemaining(nextEdge->GetEdgeId()) < demand)
         {
             NS_LOG_DEBUG("edge out: " << nextEdge);
             return false;
@@ -302,10 +395,47 @@ SnicScheduler::PathIsValid(const SnicSchedulerHeader& header, Path_t path) const
     return true;
 }
 
+SnicPlacementPolicy::Candidate
+SnicScheduler::DescribePath(uint32_t index, const Path_t& path) const
+{
+    SnicPlacementPolicy::Candidate candidate;
+    candidate.index = index;
+    candidate.hops = path.size() - 1;
+    candidate.bottleneck = UINT64_MAX;
+    candidate.load = 0;
+    for (uint32_t i = 0; i + 1 < path.size(); ++i)
+    {
+        uint32_t edgeId = path[i]->GetEdgeTo(path[i + 1])->GetEdgeId();
+        uint64_t remaining = GetEdgeRemaining(edgeId);
+        candidate.bottleneck = std::min(candidate.bottleneck, remaining);
+        if (m_edgeCapacity[edgeId] > 0)
+        {
+            double load = 1 - (double)remaining / m_edgeCapacity[edgeId];
+            candidate.load = std::max(candidate.load, load);
+        }
+    }
+    return candidate;
+}
+
 void
-SnicScheduler::AllocatePath(SnicHeader& snicHeader, SnicSchedulerHeader& schedHeader, Path_t path)
+SnicScheduler::AllocatePath(SnicHeader& snicHeader,
+                            SnicSchedulerHeader& schedHeader,
+                            uint64_t demand,
+                            const Path_t& path,
+                            int32_t placement)
 {
-    NS_LOG_FUNCTION(this);
+    NS_LOG_FUNCTION(this << demand << placement);
+    NS_ASSERT_MSG(path.size() <= SnicRoute::MAX_HOPS + 1u, "path does not fit in a route");
+    std::vector<SEdge*> allocated;
+    FlowAllocation& allocation = m_resourceAllocated[FlowId(schedHeader)];
+    allocation.bps = demand;
+    allocation.path.clear();
+    allocation.nt = schedHeader.GetNT();
+    allocation.placement = placement;
+    if (placement >= 0)
+    {
+        Place(allocation.nt, demand, placement);
+    }
 
     for (uint32_t i = 0; i < path.size() - 1; ++i)
     {
@@ -313,137 +443,323 @@ SnicScheduler::AllocatePath(SnicHeader& snicHeader, SnicSchedulerHeader& schedHe
         SVertex* nextVertex = path[i + 1];
         // if (i + 1
         SEdge* nextEdge = v->GetEdgeTo(nextVertex);
-        double d = schedHeader.GetBandwidthDemand();
-        DataRate demand = DataRate(std::to_string(d) + "Gbps");
-        NS_LOG_DEBUG(demand);
-        FlowId flowId(schedHeader);
-        // m_allPaths\c
-        m_resourceAllocated[flowId][INGRESS] = d;
-        m_resourceAllocated[flowId][EGRESS] = d;
+        uint32_t edgeId = nextEdge->GetEdgeId();
         // Allocate(flowId, path, demand);
-        nextEdge->AssignBandwidth(demand);
-        NS_LOG_DEBUG("allocating edge: " << nextEdge << " " << nextEdge->GetRemainingBandwidth());
+        ReserveEdge(edgeId, demand);
+        allocation.path.push_back(edgeId);
+        allocated.push_back(nextEdge);
+        NS_LOG_DEBUG("allocating edge: " << nextEdge << " " << GetEdgeRemaining(edgeId));
         // NS_LOG_DEBUG("D: " << d);
         // NS_LOG_DEBUG(nextEdge->GetRemainingBandwidth());
 
         SnicRte rte;
         rte.SetNextHop(nextVertex->GetVertexId());
-        rte.SetInterfaceNum(nextEdge->GetRInterfaceNum());
-        // NS_LOG_DEBUG("rte l: " << nextEdge->GetLDevice());
-        // NS_LOG_DEBUG("rte r: " << nextEdge->GetRDevice());
-        rte.SetLDevice(nextEdge->GetLDevice());
-        rte.SetRDevice(nextEdge->GetRDevice());
-        rte.SetVertices((uint64_t)nextEdge->GetLVertex(), (uint64_t)nextEdge->GetRVertex());
-        // rte.SetRDevice(nextEdge->GetRDevice());
-        //  rte.SetEdge(nextEdge);
+        rte.SetPort(nextEdge->GetLPort());
+        rte.SetVertices(v->GetVertexIndex(), nextVertex->GetVertexIndex());
         snicHeader.AddRte(rte);
-        // if (nextEdge->GetRemainingBandwidth() >= DataRate(std::to_string(d) + "Gbps"))
-        // check demand
     }
+
+    // path may point into the path cache, only touch the cache once we are done with it
+    bool crossShard = false;
+    for (auto it = allocated.begin(); it != allocated.end(); ++it)
+    {
+        crossShard |= UpdateEdge((*it)->GetEdgeId());
+    }
+    if (crossShard)
+    {
+        m_nCrossShardAllocations++;
+    }
+    else
+    {
+        m_nLocalAllocations++;
+    }
+    m_activeFlows = m_resourceAllocated.size();
 }
 
-std::vector<SVertex*>
-SnicScheduler::GetPathFromHeader(SnicHeader& snicHeader) const
+bool
+SnicScheduler::NeedsPlacement(uint32_t nt) const
 {
-    NS_LOG_FUNCTION(this);
+    return nt != 0 && m_installedNts.count(nt) > 0;
+}
+
+bool
+SnicScheduler::FindPlacement(uint32_t nt,
+                             uint64_t demand,
+                             const Path_t& path,
+                             int32_t& placement) const
+{
+    NS_LOG_FUNCTION(this << nt << demand);
+    placement = -1;
+    bool bestShared = false;
+    double bestScore = 0;
+    for (auto it = path.begin(); it != path.end(); ++it)
+    {
+        uint32_t index = (*it)->GetVertexIndex();
+        const SnicResources& resources = GetResources(index);
+        if (!resources.snic || resources.remaining[INGRESS] < demand ||
+            resources.remaining[EGRESS] < demand)
+        {
+            continue;
+        }
+        Ptr<NetworkTask> task = resources.snic->GetNT(nt);
+        if (!task)
+        {
+            continue;
+        }
 
-    auto rteList = snicHeader.GetRteList();
-    NS_LOG_DEBUG(rteList.size());
-    std::vector<SVertex*> path;
+        double need[RESOURCE_COUNT] = {0, (double)demand, (double)demand, 0};
+        bool shared;
+        auto instance = resources.instances.find(nt);
+        if (instance != resources.instances.end())
+        {
+            // one instance per NT and sNIC, the flow has to fit in it
+            if (instance->second.ingressRemaining < demand ||
+                instance->second.egressRemaining < demand)
+            {
+                continue;
+            }
+            shared = true;
+        }
+        else
+        {
+            need[FPGA] = task->GetFpgaFabric();
+            need[MEMORY] = task->GetMemoryRequirement();
+            if (resources.remaining[FPGA] < need[FPGA] ||
+                resources.remaining[MEMORY] < need[MEMORY] ||
+                task->GetIngressRate().GetBitRate() < demand ||
+                task->GetEgressRate().GetBitRate() < demand)
+            {
+                continue;
+            }
+            shared = false;
+        }
+
+        double score = 0;
+        for (uint32_t r = 0; r < RESOURCE_COUNT; ++r)
+        {
+            if (resources.capacity[r] > 0)
+            {
+                score += (resources.remaining[r] - need[r]) / resources.capacity[r];
+            }
+        }
+        NS_LOG_DEBUG("vertex " << index << " shared=" << shared << " score=" << score);
+        if (placement < 0 || (shared && !bestShared) ||
+            (shared == bestShared && score < bestScore))
+        {
+            placement = index;
+            bestShared = shared;
+            bestScore = score;
+        }
+    }
+    return placement >= 0;
+}
 
-    for (auto iter = rteList.begin(); iter != rteList.end(); ++iter)
+SnicScheduler::SnicResources&
+SnicScheduler::GetResources(uint32_t vertexIndex) const
+{
+    SnicScheduler* owner = const_cast<SnicScheduler*>(this);
+    if (!m_shards.empty())
     {
-        SVertex* v = (SVertex*)(*iter).GetLVertex();
-        path.push_back(v);
+        owner = PeekPointer(m_shards[GetVertexShard(vertexIndex)]);
     }
-    return path;
+    NS_ASSERT_MSG(owner->m_initialized, "shard not initialized");
+    NS_ASSERT_MSG(vertexIndex < owner->m_snicResources.size(), "no such vertex");
+    return owner->m_snicResources[vertexIndex];
 }
 
-void
-SnicScheduler::SetDevice(Ptr<NetDevice> device)
+uint32_t
+SnicScheduler::GetVertexShard(uint32_t vertexIndex) const
 {
-    NS_LOG_FUNCTION(this << device);
-    m_device = device;
+    uint32_t nodeId = m_vertices[vertexIndex]->GetNode()->GetId();
+    return nodeId < m_nodeShard.size() ? m_nodeShard[nodeId] : m_shard;
 }
 
-Ptr<NetDevice>
-SnicScheduler::GetDevice() const
+void
+SnicScheduler::Place(uint32_t nt, uint64_t demand, uint32_t vertexIndex)
 {
-    NS_LOG_FUNCTION(this);
-    return m_device;
+    NS_LOG_FUNCTION(this << nt << demand << vertexIndex);
+    SnicResources& resources = GetResources(vertexIndex);
+    auto instance = resources.instances.find(nt);
+    if (instance == resources.instances.end())
+    {
+        Ptr<NetworkTask> task = resources.snic->GetNT(nt);
+        NS_ASSERT_MSG(task, "NT not installed on the sNIC");
+        NtInstance placed;
+        placed.fpga = task->GetFpgaFabric();
+        placed.memory = task->GetMemoryRequirement();
+        placed.ingressRemaining = task->GetIngressRate().GetBitRate();
+        placed.egressRemaining = task->GetEgressRate().GetBitRate();
+        resources.remaining[FPGA] -= placed.fpga;
+        resources.remaining[MEMORY] -= placed.memory;
+        instance = resources.instances.insert(std::make_pair(nt, placed)).first;
+        NS_LOG_DEBUG("placed NT " << nt << " on vertex " << vertexIndex);
+    }
+    NS_ASSERT(instance->second.ingressRemaining >= demand);
+    NS_ASSERT(instance->second.egressRemaining >= demand);
+    instance->second.nFlows++;
+    instance->second.ingressRemaining -= demand;
+    instance->second.egressRemaining -= demand;
+    resources.remaining[INGRESS] -= demand;
+    resources.remaining[EGRESS] -= demand;
 }
 
 void
-SnicScheduler::DepthFirstTraversal(SVertex* src, SVertex* dst, uint32_t limit)
+SnicScheduler::Unplace(uint32_t nt, uint64_t demand, uint32_t vertexIndex)
 {
-    NS_LOG_FUNCTION(this << src << dst << limit);
+    NS_LOG_FUNCTION(this << nt << demand << vertexIndex);
+    SnicResources& resources = GetResources(vertexIndex);
+    auto instance = resources.instances.find(nt);
+    NS_ASSERT_MSG(instance != resources.instances.end(), "NT was not placed");
+    resources.remaining[INGRESS] += demand;
+    resources.remaining[EGRESS] += demand;
+    instance->second.ingressRemaining += demand;
+    instance->second.egressRemaining += demand;
+    if (--instance->second.nFlows == 0)
+    {
+        NS_LOG_DEBUG("removing NT " << nt << " from vertex " << vertexIndex);
+        resources.remaining[FPGA] += instance->second.fpga;
+        resources.remaining[MEMORY] += instance->second.memory;
+        resources.instances.erase(instance);
+    }
+}
 
-    std::map<SVertex*, int> visited;
-    SVertex* root = src;
+double
+SnicScheduler::GetRemainingResource(Ptr<Node> node, ResourceType resource) const
+{
+    NS_ASSERT_MSG(m_initialized, "scheduler not initialized");
+    NS_ASSERT_MSG(resource < RESOURCE_COUNT, "no such resource");
+    uint32_t nodeId = node->GetId();
+    NS_ASSERT_MSG(nodeId < m_addedNodes.size() && m_addedNodes[nodeId], "unknown node");
+    return GetResources(m_addedNodes[nodeId]->GetVertexIndex()).remaining[resource];
+}
 
-    NS_ASSERT(src->GetVertexType() == SVertex::VertexTypeNic);
-    NS_ASSERT(dst->GetVertexType() == SVertex::VertexTypeNic);
+Ptr<Node>
+SnicScheduler::GetPlacement(const FlowId& flowId) const
+{
+    auto it = m_resourceAllocated.find(flowId);
+    if (it == m_resourceAllocated.end() || it->second.placement < 0)
+    {
+        return nullptr;
+    }
+    return m_vertices[it->second.placement]->GetNode();
+}
 
-    // std::vector<Path_t>& paths = allPaths[src][dst];
-    typedef std::pair<SVertex*, std::vector<SVertex*>> s_t;
+void
+SnicScheduler::SetShards(uint32_t shard,
+                         const std::vector<Ptr<SnicScheduler>>& shards,
+                         const std::vector<uint32_t>& nodeShard)
+{
+    NS_LOG_FUNCTION(this << shard << shards.size());
+    NS_ASSERT_MSG(shard < shards.size(), "no such shard");
+    NS_ASSERT_MSG(PeekPointer(shards[shard]) == this, "shard is not this scheduler");
+    m_shard = shard;
+    m_shards = shards;
+    m_nodeShard = nodeShard;
+}
 
-    std::stack<s_t> s;
+uint32_t
+SnicScheduler::GetShard() const
+{
+    return m_shard;
+}
 
-    // visited[root] = 1;
-    std::vector<SVertex*> t;
-    t.push_back(root);
-    s.push(std::make_pair(root, t));
-    // int length = 0;
-    //  Path_t path;
+uint64_t
+SnicScheduler::GetNLocalAllocations() const
+{
+    return m_nLocalAllocations;
+}
 
-    // path.push(root);
+uint64_t
+SnicScheduler::GetNCrossShardAllocations() const
+{
+    return m_nCrossShardAllocations;
+}
 
-    while (!s.empty())
+SnicScheduler*
+SnicScheduler::GetEdgeOwner(uint32_t edgeId) const
+{
+    if (m_shards.empty())
     {
-        SVertex* v = s.top().first;
-        std::vector<SVertex*> p = s.top().second;
+        return const_cast<SnicScheduler*>(this);
+    }
+    uint32_t nodeId = m_edges[edgeId]->GetLVertex()->GetNode()->GetId();
+    uint32_t shard = nodeId < m_nodeShard.size() ? m_nodeShard[nodeId] : m_shard;
+    SnicScheduler* owner = PeekPointer(m_shards[shard]);
+    NS_ASSERT_MSG(owner->m_initialized, "shard not initialized");
+    // every shard walks the same node list, so edge ids agree
+    NS_ASSERT_MSG(owner->m_edges.size() == m_edges.size(), "shards disagree on the topology");
+    return owner;
+}
 
-        s.pop();
-        if (v == dst)
-        {
-            NS_LOG_DEBUG("found");
-            for (uint32_t i = 0; i < p.size(); ++i)
-            {
-                NS_LOG_DEBUG(*p[i]);
-            }
-            auto reverse_path = p;
-            std::reverse(reverse_path.begin(), reverse_path.end());
+uint64_t
+SnicScheduler::GetEdgeRemaining(uint32_t edgeId) const
+{
+    return GetEdgeOwner(edgeId)->m_edgeRemaining[edgeId];
+}
 
-            m_allPaths[dst][src].push_back(reverse_path);
-            m_allPaths[src][dst].push_back(p);
-            // NS_LOG_DEBUG("done with printing");
-            // return;
-            continue;
-        }
-        if (visited.count(v) == 1)
-        {
-            continue;
-        }
-        visited[v] = 1;
+void
+SnicScheduler::ReserveEdge(uint32_t edgeId, uint64_t bps)
+{
+    SnicScheduler* owner = GetEdgeOwner(edgeId);
+    NS_ASSERT(owner->m_edgeRemaining[edgeId] >= bps);
+    owner->m_edgeRemaining[edgeId] -= bps;
+    if (owner != this)
+    {
+        owner->m_pathEngine.NotifyEdgeChanged(owner->m_edges[edgeId]);
+    }
+}
 
-        // NS_LOG_DEBUG("finding neighbors for: " << *v);
-        for (SVertex::ListOfSVertex_t::iterator it = v->m_vertices.begin();
-             it != v->m_vertices.end();
-             ++it)
+void
+SnicScheduler::FreeEdge(uint32_t edgeId, uint64_t bps)
+{
+    SnicScheduler* owner = GetEdgeOwner(edgeId);
+    owner->m_edgeRemaining[edgeId] += bps;
+    NS_ASSERT(owner->m_edgeRemaining[edgeId] <= owner->m_edgeCapacity[edgeId]);
+    if (owner != this)
+    {
+        owner->m_pathEngine.NotifyEdgeChanged(owner->m_edges[edgeId]);
+    }
+}
+
+bool
+SnicScheduler::UpdateEdge(uint32_t edgeId)
+{
+    SnicScheduler* owner = GetEdgeOwner(edgeId);
+    m_edgeRemaining[edgeId] = owner->m_edgeRemaining[edgeId];
+    m_pathEngine.NotifyEdgeChanged(m_edges[edgeId]);
+    return owner != this;
+}
+
+void
+SnicScheduler::SyncForeignEdges()
+{
+    if (m_shards.empty())
+    {
+        return;
+    }
+    for (uint32_t e = 0; e < m_edges.size(); ++e)
+    {
+        if (GetEdgeOwner(e) != this)
         {
-            SVertex* neighbor = *it;
-            if (neighbor->GetVertexType() == SVertex::VertexTypeHost)
-            {
-                continue;
-            }
-            // NS_LOG_DEBUG("pushing: " << *neighbor);
-            auto copy = p;
-            copy.push_back(neighbor);
-            s.push(std::make_pair(neighbor, copy));
+            UpdateEdge(e);
         }
     }
 }
 
+void
+SnicScheduler::SetDevice(Ptr<NetDevice> device)
+{
+    NS_LOG_FUNCTION(this << device);
+    m_device = device;
+}
+
+Ptr<NetDevice>
+SnicScheduler::GetDevice() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_device;
+}
+
 /* returns true if we are able to allocate for this flow. Fills snicHeader
  * with allocation*/
 bool
@@ -451,11 +767,32 @@ SnicScheduler::Schedule(SnicHeader& snicHeader, SnicSchedulerHeader& schedHeader
 {
     NS_LOG_FUNCTION(this << schedHeader);
     NS_LOG_DEBUG("IN SCHEDULER");
+    // building the topology is not part of the first decision
     if (!m_initialized)
     {
         Initialize();
         DumpAllPaths();
     }
+
+    m_decisionPaths = 0;
+    m_decisionEdges = 0;
+    uint64_t start = GetWallClock();
+    bool admitted = DoSchedule(snicHeader, schedHeader);
+    uint64_t elapsed = GetWallClock() - start;
+
+    m_nSchedules++;
+    m_nAdmitted += admitted;
+    m_scheduleTime += elapsed;
+    m_maxScheduleTime = std::max(m_maxScheduleTime, elapsed);
+    m_nPathsExamined += m_decisionPaths;
+    m_nEdgesChecked += m_decisionEdges;
+    m_scheduleTrace(NanoSeconds(elapsed), m_decisionPaths, m_decisionEdges, admitted);
+    return admitted;
+}
+
+bool
+SnicScheduler::DoSchedule(SnicHeader& snicHeader, SnicSchedulerHeader& schedHeader)
+{
     m_allocationCount++;
     NS_LOG_DEBUG("allocationCount: " << m_allocationCount);
     Ipv4Address srcIp = schedHeader.GetSourceIp();
@@ -463,34 +800,72 @@ SnicScheduler::Schedule(SnicHeader& snicHeader, SnicSchedulerHeader& schedHeader
     NS_LOG_DEBUG("src: " << srcIp);
     NS_LOG_DEBUG("dest: " << dstIp);
 
-    SVertex* src = GetVertexFromIp(srcIp)->GetConnectedVertex(0);
-    SVertex* dst = GetVertexFromIp(dstIp)->GetConnectedVertex(0);
-    NS_ASSERT_MSG(src, "src not found");
-    NS_ASSERT_MSG(dst, "dst not found");
+    SVertex* srcHost = GetVertexFromIp(srcIp);
+    SVertex* dstHost = GetVertexFromIp(dstIp);
+    NS_ASSERT_MSG(srcHost, "src not found");
+    NS_ASSERT_MSG(dstHost, "dst not found");
+    SVertex* src = srcHost->GetConnectedVertex(0);
+    SVertex* dst = dstHost->GetConnectedVertex(0);
 
     NS_LOG_DEBUG(*src);
     NS_LOG_DEBUG(*dst);
-    NS_LOG_DEBUG(m_allPaths[src][dst].size());
-
-    std::vector<Path_t>& paths = m_allPaths[src][dst];
 
     // sort(paths.begin(), paths.end());
     DumpEdges();
     // return true;
 
-    NS_LOG_DEBUG("paths size=" << paths.size());
-    for (uint32_t i = 0; i < paths.size(); ++i)
+    uint64_t demand = schedHeader.GetBandwidthDemandBps();
+    uint32_t nt = schedHeader.GetNT();
+    bool needsPlacement = NeedsPlacement(nt);
+    int32_t placement = -1;
+
+    // try the cached candidates cheapest first, they are computed on demand
+    bool allCandidates = m_policy->NeedsAllCandidates();
+    std::vector<SnicPlacementPolicy::Candidate> candidates;
+    std::vector<int32_t> placements;
+    for (uint32_t i = 0; i < m_pathEngine.GetMaxPaths(); ++i)
     {
-        Path_t path = paths[i];
-        NS_LOG_DEBUG("size=" << paths[i].size());
+        const Path_t* path = m_pathEngine.GetPath(src, dst, i);
+        if (!path)
+        {
+            break;
+        }
+        m_decisionPaths++;
+        NS_LOG_DEBUG("size=" << path->size());
 
-        if (PathIsValid(schedHeader, path))
+        if (PathIsValid(demand, *path) &&
+            (!needsPlacement || FindPlacement(nt, demand, *path, placement)))
         {
-            AllocatePath(snicHeader, schedHeader, path);
-            return true;
-            // return path;
+            if (!allCandidates)
+            {
+                AllocatePath(snicHeader, schedHeader, demand, *path, placement);
+                return true;
+            }
+            candidates.push_back(DescribePath(i, *path));
+            placements.push_back(placement);
         }
     }
+    if (!candidates.empty())
+    {
+        uint32_t pick = m_policy->Select(candidates, demand);
+        NS_ASSERT_MSG(pick < candidates.size(), "policy picked no candidate");
+        // computing a path may move the others, get the pick again
+        const Path_t* path = m_pathEngine.GetPath(src, dst, candidates[pick].index);
+        AllocatePath(snicHeader, schedHeader, demand, *path, placements[pick]);
+        return true;
+    }
+
+    // none of the candidates has enough bandwidth left for this demand, look
+    // for any path that does
+    SyncForeignEdges();
+    Path_t path;
+    m_decisionPaths++;
+    if (m_pathEngine.FindFeasiblePath(src, dst, demand, path) &&
+        (!needsPlacement || FindPlacement(nt, demand, path, placement)))
+    {
+        AllocatePath(snicHeader, schedHeader, demand, path, placement);
+        return true;
+    }
 
     // sort list of routes
     // create a graph that includes edges
@@ -527,87 +902,190 @@ SnicScheduler::Schedule(SnicHeader& snicHeader, SnicSchedulerHeader& schedHeader
     return false;
 }
 
-void
+std::vector<Ptr<SnicScheduler>>
 SnicScheduler::Release(SnicHeader& snicHeader, SnicSchedulerHeader& schedHeader)
 {
     NS_LOG_FUNCTION(this);
     NS_ASSERT(m_initialized);
+    uint64_t start = GetWallClock();
 
     Ipv4Address srcIp = schedHeader.GetSourceIp();
     Ipv4Address dstIp = schedHeader.GetDestinationIp();
     NS_LOG_DEBUG("src: " << srcIp);
     NS_LOG_DEBUG("dest: " << dstIp);
 
-    SVertex* src = GetVertexFromIp(srcIp)->GetConnectedVertex(0);
-    SVertex* dst = GetVertexFromIp(dstIp)->GetConnectedVertex(0);
-    NS_ASSERT_MSG(src, "src not found");
-    NS_ASSERT_MSG(dst, "dst not found");
+    SVertex* srcHost = GetVertexFromIp(srcIp);
+    SVertex* dstHost = GetVertexFromIp(dstIp);
+    NS_ASSERT_MSG(srcHost, "src not found");
+    NS_ASSERT_MSG(dstHost, "dst not found");
+    SVertex* src = srcHost->GetConnectedVertex(0);
+    SVertex* dst = dstHost->GetConnectedVertex(0);
 
     NS_LOG_DEBUG(*src);
     NS_LOG_DEBUG(*dst);
-    NS_LOG_DEBUG(m_allPaths[src][dst].size());
-
-    // std::vector<Path_t>& paths = m_allPaths[src][dst];
 
-    std::vector<SVertex*> path = GetPathFromHeader(snicHeader);
-    // DeallocatePath(path);
-
-    // sort(paths.begin(), paths.end());
-    //DumpEdges();
-    // return true;
+    // give back what was recorded at allocation time, the route carried by
+    // the header does not include the last hop
     FlowId flowId(schedHeader);
+    auto it = m_resourceAllocated.find(flowId);
+    NS_ASSERT_MSG(it != m_resourceAllocated.end(), "can't find flow allocated??");
+    const FlowAllocation& allocation = it->second;
 
-    for (uint32_t i = 0; i < path.size() - 1; ++i)
+    std::set<uint32_t> shards;
+    for (auto e = allocation.path.begin(); e != allocation.path.end(); ++e)
     {
-        SVertex* v = path[i];
-        SVertex* nextVertex = path[i + 1];
-        SEdge* nextEdge = v->GetEdgeTo(nextVertex);
+        uint32_t edgeId = *e;
+        NS_LOG_DEBUG("before deallocating " << GetEdgeRemaining(edgeId));
+        NS_LOG_DEBUG("deallocating edge: " << m_edges[edgeId]);
+        FreeEdge(edgeId, allocation.bps);
+        if (UpdateEdge(edgeId))
+        {
+            shards.insert(GetEdgeOwner(edgeId)->m_shard);
+        }
+        NS_LOG_DEBUG("after deallocating " << m_edgeRemaining[edgeId]);
+    }
+    if (allocation.placement >= 0)
+    {
+        Unplace(allocation.nt, allocation.bps, allocation.placement);
+        if (!m_shards.empty())
+        {
+            shards.insert(GetVertexShard(allocation.placement));
+        }
+    }
+    shards.erase(m_shard);
+    uint32_t nEdges = allocation.path.size();
+    m_resourceAllocated.erase(it);
+    m_activeFlows = m_resourceAllocated.size();
+
+    uint64_t elapsed = GetWallClock() - start;
+    m_nReleases++;
+    m_releaseTime += elapsed;
+    m_maxReleaseTime = std::max(m_maxReleaseTime, elapsed);
+    m_releaseTrace(NanoSeconds(elapsed), nEdges);
+
+    std::vector<Ptr<SnicScheduler>> others;
+    for (auto s = shards.begin(); s != shards.end(); ++s)
+    {
+        others.push_back(m_shards[*s]);
+    }
+    return others;
+}
 
+uint32_t
+SnicScheduler::ScheduleBatch(std::vector<SnicSchedulerHeader>& flows,
+                             std::vector<SnicHeader>& snicHeaders,
+                             std::vector<bool>& admitted)
+{
+    NS_LOG_FUNCTION(this << flows.size());
+    std::vector<uint64_t> demands;
+    demands.reserve(flows.size());
+    for (auto it = flows.begin(); it != flows.end(); ++it)
+    {
+        demands.push_back(it->GetBandwidthDemandBps());
+    }
+    std::vector<uint32_t> order = m_policy->OrderBatch(demands);
+    NS_ASSERT_MSG(order.size() == flows.size(), "policy dropped flows of the batch");
 
-        NS_ASSERT_MSG(m_resourceAllocated.count(flowId) > 0, "can't find flow allocated??");
-        double d = m_resourceAllocated[flowId][INGRESS];
-        DataRate demand = DataRate(std::to_string(d) + "Gbps");
-        NS_LOG_DEBUG("before deallocating " << nextEdge->GetRemainingBandwidth());
-        NS_LOG_DEBUG("deallocating edge: " << nextEdge);
-        nextEdge->DeallocateBandwidth(demand);
-        NS_LOG_DEBUG("after deallocating " << nextEdge->GetRemainingBandwidth());
-        NS_LOG_DEBUG(demand);
+    snicHeaders.assign(flows.size(), SnicHeader());
+    admitted.assign(flows.size(), false);
+    uint32_t nAdmitted = 0;
+    for (auto it = order.begin(); it != order.end(); ++it)
+    {
+        admitted[*it] = Schedule(snicHeaders[*it], flows[*it]);
+        nAdmitted += admitted[*it];
+    }
+    return nAdmitted;
+}
 
+uint64_t
+SnicScheduler::GetAlllocationCount() const
+{
+    return m_allocationCount;
+}
 
-        // NS_ASSERT_MSG(m_resourceAllocated[flowId][INGRESS] == d, "doesnt match");
+uint32_t
+SnicScheduler::GetNActiveFlows() const
+{
+    return m_resourceAllocated.size();
+}
 
-        // m_allPaths\c
-        // FIXME maybe remove instead of setting to 0
+uint64_t
+SnicScheduler::GetFlowTableMemoryUsage() const
+{
+    // a node of a std::map holds its value, a color and 3 links
+    uint64_t bytes = 0;
+    for (auto it = m_resourceAllocated.begin(); it != m_resourceAllocated.end(); ++it)
+    {
+        bytes += 4 * sizeof(void*) + sizeof(*it) + it->second.path.capacity() * sizeof(uint32_t);
     }
-    m_resourceAllocated[flowId][INGRESS] = 0;
-    m_resourceAllocated[flowId][EGRESS] = 0;
+    return bytes;
 }
 
 uint64_t
-SnicScheduler::GetAlllocationCount() const
+SnicScheduler::GetPathCacheMemoryUsage() const
 {
-    return m_allocationCount;
+    return m_pathEngine.GetMemoryUsage();
+}
+
+void
+SnicScheduler::PrintStatistics(std::ostream& os) const
+{
+    os << "schedules:" << m_nSchedules << "\n"
+       << "admitted:" << m_nAdmitted << "\n"
+       << "scheduleMeanNs:" << (m_nSchedules ? m_scheduleTime / m_nSchedules : 0) << "\n"
+       << "scheduleMaxNs:" << m_maxScheduleTime << "\n"
+       << "releases:" << m_nReleases << "\n"
+       << "releaseMeanNs:" << (m_nReleases ? m_releaseTime / m_nReleases : 0) << "\n"
+       << "releaseMaxNs:" << m_maxReleaseTime << "\n"
+       << "pathsPerSchedule:" << (m_nSchedules ? (double)m_nPathsExamined / m_nSchedules : 0)
+       << "\n"
+       << "edgesPerSchedule:" << (m_nSchedules ? (double)m_nEdgesChecked / m_nSchedules : 0)
+       << "\n"
+       << "activeFlows:" << m_resourceAllocated.size() << "\n"
+       << "cachedPaths:" << m_pathEngine.GetNCachedPaths() << "\n"
+       << "pathCacheBytes:" << GetPathCacheMemoryUsage() << "\n"
+       << "flowTableBytes:" << GetFlowTableMemoryUsage() << "\n";
+}
+
+uint64_t
+SnicScheduler::GetRemainingBandwidth(uint32_t edgeId) const
+{
+    NS_ASSERT_MSG(edgeId < m_edgeRemaining.size(), "no such edge");
+    return m_edgeRemaining[edgeId];
+}
+
+uint32_t
+SnicScheduler::GetNEdges() const
+{
+    return m_edges.size();
+}
+
+uint64_t
+SnicScheduler::GetEdgeCapacity(uint32_t edgeId) const
+{
+    NS_ASSERT_MSG(edgeId < m_edgeCapacity.size(), "no such edge");
+    return m_edgeCapacity[edgeId];
+}
+
+void
+SnicScheduler::SetMaxPaths(uint32_t maxPaths)
+{
+    NS_LOG_FUNCTION(this << maxPaths);
+    m_pathEngine.SetMaxPaths(maxPaths);
+}
+
+uint32_t
+SnicScheduler::GetMaxPaths() const
+{
+    return m_pathEngine.GetMaxPaths();
 }
 
 void
 SnicScheduler::DumpAllPaths() const
 {
     NS_LOG_FUNCTION(this);
-    NS_LOG_DEBUG("Dumping all paths: ");
-    for (auto src_it = m_allPaths.begin(); src_it != m_allPaths.end(); ++src_it)
-    {
-        NS_LOG_DEBUG("\tSrc: \n" << *src_it->first);
-        const auto& dsts = src_it->second;
-        for (auto dst_it = dsts.begin(); dst_it != dsts.end(); ++dst_it)
-        {
-            NS_LOG_DEBUG("\tDst: \n" << *dst_it->first);
-            const auto& paths = dst_it->second;
-            for (auto path_it = paths.begin(); path_it != paths.end(); ++path_it)
-            {
-                DumpPath(*path_it);
-            }
-        }
-    }
+    NS_LOG_DEBUG("Cached paths: " << m_pathEngine.GetNCachedPaths() << " for "
+                                  << m_pathEngine.GetNCachedPairs() << " sNIC pairs");
 }
 
 void
@@ -630,6 +1108,7 @@ SnicScheduler::DumpEdges() const
     for (auto it = m_edges.begin(); it != m_edges.end(); ++it)
     {
         NS_LOG_DEBUG(**it);
+        NS_LOG_DEBUG("remaining=" << m_edgeRemaining[(*it)->GetEdgeId()] << "bps");
         NS_LOG_DEBUG("////////////////////");
     }
 }
@@ -642,6 +1121,7 @@ SnicScheduler::DumpEdges() const
 SVertex::SVertex()
     : m_vertexType(VertexTypeUnknown),
       m_vertexId("255.255.255.255"),
+      m_vertexIndex(0),
       // m_lsa(nullptr),
       // m_distanceFromRoot(SPF_INFINITY),
       // m_rootOif(SPF_INFINITY),
@@ -691,6 +1171,18 @@ SVertex::GetNode() const
     return m_node;
 }
 
+void
+SVertex::SetVertexIndex(uint32_t index)
+{
+    m_vertexIndex = index;
+}
+
+uint32_t
+SVertex::GetVertexIndex() const
+{
+    return m_vertexIndex;
+}
+
 int
 SVertex::GetVertexType() const
 {
@@ -705,16 +1197,24 @@ SVertex::GetConnectedVertex(uint32_t id) const
 }
 
 SEdge*
-SVertex::GetEdgeTo(SVertex* v)
+SVertex::GetEdgeTo(SVertex* v) const
 {
-    return m_edgeMap[v];
+    // degrees are small, and the latest edge to a neighbor wins
+    for (auto it = m_edges.rbegin(); it != m_edges.rend(); ++it)
+    {
+        if ((*it)->GetRVertex() == v)
+        {
+            return *it;
+        }
+    }
+    return nullptr;
 }
 
 void
 SVertex::AddEdge(SEdge* edge, SVertex* other)
 {
+    NS_ASSERT(edge->GetRVertex() == other);
     m_edges.push_back(edge);
-    m_edgeMap[other] = edge;
 }
 
 std::ostream&
@@ -746,9 +1246,10 @@ SEdge::SEdge()
     : m_leftVertex(nullptr),
       m_rightVertex(nullptr),
       m_channel(nullptr),
-      m_rightInterfaceNum(0)
-// m_consumedBandwidth(0),
-// m_remainingBandwidth(0)
+      m_rightInterfaceNum(0),
+      m_leftPort(0),
+      m_edgeId(0),
+      m_capacity(0)
 {
 }
 
@@ -783,18 +1284,29 @@ SEdge::GetRVertex() const
     return m_rightVertex;
 }
 
-DataRate
-SEdge::GetRemainingBandwidth() const
+void
+SEdge::SetEdgeId(uint32_t id)
 {
-    return m_remainingBandwidth;
+    m_edgeId = id;
+}
+
+uint32_t
+SEdge::GetEdgeId() const
+{
+    return m_edgeId;
+}
+
+uint64_t
+SEdge::GetCapacity() const
+{
+    return m_capacity;
 }
 
 void
 SEdge::SetChannel(Ptr<CsmaChannel> channel)
 {
     m_channel = channel;
-    m_totalBandwidth = channel->GetDataRate();
-    m_remainingBandwidth = m_totalBandwidth;
+    m_capacity = channel->GetDataRate().GetBitRate();
 }
 
 void
@@ -809,23 +1321,6 @@ SEdge::GetRInterfaceNum() const
     return m_rightInterfaceNum;
 }
 
-void
-SEdge::AssignBandwidth(DataRate bps)
-{
-    NS_ASSERT(m_remainingBandwidth >= bps);
-    m_remainingBandwidth -= bps;
-    m_consumedBandwidth += bps;
-    // m_allocatedBandwidth
-}
-
-void
-SEdge::DeallocateBandwidth(DataRate bps)
-{
-    NS_ASSERT(m_consumedBandwidth >= bps);
-    m_remainingBandwidth += bps;
-    m_consumedBandwidth -= bps;
-}
-
 void
 SEdge::SetLDevice(Ptr<NetDevice> dev)
 {
@@ -850,6 +1345,18 @@ SEdge::GetRDevice() const
     return m_rightDevice;
 }
 
+void
+SEdge::SetLPort(uint16_t port)
+{
+    m_leftPort = port;
+}
+
+uint16_t
+SEdge::GetLPort() const
+{
+    return m_leftPort;
+}
+
 std::ostream&
 operator<<(std::ostream& os, const SEdge& edge)
 {
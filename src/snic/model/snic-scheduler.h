@@ -6,21 +6,30 @@
 #include "ns3/flow.h"
 #include "ns3/network-task.h"
 #include "ns3/node.h"
+#include "ns3/nstime.h"
 #include "ns3/object.h"
 #include "ns3/ptr.h"
+#include "ns3/snic-path-engine.h"
+#include "ns3/snic-placement-policy.h"
 #include "ns3/snic-scheduler-header.h"
+#include "ns3/traced-callback.h"
+#include "ns3/traced-value.h"
 
 #include <list>
 #include <map>
 #include <ostream>
+#include <set>
+#include <unordered_map>
 
 namespace ns3
 {
 class SEdge;
+class SnicNetDevice;
 class SVertex
 {
   public:
     friend class SnicScheduler;
+    friend class SnicPathEngine;
     friend class SEdge;
 
     enum VertexType
@@ -39,11 +48,18 @@ class SVertex
 
     Ipv4Address GetVertexId() const;
     Ptr<Node> GetNode() const;
+
+    /**
+     * \param index dense index of this vertex, in [0, number of vertices)
+     */
+    void SetVertexIndex(uint32_t index);
+    uint32_t GetVertexIndex() const;
+
     int GetVertexType() const;
 
     SVertex* GetConnectedVertex(uint32_t id) const;
 
-    SEdge* GetEdgeTo(SVertex* v);
+    SEdge* GetEdgeTo(SVertex* v) const;
 
   protected:
     void AddEdge(SEdge* edge, SVertex* other);
@@ -53,13 +69,13 @@ class SVertex
     friend std::ostream& operator<<(std::ostream& os, const SVertex& vertex);
     VertexType m_vertexType;
     Ipv4Address m_vertexId;
+    uint32_t m_vertexIndex;
     Ptr<Node> m_node;
 
     typedef std::vector<SEdge*> ListOfSEdge_t;
     ListOfSVertex_t m_vertices;
     bool m_vertexProcessed;
     ListOfSEdge_t m_edges;
-    std::map<SVertex*, SEdge*> m_edgeMap;
 
     std::list<NetworkTask> m_networkTasks;
 };
@@ -68,6 +84,7 @@ class SEdge
 {
   public:
     friend class SnicScheduler;
+    friend class SnicPathEngine;
     friend class SVertex;
 
     SEdge();
@@ -78,21 +95,33 @@ class SEdge
     SVertex* GetLVertex() const;
     SVertex* GetRVertex() const;
 
-    DataRate GetRemainingBandwidth() const;
+    /**
+     * \param id index of this edge in the scheduler's per edge arrays
+     */
+    void SetEdgeId(uint32_t id);
+    uint32_t GetEdgeId() const;
+
+    /**
+     * \return the capacity of the underlying channel in bit/s
+     */
+    uint64_t GetCapacity() const;
 
     void SetChannel(Ptr<CsmaChannel> channel);
 
     void SetRInterfaceNum(uint32_t num);
     uint32_t GetRInterfaceNum() const;
 
-    void AssignBandwidth(DataRate bps);
-    void DeallocateBandwidth(DataRate bps);
-
     void SetLDevice(Ptr<NetDevice> device);
     void SetRDevice(Ptr<NetDevice> device);
     Ptr<NetDevice> GetLDevice() const;
     Ptr<NetDevice> GetRDevice() const;
 
+    /**
+     * \param port index of the port of the left sNIC the edge leaves from
+     */
+    void SetLPort(uint16_t port);
+    uint16_t GetLPort() const;
+
   private:
     friend std::ostream& operator<<(std::ostream& os, const SEdge& edge);
     SVertex* m_leftVertex;
@@ -101,13 +130,9 @@ class SEdge
     Ptr<NetDevice> m_leftDevice;
     Ptr<NetDevice> m_rightDevice;
     uint32_t m_rightInterfaceNum;
-    DataRate m_consumedBandwidth;
-    DataRate m_remainingBandwidth;
-
-    DataRate m_totalBandwidth;
-    // DataRate m_cosu
-    //  FIXME
-    std::map<SVertex*, double> m_allocatedBandwidth;
+    uint16_t m_leftPort;
+    uint32_t m_edgeId;
+    uint64_t m_capacity;
 };
 
 class Path : public Object
@@ -131,6 +156,16 @@ class SnicScheduler : public Object
   public:
     static TypeId GetTypeId();
 
+    /// resources of an sNIC NTs are placed on
+    enum ResourceType
+    {
+        FPGA = 0, //!< fraction of the FPGA fabric
+        INGRESS,  //!< traffic into the NTs, in bit/s
+        EGRESS,   //!< traffic out of the NTs, in bit/s
+        MEMORY,   //!< memory, in bytes
+        RESOURCE_COUNT
+    };
+
     SnicScheduler();
     ~SnicScheduler() override;
     void Initialize();
@@ -141,28 +176,223 @@ class SnicScheduler : public Object
      * with allocation*/
     typedef std::vector<SVertex*> Path_t;
     bool Schedule(SnicHeader& snicHeader, SnicSchedulerHeader& schedHeader);
-    void Release(SnicHeader& snicHeader, SnicSchedulerHeader& schedHeader);
+    /**
+     * \brief Give back the resources of a flow.
+     * \return the other shards owning some of them, in shard order: the flows
+     *         waiting for these shards may fit now
+     */
+    std::vector<Ptr<SnicScheduler>> Release(SnicHeader& snicHeader,
+                                            SnicSchedulerHeader& schedHeader);
+
+    /**
+     * \brief Schedule the flows of a batch in the order the placement policy wants.
+     * \param flows the flows
+     * \param snicHeaders resized to the number of flows, each filled with the
+     *        allocation of its flow
+     * \param admitted resized to the number of flows, true for the flows allocated
+     * \return the number of flows allocated
+     */
+    uint32_t ScheduleBatch(std::vector<SnicSchedulerHeader>& flows,
+                           std::vector<SnicHeader>& snicHeaders,
+                           std::vector<bool>& admitted);
 
     uint64_t GetAlllocationCount() const;
+
+    /**
+     * TracedCallback signature for scheduling decisions.
+     *
+     * \param [in] wallClock the wall clock time the decision took
+     * \param [in] nPaths the number of candidate paths examined
+     * \param [in] nEdges the number of edges checked for bandwidth
+     * \param [in] admitted true if the flow was allocated
+     */
+    typedef void (*ScheduleTracedCallback)(Time wallClock,
+                                           uint32_t nPaths,
+                                           uint32_t nEdges,
+                                           bool admitted);
+
+    /**
+     * TracedCallback signature for releases.
+     *
+     * \param [in] wallClock the wall clock time the release took
+     * \param [in] nEdges the number of edges given their bandwidth back
+     */
+    typedef void (*ReleaseTracedCallback)(Time wallClock, uint32_t nEdges);
+
+    /// \return the number of flows holding an allocation
+    uint32_t GetNActiveFlows() const;
+    /// \return an estimate of the bytes held by the allocations of the active flows
+    uint64_t GetFlowTableMemoryUsage() const;
+    /// \return an estimate of the bytes held by the candidate path cache
+    uint64_t GetPathCacheMemoryUsage() const;
+
+    /**
+     * \brief Print what the decisions cost so far, one key:value line per figure
+     * \param os the output stream
+     *
+     * The lines follow the format of the experiment output files, so they can
+     * be appended to them and gathered by Benchmark::WriteResults().
+     */
+    void PrintStatistics(std::ostream& os) const;
+
+    /**
+     * \param edgeId the id of the edge
+     * \return the bandwidth still available on the edge in bit/s
+     */
+    uint64_t GetRemainingBandwidth(uint32_t edgeId) const;
+
+    /**
+     * \return the number of edges of the topology
+     */
+    uint32_t GetNEdges() const;
+
+    /**
+     * \param edgeId the id of the edge
+     * \return the capacity of the edge in bit/s
+     */
+    uint64_t GetEdgeCapacity(uint32_t edgeId) const;
+
+    /**
+     * \param maxPaths the number of candidate paths kept per pair of sNICs
+     */
+    void SetMaxPaths(uint32_t maxPaths);
+    uint32_t GetMaxPaths() const;
+
+    /**
+     * \brief Make this scheduler one shard of a sharded scheduler.
+     * \param shard index of this scheduler in shards
+     * \param shards the scheduler of every shard, this one included
+     * \param nodeShard the shard owning each sNIC, indexed by node id
+     *
+     * Each shard owns the bandwidth of the edges leaving its sNICs. A flow
+     * whose path only uses edges of this shard is allocated locally, any
+     * other flow reserves the edges it uses from the shards that own them.
+     */
+    void SetShards(uint32_t shard,
+                   const std::vector<Ptr<SnicScheduler>>& shards,
+                   const std::vector<uint32_t>& nodeShard);
+    uint32_t GetShard() const;
+
+    /**
+     * \return the number of flows allocated on edges of this shard only
+     */
+    uint64_t GetNLocalAllocations() const;
+    /**
+     * \return the number of flows that needed edges of other shards
+     */
+    uint64_t GetNCrossShardAllocations() const;
+
+    /**
+     * \param node an sNIC node
+     * \param resource the resource
+     * \return what the scheduler has left of the resource on that sNIC
+     */
+    double GetRemainingResource(Ptr<Node> node, ResourceType resource) const;
+
+    /**
+     * \param flowId an allocated flow
+     * \return the sNIC running the NT of the flow, nullptr if it has none
+     */
+    Ptr<Node> GetPlacement(const FlowId& flowId) const;
+
     void DumpAllPaths() const;
     void DumpPath(const std::vector<SVertex*>& path) const;
     void DumpEdges() const;
 
   protected:
+    void DoDispose() override;
 
     void AddNode(Ptr<Node> node);
-    void DepthFirstTraversal(SVertex* src, SVertex* dst, uint32_t limit);
-    void PopulateStaticRoutes();
     void InitializeResources();
 
     SVertex* GetVertexFromIp(const Ipv4Address& ip) const;
 
-    bool PathIsValid(const SnicSchedulerHeader& header, Path_t path) const;
-    void AllocatePath(SnicHeader& snicHeader, SnicSchedulerHeader& schedHeader, Path_t path);
-
-    std::vector<SVertex*> GetPathFromHeader(SnicHeader& snicHeader) const;
+    bool PathIsValid(uint64_t demand, const Path_t& path) const;
+
+    /**
+     * \brief Summarize a feasible path for the placement policy.
+     * \param index index of the path in the path cache
+     * \param path the path
+     */
+    SnicPlacementPolicy::Candidate DescribePath(uint32_t index, const Path_t& path) const;
+    void AllocatePath(SnicHeader& snicHeader,
+                      SnicSchedulerHeader& schedHeader,
+                      uint64_t demand,
+                      const Path_t& path,
+                      int32_t placement);
+
+    /**
+     * \return true if some sNIC has the NT installed, flows asking for an NT
+     *         no sNIC can run only need bandwidth
+     */
+    bool NeedsPlacement(uint32_t nt) const;
+
+    /**
+     * \brief Pick the sNIC of a path that runs the NT of a flow.
+     * \param nt the NT
+     * \param demand bandwidth of the flow in bit/s
+     * \param path the path of the flow
+     * \param placement set to the vertex index of the sNIC
+     * \return true if some sNIC of the path can take the flow
+     *
+     * A running instance of the NT is shared by its flows, so sNICs that
+     * already run one are preferred. Otherwise the NT is placed best fit:
+     * on the sNIC left with the least of its resources, summed over every
+     * resource relative to the capacity of the sNIC.
+     */
+    bool FindPlacement(uint32_t nt, uint64_t demand, const Path_t& path, int32_t& placement) const;
 
   private:
+    /// Schedule() without the accounting of its cost
+    bool DoSchedule(SnicHeader& snicHeader, SnicSchedulerHeader& schedHeader);
+
+    /// \return the shard owning the bandwidth of an edge, this one if not sharded
+    SnicScheduler* GetEdgeOwner(uint32_t edgeId) const;
+    /// \return the bandwidth left on an edge according to its owner
+    uint64_t GetEdgeRemaining(uint32_t edgeId) const;
+    /// take bandwidth from the owner of an edge
+    void ReserveEdge(uint32_t edgeId, uint64_t bps);
+    /// give bandwidth back to the owner of an edge
+    void FreeEdge(uint32_t edgeId, uint64_t bps);
+    /**
+     * \brief Copy what the owner of an edge has left into our view of it.
+     * \return true if the edge belongs to another shard
+     */
+    bool UpdateEdge(uint32_t edgeId);
+    /// refresh our view of every edge owned by another shard
+    void SyncForeignEdges();
+
+    /// an NT placed on an sNIC, shared by the flows using it
+    struct NtInstance
+    {
+        uint32_t nFlows = 0;
+        double fpga = 0;           //!< fabric taken from the sNIC
+        double memory = 0;         //!< memory taken from the sNIC
+        uint64_t ingressRemaining; //!< what the NT can still take in
+        uint64_t egressRemaining;  //!< what the NT can still send out
+    };
+
+    /// resources of an sNIC
+    struct SnicResources
+    {
+        Ptr<SnicNetDevice> snic; //!< nullptr for hosts
+        double capacity[RESOURCE_COUNT];
+        double remaining[RESOURCE_COUNT];
+        std::map<uint32_t, NtInstance> instances; //!< indexed by NT id
+    };
+
+    /**
+     * \return the resources of a vertex, held by the shard owning it, which
+     *         must be initialized
+     */
+    SnicResources& GetResources(uint32_t vertexIndex) const;
+    /// \return the shard owning a vertex
+    uint32_t GetVertexShard(uint32_t vertexIndex) const;
+    /// take what a flow needs from its sNIC, placing the NT if needed
+    void Place(uint32_t nt, uint64_t demand, uint32_t vertexIndex);
+    /// give back what a flow took from its sNIC
+    void Unplace(uint32_t nt, uint64_t demand, uint32_t vertexIndex);
+
     Ptr<NetDevice> m_device;
     bool m_initialized;
     // topology table
@@ -170,31 +400,64 @@ class SnicScheduler : public Object
     ListOfSVertex_t m_vertices;
     ListOfSVertex_t m_nicVertices;
     ListOfSVertex_t m_hostVertices;
-    std::map<Ptr<Node>, SVertex*> m_addedNodes;
+    // indexed by node id
+    ListOfSVertex_t m_addedNodes;
+    std::unordered_map<Ipv4Address, SVertex*, Ipv4AddressHash> m_ipToVertex;
+    std::set<uint32_t> m_installedNts; //!< NTs installed on some sNIC
 
     typedef std::vector<SEdge*> ListOfSEdge_t;
     ListOfSEdge_t m_edges;
 
-    std::map<SVertex*, std::map<SVertex*, std::vector<Path_t>>> m_allPaths;
+    // candidate paths between sNICs, computed lazily
+    SnicPathEngine m_pathEngine;
+    Ptr<SnicPlacementPolicy> m_policy;
     // topology
     // active flow table
     // map<FlowId, Allocation> m_activeFlows;
     uint64_t m_allocationCount;
 
-    enum ResourceType
+    /// what a flow holds, so it can be given back on release
+    struct FlowAllocation
     {
-        FPGA = 0,
-        INGRESS,
-        EGRESS,
-        MEMORY
+        uint64_t bps;               //!< bandwidth reserved on every edge
+        std::vector<uint32_t> path; //!< ids of the edges reserved
+        uint32_t nt = 0;            //!< NT of the flow
+        int32_t placement = -1;     //!< vertex index of the sNIC running the NT
     };
 
-    // indexed by resource
-    std::map<uint8_t, double> m_resourceConsumed;
-    // indexed by vertex
-    std::map<FlowId, std::map<uint8_t, double>> m_resourceAllocated;
-    // indexed by resource
-    std::map<uint8_t, double> m_resourceRemaining;
+    // indexed by edge id, in bit/s
+    std::vector<uint64_t> m_edgeCapacity;
+    std::vector<uint64_t> m_edgeRemaining;
+
+    // indexed by vertex index
+    std::vector<SnicResources> m_snicResources;
+    // indexed by flow
+    std::map<FlowId, FlowAllocation> m_resourceAllocated;
+
+    uint32_t m_shard;
+    std::vector<Ptr<SnicScheduler>> m_shards;
+    // shard owning each sNIC, indexed by node id
+    std::vector<uint32_t> m_nodeShard;
+    uint64_t m_nLocalAllocations;
+    uint64_t m_nCrossShardAllocations;
+
+    // cost of the decisions, wall clock times in nanoseconds
+    uint64_t m_nSchedules;
+    uint64_t m_nAdmitted;
+    uint64_t m_scheduleTime;
+    uint64_t m_maxScheduleTime;
+    uint64_t m_nReleases;
+    uint64_t m_releaseTime;
+    uint64_t m_maxReleaseTime;
+    uint64_t m_nPathsExamined;
+    uint64_t m_nEdgesChecked;
+    // examined by the decision in progress
+    uint32_t m_decisionPaths;
+    mutable uint32_t m_decisionEdges;
+
+    TracedValue<uint32_t> m_activeFlows;
+    TracedCallback<Time, uint32_t, uint32_t, bool> m_scheduleTrace;
+    TracedCallback<Time, uint32_t> m_releaseTrace;
 };
 
 std::ostream& operator<<(std::ostream& os, const SVertex& vertex);
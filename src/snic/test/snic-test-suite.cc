@@ -1,9 +1,40 @@
 
 // Include a header file from your module to test.
 
+#include "ns3/arrival-trace.h"
+#include "ns3/boolean.h"
+#include "ns3/cluster-topology.h"
+#include "ns3/config.h"
+#include "ns3/double.h"
+#include "ns3/duplicate-filter.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/network-task.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/packet-arrival-rate-trace-gen.h"
+#include "ns3/packet-buffer.h"
+#include "ns3/pointer.h"
+#include "ns3/ring-topology.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/snic-header.h"
+#include "ns3/socket.h"
+#include "ns3/snic-net-device.h"
+#include "ns3/snic-placement-policy.h"
+#include "ns3/snic-scheduler-header.h"
+#include "ns3/snic-scheduler.h"
+
 // An essential include is test.h
 #include "ns3/test.h"
 
+#include <deque>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <vector>
+
 // Do not put your test classes in namespace ns3.  You may find it useful
 // to use the using directive to access the ns3 namespace directly
 using namespace ns3;
@@ -44,6 +75,1380 @@ SnicTestCase1::DoRun()
     NS_TEST_ASSERT_MSG_EQ_TOL(0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+/**
+ * \ingroup snic-tests
+ * Check that the scheduler falls back to longer paths once the shortest one
+ * is out of bandwidth, and rejects flows once every path is.
+ */
+class SnicSchedulerPathTestCase : public TestCase
+{
+  public:
+    SnicSchedulerPathTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Ask the scheduler for a flow between two terminals
+     * \param scheduler the scheduler
+     * \param src source terminal address
+     * \param dst destination terminal address
+     * \param flowId flow id
+     * \param gbps demand in Gbps
+     * \param snicHeader filled with the route on success
+     * \return true if the flow was admitted
+     */
+    bool Request(Ptr<SnicScheduler> scheduler,
+                 Ipv4Address src,
+                 Ipv4Address dst,
+                 uint64_t flowId,
+                 double gbps,
+                 SnicHeader& snicHeader);
+};
+
+SnicSchedulerPathTestCase::SnicSchedulerPathTestCase()
+    : TestCase("Scheduler k-shortest-path fallback on a ring")
+{
+}
+
+bool
+SnicSchedulerPathTestCase::Request(Ptr<SnicScheduler> scheduler,
+                                   Ipv4Address src,
+                                   Ipv4Address dst,
+                                   uint64_t flowId,
+                                   double gbps,
+                                   SnicHeader& snicHeader)
+{
+    SnicSchedulerHeader schedHeader(src, 1000, dst, 9, 17, flowId);
+    schedHeader.SetBandwidthDemand(gbps);
+    return scheduler->Schedule(snicHeader, schedHeader);
+}
+
+void
+SnicSchedulerPathTestCase::DoRun()
+{
+    // 5 sNICs in a ring of 100Gbps links, one terminal each
+    RingTopologyHelper ring(5, 1, 0);
+    Ipv4InterfaceContainer interfaces = ring.GetInterfaces();
+    Ptr<SnicScheduler> scheduler = CreateObject<SnicScheduler>();
+
+    // terminal 1 to terminal 3: 2 hops one way round, 3 hops the other
+    SnicHeader first;
+    NS_TEST_ASSERT_MSG_EQ(
+        Request(scheduler, interfaces.GetAddress(1), interfaces.GetAddress(3), 1, 60, first),
+        true,
+        "first flow should fit");
+    NS_TEST_ASSERT_MSG_EQ(first.GetRteNumber(), 2, "first flow should take the shortest path");
+
+    SnicHeader second;
+    NS_TEST_ASSERT_MSG_EQ(
+        Request(scheduler, interfaces.GetAddress(1), interfaces.GetAddress(3), 2, 60, second),
+        true,
+        "second flow should fit on the long way round");
+    NS_TEST_ASSERT_MSG_EQ(second.GetRteNumber(), 3, "second flow should take the longer path");
+
+    SnicHeader third;
+    NS_TEST_ASSERT_MSG_EQ(
+        Request(scheduler, interfaces.GetAddress(1), interfaces.GetAddress(3), 3, 60, third),
+        false,
+        "third flow should not fit anywhere");
+
+    // smaller flows still fit in what is left on the short path
+    SnicHeader fourth;
+    NS_TEST_ASSERT_MSG_EQ(
+        Request(scheduler, interfaces.GetAddress(1), interfaces.GetAddress(3), 4, 40, fourth),
+        true,
+        "fourth flow should fit");
+    NS_TEST_ASSERT_MSG_EQ(fourth.GetRteNumber(), 2, "fourth flow should take the shortest path");
+
+    // releasing must give back every hop, including the last one
+    SnicHeader* admitted[] = {&first, &second, &fourth};
+    uint64_t flowIds[] = {1, 2, 4};
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        SnicSchedulerHeader schedHeader(interfaces.GetAddress(1),
+                                        1000,
+                                        interfaces.GetAddress(3),
+                                        9,
+                                        17,
+                                        flowIds[i]);
+        scheduler->Release(*admitted[i], schedHeader);
+    }
+    SnicHeader full;
+    NS_TEST_ASSERT_MSG_EQ(
+        Request(scheduler, interfaces.GetAddress(1), interfaces.GetAddress(3), 5, 100, full),
+        true,
+        "a full rate flow should fit once everything is released");
+    NS_TEST_ASSERT_MSG_EQ(full.GetRteNumber(), 2, "full rate flow should take the shortest path");
+    scheduler->Dispose();
+    Simulator::Destroy();
+
+    // on a ring of 24 sNICs the long way round takes more hops than a
+    // route can carry
+    RingTopologyHelper bigRing(24, 1, 0);
+    Ipv4InterfaceContainer bigInterfaces = bigRing.GetInterfaces();
+    scheduler = CreateObject<SnicScheduler>();
+    SnicHeader shortWay;
+    NS_TEST_ASSERT_MSG_EQ(Request(scheduler,
+                                  bigInterfaces.GetAddress(1),
+                                  bigInterfaces.GetAddress(3),
+                                  1,
+                                  60,
+                                  shortWay),
+                          true,
+                          "first flow should fit");
+    SnicHeader longWay;
+    NS_TEST_ASSERT_MSG_EQ(Request(scheduler,
+                                  bigInterfaces.GetAddress(1),
+                                  bigInterfaces.GetAddress(3),
+                                  2,
+                                  60,
+                                  longWay),
+                          false,
+                          "a path longer than a route should not be taken");
+    NS_TEST_ASSERT_MSG_EQ(longWay.GetRteNumber(), 0, "no route should be written");
+
+    scheduler->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup snic-tests
+ * Check that the scheduler places the NT of a flow on an sNIC of its path
+ * that has the fabric, memory and bandwidth for it, sharing running NTs.
+ */
+class SnicSchedulerPlacementTestCase : public TestCase
+{
+  public:
+    SnicSchedulerPlacementTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+SnicSchedulerPlacementTestCase::SnicSchedulerPlacementTestCase()
+    : TestCase("Scheduler NT placement on a ring")
+{
+}
+
+void
+SnicSchedulerPlacementTestCase::DoRun()
+{
+    RingTopologyHelper ring(5, 1, 0);
+    Ipv4InterfaceContainer interfaces = ring.GetInterfaces();
+    Ptr<SnicNetDevice> snic1 = DynamicCast<SnicNetDevice>(ring.GetSnics().Get(1));
+    Ptr<SnicNetDevice> snic2 = DynamicCast<SnicNetDevice>(ring.GetSnics().Get(2));
+    Ptr<SnicScheduler> scheduler = CreateObject<SnicScheduler>();
+
+    // NT 7 can run on sNICs 1 and 2, NT 8 only on sNIC 2
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        Ptr<NetworkTask> nt = CreateObject<NetworkTask>();
+        nt->SetAttribute("FpgaFabric", DoubleValue(0.5));
+        nt->SetAttribute("IngressRate", DataRateValue(DataRate("40Gbps")));
+        nt->SetAttribute("EgressRate", DataRateValue(DataRate("40Gbps")));
+        (i == 0 ? snic1 : snic2)->AddNT(nt, 7);
+    }
+    Ptr<NetworkTask> big = CreateObject<NetworkTask>();
+    big->SetAttribute("FpgaFabric", DoubleValue(0.75));
+    snic2->AddNT(big, 8);
+
+    // terminal 1 to terminal 3 goes through sNICs 1, 2 and 3
+    Ipv4Address src = interfaces.GetAddress(1);
+    Ipv4Address dst = interfaces.GetAddress(3);
+    SnicSchedulerHeader flows[5];
+    uint16_t nts[] = {7, 7, 7, 8, 5};
+    double gbps[] = {10, 10, 30, 1, 1};
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        flows[i] = SnicSchedulerHeader(src, 1000, dst, 9, 17, i);
+        flows[i].SetBandwidthDemand(gbps[i]);
+        flows[i].AddNT(nts[i]);
+    }
+
+    SnicHeader header[5];
+    NS_TEST_ASSERT_MSG_EQ(scheduler->Schedule(header[0], flows[0]), true, "flow should fit");
+    NS_TEST_ASSERT_MSG_EQ(scheduler->GetPlacement(FlowId(flows[0])),
+                          snic1->GetNode(),
+                          "first sNIC of the path should run the NT");
+    NS_TEST_ASSERT_MSG_EQ(scheduler->Schedule(header[1], flows[1]), true, "flow should fit");
+    NS_TEST_ASSERT_MSG_EQ(scheduler->GetPlacement(FlowId(flows[1])),
+                          snic1->GetNode(),
+                          "running NT should be shared");
+    NS_TEST_ASSERT_MSG_EQ(scheduler->GetRemainingResource(snic1->GetNode(), SnicScheduler::FPGA),
+                          0.5,
+                          "a shared NT takes fabric once");
+
+    // the NT on sNIC 1 only has 20Gbps left
+    NS_TEST_ASSERT_MSG_EQ(scheduler->Schedule(header[2], flows[2]), true, "flow should fit");
+    NS_TEST_ASSERT_MSG_EQ(scheduler->GetPlacement(FlowId(flows[2])),
+                          snic2->GetNode(),
+                          "a full NT should be placed again elsewhere");
+
+    // sNIC 2 has half its fabric left, too little for NT 8
+    NS_TEST_ASSERT_MSG_EQ(scheduler->Schedule(header[3], flows[3]),
+                          false,
+                          "NT should not fit on the fabric left");
+
+    // no sNIC runs NT 5, the flow only needs bandwidth
+    NS_TEST_ASSERT_MSG_EQ(scheduler->Schedule(header[4], flows[4]), true, "flow should fit");
+    NS_TEST_ASSERT_MSG_EQ(scheduler->GetPlacement(FlowId(flows[4])), nullptr, "nothing to place");
+
+    scheduler->Release(header[2], flows[2]);
+    NS_TEST_ASSERT_MSG_EQ(scheduler->GetRemainingResource(snic2->GetNode(), SnicScheduler::FPGA),
+                          1,
+                          "NT without flows should give its fabric back");
+    NS_TEST_ASSERT_MSG_EQ(scheduler->Schedule(header[3], flows[3]), true, "NT should fit now");
+    NS_TEST_ASSERT_MSG_EQ(scheduler->GetPlacement(FlowId(flows[3])), snic2->GetNode(), "wrong sNIC");
+
+    scheduler->Release(header[0], flows[0]);
+    scheduler->Release(header[1], flows[1]);
+    NS_TEST_ASSERT_MSG_EQ(scheduler->GetRemainingResource(snic1->GetNode(), SnicScheduler::INGRESS),
+                          100e9,
+                          "ingress should be given back");
+
+    scheduler->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup snic-tests
+ * Check that the placement policy picks the path of a flow and the order
+ * of a batch.
+ */
+class SnicPlacementPolicyTestCase : public TestCase
+{
+  public:
+    SnicPlacementPolicyTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+SnicPlacementPolicyTestCase::SnicPlacementPolicyTestCase()
+    : TestCase("Scheduler placement policies")
+{
+}
+
+void
+SnicPlacementPolicyTestCase::DoRun()
+{
+    RingTopologyHelper ring(5, 1, 0);
+    Ipv4InterfaceContainer interfaces = ring.GetInterfaces();
+    Ipv4Address src = interfaces.GetAddress(1);
+    Ipv4Address dst = interfaces.GetAddress(3);
+
+    // first-fit keeps taking the short way round while it has room, least
+    // loaded moves the second flow to the idle long way round
+    Ptr<SnicScheduler> firstFit = CreateObject<SnicScheduler>();
+    Ptr<SnicScheduler> leastLoaded = CreateObject<SnicScheduler>();
+    leastLoaded->SetAttribute("PlacementPolicy",
+                              PointerValue(CreateObject<SnicLeastLoadedPolicy>()));
+    for (uint64_t f = 0; f < 2; ++f)
+    {
+        SnicSchedulerHeader flow(src, 1000, dst, 9, 17, f);
+        flow.SetBandwidthDemand(20);
+        SnicHeader a;
+        SnicHeader b;
+        NS_TEST_ASSERT_MSG_EQ(firstFit->Schedule(a, flow), true, "flow should fit");
+        NS_TEST_ASSERT_MSG_EQ(leastLoaded->Schedule(b, flow), true, "flow should fit");
+        NS_TEST_ASSERT_MSG_EQ(a.GetRteNumber(), 2, "first-fit should take the short path");
+        NS_TEST_ASSERT_MSG_EQ(b.GetRteNumber(), (f == 0 ? 2 : 3), "wrong least loaded path");
+    }
+
+    // best fit packs a small flow next to a big one, leaving the long way round free
+    Ptr<SnicScheduler> bestFit = CreateObject<SnicScheduler>();
+    bestFit->SetAttribute("PlacementPolicy", PointerValue(CreateObject<SnicBestFitPolicy>()));
+    SnicSchedulerHeader big(interfaces.GetAddress(0), 1000, interfaces.GetAddress(4), 9, 17, 1);
+    big.SetBandwidthDemand(70);
+    SnicHeader bigHeader;
+    NS_TEST_ASSERT_MSG_EQ(bestFit->Schedule(bigHeader, big), true, "flow should fit");
+    SnicSchedulerHeader small(interfaces.GetAddress(0), 1000, interfaces.GetAddress(4), 9, 17, 2);
+    small.SetBandwidthDemand(20);
+    SnicHeader smallHeader;
+    NS_TEST_ASSERT_MSG_EQ(bestFit->Schedule(smallHeader, small), true, "flow should fit");
+    NS_TEST_ASSERT_MSG_EQ(smallHeader.GetRteNumber(), 1, "best fit should share the busy edge");
+
+    // the greedy batch policy serves the largest flows first
+    Ptr<SnicGreedyBatchPolicy> greedy = CreateObject<SnicGreedyBatchPolicy>();
+    std::vector<uint64_t> demands = {10, 40, 20, 40};
+    std::vector<uint32_t> order = greedy->OrderBatch(demands);
+    std::vector<uint32_t> expected = {1, 3, 2, 0};
+    NS_TEST_ASSERT_MSG_EQ((order == expected), true, "wrong batch order");
+
+    firstFit->Dispose();
+    leastLoaded->Dispose();
+    bestFit->Dispose();
+    Simulator::Destroy();
+}
+
+/**
+ * Check that SnicHeaderView reads and updates the headers in place
+ */
+class SnicHeaderViewTestCase : public TestCase
+{
+  public:
+    SnicHeaderViewTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+SnicHeaderViewTestCase::SnicHeaderViewTestCase()
+    : TestCase("Snic header view")
+{
+}
+
+void
+SnicHeaderViewTestCase::DoRun()
+{
+    SnicHeader snicHeader;
+    snicHeader.SetSourcePort(1000);
+    snicHeader.SetDestinationPort(9);
+    snicHeader.SetFlowId(42);
+    snicHeader.AddNT(7);
+    snicHeader.SetTput(12.5);
+    snicHeader.SetUseRouting(true);
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        SnicRte rte;
+        rte.SetPort(i + 1);
+        rte.SetVertices(0x100 + i, 0x200 + i);
+        snicHeader.AddRte(rte);
+    }
+    Ipv4Header ipv4Header;
+    ipv4Header.SetSource(Ipv4Address("10.1.1.1"));
+    ipv4Header.SetDestination(Ipv4Address("10.1.1.2"));
+    ipv4Header.SetPayloadSize(snicHeader.GetSerializedSize() + 100);
+
+    Ptr<Packet> packet = Create<Packet>(100);
+    packet->AddHeader(snicHeader);
+    packet->AddHeader(ipv4Header);
+    uint32_t size = packet->GetSize();
+
+    SnicHeaderView view(packet);
+    NS_TEST_ASSERT_MSG_EQ(view.GetSource(), Ipv4Address("10.1.1.1"), "wrong source");
+    NS_TEST_ASSERT_MSG_EQ(view.GetDestination(), Ipv4Address("10.1.1.2"), "wrong destination");
+    NS_TEST_ASSERT_MSG_EQ(view.GetSourcePort(), 1000, "wrong source port");
+    NS_TEST_ASSERT_MSG_EQ(view.GetDestinationPort(), 9, "wrong destination port");
+    NS_TEST_ASSERT_MSG_EQ(view.GetFlowId(), 42, "wrong flow id");
+    NS_TEST_ASSERT_MSG_EQ(view.GetNT(), 7, "wrong NT");
+    uint16_t nt = 0;
+    NS_TEST_ASSERT_MSG_EQ(SnicHeaderView::PeekNT(packet, nt), true, "NT not found");
+    NS_TEST_ASSERT_MSG_EQ(nt, 7, "wrong peeked NT");
+    Ptr<Packet> bare = Create<Packet>();
+    bare->AddHeader(ipv4Header);
+    NS_TEST_ASSERT_MSG_EQ(SnicHeaderView::PeekNT(bare, nt), false, "no SnicHeader");
+    NS_TEST_ASSERT_MSG_EQ(view.GetTput(), 12.5, "wrong tput");
+    NS_TEST_ASSERT_MSG_EQ(view.GetUseRouting(), true, "wrong use routing");
+    NS_TEST_ASSERT_MSG_EQ(view.HasSeenNic(), false, "wrong seen nic");
+    NS_TEST_ASSERT_MSG_EQ(view.GetRteNumber(), 3, "wrong number of RTEs");
+    NS_TEST_ASSERT_MSG_EQ(view.GetHop(), 0, "no RTE should be taken");
+    NS_TEST_ASSERT_MSG_EQ(view.GetRtePort(2), 3, "wrong port of the third RTE");
+
+    NS_TEST_ASSERT_MSG_EQ(view.AdvanceRte(), 0, "first RTE should be taken");
+    NS_TEST_ASSERT_MSG_EQ(view.AdvanceRte(), 1, "second RTE should be taken");
+    view.SetHasSeenNic();
+    view.Commit();
+    NS_TEST_ASSERT_MSG_EQ(packet->GetSize(), size, "commit changed the packet size");
+
+    Ipv4Header ipv4Out;
+    SnicHeader snicOut;
+    packet->RemoveHeader(ipv4Out);
+    packet->RemoveHeader(snicOut);
+    NS_TEST_ASSERT_MSG_EQ(ipv4Out.GetSource(), Ipv4Address("10.1.1.1"), "ipv4 header damaged");
+    NS_TEST_ASSERT_MSG_EQ(snicOut.HasSeenNic(), true, "seen nic not written back");
+    NS_TEST_ASSERT_MSG_EQ(snicOut.GetFlowId(), 42, "snic header damaged");
+    NS_TEST_ASSERT_MSG_EQ(snicOut.GetRteNumber(), 3, "RTEs lost");
+    NS_TEST_ASSERT_MSG_EQ(snicOut.GetHop(), 2, "hop cursor not written back");
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        NS_TEST_ASSERT_MSG_EQ(snicOut.GetRte(i).GetPort(), i + 1, "wrong RTE port");
+        NS_TEST_ASSERT_MSG_EQ(snicOut.GetRte(i).GetRVertex(), 0x200 + i, "wrong RTE vertex");
+    }
+    NS_TEST_ASSERT_MSG_EQ(packet->GetSize(), 100, "payload damaged");
+
+    // a header claiming more RTEs than a route holds is malformed
+    Ptr<Packet> bad = Create<Packet>(SnicRoute::MAX_HOPS * 14 + 100);
+    bad->AddHeader(snicHeader);
+    bad->AddHeader(ipv4Header);
+    std::vector<uint8_t> bytes(bad->GetSize());
+    bad->CopyData(bytes.data(), bytes.size());
+    bytes[ipv4Header.GetSerializedSize() + 36] = SnicRoute::MAX_HOPS + 1;
+    bad = Create<Packet>(bytes.data(), bytes.size());
+    NS_TEST_ASSERT_MSG_EQ(SnicHeaderView(bad).IsMalformed(), true, "view should be malformed");
+    bad->RemoveHeader(ipv4Out);
+    SnicHeader badHeader;
+    bad->RemoveHeader(badHeader);
+    NS_TEST_ASSERT_MSG_EQ(badHeader.IsChecksumOk(), false, "header should be malformed");
+    NS_TEST_ASSERT_MSG_EQ(badHeader.GetRteNumber(), 0, "no RTE should be read");
+
+    // a frame too short for a SnicHeader, and one whose IHL is below 5
+    Ptr<Packet> shortFrame = Create<Packet>(10);
+    shortFrame->AddHeader(ipv4Header);
+    SnicHeaderView shortView(shortFrame);
+    NS_TEST_ASSERT_MSG_EQ(shortView.IsMalformed(), true, "short frame should be malformed");
+    NS_TEST_ASSERT_MSG_EQ(shortView.GetSourcePort(), 0, "fields of a short frame read as zero");
+    std::vector<uint8_t> ihl(size);
+    Ptr<Packet> good = Create<Packet>(100);
+    good->AddHeader(snicHeader);
+    good->AddHeader(ipv4Header);
+    good->CopyData(ihl.data(), ihl.size());
+    ihl[0] = 0x42;
+    NS_TEST_ASSERT_MSG_EQ(SnicHeaderView(Create<Packet>(ihl.data(), ihl.size())).IsMalformed(),
+                          true,
+                          "bad IHL should be malformed");
+}
+
+// Two scheduler shards over a ring of 8 sNICs, 4 sNICs each
+class SnicShardedSchedulerTestCase : public TestCase
+{
+  public:
+    SnicShardedSchedulerTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+SnicShardedSchedulerTestCase::SnicShardedSchedulerTestCase()
+    : TestCase("Sharded scheduler on a ring")
+{
+}
+
+void
+SnicShardedSchedulerTestCase::DoRun()
+{
+    RingTopologyHelper ring(8, 1, 0, 2);
+    Ipv4InterfaceContainer interfaces = ring.GetInterfaces();
+    NetDeviceContainer schedulers = ring.GetSchedulers();
+    NS_TEST_ASSERT_MSG_EQ(schedulers.GetN(), 2, "one scheduler per shard");
+    Ptr<SnicScheduler> shard0 = DynamicCast<SnicNetDevice>(schedulers.Get(0))->GetScheduler();
+    Ptr<SnicScheduler> shard1 = DynamicCast<SnicNetDevice>(schedulers.Get(1))->GetScheduler();
+    NS_TEST_ASSERT_MSG_EQ(DynamicCast<SnicNetDevice>(ring.GetSnics().Get(5))->GetSchedulerAddress(),
+                          ring.GetSnicInterfaces().GetAddress(4),
+                          "sNIC 5 should use the scheduler of the second segment");
+
+    // terminal 1 to terminal 2 stays in the first segment
+    SnicHeader local;
+    SnicSchedulerHeader localFlow(interfaces.GetAddress(1), 1000, interfaces.GetAddress(2), 9, 17, 1);
+    localFlow.SetBandwidthDemand(10);
+    NS_TEST_ASSERT_MSG_EQ(shard0->Schedule(local, localFlow), true, "local flow should fit");
+    NS_TEST_ASSERT_MSG_EQ(shard0->GetNLocalAllocations(), 1, "flow should be local");
+
+    // terminal 2 to terminal 5 uses the 4 -> 5 edge owned by the second shard
+    SnicHeader cross;
+    SnicSchedulerHeader crossFlow(interfaces.GetAddress(2), 1000, interfaces.GetAddress(5), 9, 17, 2);
+    crossFlow.SetBandwidthDemand(60);
+    NS_TEST_ASSERT_MSG_EQ(shard0->Schedule(cross, crossFlow), true, "cross flow should fit");
+    NS_TEST_ASSERT_MSG_EQ(cross.GetRteNumber(), 3, "cross flow should take the shortest path");
+    NS_TEST_ASSERT_MSG_EQ(shard0->GetNCrossShardAllocations(), 1, "flow should cross shards");
+
+    // the second shard sees what the first one reserved on its edge
+    SnicHeader around;
+    SnicSchedulerHeader aroundFlow(interfaces.GetAddress(4), 1000, interfaces.GetAddress(5), 9, 17, 3);
+    aroundFlow.SetBandwidthDemand(50);
+    NS_TEST_ASSERT_MSG_EQ(shard1->Schedule(around, aroundFlow), true, "flow should fit");
+    NS_TEST_ASSERT_MSG_EQ(around.GetRteNumber(), 7, "4 -> 5 should be taken by the cross flow");
+
+    // the first shard tells which shard to retry the waiting flows of
+    std::vector<Ptr<SnicScheduler>> others = shard0->Release(cross, crossFlow);
+    NS_TEST_ASSERT_MSG_EQ(others.size(), 1, "the cross flow used edges of one other shard");
+    NS_TEST_ASSERT_MSG_EQ(others[0], shard1, "the second shard owns 4 -> 5");
+    NS_TEST_ASSERT_MSG_EQ(shard0->Release(local, localFlow).empty(), true, "flow was local");
+    SnicHeader direct;
+    SnicSchedulerHeader directFlow(interfaces.GetAddress(4), 1000, interfaces.GetAddress(5), 9, 17, 4);
+    directFlow.SetBandwidthDemand(50);
+    NS_TEST_ASSERT_MSG_EQ(shard1->Schedule(direct, directFlow), true, "flow should fit");
+    NS_TEST_ASSERT_MSG_EQ(direct.GetRteNumber(), 1, "4 -> 5 should be free again");
+
+    Simulator::Destroy();
+}
+
+// Scheduler cost accounting: traces, counters and state sizes
+class SnicSchedulerStatisticsTestCase : public TestCase
+{
+  public:
+    SnicSchedulerStatisticsTestCase();
+
+  private:
+    void DoRun() override;
+    void ScheduleDecision(Time wallClock, uint32_t nPaths, uint32_t nEdges, bool admitted);
+    void ActiveFlows(uint32_t oldValue, uint32_t newValue);
+
+    uint32_t m_decisions;
+    uint32_t m_admitted;
+    uint32_t m_paths;
+    uint32_t m_edges;
+    uint32_t m_activeFlows;
+};
+
+SnicSchedulerStatisticsTestCase::SnicSchedulerStatisticsTestCase()
+    : TestCase("Scheduler decision statistics")
+{
+}
+
+void
+SnicSchedulerStatisticsTestCase::ScheduleDecision(Time wallClock,
+                                                  uint32_t nPaths,
+                                                  uint32_t nEdges,
+                                                  bool admitted)
+{
+    m_decisions++;
+    m_admitted += admitted;
+    m_paths += nPaths;
+    m_edges += nEdges;
+}
+
+void
+SnicSchedulerStatisticsTestCase::ActiveFlows(uint32_t oldValue, uint32_t newValue)
+{
+    m_activeFlows = newValue;
+}
+
+void
+SnicSchedulerStatisticsTestCase::DoRun()
+{
+    m_decisions = 0;
+    m_admitted = 0;
+    m_paths = 0;
+    m_edges = 0;
+    m_activeFlows = 0;
+
+    RingTopologyHelper ring(5, 1, 0);
+    Ipv4InterfaceContainer interfaces = ring.GetInterfaces();
+    Ptr<SnicScheduler> scheduler = CreateObject<SnicScheduler>();
+    scheduler->TraceConnectWithoutContext(
+        "ScheduleDecision",
+        MakeCallback(&SnicSchedulerStatisticsTestCase::ScheduleDecision, this));
+    scheduler->TraceConnectWithoutContext(
+        "ActiveFlows",
+        MakeCallback(&SnicSchedulerStatisticsTestCase::ActiveFlows, this));
+
+    // terminal 1 to terminal 3, the shortest path has 2 edges
+    SnicHeader first;
+    SnicSchedulerHeader firstFlow(interfaces.GetAddress(1),
+                                  1000,
+                                  interfaces.GetAddress(3),
+                                  9,
+                                  17,
+                                  1);
+    firstFlow.SetBandwidthDemand(60);
+    NS_TEST_ASSERT_MSG_EQ(scheduler->Schedule(first, firstFlow), true, "first flow should fit");
+    NS_TEST_ASSERT_MSG_EQ(m_paths, 1, "only the shortest path is needed");
+    NS_TEST_ASSERT_MSG_EQ(m_edges, 2, "both edges of the shortest path are checked");
+
+    // the second one needs the long way round once the short one is full
+    SnicHeader second;
+    SnicSchedulerHeader secondFlow(interfaces.GetAddress(1),
+                                   1000,
+                                   interfaces.GetAddress(3),
+                                   9,
+                                   17,
+                                   2);
+    secondFlow.SetBandwidthDemand(60);
+    NS_TEST_ASSERT_MSG_EQ(scheduler->Schedule(second, secondFlow), true, "second flow should fit");
+    NS_TEST_ASSERT_MSG_EQ(m_decisions, 2, "one trace per decision");
+    NS_TEST_ASSERT_MSG_EQ(m_admitted, 2, "both flows are admitted");
+    NS_TEST_ASSERT_MSG_GT_OR_EQ(m_paths, 3, "the second flow examines both paths");
+    NS_TEST_ASSERT_MSG_EQ(m_activeFlows, 2, "two active flows");
+    NS_TEST_ASSERT_MSG_EQ(scheduler->GetNActiveFlows(), 2, "two active flows");
+    NS_TEST_ASSERT_MSG_GT(scheduler->GetPathCacheMemoryUsage(), 0, "paths are cached");
+    uint64_t flowTable = scheduler->GetFlowTableMemoryUsage();
+    NS_TEST_ASSERT_MSG_GT(flowTable, 0, "flows are held");
+
+    scheduler->Release(first, firstFlow);
+    NS_TEST_ASSERT_MSG_EQ(m_activeFlows, 1, "one active flow left");
+    NS_TEST_ASSERT_MSG_LT(scheduler->GetFlowTableMemoryUsage(), flowTable, "flow not freed");
+
+    std::ostringstream statistics;
+    scheduler->PrintStatistics(statistics);
+    NS_TEST_ASSERT_MSG_NE(statistics.str().find("schedules:2\n"),
+                          std::string::npos,
+                          "schedules missing from the report");
+    NS_TEST_ASSERT_MSG_NE(statistics.str().find("releases:1\n"),
+                          std::string::npos,
+                          "releases missing from the report");
+
+    scheduler->Dispose();
+    Simulator::Destroy();
+}
+
+// Batched scheduler headers survive serialization, routes included
+class SnicSchedulerBatchTestCase : public TestCase
+{
+  public:
+    SnicSchedulerBatchTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+SnicSchedulerBatchTestCase::SnicSchedulerBatchTestCase()
+    : TestCase("Snic scheduler header batch")
+{
+}
+
+void
+SnicSchedulerBatchTestCase::DoRun()
+{
+    SnicSchedulerHeader batch;
+    batch.SetPacketType(SnicSchedulerHeader::ALLOCATION_RESPONSE);
+    for (uint16_t f = 0; f < 3; ++f)
+    {
+        SnicSchedulerHeader flow(Ipv4Address("10.1.1.1"),
+                                 1000 + f,
+                                 Ipv4Address("10.1.1.2"),
+                                 9,
+                                 17,
+                                 100 + f);
+        flow.SetBandwidthDemand(1.5 * f);
+        batch.AddFlow(flow);
+        SnicRoute route;
+        for (uint32_t h = 0; h < f; ++h)
+        {
+            SnicRte rte;
+            rte.SetPort(h);
+            route.Add(rte);
+        }
+        batch.SetFlowRoute(f, route);
+    }
+
+    Ptr<Packet> packet = Create<Packet>();
+    packet->AddHeader(batch);
+    SnicSchedulerHeader out;
+    packet->RemoveHeader(out);
+    NS_TEST_ASSERT_MSG_EQ(packet->GetSize(), 0, "wrong serialized size");
+    NS_TEST_ASSERT_MSG_EQ(out.GetNFlows(), 3, "flows lost");
+    for (uint16_t f = 0; f < 3; ++f)
+    {
+        SnicSchedulerHeader flow = out.GetFlow(f);
+        NS_TEST_ASSERT_MSG_EQ(flow.GetPacketType(),
+                              SnicSchedulerHeader::ALLOCATION_RESPONSE,
+                              "wrong packet type");
+        NS_TEST_ASSERT_MSG_EQ(flow.GetFlowId(), (uint64_t)(100 + f), "wrong flow id");
+        NS_TEST_ASSERT_MSG_EQ(flow.GetSourcePort(), 1000 + f, "wrong source port");
+        NS_TEST_ASSERT_MSG_EQ(flow.GetDestinationIp(), Ipv4Address("10.1.1.2"), "wrong dst");
+        NS_TEST_ASSERT_MSG_EQ(flow.GetBandwidthDemand(), 1.5 * f, "wrong demand");
+        NS_TEST_ASSERT_MSG_EQ(out.GetFlowRoute(f).GetN(), f, "wrong route length");
+        if (f > 0)
+        {
+            NS_TEST_ASSERT_MSG_EQ(out.GetFlowRoute(f).Get(f - 1).GetPort(), f - 1, "wrong port");
+        }
+    }
+}
+
+// PacketBuffer flow table: full 5-tuple keys, reuse, eviction and expiry
+class PacketBufferTestCase : public TestCase
+{
+  public:
+    PacketBufferTestCase();
+
+  private:
+    void DoRun() override;
+    /// eviction callback, counts the allocations given back
+    void Released(const FlowId& flowId, uint16_t protocol);
+    /// PendingDrop trace sink
+    void PendingDrop(Ptr<const Packet> packet);
+
+    uint32_t m_released;
+    uint32_t m_pendingDrops;
+};
+
+PacketBufferTestCase::PacketBufferTestCase()
+    : TestCase("Packet buffer flow table"),
+      m_released(0),
+      m_pendingDrops(0)
+{
+}
+
+void
+PacketBufferTestCase::Released(const FlowId& flowId, uint16_t protocol)
+{
+    m_released++;
+}
+
+void
+PacketBufferTestCase::PendingDrop(Ptr<const Packet> packet)
+{
+    m_pendingDrops++;
+}
+
+void
+PacketBufferTestCase::DoRun()
+{
+    Ptr<PacketBuffer> buffer = CreateObject<PacketBuffer>();
+    buffer->SetAttribute("MaxFlows", UintegerValue(1000));
+    buffer->SetAttribute("IdleTimeout", TimeValue(Seconds(1)));
+    buffer->SetEvictionCallback(MakeCallback(&PacketBufferTestCase::Released, this));
+
+    Ipv4Address a("10.1.1.1");
+    Ipv4Address b("10.1.1.2");
+    // same flow id, different 5-tuples must be different flows
+    FlowId f1(a, 1000, b, 9, 17, 7);
+    FlowId f2(b, 1000, a, 9, 17, 7);
+    PacketBuffer::Entry* e1 = buffer->Add(f1);
+    PacketBuffer::Entry* e2 = buffer->Add(f2);
+    NS_TEST_ASSERT_MSG_NE(e1, e2, "flows sharing an id were merged");
+    NS_TEST_ASSERT_MSG_EQ(buffer->Lookup(f1), e1, "wrong entry");
+    NS_TEST_ASSERT_MSG_EQ(buffer->Lookup(f2), e2, "wrong entry");
+    NS_TEST_ASSERT_MSG_EQ(buffer->Lookup(FlowId(a, 1000, b, 9, 17, 8)), nullptr, "unknown flow");
+    NS_TEST_ASSERT_MSG_EQ(buffer->GetNHits(), 2, "wrong hit count");
+    NS_TEST_ASSERT_MSG_EQ(buffer->GetNMisses(), 1, "wrong miss count");
+
+    // deleted entries are reused
+    NS_TEST_ASSERT_MSG_EQ(buffer->Delete(f1), true, "delete failed");
+    NS_TEST_ASSERT_MSG_EQ(buffer->Delete(f1), false, "deleted twice");
+    NS_TEST_ASSERT_MSG_EQ(buffer->Add(FlowId(a, 1001, b, 9, 17, 1)), e1, "entry not reused");
+    buffer->Delete(FlowId(a, 1001, b, 9, 17, 1));
+    buffer->Delete(f2);
+    NS_TEST_ASSERT_MSG_EQ(buffer->GetNFlows(), 0, "flows left behind");
+
+    // grow well past the initial table and delete every other flow
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        buffer->Add(FlowId(a, i, b, 9, 17, i))->MarkActive();
+    }
+    for (uint32_t i = 0; i < 1000; i += 2)
+    {
+        buffer->Delete(FlowId(a, i, b, 9, 17, i));
+    }
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        bool found = buffer->Lookup(FlowId(a, i, b, 9, 17, i)) != nullptr;
+        NS_TEST_ASSERT_MSG_EQ(found, (i % 2 == 1), "wrong lookup after deletes");
+    }
+
+    // filling the table evicts instead of growing past MaxFlows
+    for (uint32_t i = 1000; i < 1600; ++i)
+    {
+        buffer->Add(FlowId(a, i, b, 9, 17, i));
+    }
+    NS_TEST_ASSERT_MSG_EQ(buffer->GetNFlows(), 1000, "MaxFlows not enforced");
+    NS_TEST_ASSERT_MSG_EQ(buffer->GetNEvictions(), 100, "wrong eviction count");
+    // waiting flows are only evicted when no active one is close by
+    NS_TEST_ASSERT_MSG_GT(m_released, 90, "allocations of evicted flows not given back");
+
+    // active flows expire once idle, flows waiting for the scheduler do not
+    Simulator::Stop(Seconds(1.5));
+    Simulator::Run();
+    uint32_t waiting = 0;
+    for (uint32_t i = 1000; i < 1600; ++i)
+    {
+        waiting += buffer->Lookup(FlowId(a, i, b, 9, 17, i)) != nullptr;
+    }
+    NS_TEST_ASSERT_MSG_EQ(buffer->GetNFlows(), waiting, "active flows did not expire");
+    NS_TEST_ASSERT_MSG_GT(waiting, 0, "waiting flows expired");
+    NS_TEST_ASSERT_MSG_EQ(m_released, 500, "allocations of expired flows not given back");
+    Simulator::Destroy();
+    buffer->Dispose();
+
+    // evicting a flow that waits for the scheduler drops its pending packets
+    Ptr<PacketBuffer> small = CreateObject<PacketBuffer>();
+    small->SetAttribute("MaxFlows", UintegerValue(1));
+    small->SetEvictionCallback(MakeCallback(&PacketBufferTestCase::Released, this));
+    small->TraceConnectWithoutContext("PendingDrop",
+                                      MakeCallback(&PacketBufferTestCase::PendingDrop, this));
+    small->Add(f1)->EnqueuePending(Create<Packet>(100));
+    small->Add(f2);
+    NS_TEST_ASSERT_MSG_EQ(small->Lookup(f1), nullptr, "flow not evicted");
+    NS_TEST_ASSERT_MSG_EQ(m_pendingDrops, 1, "pending packet dropped silently");
+    NS_TEST_ASSERT_MSG_EQ(m_released, 500, "flow without allocation given back");
+    Simulator::Destroy();
+    small->Dispose();
+}
+
+// DuplicateFilter: bounded by capacity and by the window
+class DuplicateFilterTestCase : public TestCase
+{
+  public:
+    DuplicateFilterTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+DuplicateFilterTestCase::DuplicateFilterTestCase()
+    : TestCase("Duplicate filter")
+{
+}
+
+void
+DuplicateFilterTestCase::DoRun()
+{
+    DuplicateFilter filter(4, MilliSeconds(10));
+    for (uint32_t uid = 1; uid <= 4; ++uid)
+    {
+        NS_TEST_ASSERT_MSG_EQ(filter.IsDuplicate(uid, Seconds(0)), false, "uid is new");
+    }
+    NS_TEST_ASSERT_MSG_EQ(filter.IsDuplicate(1, Seconds(0)), true, "uid was seen");
+    // a full filter forgets the oldest uid
+    NS_TEST_ASSERT_MSG_EQ(filter.IsDuplicate(5, Seconds(0)), false, "uid is new");
+    NS_TEST_ASSERT_MSG_EQ(filter.IsDuplicate(1, Seconds(0)), false, "oldest uid not forgotten");
+    NS_TEST_ASSERT_MSG_EQ(filter.IsDuplicate(5, Seconds(0)), true, "uid was seen");
+    NS_TEST_ASSERT_MSG_EQ(filter.GetSize(), 4, "filter went over its capacity");
+    NS_TEST_ASSERT_MSG_EQ(filter.GetNDuplicates(), 2, "wrong duplicate count");
+    NS_TEST_ASSERT_MSG_EQ(filter.GetNEvictions(), 2, "wrong eviction count");
+    // uids older than the window are forgotten
+    NS_TEST_ASSERT_MSG_EQ(filter.IsDuplicate(5, MilliSeconds(9)), true, "uid was seen");
+    NS_TEST_ASSERT_MSG_EQ(filter.IsDuplicate(5, MilliSeconds(10)), false, "uid not expired");
+    NS_TEST_ASSERT_MSG_EQ(filter.GetSize(), 1, "expired uids left behind");
+
+    // against a plain model, with uids colliding in the hash table
+    DuplicateFilter big(1000);
+    std::deque<uint32_t> order;
+    std::set<uint32_t> seen;
+    uint32_t x = 1;
+    for (uint32_t i = 0; i < 20000; ++i)
+    {
+        x = x * 1103515245 + 12345;
+        uint32_t uid = (x >> 16) % 3000;
+        bool expected = seen.count(uid) > 0;
+        if (!expected)
+        {
+            if (order.size() == 1000)
+            {
+                seen.erase(order.front());
+                order.pop_front();
+            }
+            order.push_back(uid);
+            seen.insert(uid);
+        }
+        if (big.IsDuplicate(uid, Seconds(0)) != expected)
+        {
+            NS_TEST_ASSERT_MSG_EQ(!expected, expected, "wrong answer for uid " << uid);
+            break;
+        }
+    }
+    NS_TEST_ASSERT_MSG_EQ(big.GetSize(), 1000, "wrong size");
+}
+
+// SnicNetDevice broadcast filter: sized from its attributes, drops the copies
+class SnicBroadcastFilterTestCase : public TestCase
+{
+  public:
+    SnicBroadcastFilterTestCase();
+
+  private:
+    void DoRun() override;
+    void Send(Ptr<Socket> socket, uint64_t flowId);
+};
+
+SnicBroadcastFilterTestCase::SnicBroadcastFilterTestCase()
+    : TestCase("Snic broadcast filter")
+{
+}
+
+void
+SnicBroadcastFilterTestCase::Send(Ptr<Socket> socket, uint64_t flowId)
+{
+    Ptr<Packet> p = Create<Packet>(450);
+    SnicHeader header;
+    header.SetFlowId(flowId);
+    header.SetNewFlow(true);
+    header.SetIsLastInFlow(true);
+    header.SetTput(1);
+    p->AddHeader(header);
+    socket->Send(p);
+}
+
+void
+SnicBroadcastFilterTestCase::DoRun()
+{
+    RingTopologyHelper ring(4, 1, 0);
+    Ipv4InterfaceContainer interfaces = ring.GetInterfaces();
+    Ptr<SnicNetDevice> clientSnic = DynamicCast<SnicNetDevice>(ring.GetSnics().Get(1));
+    Ptr<SnicNetDevice> smallSnic = DynamicCast<SnicNetDevice>(ring.GetSnics().Get(3));
+    smallSnic->SetAttribute("BroadcastFilterSize", UintegerValue(1));
+
+    // an ARP request from terminal 1 for every other terminal
+    TypeId tid = TypeId::LookupByName("ns3::SnicSocketFactory");
+    for (uint32_t t = 0; t < 4; ++t)
+    {
+        if (t == 1)
+        {
+            continue;
+        }
+        Ptr<Socket> client = Socket::CreateSocket(ring.GetTerminals().Get(1), tid);
+        client->Bind();
+        client->Connect(InetSocketAddress(interfaces.GetAddress(t), 9));
+        Simulator::Schedule(Seconds(1), &SnicBroadcastFilterTestCase::Send, this, client, t);
+    }
+    Simulator::Stop(Seconds(2));
+    Simulator::Run();
+
+    // the requests come back around the ring, the default filter holds them all
+    NS_TEST_ASSERT_MSG_GT(clientSnic->GetNSuppressedBroadcasts(), 0, "broadcasts not suppressed");
+    NS_TEST_ASSERT_MSG_EQ(clientSnic->GetNBroadcastFilterEvictions(), 0, "filter too small");
+    // a filter of one packet forgets a request as soon as the next one comes
+    NS_TEST_ASSERT_MSG_GT(smallSnic->GetNBroadcastFilterEvictions(), 0, "filter not resized");
+    Simulator::Destroy();
+}
+
+// ArrivalTrace: text conversion, shared mapping and replay with offsets
+class ArrivalTraceTestCase : public TestCase
+{
+  public:
+    ArrivalTraceTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+ArrivalTraceTestCase::ArrivalTraceTestCase()
+    : TestCase("Arrival trace")
+{
+}
+
+void
+ArrivalTraceTestCase::DoRun()
+{
+    std::string text = CreateTempDirFilename("trace.txt");
+    std::ofstream file(text);
+    file << "1000\n" << 500 << "\n";
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        file << i + 1 << "\n";
+    }
+    file.close();
+
+    NS_TEST_ASSERT_MSG_EQ(ArrivalTrace::IsBinary(text), false, "text trace taken as binary");
+    Ptr<ArrivalTrace> trace = ArrivalTrace::Open(text);
+    NS_TEST_ASSERT_MSG_EQ(trace->GetFileName(), text + ".bin", "text trace not converted");
+    NS_TEST_ASSERT_MSG_EQ(ArrivalTrace::IsBinary(text + ".bin"), true, "bad binary trace");
+    NS_TEST_ASSERT_MSG_EQ(trace->GetNIntervals(), 1000, "wrong number of intervals");
+    NS_TEST_ASSERT_MSG_EQ_TOL(trace->GetAverage(), 500.5, 1e-9, "wrong average");
+    NS_TEST_ASSERT_MSG_EQ(trace->GetInterval(0), 1, "wrong first interval");
+    NS_TEST_ASSERT_MSG_EQ(trace->GetInterval(999), 1000, "wrong last interval");
+    // the mapping is shared while in use
+    NS_TEST_ASSERT_MSG_EQ(ArrivalTrace::Open(text), trace, "trace mapped twice");
+    NS_TEST_ASSERT_MSG_EQ(ArrivalTrace::Open(text + ".bin"), trace, "trace mapped twice");
+
+    Ptr<PacketArrivalRateTraceGen> first = CreateObject<PacketArrivalRateTraceGen>();
+    first->SetTrace(trace);
+    Ptr<PacketArrivalRateTraceGen> second = CreateObject<PacketArrivalRateTraceGen>();
+    second->SetAttribute("FileName", StringValue(text));
+    second->SetAttribute("Offset", UintegerValue(2998));
+    NS_TEST_ASSERT_MSG_EQ(second->GetTrace(), trace, "trace mapped twice");
+    NS_TEST_ASSERT_MSG_EQ(first->NextInterval(), NanoSeconds(1), "wrong interval");
+    NS_TEST_ASSERT_MSG_EQ(first->NextInterval(), NanoSeconds(2), "wrong interval");
+    // the offset is taken modulo the trace and the replay wraps around
+    NS_TEST_ASSERT_MSG_EQ(second->NextInterval(), NanoSeconds(999), "wrong offset");
+    NS_TEST_ASSERT_MSG_EQ(second->NextInterval(), NanoSeconds(1000), "wrong interval");
+    NS_TEST_ASSERT_MSG_EQ(second->NextInterval(), NanoSeconds(1), "did not loop");
+
+    // a trace rewritten within the same second is converted again
+    file.open(text);
+    file << "2\n" << 7 << "\n" << 5 << "\n" << 9 << "\n";
+    file.close();
+    Ptr<ArrivalTrace> rewritten = ArrivalTrace::Open(text);
+    NS_TEST_ASSERT_MSG_NE(rewritten, trace, "stale trace kept");
+    NS_TEST_ASSERT_MSG_EQ(rewritten->GetNIntervals(), 2, "stale binary trace");
+    NS_TEST_ASSERT_MSG_EQ(rewritten->GetInterval(1), 9, "wrong interval");
+    NS_TEST_ASSERT_MSG_EQ(ArrivalTrace::Open(text), rewritten, "trace mapped twice");
+    // the users of the old trace keep its mapping
+    NS_TEST_ASSERT_MSG_EQ(trace->GetInterval(999), 1000, "old mapping changed");
+}
+
+// Cluster topologies: sizes, ports and shortest paths seen by the scheduler
+class ClusterTopologyTestCase : public TestCase
+{
+  public:
+    ClusterTopologyTestCase();
+
+  private:
+    void DoRun() override;
+    /// \return the number of sNIC hops the scheduler gives a flow
+    uint32_t GetHops(const ClusterTopologyHelper& cluster, uint32_t src, uint32_t dst);
+};
+
+ClusterTopologyTestCase::ClusterTopologyTestCase()
+    : TestCase("Fat-tree, leaf-spine and torus topologies")
+{
+}
+
+uint32_t
+ClusterTopologyTestCase::GetHops(const ClusterTopologyHelper& cluster, uint32_t src, uint32_t dst)
+{
+    Ipv4InterfaceContainer interfaces = cluster.GetInterfaces();
+    Ptr<SnicScheduler> scheduler = CreateObject<SnicScheduler>();
+    SnicHeader snicHeader;
+    SnicSchedulerHeader schedHeader(interfaces.GetAddress(src),
+                                    1000,
+                                    interfaces.GetAddress(dst),
+                                    9,
+                                    17,
+                                    1);
+    schedHeader.SetBandwidthDemand(1);
+    NS_TEST_EXPECT_MSG_EQ(scheduler->Schedule(snicHeader, schedHeader), true, "flow should fit");
+    scheduler->Dispose();
+    return snicHeader.GetRteNumber();
+}
+
+void
+ClusterTopologyTestCase::DoRun()
+{
+    {
+        FatTreeTopologyHelper fatTree(4);
+        NS_TEST_ASSERT_MSG_EQ(fatTree.GetSnics().GetN(), 20, "wrong number of sNICs");
+        NS_TEST_ASSERT_MSG_EQ(fatTree.GetTerminals().GetN(), 16, "wrong number of hosts");
+        NS_TEST_ASSERT_MSG_EQ(fatTree.GetNLinks(), 32, "wrong number of links");
+        NS_TEST_ASSERT_MSG_EQ(fatTree.GetInterfaces().GetN(), 16, "hosts without address");
+        NS_TEST_ASSERT_MSG_EQ(fatTree.GetSnicInterfaces().GetN(), 20, "sNICs without address");
+        // every switch of a fat-tree has k ports
+        for (uint32_t i = 0; i < fatTree.GetSnics().GetN(); ++i)
+        {
+            Ptr<SnicNetDevice> snic = DynamicCast<SnicNetDevice>(fatTree.GetSnics().Get(i));
+            NS_TEST_ASSERT_MSG_EQ(snic->GetNSnicPorts(), 4, "wrong number of ports");
+        }
+        NS_TEST_ASSERT_MSG_EQ(fatTree.GetCoreIndex(3), 19, "wrong core index");
+        // hosts 0 and 2 are under two edges of the first pod, 15 in the last pod
+        NS_TEST_ASSERT_MSG_EQ(GetHops(fatTree, 2, 0), 2, "edge, aggregation, edge");
+        NS_TEST_ASSERT_MSG_EQ(GetHops(fatTree, 15, 0), 4, "up to a core and down");
+        Simulator::Destroy();
+    }
+    {
+        LeafSpineTopologyHelper leafSpine(3, 2, 2);
+        NS_TEST_ASSERT_MSG_EQ(leafSpine.GetSnics().GetN(), 5, "wrong number of sNICs");
+        NS_TEST_ASSERT_MSG_EQ(leafSpine.GetTerminals().GetN(), 6, "wrong number of hosts");
+        NS_TEST_ASSERT_MSG_EQ(leafSpine.GetNLinks(), 6, "wrong number of links");
+        Ptr<SnicNetDevice> spine =
+            DynamicCast<SnicNetDevice>(leafSpine.GetSnics().Get(leafSpine.GetSpineIndex(1)));
+        NS_TEST_ASSERT_MSG_EQ(spine->GetNSnicPorts(), 3, "a spine links every leaf");
+        NS_TEST_ASSERT_MSG_EQ(GetHops(leafSpine, 5, 0), 2, "leaf, spine, leaf");
+        Simulator::Destroy();
+    }
+    {
+        TorusTopologyHelper torus(3, 4, 1);
+        NS_TEST_ASSERT_MSG_EQ(torus.GetSnics().GetN(), 12, "wrong number of sNICs");
+        NS_TEST_ASSERT_MSG_EQ(torus.GetNLinks(), 24, "wrong number of links");
+        Ptr<SnicNetDevice> snic = DynamicCast<SnicNetDevice>(torus.GetSnics().Get(0));
+        NS_TEST_ASSERT_MSG_EQ(snic->GetNSnicPorts(), 5, "one host and four neighbours");
+        NS_TEST_ASSERT_MSG_EQ(GetHops(torus, torus.GetIndex(1, 2), 0), 3, "wrong torus path");
+        NS_TEST_ASSERT_MSG_EQ(GetHops(torus, torus.GetIndex(2, 3), 0), 2, "did not wrap round");
+        Simulator::Destroy();
+    }
+    {
+        // a dimension of 2 has a single link
+        TorusTopologyHelper torus(1, 2, 1);
+        NS_TEST_ASSERT_MSG_EQ(torus.GetNLinks(), 1, "linked twice");
+        Simulator::Destroy();
+    }
+}
+
+class SnicPipelineTestCase : public TestCase
+{
+  public:
+    SnicPipelineTestCase();
+
+  private:
+    void DoRun() override;
+
+    bool Receive(Ptr<NetDevice> device,
+                 Ptr<const Packet> packet,
+                 uint16_t protocol,
+                 const Address& from);
+    void QueueingDelay(uint32_t nt, Time delay);
+    void Occupancy(uint32_t oldValue, uint32_t newValue);
+    void Drop(Ptr<const Packet> packet);
+
+    std::vector<Time> m_received;
+    std::vector<Time> m_delays;
+    uint32_t m_maxOccupancy;
+    uint32_t m_drops;
+};
+
+SnicPipelineTestCase::SnicPipelineTestCase()
+    : TestCase("Snic processing pipeline"),
+      m_maxOccupancy(0),
+      m_drops(0)
+{
+}
+
+bool
+SnicPipelineTestCase::Receive(Ptr<NetDevice> device,
+                              Ptr<const Packet> packet,
+                              uint16_t protocol,
+                              const Address& from)
+{
+    m_received.push_back(Simulator::Now());
+    return true;
+}
+
+void
+SnicPipelineTestCase::QueueingDelay(uint32_t nt, Time delay)
+{
+    m_delays.push_back(delay);
+}
+
+void
+SnicPipelineTestCase::Occupancy(uint32_t oldValue, uint32_t newValue)
+{
+    m_maxOccupancy = std::max(m_maxOccupancy, newValue);
+}
+
+void
+SnicPipelineTestCase::Drop(Ptr<const Packet> packet)
+{
+    m_drops++;
+}
+
+void
+SnicPipelineTestCase::DoRun()
+{
+    NodeContainer nodes;
+    nodes.Create(2);
+    SimpleNetDeviceHelper simple;
+    NetDeviceContainer devices = simple.Install(nodes);
+    devices.Get(1)->SetReceiveCallback(MakeCallback(&SnicPipelineTestCase::Receive, this));
+
+    // 1000 bytes at 8Gbps keep the ingress busy for 1us
+    Ptr<SnicNetDevice> snic = CreateObject<SnicNetDevice>();
+    nodes.Get(0)->AddDevice(snic);
+    snic->AddSnicPort(devices.Get(0));
+    snic->SetAttribute("PipelineSize", UintegerValue(2));
+    snic->SetAttribute("PipelineDelay", TimeValue(NanoSeconds(100)));
+    snic->SetAttribute("PipelineRate", DataRateValue(DataRate("8Gbps")));
+    snic->SetAttribute("PipelineQueueSize", UintegerValue(3));
+    snic->TraceConnectWithoutContext("QueueingDelay",
+                                     MakeCallback(&SnicPipelineTestCase::QueueingDelay, this));
+    snic->TraceConnectWithoutContext("PipelineOccupancy",
+                                     MakeCallback(&SnicPipelineTestCase::Occupancy, this));
+    snic->TraceConnectWithoutContext("PipelineDrop",
+                                     MakeCallback(&SnicPipelineTestCase::Drop, this));
+
+    // two packets fill the pipeline, three wait and the last one is dropped
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        snic->SendFrom(Create<Packet>(1000),
+                       devices.Get(0)->GetAddress(),
+                       devices.Get(1)->GetAddress(),
+                       0x88b5);
+    }
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_drops, 1, "wrong number of drops");
+    NS_TEST_ASSERT_MSG_EQ(m_maxOccupancy, 2, "pipeline went over its size");
+    NS_TEST_ASSERT_MSG_EQ(m_received.size(), 5, "wrong number of packets sent");
+    NS_TEST_ASSERT_MSG_EQ(m_delays.size(), 5, "wrong number of queueing delays");
+    for (uint32_t i = 0; i < m_received.size() && i < m_delays.size(); ++i)
+    {
+        // the ingress rate sets the throughput once the queue builds up
+        NS_TEST_ASSERT_MSG_EQ(m_received[i], NanoSeconds(1000 * (i + 1) + 100), "wrong send time");
+        NS_TEST_ASSERT_MSG_EQ(m_delays[i], MicroSeconds(i), "wrong queueing delay");
+    }
+    Simulator::Destroy();
+    snic->Dispose();
+}
+
+/**
+ * \ingroup snic-tests
+ * Check that flows the scheduler has no room for wait for a release, and
+ * that flows it turns down, or that don't fit in their pending queue, go to
+ * their host without offload or are dropped.
+ */
+class SnicAdmissionTestCase : public TestCase
+{
+  public:
+    SnicAdmissionTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Send 20 two packet flows from terminal 1 to terminal 0 of a ring where
+     * every path has blockerGbps taken by flows that are never released.
+     */
+    void RunFlows(double blockerGbps, uint32_t queueSize, bool fallback, uint32_t pendingSize);
+    void Send(Ptr<Socket> socket, uint32_t n);
+    void Receive(Ptr<Socket> socket);
+    void AdmissionReject(const FlowId& flowId);
+    void AdmissionQueueDelay(Time delay);
+    void FlowRejected(const FlowId& flowId);
+    void Drop(Ptr<const Packet> packet);
+
+    uint32_t m_received;
+    uint32_t m_admissionRejects;
+    uint32_t m_queueDelays;
+    uint32_t m_flowRejects;
+    uint32_t m_drops;
+    bool m_leaked; //!< bandwidth not given back once the flows are done
+};
+
+SnicAdmissionTestCase::SnicAdmissionTestCase()
+    : TestCase("Snic admission queue and flow rejection")
+{
+}
+
+void
+SnicAdmissionTestCase::Send(Ptr<Socket> socket, uint32_t n)
+{
+    Ptr<Packet> p = Create<Packet>(450);
+    SnicHeader header;
+    // the first packet of every flow, then the last one of every flow
+    header.SetFlowId(n % 20);
+    header.SetNewFlow(n < 20);
+    header.SetIsLastInFlow(n >= 20);
+    header.SetTput(20.56);
+    p->AddHeader(header);
+    socket->Send(p);
+}
+
+void
+SnicAdmissionTestCase::Receive(Ptr<Socket> socket)
+{
+    while (socket->Recv())
+    {
+        m_received++;
+    }
+}
+
+void
+SnicAdmissionTestCase::AdmissionReject(const FlowId& flowId)
+{
+    m_admissionRejects++;
+}
+
+void
+SnicAdmissionTestCase::AdmissionQueueDelay(Time delay)
+{
+    m_queueDelays++;
+}
+
+void
+SnicAdmissionTestCase::FlowRejected(const FlowId& flowId)
+{
+    m_flowRejects++;
+}
+
+void
+SnicAdmissionTestCase::Drop(Ptr<const Packet> packet)
+{
+    m_drops++;
+}
+
+void
+SnicAdmissionTestCase::RunFlows(double blockerGbps,
+                                uint32_t queueSize,
+                                bool fallback,
+                                uint32_t pendingSize)
+{
+    m_received = 0;
+    m_admissionRejects = 0;
+    m_queueDelays = 0;
+    m_flowRejects = 0;
+    m_drops = 0;
+
+    RingTopologyHelper ring(4, 1, 0);
+    Ipv4InterfaceContainer interfaces = ring.GetInterfaces();
+    Ptr<SnicNetDevice> schedulerSnic = DynamicCast<SnicNetDevice>(ring.GetSchedulers().Get(0));
+    Ptr<SnicNetDevice> clientSnic = DynamicCast<SnicNetDevice>(ring.GetSnics().Get(1));
+    Ptr<SnicScheduler> scheduler = schedulerSnic->GetScheduler();
+    schedulerSnic->SetAttribute("AdmissionQueueSize", UintegerValue(queueSize));
+    schedulerSnic->SetAttribute("AdmissionQueueTimeout", TimeValue(MicroSeconds(10)));
+    clientSnic->SetAttribute("FallbackToHost", BooleanValue(fallback));
+    PointerValue buffer;
+    clientSnic->GetAttribute("PacketBuffer", buffer);
+    buffer.Get<PacketBuffer>()->SetAttribute("PendingQueueSize", UintegerValue(pendingSize));
+
+    // one blocker on each of the two ways round the ring
+    for (uint64_t id = 100; id < 102; ++id)
+    {
+        SnicHeader snicHeader;
+        SnicSchedulerHeader blocker(interfaces.GetAddress(1),
+                                    2000,
+                                    interfaces.GetAddress(0),
+                                    9,
+                                    17,
+                                    id);
+        blocker.SetBandwidthDemand(blockerGbps);
+        NS_TEST_ASSERT_MSG_EQ(scheduler->Schedule(snicHeader, blocker), true, "blocker should fit");
+    }
+    std::vector<uint64_t> remaining;
+    for (uint32_t e = 0; e < scheduler->GetNEdges(); ++e)
+    {
+        remaining.push_back(scheduler->GetRemainingBandwidth(e));
+    }
+
+    schedulerSnic->TraceConnectWithoutContext(
+        "AdmissionReject",
+        MakeCallback(&SnicAdmissionTestCase::AdmissionReject, this));
+    schedulerSnic->TraceConnectWithoutContext(
+        "AdmissionQueueDelay",
+        MakeCallback(&SnicAdmissionTestCase::AdmissionQueueDelay, this));
+    clientSnic->TraceConnectWithoutContext(
+        "FlowRejected",
+        MakeCallback(&SnicAdmissionTestCase::FlowRejected, this));
+    clientSnic->TraceConnectWithoutContext("OffloadDrop",
+                                           MakeCallback(&SnicAdmissionTestCase::Drop, this));
+
+    TypeId tid = TypeId::LookupByName("ns3::SnicSocketFactory");
+    Ptr<Socket> server = Socket::CreateSocket(ring.GetTerminals().Get(0), tid);
+    server->Bind(InetSocketAddress(Ipv4Address::GetAny(), 9));
+    server->SetRecvCallback(MakeCallback(&SnicAdmissionTestCase::Receive, this));
+    Ptr<Socket> client = Socket::CreateSocket(ring.GetTerminals().Get(1), tid);
+    client->Bind();
+    client->Connect(InetSocketAddress(interfaces.GetAddress(0), 9));
+
+    // all the flows ask for an allocation before the first one is admitted
+    for (uint32_t n = 0; n < 40; ++n)
+    {
+        Simulator::Schedule(Seconds(1) + NanoSeconds(4 * n),
+                            &SnicAdmissionTestCase::Send,
+                            this,
+                            client,
+                            n);
+    }
+    Simulator::Stop(Seconds(2));
+    Simulator::Run();
+
+    m_leaked = false;
+    for (uint32_t e = 0; e < scheduler->GetNEdges(); ++e)
+    {
+        m_leaked = m_leaked || scheduler->GetRemainingBandwidth(e) != remaining[e];
+    }
+    Simulator::Destroy();
+}
+
+void
+SnicAdmissionTestCase::DoRun()
+{
+    // the flows start before ARP is resolved
+    Config::SetDefault("ns3::ArpCache::PendingQueueSize", UintegerValue(64));
+
+    // 30Gbps left on each way round: two flows at a time, the others wait
+    RunFlows(70, 1024, true, 1900);
+    NS_TEST_ASSERT_MSG_EQ(m_received, 40, "packets were lost");
+    NS_TEST_ASSERT_MSG_EQ(m_admissionRejects, 0, "no flow should be rejected");
+    NS_TEST_ASSERT_MSG_GT(m_queueDelays, 0, "no flow waited for a release");
+    NS_TEST_ASSERT_MSG_EQ(m_leaked, false, "bandwidth was not given back");
+
+    // no room at all: every flow is rejected once it waited 10us and its
+    // packets go to the host without offload
+    RunFlows(90, 1024, true, 1900);
+    NS_TEST_ASSERT_MSG_EQ(m_received, 40, "rejected flows did not fall back to the host");
+    NS_TEST_ASSERT_MSG_EQ(m_admissionRejects, 20, "wrong number of rejections");
+    NS_TEST_ASSERT_MSG_EQ(m_flowRejects, 20, "the sNIC did not see every rejection");
+    NS_TEST_ASSERT_MSG_EQ(m_queueDelays, 0, "no flow should be admitted");
+    NS_TEST_ASSERT_MSG_EQ(m_leaked, false, "bandwidth was taken by rejected flows");
+
+    // without a queue flows are rejected at once, and without fallback their
+    // packets are dropped
+    RunFlows(90, 0, false, 1900);
+    NS_TEST_ASSERT_MSG_EQ(m_received, 0, "packets of rejected flows were delivered");
+    NS_TEST_ASSERT_MSG_EQ(m_admissionRejects, 20, "wrong number of rejections");
+    NS_TEST_ASSERT_MSG_EQ(m_drops, 40, "wrong number of drops");
+
+    // with a pending queue of one packet, flows still waiting when their
+    // last packet comes lose the first one, the last one waits so that the
+    // flow is released
+    RunFlows(70, 1024, false, 1);
+    NS_TEST_ASSERT_MSG_GT(m_drops, 0, "no pending queue overflowed");
+    NS_TEST_ASSERT_MSG_EQ(m_received + m_drops, 40, "packets were lost");
+    NS_TEST_ASSERT_MSG_EQ(m_leaked, false, "bandwidth was not given back");
+
+    Config::Reset();
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -59,6 +1464,20 @@ SnicTestSuite::SnicTestSuite()
 {
     // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
     AddTestCase(new SnicTestCase1, TestCase::QUICK);
+    AddTestCase(new SnicSchedulerPathTestCase, TestCase::QUICK);
+    AddTestCase(new SnicSchedulerPlacementTestCase, TestCase::QUICK);
+    AddTestCase(new SnicPlacementPolicyTestCase, TestCase::QUICK);
+    AddTestCase(new SnicHeaderViewTestCase, TestCase::QUICK);
+    AddTestCase(new SnicShardedSchedulerTestCase, TestCase::QUICK);
+    AddTestCase(new SnicSchedulerStatisticsTestCase, TestCase::QUICK);
+    AddTestCase(new SnicSchedulerBatchTestCase, TestCase::QUICK);
+    AddTestCase(new PacketBufferTestCase, TestCase::QUICK);
+    AddTestCase(new DuplicateFilterTestCase, TestCase::QUICK);
+    AddTestCase(new SnicBroadcastFilterTestCase, TestCase::QUICK);
+    AddTestCase(new ArrivalTraceTestCase, TestCase::QUICK);
+    AddTestCase(new ClusterTopologyTestCase, TestCase::QUICK);
+    AddTestCase(new SnicPipelineTestCase, TestCase::QUICK);
+    AddTestCase(new SnicAdmissionTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
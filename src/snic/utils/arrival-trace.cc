@@ -0,0 +1,302 @@
+#include "arrival-trace.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ArrivalTrace");
+
+static const char TRACE_MAGIC[8] = {'S', 'N', 'I', 'C', 'A', 'R', 'R', 'V'};
+static const uint32_t TRACE_VERSION = 2;
+
+/// the traces mapped, by binary file name, removed when the last user goes
+static std::map<std::string, ArrivalTrace*>&
+GetMappedTraces()
+{
+    static std::map<std::string, ArrivalTrace*> traces;
+    return traces;
+}
+
+/**
+ * \param fileName a text trace
+ * \param size set to the size of the file
+ * \param mtime set to the modification time of the file, in nanoseconds
+ * \return false if the file cannot be found
+ */
+static bool
+GetSourceStatus(std::string fileName, uint64_t* size, int64_t* mtime)
+{
+    struct stat info;
+    if (stat(fileName.c_str(), &info) != 0)
+    {
+        return false;
+    }
+    *size = info.st_size;
+    *mtime = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+    return true;
+}
+
+/**
+ * \param fileName a text trace
+ * \return the binary trace it is converted to when its own directory is read-only
+ */
+static std::string
+GetTemporaryFileName(std::string fileName)
+{
+    const char* path = std::getenv("TMP");
+    if (!path || std::strlen(path) == 0)
+    {
+        path = std::getenv("TEMP");
+        if (!path || std::strlen(path) == 0)
+        {
+            path = "/tmp";
+        }
+    }
+    char* absolute = realpath(fileName.c_str(), nullptr);
+    std::string name = absolute ? absolute : fileName;
+    std::free(absolute);
+    std::ostringstream oss;
+    oss << path << "/snic-arrival-" << std::hex << std::hash<std::string>()(name) << ".bin";
+    return oss.str();
+}
+
+Ptr<ArrivalTrace>
+ArrivalTrace::Open(std::string fileName)
+{
+    NS_LOG_FUNCTION(fileName);
+    std::string binaryFileName = fileName;
+    bool converted = false;
+    if (!IsBinary(fileName))
+    {
+        uint64_t size;
+        int64_t mtime;
+        NS_ABORT_MSG_IF(!GetSourceStatus(fileName, &size, &mtime),
+                        "cannot open trace " << fileName);
+        binaryFileName = fileName + ".bin";
+        if (!IsConvertedFrom(binaryFileName, size, mtime))
+        {
+            std::string temporaryFileName = GetTemporaryFileName(fileName);
+            uint64_t count;
+            if (IsConvertedFrom(temporaryFileName, size, mtime))
+            {
+                binaryFileName = temporaryFileName;
+            }
+            else
+            {
+                NS_LOG_INFO("converting " << fileName << " to " << binaryFileName);
+                if (!Write(fileName, binaryFileName, &count))
+                {
+                    // the directory of the trace may be read-only
+                    NS_LOG_WARN("cannot write " << binaryFileName << ", converting " << fileName
+                                                << " to " << temporaryFileName);
+                    binaryFileName = temporaryFileName;
+                    NS_ABORT_MSG_IF(!Write(fileName, binaryFileName, &count),
+                                    "cannot write trace " << binaryFileName);
+                }
+                converted = true;
+            }
+        }
+    }
+
+    std::map<std::string, ArrivalTrace*>& traces = GetMappedTraces();
+    auto iter = traces.find(binaryFileName);
+    // the users of a trace converted again keep the mapping of the old one
+    if (iter != traces.end() && !converted)
+    {
+        return Ptr<ArrivalTrace>(iter->second);
+    }
+    Ptr<ArrivalTrace> trace = Ptr<ArrivalTrace>(new ArrivalTrace(binaryFileName), false);
+    traces[binaryFileName] = PeekPointer(trace);
+    return trace;
+}
+
+uint64_t
+ArrivalTrace::Convert(std::string textFileName, std::string binaryFileName)
+{
+    NS_LOG_FUNCTION(textFileName << binaryFileName);
+    uint64_t count;
+    NS_ABORT_MSG_IF(!Write(textFileName, binaryFileName, &count),
+                    "cannot write trace " << binaryFileName);
+    return count;
+}
+
+bool
+ArrivalTrace::Write(std::string textFileName, std::string binaryFileName, uint64_t* count)
+{
+    NS_LOG_FUNCTION(textFileName << binaryFileName);
+    FileHeader header;
+    std::memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    header.reserved = 0;
+    header.count = 0;
+    header.average = 0;
+    // taken before reading, a trace changed meanwhile is converted again
+    NS_ABORT_MSG_IF(!GetSourceStatus(textFileName, &header.sourceSize, &header.sourceMtime),
+                    "cannot open trace " << textFileName);
+    std::ifstream text(textFileName);
+    NS_ABORT_MSG_IF(!text, "cannot open trace " << textFileName);
+
+    // written next to the trace and renamed into place, so that no reader maps it half written
+    std::string temporaryFileName = binaryFileName + ".tmp." + std::to_string(getpid());
+    std::ofstream binary(temporaryFileName, std::ofstream::binary | std::ofstream::trunc);
+    if (!binary)
+    {
+        return false;
+    }
+    // the header is written again once the intervals are counted
+    binary.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // skip the count and the average, they are recomputed
+    std::string line;
+    std::getline(text, line);
+    std::getline(text, line);
+
+    std::vector<uint32_t> block;
+    block.reserve(1 << 16);
+    long double sum = 0;
+    while (std::getline(text, line))
+    {
+        if (line.empty())
+        {
+            continue;
+        }
+        char* end;
+        errno = 0;
+        unsigned long interval = std::strtoul(line.c_str(), &end, 10);
+        if (end == line.c_str() || errno == ERANGE || interval > UINT32_MAX)
+        {
+            binary.close();
+            std::remove(temporaryFileName.c_str());
+            NS_ABORT_MSG("bad interval in " << textFileName << ": " << line);
+        }
+        block.push_back(interval);
+        sum += interval;
+        if (block.size() == block.capacity())
+        {
+            binary.write(reinterpret_cast<const char*>(block.data()),
+                         block.size() * sizeof(uint32_t));
+            header.count += block.size();
+            block.clear();
+        }
+    }
+    binary.write(reinterpret_cast<const char*>(block.data()), block.size() * sizeof(uint32_t));
+    header.count += block.size();
+
+    header.average = header.count > 0 ? sum / header.count : 0;
+    binary.seekp(0);
+    binary.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    binary.close();
+    if (!binary || std::rename(temporaryFileName.c_str(), binaryFileName.c_str()) != 0)
+    {
+        std::remove(temporaryFileName.c_str());
+        return false;
+    }
+    *count = header.count;
+    return true;
+}
+
+bool
+ArrivalTrace::IsConvertedFrom(std::string binaryFileName, uint64_t size, int64_t mtime)
+{
+    std::ifstream file(binaryFileName, std::ifstream::binary);
+    FileHeader header;
+    return file.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+           std::memcmp(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) == 0 &&
+           header.version == TRACE_VERSION && header.sourceSize == size &&
+           header.sourceMtime == mtime;
+}
+
+bool
+ArrivalTrace::IsBinary(std::string fileName)
+{
+    std::ifstream file(fileName, std::ifstream::binary);
+    char magic[sizeof(TRACE_MAGIC)];
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, TRACE_MAGIC, sizeof(magic)) == 0;
+}
+
+ArrivalTrace::ArrivalTrace(std::string fileName)
+    : m_fileName(fileName)
+{
+    NS_LOG_FUNCTION(this << fileName);
+    int fd = open(fileName.c_str(), O_RDONLY);
+    NS_ABORT_MSG_IF(fd < 0, "cannot open trace " << fileName);
+    struct stat info;
+    NS_ABORT_MSG_IF(fstat(fd, &info) != 0, "cannot stat trace " << fileName);
+    m_length = info.st_size;
+    NS_ABORT_MSG_IF(m_length < sizeof(FileHeader), "truncated trace " << fileName);
+    m_base = mmap(nullptr, m_length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    NS_ABORT_MSG_IF(m_base == MAP_FAILED, "cannot map trace " << fileName);
+    // generators mostly walk the intervals in order
+    madvise(m_base, m_length, MADV_SEQUENTIAL);
+
+    const FileHeader* header = static_cast<const FileHeader*>(m_base);
+    NS_ABORT_MSG_IF(std::memcmp(header->magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0,
+                    fileName << " is not a binary trace");
+    NS_ABORT_MSG_IF(header->version != TRACE_VERSION,
+                    "unsupported trace version " << header->version);
+    m_count = header->count;
+    m_average = header->average;
+    NS_ABORT_MSG_IF(m_length < sizeof(FileHeader) + m_count * sizeof(uint32_t),
+                    "truncated trace " << fileName);
+    m_intervals = reinterpret_cast<const uint32_t*>(static_cast<const char*>(m_base) +
+                                                    sizeof(FileHeader));
+    NS_LOG_DEBUG("mapped " << m_count << " intervals, average " << m_average << "ns");
+}
+
+ArrivalTrace::~ArrivalTrace()
+{
+    NS_LOG_FUNCTION(this);
+    std::map<std::string, ArrivalTrace*>& traces = GetMappedTraces();
+    auto iter = traces.find(m_fileName);
+    if (iter != traces.end() && iter->second == this)
+    {
+        traces.erase(iter);
+    }
+    munmap(m_base, m_length);
+}
+
+std::string
+ArrivalTrace::GetFileName() const
+{
+    return m_fileName;
+}
+
+uint64_t
+ArrivalTrace::GetNIntervals() const
+{
+    return m_count;
+}
+
+double
+ArrivalTrace::GetAverage() const
+{
+    return m_average;
+}
+
+uint32_t
+ArrivalTrace::GetInterval(uint64_t index) const
+{
+    NS_ASSERT_MSG(index < m_count, "interval " << index << " out of the trace");
+    return m_intervals[index];
+}
+
+} // namespace ns3
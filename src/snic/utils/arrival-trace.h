@@ -0,0 +1,119 @@
+#ifndef ARRIVAL_TRACE_H
+#define ARRIVAL_TRACE_H
+
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+
+#include <stdint.h>
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * \ingroup snic
+ * \brief A packet arrival trace, memory-mapped from a binary file.
+ *
+ * The binary format is a FileHeader followed by the intervals between two
+ * packets, in nanoseconds, as uint32_t in host byte order. The file is
+ * mapped read-only rather than read, so the intervals are paged in as the
+ * generators walk through them, and every generator opening the same file
+ * while it is mapped shares the mapping.
+ *
+ * The text format of PacketArrivalRateFileGen (the number of intervals,
+ * their average, then one interval per line) is converted by Convert(),
+ * which Open() does by itself when it is given a text trace. The binary
+ * trace records the size and modification time of the text trace, and is
+ * converted again once they change.
+ */
+class ArrivalTrace : public SimpleRefCount<ArrivalTrace>
+{
+  public:
+    /**
+     * \param fileName a binary trace, or a text trace which is then converted
+     *        to fileName + ".bin" unless that file was converted from it as it
+     *        is now, or to the temporary directory if that file cannot be written
+     * \return the trace, shared with the other users of the same file
+     */
+    static Ptr<ArrivalTrace> Open(std::string fileName);
+
+    /**
+     * \brief Convert a text trace to the binary format, one line at a time
+     *
+     * The binary trace is written to a temporary file renamed into place,
+     * so that it is never seen half written.
+     *
+     * \param textFileName the text trace
+     * \param binaryFileName the binary trace to write
+     * \return the number of intervals converted
+     */
+    static uint64_t Convert(std::string textFileName, std::string binaryFileName);
+
+    /**
+     * \param fileName a file
+     * \return true if the file starts like a binary trace
+     */
+    static bool IsBinary(std::string fileName);
+
+    ~ArrivalTrace();
+
+    /// \return the name of the binary file mapped
+    std::string GetFileName() const;
+    /// \return the number of intervals
+    uint64_t GetNIntervals() const;
+    /// \return the average of the intervals in nanoseconds
+    double GetAverage() const;
+
+    /**
+     * \param index the index of an interval, below GetNIntervals()
+     * \return the interval in nanoseconds
+     */
+    uint32_t GetInterval(uint64_t index) const;
+
+  private:
+    /// the start of a binary trace
+    struct FileHeader
+    {
+        char magic[8];    //!< "SNICARRV"
+        uint32_t version; //!< format version, 2
+        uint32_t reserved;
+        uint64_t count;      //!< number of intervals that follow
+        double average;      //!< average of the intervals in nanoseconds
+        uint64_t sourceSize; //!< size of the text trace converted
+        int64_t sourceMtime; //!< modification time of the text trace in nanoseconds
+    };
+
+    /**
+     * \brief Convert a text trace like Convert(), without aborting if the
+     *        binary trace cannot be written
+     * \param textFileName the text trace
+     * \param binaryFileName the binary trace to write
+     * \param count set to the number of intervals converted
+     * \return false if the binary trace could not be written
+     */
+    static bool Write(std::string textFileName, std::string binaryFileName, uint64_t* count);
+
+    /**
+     * \param binaryFileName a binary trace
+     * \param size the size of a text trace
+     * \param mtime the modification time of the text trace, in nanoseconds
+     * \return true if the binary trace was converted from the text trace as it is now
+     */
+    static bool IsConvertedFrom(std::string binaryFileName, uint64_t size, int64_t mtime);
+
+    /**
+     * \param fileName the binary trace to map
+     */
+    ArrivalTrace(std::string fileName);
+
+    std::string m_fileName;      //!< the binary file
+    void* m_base;                //!< start of the mapping
+    uint64_t m_length;           //!< length of the mapping
+    const uint32_t* m_intervals; //!< the intervals, in the mapping
+    uint64_t m_count;            //!< number of intervals
+    double m_average;            //!< average interval in nanoseconds
+};
+
+} // namespace ns3
+
+#endif // ARRIVAL_TRACE_H
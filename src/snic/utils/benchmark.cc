@@ -2,6 +2,15 @@
 
 #include "ns3/simple-experiment.h"
 
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
 namespace ns3
 {
 
@@ -10,7 +19,10 @@ NS_OBJECT_ENSURE_REGISTERED(Benchmark);
 
 Benchmark::Benchmark(std::string name)
     : m_outputFileNamePrefix(name),
-      m_numExperiments(0)
+      m_numExperiments(0),
+      m_traceFileName("trace.txt"),
+      m_numWorkers(0),
+      m_outputDirectory(name)
 {
 }
 
@@ -40,32 +52,182 @@ Benchmark::Initialize()
     //}
 }
 
-void
+uint32_t
 Benchmark::Run()
 {
     NS_LOG_FUNCTION(this);
+    NS_LOG_DEBUG("running " << m_numExperiments << " experiments");
 
-    // for (Experiment& experiment : m_experiments)
-    //{
-    // experiment.Run();
-    //}
-    NS_LOG_FUNCTION(this);
-    NS_LOG_DEBUG("adding " << m_numExperiments << " experiments");
+    // mapped once here, the workers share the mapping
+    Ptr<ArrivalTrace> trace = ArrivalTrace::Open(m_traceFileName);
+
+    mkdir(m_outputDirectory.c_str(), 0755);
+    std::deque<uint32_t> queue;
+    for (uint32_t n = 0; n < m_numExperiments; ++n)
+    {
+        struct stat done;
+        if (stat((GetExperimentDirectory(n) + "/done").c_str(), &done) == 0)
+        {
+            NS_LOG_INFO("experiment " << n << " already done");
+            continue;
+        }
+        queue.push_back(n);
+    }
+
+    uint32_t numWorkers = m_numWorkers;
+    if (numWorkers == 0)
+    {
+        numWorkers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    NS_LOG_INFO(queue.size() << " experiments to run on " << numWorkers << " workers");
+
+    std::map<pid_t, uint32_t> running;
+    uint32_t failed = 0;
+    while (!queue.empty() || !running.empty())
+    {
+        while (!queue.empty() && running.size() < numWorkers)
+        {
+            uint32_t n = queue.front();
+            queue.pop_front();
+            mkdir(GetExperimentDirectory(n).c_str(), 0755);
+            // or the worker would print what is buffered again
+            std::cout.flush();
+            std::cerr.flush();
+            pid_t pid = fork();
+            NS_ABORT_MSG_IF(pid < 0, "cannot fork a worker");
+            if (pid == 0)
+            {
+                RunExperiment(n, trace);
+                std::cout.flush();
+                _exit(0);
+            }
+            NS_LOG_INFO("experiment " << n << " started in worker " << pid);
+            running[pid] = n;
+        }
 
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        NS_ABORT_MSG_IF(pid < 0, "lost the workers");
+        auto iter = running.find(pid);
+        if (iter == running.end())
+        {
+            continue;
+        }
+        uint32_t n = iter->second;
+        running.erase(iter);
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+        {
+            std::ofstream(GetExperimentDirectory(n) + "/done");
+            NS_LOG_INFO("experiment " << n << " done");
+        }
+        else
+        {
+            NS_LOG_WARN("experiment " << n << " failed with status " << status);
+            failed++;
+        }
+    }
+
+    WriteResults();
+    return failed;
+}
+
+std::map<std::string, uint32_t>
+Benchmark::GetIndexes(uint32_t n) const
+{
+    // walk the cartesian product of all the variables
     std::map<std::string, uint32_t> indexes;
+    uint32_t rest = n;
+    for (const auto& var : m_variables)
+    {
+        uint32_t size = var.GetValues().size();
+        indexes[var.GetName()] = rest % size;
+        rest /= size;
+    }
+    return indexes;
+}
+
+std::string
+Benchmark::GetExperimentDirectory(uint32_t n) const
+{
+    return m_outputDirectory + "/" + std::to_string(n);
+}
 
+void
+Benchmark::RunExperiment(uint32_t n, Ptr<ArrivalTrace> trace) const
+{
+    NS_LOG_FUNCTION(this << n);
+    std::map<std::string, std::vector<Ptr<AttributeValue>>> variables;
+    for (const auto& var : m_variables)
+    {
+        variables[var.GetName()] = var.GetValues();
+    }
+    // the experiment writes its traces and results in the current directory
+    NS_ABORT_MSG_IF(chdir(GetExperimentDirectory(n).c_str()) != 0,
+                    "cannot enter " << GetExperimentDirectory(n));
+    SimpleExperiment experiment = SimpleExperiment(n, m_outputFileNamePrefix);
+    experiment.SetArrivalTrace(trace);
+    experiment.Initialize(variables, GetIndexes(n));
+    experiment.Run();
+}
+
+void
+Benchmark::WriteResults() const
+{
+    NS_LOG_FUNCTION(this);
+    // the results are the "key:value" lines after "done" in the output of
+    // an experiment, the columns are the keys seen in any experiment
+    std::vector<std::string> keys;
+    std::vector<std::map<std::string, std::string>> results(m_numExperiments);
     for (uint32_t n = 0; n < m_numExperiments; ++n)
     {
-        SimpleExperiment experiment = SimpleExperiment(n, m_outputFileNamePrefix);
-        // XXX hack
-        for (const auto& kv : m_variables)
+        std::ifstream output(GetExperimentDirectory(n) + "/" + m_outputFileNamePrefix + "_" +
+                             std::to_string(n) + ".txt");
+        std::string line;
+        while (std::getline(output, line) && line != "done")
         {
-            indexes[kv.first] = n;
         }
+        while (std::getline(output, line))
+        {
+            std::string::size_type colon = line.find(':');
+            if (colon == std::string::npos)
+            {
+                continue;
+            }
+            std::string key = line.substr(0, colon);
+            if (std::find(keys.begin(), keys.end(), key) == keys.end())
+            {
+                keys.push_back(key);
+            }
+            results[n][key] = line.substr(colon + 1);
+        }
+    }
 
-        experiment.Initialize(m_variables, indexes);
-        experiment.Run();
-        // m_experiments.push_back(experiment);
+    std::ofstream csv(m_outputDirectory + "/results.csv");
+    csv << "experiment";
+    for (const auto& var : m_variables)
+    {
+        csv << "," << var.GetName();
+    }
+    for (const auto& key : keys)
+    {
+        csv << "," << key;
+    }
+    csv << "\n";
+    for (uint32_t n = 0; n < m_numExperiments; ++n)
+    {
+        std::map<std::string, uint32_t> indexes = GetIndexes(n);
+        csv << n;
+        for (const auto& var : m_variables)
+        {
+            Ptr<AttributeValue> value = var.GetValue(indexes[var.GetName()]);
+            csv << "," << value->SerializeToString(var.GetChecker());
+        }
+        for (const auto& key : keys)
+        {
+            auto iter = results[n].find(key);
+            csv << "," << (iter != results[n].end() ? iter->second : "");
+        }
+        csv << "\n";
     }
 }
 
@@ -80,12 +242,33 @@ Benchmark::AddVariable(ExperimentVariable var)
     m_variables.push_back(var);
     if (m_numExperiments == 0)
     {
-        m_numExperiments = values.size();
+        m_numExperiments = var.GetValues().size();
     }
     else
     {
-        m_numExperiments *= values.size();
+        m_numExperiments *= var.GetValues().size();
     }
 }
 
+void
+Benchmark::SetArrivalTraceFile(std::string fileName)
+{
+    NS_LOG_FUNCTION(this << fileName);
+    m_traceFileName = fileName;
+}
+
+void
+Benchmark::SetNumWorkers(uint32_t numWorkers)
+{
+    NS_LOG_FUNCTION(this << numWorkers);
+    m_numWorkers = numWorkers;
+}
+
+void
+Benchmark::SetOutputDirectory(std::string directory)
+{
+    NS_LOG_FUNCTION(this << directory);
+    m_outputDirectory = directory;
+}
+
 } // namespace ns3
@@ -1,6 +1,7 @@
 #ifndef BENCHMARK_H
 #define BENCHMARK_H
 
+#include "ns3/arrival-trace.h"
 #include "ns3/experiment-variable.h"
 #include "ns3/experiment.h"
 #include "ns3/log.h"
@@ -8,6 +9,22 @@
 
 namespace ns3
 {
+/**
+ * \ingroup snic
+ * \brief Runs a SimpleExperiment for every combination of the variables.
+ *
+ * Each experiment runs in a worker process of its own, forked from the
+ * benchmark, with up to NumWorkers of them at once. A worker runs in the
+ * directory <OutputDirectory>/<experiment>, so the traces and results of
+ * two experiments never overwrite each other. Once a worker exits
+ * successfully the directory is marked done, and a later Run() with the
+ * same output directory skips the experiments already done, so an
+ * interrupted sweep can be resumed.
+ *
+ * When every experiment has run, the variable values and the results of
+ * the experiments are gathered in <OutputDirectory>/results.csv, one row
+ * per experiment.
+ */
 class Benchmark : public Object
 {
   public:
@@ -15,18 +32,61 @@ class Benchmark : public Object
     ~Benchmark();
 
     void Initialize();
-    void Run();
+    /**
+     * \brief Run the experiments not done yet and gather the results
+     * \return the number of experiments that failed
+     */
+    uint32_t Run();
 
     // virtual void AddVariable(std::string varName, std::vector<Ptr<AttributeValue>> values);
     virtual void AddVariable(ExperimentVariable var);
 
+    /**
+     * \param fileName the arrival trace every experiment replays, mapped
+     *        once for the whole benchmark
+     */
+    void SetArrivalTraceFile(std::string fileName);
+
+    /**
+     * \param numWorkers experiments run at once, 0 for one per core
+     */
+    void SetNumWorkers(uint32_t numWorkers);
+
+    /**
+     * \param directory where the experiments run, the name of the
+     *        benchmark by default
+     */
+    void SetOutputDirectory(std::string directory);
+
   private:
+    /**
+     * \param n an experiment
+     * \return the index of the value of every variable in the experiment
+     */
+    std::map<std::string, uint32_t> GetIndexes(uint32_t n) const;
+    /**
+     * \param n an experiment
+     * \return the directory the experiment runs in
+     */
+    std::string GetExperimentDirectory(uint32_t n) const;
+    /**
+     * \brief Run one experiment, in the worker process
+     * \param n the experiment
+     * \param trace the arrival trace, mapped by the benchmark
+     */
+    void RunExperiment(uint32_t n, Ptr<ArrivalTrace> trace) const;
+    /// \brief Gather the results of the experiments in results.csv
+    void WriteResults() const;
+
     std::string m_outputFileNamePrefix;
     std::list<Experiment> m_experiments;
     // std::map<std::string, std::vector<Ptr<AttributeValue>>> m_variables;
     std::vector<ExperimentVariable> m_variables;
     std::map<std::string, bool> m_experimentsAdded;
     uint32_t m_numExperiments;
+    std::string m_traceFileName;
+    uint32_t m_numWorkers;
+    std::string m_outputDirectory;
 };
 } // namespace ns3
 #endif // BENCHMARK_H
@@ -0,0 +1,341 @@
+#include "cluster-topology.h"
+
+#include "ns3/abort.h"
+#include "ns3/csma-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/log.h"
+#include "ns3/snic-module.h"
+
+#include <chrono>
+#include <fstream>
+#include <unistd.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ClusterTopologyHelper");
+
+/// \return the steady clock in nanoseconds
+static int64_t
+GetSteadyClock()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+ClusterTopologyHelper::ClusterTopologyHelper()
+    : m_nLinks(0),
+      m_buildTime(0),
+      m_buildMemory(0)
+{
+    NS_LOG_FUNCTION(this);
+    m_buildStart = GetSteadyClock();
+    m_memoryStart = GetResidentMemory();
+
+    m_csmaHelper.SetChannelAttribute("DataRate", DataRateValue(DataRate("100Gbps")));
+    m_csmaHelper.SetChannelAttribute("Delay", TimeValue(NanoSeconds(1)));
+}
+
+ClusterTopologyHelper::~ClusterTopologyHelper()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+uint32_t
+ClusterTopologyHelper::CreateSnic(uint32_t nHosts)
+{
+    NS_LOG_FUNCTION(this << nHosts);
+    SnicHelper snicHelper;
+    snicHelper
+        .CreateSnic(m_snics, nHosts, m_terminals, m_csmaSwitches, m_terminalDevices, m_csmaHelper);
+    return m_snics.GetN() - 1;
+}
+
+void
+ClusterTopologyHelper::Link(uint32_t a, uint32_t b)
+{
+    NS_LOG_FUNCTION(this << a << b);
+    NS_ASSERT_MSG(a != b && a < m_snics.GetN() && b < m_snics.GetN(), "bad link " << a << b);
+    NetDeviceContainer devs =
+        m_csmaHelper.Install(NodeContainer(m_csmaSwitches.Get(a), m_csmaSwitches.Get(b)));
+    SnicHelper snicHelper;
+    snicHelper.AddPort(m_snics.Get(a), devs.Get(0));
+    snicHelper.AddPort(m_snics.Get(b), devs.Get(1));
+    m_nLinks++;
+}
+
+void
+ClusterTopologyHelper::Finish(uint32_t schedulerIdx)
+{
+    NS_LOG_FUNCTION(this << schedulerIdx);
+    NS_ABORT_MSG_IF(schedulerIdx >= m_snics.GetN(),
+                    "scheduler " << schedulerIdx << " out of " << m_snics.GetN() << " sNICs");
+
+    SnicStackHelper internet;
+    internet.Install(m_terminals);
+    internet.Install(m_csmaSwitches);
+
+    // every host and sNIC shares one subnet, the narrowest that holds them
+    uint64_t nAddresses = m_terminalDevices.GetN() + m_snics.GetN() + 2;
+    uint32_t prefix = 24;
+    while (prefix > 8 && (uint64_t(1) << (32 - prefix)) < nAddresses)
+    {
+        prefix--;
+    }
+    NS_ABORT_MSG_IF((uint64_t(1) << (32 - prefix)) < nAddresses,
+                    "too many addresses for one subnet: " << nAddresses);
+    NS_LOG_INFO("Assign " << nAddresses << " IP Addresses in 10.0.0.0/" << prefix);
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase("10.0.0.0", Ipv4Mask(("/" + std::to_string(prefix)).c_str()));
+    m_interfaces = ipv4.Assign(m_terminalDevices);
+    m_snic_interfaces = ipv4.Assign(m_snics);
+
+    Ipv4Address schedulerAddress = m_snic_interfaces.GetAddress(schedulerIdx);
+    for (uint32_t i = 0; i < m_snics.GetN(); ++i)
+    {
+        Ptr<SnicNetDevice> snic = DynamicCast<SnicNetDevice, NetDevice>(m_snics.Get(i));
+        snic->SetSchedulerAddress(schedulerAddress);
+        snic->SetIpAddress(m_snic_interfaces.GetAddress(i));
+    }
+    Ptr<SnicNetDevice> scheduler =
+        DynamicCast<SnicNetDevice, NetDevice>(m_snics.Get(schedulerIdx));
+    scheduler->SetIsScheduler(true);
+    m_schedulers.Add(scheduler);
+
+    m_buildTime = (GetSteadyClock() - m_buildStart) / 1e9;
+    uint64_t memory = GetResidentMemory();
+    m_buildMemory = memory > m_memoryStart ? memory - m_memoryStart : 0;
+    NS_LOG_INFO("built " << m_snics.GetN() << " sNICs and " << m_nLinks << " links in "
+                         << m_buildTime << "s");
+}
+
+uint64_t
+ClusterTopologyHelper::GetResidentMemory()
+{
+    // the second field of statm is the resident set, in pages
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0;
+    uint64_t resident = 0;
+    if (!(statm >> size >> resident))
+    {
+        return 0;
+    }
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+NodeContainer
+ClusterTopologyHelper::GetTerminals() const
+{
+    return m_terminals;
+}
+
+NodeContainer
+ClusterTopologyHelper::GetCsmaSwitches() const
+{
+    return m_csmaSwitches;
+}
+
+NetDeviceContainer
+ClusterTopologyHelper::GetTerminalDevices() const
+{
+    return m_terminalDevices;
+}
+
+NetDeviceContainer
+ClusterTopologyHelper::GetSnics() const
+{
+    return m_snics;
+}
+
+NetDeviceContainer
+ClusterTopologyHelper::GetSchedulers() const
+{
+    return m_schedulers;
+}
+
+Ipv4InterfaceContainer
+ClusterTopologyHelper::GetInterfaces() const
+{
+    return m_interfaces;
+}
+
+Ipv4InterfaceContainer
+ClusterTopologyHelper::GetSnicInterfaces() const
+{
+    return m_snic_interfaces;
+}
+
+CsmaHelper
+ClusterTopologyHelper::GetCsmaHelper() const
+{
+    return m_csmaHelper;
+}
+
+uint32_t
+ClusterTopologyHelper::GetNLinks() const
+{
+    return m_nLinks;
+}
+
+double
+ClusterTopologyHelper::GetBuildTime() const
+{
+    return m_buildTime;
+}
+
+uint64_t
+ClusterTopologyHelper::GetBuildMemory() const
+{
+    return m_buildMemory;
+}
+
+void
+ClusterTopologyHelper::PrintStatistics(std::ostream& os) const
+{
+    os << "snics=" << m_snics.GetN() << " hosts=" << m_terminals.GetN() << " links=" << m_nLinks
+       << " buildTime=" << m_buildTime << "s buildMemory=" << m_buildMemory / 1024 << "KiB";
+}
+
+FatTreeTopologyHelper::FatTreeTopologyHelper(uint32_t k, uint32_t nHosts, uint32_t schedulerIdx)
+    : m_k(k)
+{
+    NS_LOG_FUNCTION(this << k << nHosts << schedulerIdx);
+    NS_ABORT_MSG_IF(k < 2 || k % 2 != 0, "a fat-tree needs an even k, not " << k);
+    uint32_t half = k / 2;
+    if (nHosts == 0)
+    {
+        nHosts = half;
+    }
+
+    for (uint32_t i = 0; i < k * half; ++i)
+    {
+        CreateSnic(nHosts);
+    }
+    for (uint32_t i = 0; i < k * half + half * half; ++i)
+    {
+        CreateSnic(0);
+    }
+
+    for (uint32_t pod = 0; pod < k; ++pod)
+    {
+        for (uint32_t a = 0; a < half; ++a)
+        {
+            for (uint32_t e = 0; e < half; ++e)
+            {
+                Link(GetEdgeIndex(pod, e), GetAggregationIndex(pod, a));
+            }
+            for (uint32_t c = 0; c < half; ++c)
+            {
+                Link(GetAggregationIndex(pod, a), GetCoreIndex(a * half + c));
+            }
+        }
+    }
+
+    Finish(schedulerIdx);
+}
+
+uint32_t
+FatTreeTopologyHelper::GetEdgeIndex(uint32_t pod, uint32_t i) const
+{
+    NS_ASSERT(pod < m_k && i < m_k / 2);
+    return pod * (m_k / 2) + i;
+}
+
+uint32_t
+FatTreeTopologyHelper::GetAggregationIndex(uint32_t pod, uint32_t i) const
+{
+    NS_ASSERT(pod < m_k && i < m_k / 2);
+    return m_k * (m_k / 2) + pod * (m_k / 2) + i;
+}
+
+uint32_t
+FatTreeTopologyHelper::GetCoreIndex(uint32_t i) const
+{
+    NS_ASSERT(i < (m_k / 2) * (m_k / 2));
+    return 2 * m_k * (m_k / 2) + i;
+}
+
+LeafSpineTopologyHelper::LeafSpineTopologyHelper(uint32_t nLeaves,
+                                                 uint32_t nSpines,
+                                                 uint32_t nHosts,
+                                                 uint32_t schedulerIdx)
+    : m_nLeaves(nLeaves)
+{
+    NS_LOG_FUNCTION(this << nLeaves << nSpines << nHosts << schedulerIdx);
+    NS_ABORT_MSG_IF(nLeaves == 0 || nSpines == 0, "need at least one leaf and one spine");
+
+    for (uint32_t i = 0; i < nLeaves; ++i)
+    {
+        CreateSnic(nHosts);
+    }
+    for (uint32_t i = 0; i < nSpines; ++i)
+    {
+        CreateSnic(0);
+    }
+    for (uint32_t leaf = 0; leaf < nLeaves; ++leaf)
+    {
+        for (uint32_t spine = 0; spine < nSpines; ++spine)
+        {
+            Link(GetLeafIndex(leaf), GetSpineIndex(spine));
+        }
+    }
+
+    Finish(schedulerIdx);
+}
+
+uint32_t
+LeafSpineTopologyHelper::GetLeafIndex(uint32_t i) const
+{
+    NS_ASSERT(i < m_nLeaves);
+    return i;
+}
+
+uint32_t
+LeafSpineTopologyHelper::GetSpineIndex(uint32_t i) const
+{
+    return m_nLeaves + i;
+}
+
+TorusTopologyHelper::TorusTopologyHelper(uint32_t nRows,
+                                         uint32_t nColumns,
+                                         uint32_t nHosts,
+                                         uint32_t schedulerIdx)
+    : m_nRows(nRows),
+      m_nColumns(nColumns)
+{
+    NS_LOG_FUNCTION(this << nRows << nColumns << nHosts << schedulerIdx);
+    NS_ABORT_MSG_IF(nRows == 0 || nColumns == 0, "need at least one row and one column");
+
+    for (uint32_t i = 0; i < nRows * nColumns; ++i)
+    {
+        CreateSnic(nHosts);
+    }
+    for (uint32_t row = 0; row < nRows; ++row)
+    {
+        for (uint32_t column = 0; column < nColumns; ++column)
+        {
+            // the link to the next one wraps round unless it would double
+            // the link to the previous one
+            if (column + 1 < nColumns || nColumns > 2)
+            {
+                Link(GetIndex(row, column), GetIndex(row, (column + 1) % nColumns));
+            }
+            if (row + 1 < nRows || nRows > 2)
+            {
+                Link(GetIndex(row, column), GetIndex((row + 1) % nRows, column));
+            }
+        }
+    }
+
+    Finish(schedulerIdx);
+}
+
+uint32_t
+TorusTopologyHelper::GetIndex(uint32_t row, uint32_t column) const
+{
+    NS_ASSERT(row < m_nRows && column < m_nColumns);
+    return row * m_nColumns + column;
+}
+
+} // namespace ns3
@@ -0,0 +1,204 @@
+#ifndef SNIC_CLUSTER_TOPOLOGY_HELPER_H
+#define SNIC_CLUSTER_TOPOLOGY_HELPER_H
+
+#include "ns3/csma-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+
+#include <ostream>
+#include <stdint.h>
+
+namespace ns3
+{
+
+/**
+ * \ingroup snic
+ * \brief Common part of the large sNIC cluster topologies.
+ *
+ * Every sNIC is a switch node bridging its hosts and its links to the other
+ * sNICs, like in RingTopologyHelper. A subclass creates the sNICs with
+ * CreateSnic(), wires them with Link(), which only ever touches the two
+ * sNICs it is given by index, then calls Finish() once. Finish() installs
+ * the stack and assigns the addresses of all the hosts and then all the
+ * sNICs in a single pass over a subnet wide enough for the whole cluster.
+ *
+ * The wall clock time and the resident memory taken by the construction
+ * are kept so that the cost of building a cluster can be compared across
+ * sizes.
+ */
+class ClusterTopologyHelper
+{
+  public:
+    virtual ~ClusterTopologyHelper();
+
+    NodeContainer GetTerminals() const;
+    NodeContainer GetCsmaSwitches() const;
+    NetDeviceContainer GetTerminalDevices() const;
+    NetDeviceContainer GetSnics() const;
+    /**
+     * \return the scheduler sNIC
+     */
+    NetDeviceContainer GetSchedulers() const;
+    Ipv4InterfaceContainer GetInterfaces() const;
+    Ipv4InterfaceContainer GetSnicInterfaces() const;
+    CsmaHelper GetCsmaHelper() const;
+
+    /// \return the number of links between two sNICs
+    uint32_t GetNLinks() const;
+    /// \return the wall clock time the construction took, in seconds
+    double GetBuildTime() const;
+    /// \return the resident memory grown during the construction, in bytes
+    uint64_t GetBuildMemory() const;
+
+    /**
+     * \brief Print the size of the cluster and what building it cost on one line
+     * \param os the output stream
+     */
+    void PrintStatistics(std::ostream& os) const;
+
+  protected:
+    ClusterTopologyHelper();
+
+    /**
+     * \brief Create an sNIC with its hosts
+     * \param nHosts number of hosts behind the sNIC
+     * \return the index of the sNIC
+     */
+    uint32_t CreateSnic(uint32_t nHosts);
+
+    /**
+     * \brief Connect two sNICs with a point to point csma channel
+     * \param a index of the first sNIC
+     * \param b index of the second sNIC
+     */
+    void Link(uint32_t a, uint32_t b);
+
+    /**
+     * \brief Install the stack, assign the addresses and set the scheduler
+     * \param schedulerIdx index of the scheduler sNIC
+     */
+    void Finish(uint32_t schedulerIdx);
+
+  private:
+    /// \return the resident memory of the process in bytes, 0 if unknown
+    static uint64_t GetResidentMemory();
+
+    // list of end host nodes
+    NodeContainer m_terminals;
+    // List of csma devices at each end host
+    NetDeviceContainer m_terminalDevices;
+    // List of sNICs
+    NetDeviceContainer m_snics;
+    // List of Nodes for switch
+    NodeContainer m_csmaSwitches;
+    // the scheduler sNIC
+    NetDeviceContainer m_schedulers;
+
+    Ipv4InterfaceContainer m_interfaces;
+    Ipv4InterfaceContainer m_snic_interfaces;
+    CsmaHelper m_csmaHelper;
+
+    uint32_t m_nLinks;      //!< number of links between two sNICs
+    int64_t m_buildStart;   //!< steady clock at the start of the construction, in ns
+    uint64_t m_memoryStart; //!< resident memory at the start of the construction
+    double m_buildTime;     //!< seconds taken by the construction
+    uint64_t m_buildMemory; //!< bytes of resident memory grown by the construction
+};
+
+/**
+ * \ingroup snic
+ * \brief A k-ary fat-tree of sNICs.
+ *
+ * k pods of k/2 edge and k/2 aggregation sNICs, with every edge sNIC linked
+ * to every aggregation sNIC of its pod, and (k/2)^2 core sNICs, the i-th
+ * aggregation sNIC of every pod being linked to the cores i * k/2 to
+ * (i + 1) * k/2 - 1. The hosts are behind the edge sNICs.
+ *
+ * The sNICs are numbered edges first, pod by pod, then aggregations, pod
+ * by pod, then cores.
+ */
+class FatTreeTopologyHelper : public ClusterTopologyHelper
+{
+  public:
+    /**
+     * \param k number of ports of a switch, even
+     * \param nHosts number of hosts behind each edge sNIC, k/2 if 0
+     * \param schedulerIdx index of the scheduler sNIC
+     */
+    FatTreeTopologyHelper(uint32_t k, uint32_t nHosts = 0, uint32_t schedulerIdx = 0);
+
+    /// \return the index of an edge sNIC
+    uint32_t GetEdgeIndex(uint32_t pod, uint32_t i) const;
+    /// \return the index of an aggregation sNIC
+    uint32_t GetAggregationIndex(uint32_t pod, uint32_t i) const;
+    /// \return the index of a core sNIC
+    uint32_t GetCoreIndex(uint32_t i) const;
+
+  private:
+    uint32_t m_k; //!< number of ports of a switch
+};
+
+/**
+ * \ingroup snic
+ * \brief A two tier leaf-spine cluster of sNICs.
+ *
+ * Every leaf sNIC is linked to every spine sNIC and the hosts are behind the
+ * leaves. The sNICs are numbered leaves first, then spines.
+ */
+class LeafSpineTopologyHelper : public ClusterTopologyHelper
+{
+  public:
+    /**
+     * \param nLeaves number of leaf sNICs
+     * \param nSpines number of spine sNICs
+     * \param nHosts number of hosts behind each leaf sNIC
+     * \param schedulerIdx index of the scheduler sNIC
+     */
+    LeafSpineTopologyHelper(uint32_t nLeaves,
+                            uint32_t nSpines,
+                            uint32_t nHosts,
+                            uint32_t schedulerIdx = 0);
+
+    /// \return the index of a leaf sNIC
+    uint32_t GetLeafIndex(uint32_t i) const;
+    /// \return the index of a spine sNIC
+    uint32_t GetSpineIndex(uint32_t i) const;
+
+  private:
+    uint32_t m_nLeaves; //!< number of leaf sNICs
+};
+
+/**
+ * \ingroup snic
+ * \brief A two dimensional torus of sNICs.
+ *
+ * Every sNIC is linked to its neighbours in its row and its column, the
+ * last one wrapping round to the first. A dimension of 2 has a single link
+ * between its two sNICs and a dimension of 1 none. The sNICs are numbered
+ * row by row.
+ */
+class TorusTopologyHelper : public ClusterTopologyHelper
+{
+  public:
+    /**
+     * \param nRows number of rows
+     * \param nColumns number of columns
+     * \param nHosts number of hosts behind each sNIC
+     * \param schedulerIdx index of the scheduler sNIC
+     */
+    TorusTopologyHelper(uint32_t nRows,
+                        uint32_t nColumns,
+                        uint32_t nHosts,
+                        uint32_t schedulerIdx = 0);
+
+    /// \return the index of the sNIC at a row and a column
+    uint32_t GetIndex(uint32_t row, uint32_t column) const;
+
+  private:
+    uint32_t m_nRows;    //!< number of rows
+    uint32_t m_nColumns; //!< number of columns
+};
+
+} // namespace ns3
+
+#endif // SNIC_CLUSTER_TOPOLOGY_HELPER_H
@@ -9,6 +9,27 @@ ExperimentVariable::ExperimentVariable(std::string varName, Ptr<const AttributeC
 {
 }
 
+ExperimentVariable::ExperimentVariable(std::string varName,
+                                       Ptr<const AttributeChecker> checker,
+                                       std::vector<Ptr<AttributeValue>> values)
+    : m_varName(varName),
+      m_checker(checker),
+      m_values(values)
+{
+}
+
+std::string
+ExperimentVariable::GetName() const
+{
+    return m_varName;
+}
+
+Ptr<const AttributeChecker>
+ExperimentVariable::GetChecker() const
+{
+    return m_checker;
+}
+
 void
 ExperimentVariable::SetValues(std::vector<Ptr<AttributeValue>> values)
 {
@@ -9,6 +9,12 @@ class ExperimentVariable : public Object
 {
   public:
     ExperimentVariable(std::string varName, Ptr<const AttributeChecker> checker);
+    ExperimentVariable(std::string varName,
+                       Ptr<const AttributeChecker> checker,
+                       std::vector<Ptr<AttributeValue>> values);
+
+    std::string GetName() const;
+    Ptr<const AttributeChecker> GetChecker() const;
 
     void SetValues(std::vector<Ptr<AttributeValue>> values);
 
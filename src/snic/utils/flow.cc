@@ -6,6 +6,14 @@ namespace ns3
 // NS_LOG_COMPONENT_DEFINE("FlowId");
 // NS_OBJECT_ENSURE_REGISTERED(FlowId);
 
+FlowId::FlowId()
+    : m_srcPort(0),
+      m_dstPort(0),
+      m_protocol(0),
+      m_id(0)
+{
+}
+
 FlowId::FlowId(Ipv4Address srcIp,
                uint16_t srcPort,
                Ipv4Address dstIp,
@@ -44,6 +52,30 @@ FlowId::FlowId(const Ipv4Header& ipv4Header, const SnicHeader& snicHeader)
     // NS_LOG_FUNCTION(this);
 }
 
+namespace
+{
+/// splitmix64 finalizer
+uint64_t
+Mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+} // namespace
+
+uint64_t
+FlowId::GetHash() const
+{
+    uint64_t h = Mix(m_id);
+    h = Mix(h ^ (((uint64_t)m_srcIp.Get() << 32) | m_dstIp.Get()));
+    h = Mix(h ^ (((uint64_t)m_srcPort << 32) | ((uint64_t)m_dstPort << 16) | m_protocol));
+    return h;
+}
+
 // FlowId::FlowId(const SnicHeader& snicHeader)
 //{
 // FlowId(snicHeader.GetSourceIp(),
@@ -13,6 +13,7 @@ namespace ns3
 class FlowId
 {
   public:
+    FlowId();
     FlowId(Ipv4Address srcIp,
            uint16_t srcPort,
            Ipv4Address dstIp,
@@ -27,6 +28,36 @@ class FlowId
         return m_id;
     }
 
+    Ipv4Address GetSourceIp() const
+    {
+        return m_srcIp;
+    }
+
+    Ipv4Address GetDestinationIp() const
+    {
+        return m_dstIp;
+    }
+
+    uint16_t GetSourcePort() const
+    {
+        return m_srcPort;
+    }
+
+    uint16_t GetDestinationPort() const
+    {
+        return m_dstPort;
+    }
+
+    uint16_t GetProtocol() const
+    {
+        return m_protocol;
+    }
+
+    /**
+     * \return a hash of the 5-tuple and the flow id
+     */
+    uint64_t GetHash() const;
+
   private:
     friend bool operator==(const FlowId& a, const FlowId& b);
     friend bool operator!=(const FlowId& a, const FlowId& b);
@@ -55,10 +86,28 @@ operator!=(const FlowId& a, const FlowId& b)
 inline bool
 operator<(const FlowId& a, const FlowId& b)
 {
-    // return (a.m_srcIp < b.m_srcIp);
-    return (a.m_id < b.m_id);
-    // return (a.m_srcIp < b.m_srcIp && a.m_dstIp < b.m_dstIp && a.m_srcPort < b.m_srcPort &&
-    // a.m_dstPort < b.m_dstPort && a.m_protocol < b.m_protocol && a.m_id < b.m_id);
+    // order on every field so that it agrees with operator==
+    if (a.m_id != b.m_id)
+    {
+        return a.m_id < b.m_id;
+    }
+    if (a.m_srcIp != b.m_srcIp)
+    {
+        return a.m_srcIp < b.m_srcIp;
+    }
+    if (a.m_dstIp != b.m_dstIp)
+    {
+        return a.m_dstIp < b.m_dstIp;
+    }
+    if (a.m_srcPort != b.m_srcPort)
+    {
+        return a.m_srcPort < b.m_srcPort;
+    }
+    if (a.m_dstPort != b.m_dstPort)
+    {
+        return a.m_dstPort < b.m_dstPort;
+    }
+    return a.m_protocol < b.m_protocol;
 }
 
 } // namespace ns3
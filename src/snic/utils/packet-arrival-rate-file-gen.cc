@@ -1,5 +1,7 @@
 #include "packet-arrival-rate-file-gen.h"
 
+#include "ns3/abort.h"
+
 #include <cmath>
 #include <fstream>
 
@@ -81,6 +83,8 @@ PacketArrivalRateFileGen::~PacketArrivalRateFileGen()
 Time
 PacketArrivalRateFileGen::NextInterval()
 {
+    NS_ABORT_MSG_IF(m_currentIdx >= m_intervals.size(),
+                    "ran past the end of the trace " << m_fileName);
     return NanoSeconds(m_intervals[m_currentIdx++]);
 }
 
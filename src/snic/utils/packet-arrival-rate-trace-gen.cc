@@ -0,0 +1,119 @@
+#include "packet-arrival-rate-trace-gen.h"
+
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/log.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("PacketArrivalRateTraceGen");
+NS_OBJECT_ENSURE_REGISTERED(PacketArrivalRateTraceGen);
+
+TypeId
+PacketArrivalRateTraceGen::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::PacketArrivalRateTraceGen")
+            .SetParent<PacketArrivalRateGen>()
+            .SetGroupName("Snic")
+            .AddConstructor<PacketArrivalRateTraceGen>()
+            .AddAttribute("FileName",
+                          "The arrival trace to replay, binary or text.",
+                          StringValue(""),
+                          MakeStringAccessor(&PacketArrivalRateTraceGen::SetFileName,
+                                             &PacketArrivalRateTraceGen::GetFileName),
+                          MakeStringChecker())
+            .AddAttribute("Offset",
+                          "Index of the first interval replayed, so that generators "
+                          "sharing a trace do not send in lockstep.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&PacketArrivalRateTraceGen::SetOffset,
+                                               &PacketArrivalRateTraceGen::GetOffset),
+                          MakeUintegerChecker<uint64_t>())
+            .AddAttribute("Loop",
+                          "Wrap around at the end of the trace. If false, running past "
+                          "the end of the trace is an error.",
+                          BooleanValue(true),
+                          MakeBooleanAccessor(&PacketArrivalRateTraceGen::m_loop),
+                          MakeBooleanChecker());
+    return tid;
+}
+
+PacketArrivalRateTraceGen::PacketArrivalRateTraceGen()
+    : m_offset(0),
+      m_next(0),
+      m_loop(true)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+PacketArrivalRateTraceGen::~PacketArrivalRateTraceGen()
+{
+    NS_LOG_FUNCTION_NOARGS();
+}
+
+Time
+PacketArrivalRateTraceGen::NextInterval()
+{
+    NS_ASSERT_MSG(m_trace, "no trace to replay");
+    if (m_next == m_trace->GetNIntervals())
+    {
+        NS_ABORT_MSG_UNLESS(m_loop,
+                            "ran past the end of the trace " << m_trace->GetFileName());
+        m_next = 0;
+    }
+    return NanoSeconds(m_trace->GetInterval(m_next++));
+}
+
+void
+PacketArrivalRateTraceGen::SetFileName(std::string fileName)
+{
+    NS_LOG_FUNCTION(this << fileName);
+    SetTrace(fileName.empty() ? nullptr : ArrivalTrace::Open(fileName));
+    m_fileName = fileName;
+}
+
+std::string
+PacketArrivalRateTraceGen::GetFileName() const
+{
+    return m_fileName;
+}
+
+void
+PacketArrivalRateTraceGen::SetOffset(uint64_t offset)
+{
+    NS_LOG_FUNCTION(this << offset);
+    m_offset = offset;
+    m_next = 0;
+    if (m_trace)
+    {
+        NS_ABORT_MSG_IF(m_trace->GetNIntervals() == 0, "empty trace " << m_fileName);
+        m_next = offset % m_trace->GetNIntervals();
+    }
+}
+
+uint64_t
+PacketArrivalRateTraceGen::GetOffset() const
+{
+    return m_offset;
+}
+
+void
+PacketArrivalRateTraceGen::SetTrace(Ptr<ArrivalTrace> trace)
+{
+    NS_LOG_FUNCTION(this << trace);
+    m_trace = trace;
+    m_fileName = trace ? trace->GetFileName() : "";
+    SetOffset(m_offset);
+}
+
+Ptr<ArrivalTrace>
+PacketArrivalRateTraceGen::GetTrace() const
+{
+    return m_trace;
+}
+
+} // namespace ns3
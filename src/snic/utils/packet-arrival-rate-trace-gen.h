@@ -0,0 +1,60 @@
+#ifndef PACKET_ARRIVAL_RATE_TRACE_GEN_H
+#define PACKET_ARRIVAL_RATE_TRACE_GEN_H
+
+#include "ns3/arrival-trace.h"
+#include "ns3/nstime.h"
+#include "ns3/packet-arrival-rate-gen.h"
+
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * \ingroup snic
+ * \brief Replays the intervals of a memory-mapped ArrivalTrace.
+ *
+ * Nothing is loaded up front, each call to NextInterval() reads the next
+ * interval of the mapping. Several generators can share one trace: each
+ * starts at its own Offset, and with Loop wraps around at the end of the
+ * trace instead of stopping the simulation.
+ */
+class PacketArrivalRateTraceGen : public PacketArrivalRateGen
+{
+  public:
+    static TypeId GetTypeId();
+
+    PacketArrivalRateTraceGen();
+    ~PacketArrivalRateTraceGen() override;
+
+    Time NextInterval() override;
+
+    /**
+     * \param fileName the trace to replay, see ArrivalTrace::Open()
+     */
+    void SetFileName(std::string fileName);
+    std::string GetFileName() const;
+
+    /**
+     * \param offset index of the first interval, taken modulo the trace length
+     */
+    void SetOffset(uint64_t offset);
+    uint64_t GetOffset() const;
+
+    /**
+     * \param trace the trace to replay, already opened by the caller
+     */
+    void SetTrace(Ptr<ArrivalTrace> trace);
+    Ptr<ArrivalTrace> GetTrace() const;
+
+  private:
+    Ptr<ArrivalTrace> m_trace;
+    std::string m_fileName;
+    uint64_t m_offset;
+    uint64_t m_next; //!< index of the next interval
+    bool m_loop;
+};
+
+} // namespace ns3
+
+#endif // PACKET_ARRIVAL_RATE_TRACE_GEN_H
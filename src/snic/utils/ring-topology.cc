@@ -10,9 +10,13 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("RingTopologyHelper");
 
-RingTopologyHelper::RingTopologyHelper(uint32_t nSnics, uint32_t nHosts, uint32_t schedulerIdx)
+RingTopologyHelper::RingTopologyHelper(uint32_t nSnics,
+                                       uint32_t nHosts,
+                                       uint32_t schedulerIdx,
+                                       uint32_t nShards)
 {
-    NS_LOG_FUNCTION(this << nSnics << nHosts);
+    NS_LOG_FUNCTION(this << nSnics << nHosts << nShards);
+    NS_ASSERT_MSG(nShards > 0 && nShards <= nSnics, "need between 1 and nSnics shards");
 
     // CsmaHelper csmaHelper;
     // m_csmaHelper.SetChannelAttribute("DataRate", DataRateValue(1000000000));
@@ -89,16 +93,55 @@ RingTopologyHelper::RingTopologyHelper(uint32_t nSnics, uint32_t nHosts, uint32_
     // NS_LOG_INFO("m_snics helper: " << m_snics);
     m_snic_interfaces = ipv4.Assign(m_snics);
 
+    // split the ring in contiguous segments, one scheduler each
+    std::vector<uint32_t> snicShard(nSnics);
+    std::vector<uint32_t> shardScheduler(nShards);
+    for (uint32_t k = 0; k < nShards; ++k)
+    {
+        uint32_t begin = k * nSnics / nShards;
+        uint32_t end = (k + 1) * nSnics / nShards;
+        shardScheduler[k] = (schedulerIdx >= begin && schedulerIdx < end) ? schedulerIdx : begin;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            snicShard[i] = k;
+        }
+    }
+
     // set scheduler
     for (NetDeviceContainer::Iterator i = m_snics.Begin(); i != m_snics.End(); ++i)
     {
         NS_LOG_LOGIC("snic_ptr " << *i);
         NS_LOG_LOGIC("addresses ");
         Ptr<SnicNetDevice> snic = DynamicCast<SnicNetDevice, NetDevice>(*i);
-        snic->SetSchedulerAddress(m_snic_interfaces.GetAddress(schedulerIdx));
-        snic->SetIpAddress(m_snic_interfaces.GetAddress(i - m_snics.Begin()));
+        uint32_t idx = i - m_snics.Begin();
+        snic->SetSchedulerAddress(m_snic_interfaces.GetAddress(shardScheduler[snicShard[idx]]));
+        snic->SetIpAddress(m_snic_interfaces.GetAddress(idx));
+    }
+    for (uint32_t k = 0; k < nShards; ++k)
+    {
+        Ptr<SnicNetDevice> scheduler =
+            DynamicCast<SnicNetDevice, NetDevice>(m_snics.Get(shardScheduler[k]));
+        scheduler->SetIsScheduler(true);
+        m_schedulers.Add(scheduler);
+    }
+
+    if (nShards > 1)
+    {
+        std::vector<Ptr<SnicScheduler>> shards;
+        for (uint32_t k = 0; k < nShards; ++k)
+        {
+            shards.push_back(DynamicCast<SnicNetDevice>(m_schedulers.Get(k))->GetScheduler());
+        }
+        std::vector<uint32_t> nodeShard(NodeList::GetNNodes(), 0);
+        for (uint32_t i = 0; i < nSnics; ++i)
+        {
+            nodeShard[m_snics.Get(i)->GetNode()->GetId()] = snicShard[i];
+        }
+        for (uint32_t k = 0; k < nShards; ++k)
+        {
+            shards[k]->SetShards(k, shards, nodeShard);
+        }
     }
-    DynamicCast<SnicNetDevice, NetDevice>(m_snics.Get(schedulerIdx))->SetIsScheduler(true);
 }
 
 RingTopologyHelper::~RingTopologyHelper()
@@ -130,6 +173,12 @@ RingTopologyHelper::GetSnics() const
     return m_snics;
 }
 
+NetDeviceContainer
+RingTopologyHelper::GetSchedulers() const
+{
+    return m_schedulers;
+}
+
 Ipv4InterfaceContainer
 RingTopologyHelper::GetInterfaces() const
 {
@@ -11,7 +11,18 @@ namespace ns3
 class RingTopologyHelper
 {
   public:
-    RingTopologyHelper(uint32_t nSnics, uint32_t nHosts, uint32_t schedulerIdx);
+    /**
+     * \param nSnics number of sNICs in the ring
+     * \param nHosts number of hosts behind each sNIC
+     * \param schedulerIdx index of the scheduler sNIC
+     * \param nShards number of ring segments, each with its own scheduler.
+     *        The scheduler of a segment is schedulerIdx if it falls in the
+     *        segment, its first sNIC otherwise.
+     */
+    RingTopologyHelper(uint32_t nSnics,
+                       uint32_t nHosts,
+                       uint32_t schedulerIdx,
+                       uint32_t nShards = 1);
     ~RingTopologyHelper();
 
     Ptr<Node> GetNode(uint32_t n);
@@ -19,6 +30,10 @@ class RingTopologyHelper
     NodeContainer GetCsmaSwitches() const;
     NetDeviceContainer GetTerminalDevices() const;
     NetDeviceContainer GetSnics() const;
+    /**
+     * \return the scheduler sNIC of every shard
+     */
+    NetDeviceContainer GetSchedulers() const;
     Ipv4InterfaceContainer GetInterfaces() const;
     Ipv4InterfaceContainer GetSnicInterfaces() const;
     CsmaHelper GetCsmaHelper() const;
@@ -33,6 +48,8 @@ class RingTopologyHelper
     NetDeviceContainer m_snics;
     // List of Nodes for switch
     NodeContainer m_csmaSwitches;
+    // scheduler sNIC of every shard
+    NetDeviceContainer m_schedulers;
 
     Ipv4InterfaceContainer m_interfaces;
     Ipv4InterfaceContainer m_snic_interfaces;
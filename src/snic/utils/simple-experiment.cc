@@ -5,6 +5,7 @@
 #include "ns3/csma-module.h"
 #include "ns3/internet-module.h"
 #include "ns3/network-module.h"
+#include "ns3/packet-arrival-rate-trace-gen.h"
 #include "ns3/ring-topology.h"
 #include "ns3/snic-helper.h"
 #include "ns3/snic-net-device.h"
@@ -91,13 +92,12 @@ SimpleExperiment::Initialize(std::map<std::string, std::vector<Ptr<AttributeValu
 
     for (const auto& kv : variables)
     {
-        std::string varName = kv.GetName();
-        std::vector<Ptr<AttributeValue>> values = kv.GetValues();
         workloadClient.SetAttribute(kv.first, *kv.second[indexes[kv.first]]);
-        outputFile << kv.first << ":" << (*kv.second[indexes[kv.first]]).SerializeToString()
-                   << "\n";
+        outputFile << kv.first << ":" << indexes[kv.first] << "\n";
     }
     outputFile << "done\n";
+    // the server appends its summary once the simulation below is over
+    outputFile.close();
 
     // workloadClient.SetAttribute("Gen", FileGen("trace.txt"));
 
@@ -105,7 +105,12 @@ SimpleExperiment::Initialize(std::map<std::string, std::vector<Ptr<AttributeValu
     ApplicationContainer clientApps2 = workloadClient.Install(terminals.Get(1));
     Ptr<SnicWorkloadClient> client =
         DynamicCast<SnicWorkloadClient, Application>(clientApps2.Get(0));
-    Ptr<PacketArrivalRateGen> gen = Create<PacketArrivalRateFileGen>("trace.txt");
+    if (!m_trace)
+    {
+        m_trace = ArrivalTrace::Open("trace.txt");
+    }
+    Ptr<PacketArrivalRateTraceGen> gen = CreateObject<PacketArrivalRateTraceGen>();
+    gen->SetTrace(m_trace);
     NS_LOG_DEBUG("gen");
     client->SetPktGen(gen);
 
@@ -147,6 +152,14 @@ SimpleExperiment::Initialize(std::map<std::string, std::vector<Ptr<AttributeValu
     // NS_ASSERT(m_initialized);
     NS_LOG_INFO("Run Simulation.");
     Simulator::Run();
+
+    // what the scheduler decisions cost goes along with the server summary
+    Ptr<SnicNetDevice> scheduler =
+        DynamicCast<SnicNetDevice, NetDevice>(ringHelper.GetSchedulers().Get(0));
+    outputFile.open(m_outputFileName, std::ofstream::app);
+    scheduler->GetScheduler()->PrintStatistics(outputFile);
+    outputFile.close();
+
     Simulator::Destroy();
     NS_LOG_INFO("Done.");
 }
@@ -155,4 +168,10 @@ void
 SimpleExperiment::Run()
 {
 }
+
+void
+SimpleExperiment::SetArrivalTrace(Ptr<ArrivalTrace> trace)
+{
+    m_trace = trace;
+}
 } // namespace ns3
@@ -1,6 +1,7 @@
 #ifndef SIMPLE_EXPERIMENT_H
 #define SIMPLE_EXPERIMENT_H
 
+#include "ns3/arrival-trace.h"
 #include "ns3/experiment.h"
 #include "ns3/object.h"
 #include "ns3/simulator.h"
@@ -18,7 +19,14 @@ class SimpleExperiment : public Experiment
                             std::map<std::string, uint32_t> indexes) override;
     virtual void Run() override;
 
+    /**
+     * \param trace the arrival trace of the client, shared between the
+     *        experiments of a benchmark
+     */
+    void SetArrivalTrace(Ptr<ArrivalTrace> trace);
+
   private:
+    Ptr<ArrivalTrace> m_trace;
 };
 
 } // namespace ns3
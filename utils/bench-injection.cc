@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2023 UCSD WukLab, San Diego, USA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/core-module.h"
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace ns3;
+
+/** Log to std::cout */
+#define LOG(x) std::cout << x << std::endl
+
+/**
+ * Benchmark of the events scheduled by other threads than the main one.
+ *
+ * The main thread runs a chain of events, each scheduling the next one,
+ * while the producer threads schedule events with a context as fast as
+ * they can, like the readers of emulation devices do. The run goes on
+ * until the chain and the injected events have all run.
+ */
+class InjectionBench
+{
+  public:
+    /** The output. */
+    struct Result
+    {
+        double injection; /**< Time (s) the producers took to schedule their events. */
+        double run;       /**< Time (s) of the whole run. */
+        uint64_t local;   /**< Events of the chain. */
+        uint64_t remote;  /**< Events scheduled by the producers. */
+    };
+
+    /**
+     * Run the benchmark.
+     *
+     * \param [in] producers The number of producer threads.
+     * \param [in] perProducer The events scheduled by each producer.
+     * \param [in] local The events of the chain.
+     * \returns The Result.
+     */
+    Result Run(uint32_t producers, uint64_t perProducer, uint64_t local);
+
+  private:
+    /** Event of the chain, schedules the next one. */
+    void Local();
+    /** Event scheduled by a producer. */
+    void Remote();
+    /**
+     * Body of a producer thread.
+     *
+     * \param [in] context The context of its events.
+     * \param [in] n The number of events to schedule.
+     */
+    void Produce(uint32_t context, uint64_t n);
+
+    uint64_t m_localTotal;        /**< Events of the chain to run. */
+    uint64_t m_remoteTotal;       /**< Events of the producers to run. */
+    uint64_t m_localCount;        /**< Events of the chain run so far. */
+    uint64_t m_remoteCount;       /**< Events of the producers run so far. */
+    std::atomic<bool> m_go;       /**< Set to start the producers. */
+    std::atomic<uint32_t> m_done; /**< Producers done. */
+};
+
+void
+InjectionBench::Local()
+{
+    m_localCount++;
+    if (m_localCount < m_localTotal || m_remoteCount < m_remoteTotal)
+    {
+        Simulator::Schedule(NanoSeconds(1), &InjectionBench::Local, this);
+    }
+}
+
+void
+InjectionBench::Remote()
+{
+    m_remoteCount++;
+}
+
+void
+InjectionBench::Produce(uint32_t context, uint64_t n)
+{
+    while (!m_go.load())
+    {
+        std::this_thread::yield();
+    }
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        Simulator::ScheduleWithContext(context, Seconds(0), &InjectionBench::Remote, this);
+    }
+    m_done++;
+}
+
+InjectionBench::Result
+InjectionBench::Run(uint32_t producers, uint64_t perProducer, uint64_t local)
+{
+    m_localTotal = local;
+    m_remoteTotal = producers * perProducer;
+    m_localCount = 0;
+    m_remoteCount = 0;
+    m_go = false;
+    m_done = 0;
+
+    Simulator::Schedule(NanoSeconds(1), &InjectionBench::Local, this);
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < producers; ++i)
+    {
+        threads.emplace_back(&InjectionBench::Produce, this, i, perProducer);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    double injection = 0;
+    m_go = true;
+    std::thread timer([this, producers, start, &injection]() {
+        while (m_done.load() < producers)
+        {
+            std::this_thread::yield();
+        }
+        auto end = std::chrono::steady_clock::now();
+        injection = std::chrono::duration<double>(end - start).count();
+    });
+    Simulator::Run();
+    auto end = std::chrono::steady_clock::now();
+    timer.join();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    Simulator::Destroy();
+
+    double run = std::chrono::duration<double>(end - start).count();
+    return Result{injection, run, m_localCount, m_remoteCount};
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t producers = 4;
+    uint64_t perProducer = 250000;
+    uint64_t local = 1000000;
+
+    CommandLine cmd(__FILE__);
+    cmd.Usage("Benchmark the events scheduled by other threads than the main one.\n"
+              "\n"
+              "Compares the rate of the main thread running a chain of events alone\n"
+              "and while the producers schedule their events.");
+    cmd.AddValue("producers", "number of producer threads", producers);
+    cmd.AddValue("events", "events scheduled by each producer", perProducer);
+    cmd.AddValue("local", "events of the chain run by the main thread", local);
+    cmd.Parse(argc, argv);
+
+    InjectionBench bench;
+    InjectionBench::Result alone = bench.Run(0, 0, local);
+    InjectionBench::Result loaded = bench.Run(producers, perProducer, local);
+
+    LOG(std::setprecision(4));
+    LOG(cmd.GetName() << ": " << producers << " producers of " << perProducer << " events, "
+                      << local << " events of the chain");
+    LOG("  main thread alone:     " << alone.local / alone.run << " ev/s");
+    LOG("  with the producers:    " << (loaded.local + loaded.remote) / loaded.run << " ev/s, "
+                                    << loaded.remote << " injected, " << loaded.local
+                                    << " of the chain");
+    LOG("  injection:             " << loaded.remote / loaded.injection << " ev/s over "
+                                    << loaded.injection << " s");
+    LOG("  main loop overhead:    "
+        << (loaded.run / (loaded.local + loaded.remote) - alone.run / alone.local) * 1e9
+        << " ns/ev");
+    return 0;
+}
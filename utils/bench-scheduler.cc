@@ -107,6 +107,8 @@ class Bench
         double simu;     /**< Time (s) for simulation. */
         uint64_t pop;    /**< Event population. */
         uint64_t events; /**< Number of events executed. */
+        uint64_t initAllocs; /**< Events taken from the heap during initialization. */
+        uint64_t simuAllocs; /**< Events taken from the heap during simulation. */
     };
 
     /**
@@ -140,6 +142,7 @@ Bench::Run()
     DEB("initializing");
     m_count = 0;
 
+    uint64_t allocs = EventImpl::GetNHeapAllocations();
     timer.Start();
     for (uint64_t i = 0; i < m_population; ++i)
     {
@@ -147,17 +150,20 @@ Bench::Run()
         Simulator::Schedule(at, &Bench::Cb, this);
     }
     init = timer.End() / 1000.0;
+    uint64_t initAllocs = EventImpl::GetNHeapAllocations() - allocs;
     DEB("initialization took " << init << "s");
 
     DEB("running");
+    allocs = EventImpl::GetNHeapAllocations();
     timer.Start();
     Simulator::Run();
     simu = timer.End() / 1000.0;
+    uint64_t simuAllocs = EventImpl::GetNHeapAllocations() - allocs;
     DEB("run took " << simu << "s");
 
     Simulator::Destroy();
 
-    return Result{init, simu, m_population, m_count};
+    return Result{init, simu, m_population, m_count, initAllocs, simuAllocs};
 }
 
 void
@@ -193,13 +199,15 @@ class BenchSuite
      * \param [in] runs The number of replications.
      * \param [in] eventStream The random stream of event delays.
      * \param [in] calRev For the CalendarScheduler, whether the Reverse attribute was set.
+     * \param [in] pool Whether the events are recycled.
      */
     BenchSuite(ObjectFactory& factory,
                uint64_t pop,
                uint64_t total,
                uint64_t runs,
                Ptr<RandomVariableStream> eventStream,
-               bool calRev);
+               bool calRev,
+               bool pool);
 
     /** Write the results to \c LOG() */
     void Log() const;
@@ -214,6 +222,7 @@ class BenchSuite
         double time;   /**< Phase run time time (s). */
         double rate;   /**< Phase event rate (events/s). */
         double period; /**< Phase period (s/event). */
+        double allocs; /**< Events taken from the heap per event executed. */
     };
 
     /** Results from initialization and execution of a single run. */
@@ -248,8 +257,8 @@ class BenchSuite
 BenchSuite::Result
 BenchSuite::Result::Bench(Bench::Result r)
 {
-    return Result{{r.init, r.pop / r.init, r.init / r.pop},
-                  {r.simu, r.events / r.simu, r.simu / r.events}};
+    return Result{{r.init, r.pop / r.init, r.init / r.pop, double(r.initAllocs) / r.pop},
+                  {r.simu, r.events / r.simu, r.simu / r.events, double(r.simuAllocs) / r.events}};
 }
 
 template <typename T>
@@ -260,8 +269,9 @@ BenchSuite::Result::Log(T label) const
 
     LOG(std::left << std::setw(g_fwidth) << label << std::setw(g_fwidth) << init.time
                   << std::setw(g_fwidth) << init.rate << std::setw(g_fwidth) << init.period
-                  << std::setw(g_fwidth) << run.time << std::setw(g_fwidth) << run.rate
-                  << std::setw(g_fwidth) << run.period);
+                  << std::setw(g_fwidth) << init.allocs << std::setw(g_fwidth) << run.time
+                  << std::setw(g_fwidth) << run.rate << std::setw(g_fwidth) << run.period
+                  << std::setw(g_fwidth) << run.allocs);
 }
 
 BenchSuite::BenchSuite(ObjectFactory& factory,
@@ -269,8 +279,10 @@ BenchSuite::BenchSuite(ObjectFactory& factory,
                        uint64_t total,
                        uint64_t runs,
                        Ptr<RandomVariableStream> eventStream,
-                       bool calRev)
+                       bool calRev,
+                       bool pool)
 {
+    GlobalValue::Bind("EventPoolEnabled", BooleanValue(pool));
     Simulator::SetScheduler(factory);
 
     m_scheduler = factory.GetTypeId().GetName();
@@ -282,6 +294,13 @@ BenchSuite::BenchSuite(ObjectFactory& factory,
     {
         m_scheduler += " (default)";
     }
+    if (m_scheduler == "ns3::DaryHeapScheduler")
+    {
+        UintegerValue arity;
+        factory.Create()->GetAttribute("Arity", arity);
+        m_scheduler += ": arity " + std::to_string(arity.Get());
+    }
+    m_scheduler += pool ? ", pooled events" : ", events from the heap";
 
     Bench bench(pop, total);
     bench.SetRandomStream(eventStream);
@@ -314,18 +333,21 @@ BenchSuite::Header() const
     // table header
     LOG("");
     LOG(m_scheduler);
-    LOG(std::left << std::setw(g_fwidth) << "Run #" << std::left << std::setw(3 * g_fwidth)
+    LOG(std::left << std::setw(g_fwidth) << "Run #" << std::left << std::setw(4 * g_fwidth)
                   << "Initialization:" << std::left << "Simulation:");
     LOG(std::left << std::setw(g_fwidth) << "" << std::left << std::setw(g_fwidth) << "Time (s)"
                   << std::left << std::setw(g_fwidth) << "Rate (ev/s)" << std::left
                   << std::setw(g_fwidth) << "Per (s/ev)" << std::left << std::setw(g_fwidth)
-                  << "Time (s)" << std::left << std::setw(g_fwidth) << "Rate (ev/s)" << std::left
-                  << "Per (s/ev)");
+                  << "Allocs/ev" << std::left << std::setw(g_fwidth) << "Time (s)" << std::left
+                  << std::setw(g_fwidth) << "Rate (ev/s)" << std::left << std::setw(g_fwidth)
+                  << "Per (s/ev)" << std::left << "Allocs/ev");
     LOG(std::setfill('-') << std::right << std::setw(g_fwidth) << " " << std::right
                           << std::setw(g_fwidth) << " " << std::right << std::setw(g_fwidth) << " "
                           << std::right << std::setw(g_fwidth) << " " << std::right
                           << std::setw(g_fwidth) << " " << std::right << std::setw(g_fwidth) << " "
-                          << std::right << std::setw(g_fwidth) << " " << std::setfill(' '));
+                          << std::right << std::setw(g_fwidth) << " " << std::right
+                          << std::setw(g_fwidth) << " " << std::right << std::setw(g_fwidth) << " "
+                          << std::setfill(' '));
 }
 
 void
@@ -345,8 +367,8 @@ BenchSuite::Log() const
 
     uint64_t n{0};                // number of samples
     Result average{m_results[0]}; // average
-    Result moment2{{0, 0, 0},     // 2nd moment, to calculate stdev
-                   {0, 0, 0}};
+    Result moment2{{0, 0, 0, 0},  // 2nd moment, to calculate stdev
+                   {0, 0, 0, 0}};
 
     for (; n < m_results.size(); ++n)
     {
@@ -364,19 +386,23 @@ BenchSuite::Log() const
         ACCUMULATE(init, time);
         ACCUMULATE(init, rate);
         ACCUMULATE(init, period);
+        ACCUMULATE(init, allocs);
         ACCUMULATE(run, time);
         ACCUMULATE(run, rate);
         ACCUMULATE(run, period);
+        ACCUMULATE(run, allocs);
 
 #undef ACCUMULATE
     }
 
     auto stdev = Result{{std::sqrt(moment2.init.time / n),
                          std::sqrt(moment2.init.rate / n),
-                         std::sqrt(moment2.init.period / n)},
+                         std::sqrt(moment2.init.period / n),
+                         std::sqrt(moment2.init.allocs / n)},
                         {std::sqrt(moment2.run.time / n),
                          std::sqrt(moment2.run.rate / n),
-                         std::sqrt(moment2.run.period / n)}};
+                         std::sqrt(moment2.run.period / n),
+                         std::sqrt(moment2.run.allocs / n)}};
 
     average.Log("average");
     stdev.Log("stdev");
@@ -449,12 +475,45 @@ GetRandomStream(std::string filename)
     return stream;
 }
 
+/**
+ *  Run the benchmarks of a scheduler with pooled events, without, or both.
+ *
+ * \param [in] factory Factory pre-configured to create the desired Scheduler.
+ * \param [in] pop The event population size.
+ * \param [in] total The total number of events to execute.
+ * \param [in] runs The number of replications.
+ * \param [in] eventStream The random stream of event delays.
+ * \param [in] calRev For the CalendarScheduler, whether the Reverse attribute was set.
+ * \param [in] pool 1 to recycle the events, 0 not to, 2 to run both.
+ */
+void
+RunBenchSuites(ObjectFactory& factory,
+               uint64_t pop,
+               uint64_t total,
+               uint64_t runs,
+               Ptr<RandomVariableStream> eventStream,
+               bool calRev,
+               int pool)
+{
+    if (pool != 0)
+    {
+        BenchSuite(factory, pop, total, runs, eventStream, calRev, true).Log();
+    }
+    if (pool != 1)
+    {
+        BenchSuite(factory, pop, total, runs, eventStream, calRev, false).Log();
+    }
+}
+
 int
 main(int argc, char* argv[])
 {
     bool allSched = false;
+    bool schedAdaptive = false;
     bool schedCal = false;
+    bool schedDary = false;
     bool schedHeap = false;
+    bool schedLadder = false;
     bool schedList = false;
     bool schedMap = false; // default scheduler
     bool schedPQ = false;
@@ -464,6 +523,7 @@ main(int argc, char* argv[])
     uint64_t runs = 1;
     std::string filename = "";
     bool calRev = false;
+    int pool = 1;
 
     CommandLine cmd(__FILE__);
     cmd.Usage("Benchmark the simulator scheduler.\n"
@@ -475,11 +535,17 @@ main(int argc, char* argv[])
               "In the case of either --file form, the input is expected\n"
               "to be ascii, giving the relative event times in ns.\n"
               "\n"
-              "If no scheduler is specified the MapScheduler will be run.");
+              "If no scheduler is specified the MapScheduler will be run.\n"
+              "\n"
+              "Allocs/ev counts the events taken from the heap rather than\n"
+              "from the free lists, per event.");
     cmd.AddValue("all", "use all schedulers", allSched);
+    cmd.AddValue("adaptive", "use AdaptiveScheduler", schedAdaptive);
     cmd.AddValue("cal", "use CalendarSheduler", schedCal);
     cmd.AddValue("calrev", "reverse ordering in the CalendarScheduler", calRev);
+    cmd.AddValue("dary", "use DaryHeapScheduler, 4-ary and 8-ary", schedDary);
     cmd.AddValue("heap", "use HeapScheduler", schedHeap);
+    cmd.AddValue("ladder", "use LadderScheduler", schedLadder);
     cmd.AddValue("list", "use ListSheduler", schedList);
     cmd.AddValue("map", "use MapScheduler (default)", schedMap);
     cmd.AddValue("pri", "use PriorityQueue", schedPQ);
@@ -489,6 +555,7 @@ main(int argc, char* argv[])
     cmd.AddValue("runs", "number of runs", runs);
     cmd.AddValue("file", "file of relative event times", filename);
     cmd.AddValue("prec", "printed output precision", g_fwidth);
+    cmd.AddValue("pool", "recycle the events: 0 no, 1 yes, 2 run both", pool);
     cmd.Parse(argc, argv);
 
     g_me = cmd.GetName() + ": ";
@@ -499,14 +566,17 @@ main(int argc, char* argv[])
     LOG("  Event population size:        " << pop);
     LOG("  Total events per run:         " << total);
     LOG("  Number of runs per scheduler: " << runs);
+    LOG("  Event pooling:                " << (pool == 2 ? "both" : pool ? "on" : "off"));
     DEB("debugging is ON");
 
     if (allSched)
     {
-        schedCal = schedHeap = schedList = schedMap = schedPQ = true;
+        schedAdaptive = schedCal = schedDary = schedHeap = schedLadder = schedList = schedMap =
+            schedPQ = true;
     }
     // Set the default case if nothing else is set
-    if (!(schedCal || schedHeap || schedList || schedMap || schedPQ))
+    if (!(schedAdaptive || schedCal || schedDary || schedHeap || schedLadder || schedList ||
+          schedMap || schedPQ))
     {
         schedMap = true;
     }
@@ -518,17 +588,35 @@ main(int argc, char* argv[])
     {
         factory.SetTypeId("ns3::CalendarScheduler");
         factory.Set("Reverse", BooleanValue(calRev));
-        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+        RunBenchSuites(factory, pop, total, runs, eventStream, calRev, pool);
         if (allSched)
         {
             factory.Set("Reverse", BooleanValue(!calRev));
-            BenchSuite(factory, pop, total, runs, eventStream, !calRev).Log();
+            RunBenchSuites(factory, pop, total, runs, eventStream, !calRev, pool);
         }
     }
+    if (schedDary)
+    {
+        factory.SetTypeId("ns3::DaryHeapScheduler");
+        factory.Set("Arity", UintegerValue(4));
+        RunBenchSuites(factory, pop, total, runs, eventStream, calRev, pool);
+        factory.Set("Arity", UintegerValue(8));
+        RunBenchSuites(factory, pop, total, runs, eventStream, calRev, pool);
+    }
     if (schedHeap)
     {
         factory.SetTypeId("ns3::HeapScheduler");
-        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+        RunBenchSuites(factory, pop, total, runs, eventStream, calRev, pool);
+    }
+    if (schedLadder)
+    {
+        factory.SetTypeId("ns3::LadderScheduler");
+        RunBenchSuites(factory, pop, total, runs, eventStream, calRev, pool);
+    }
+    if (schedAdaptive)
+    {
+        factory.SetTypeId("ns3::AdaptiveScheduler");
+        RunBenchSuites(factory, pop, total, runs, eventStream, calRev, pool);
     }
     if (schedList)
     {
@@ -539,17 +627,17 @@ main(int argc, char* argv[])
             LOG("Running List scheduler with 1/10 total events");
             listTotal /= 10;
         }
-        BenchSuite(factory, pop, listTotal, runs, eventStream, calRev).Log();
+        RunBenchSuites(factory, pop, listTotal, runs, eventStream, calRev, pool);
     }
     if (schedMap)
     {
         factory.SetTypeId("ns3::MapScheduler");
-        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+        RunBenchSuites(factory, pop, total, runs, eventStream, calRev, pool);
     }
     if (schedPQ)
     {
         factory.SetTypeId("ns3::PriorityQueueScheduler");
-        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+        RunBenchSuites(factory, pop, total, runs, eventStream, calRev, pool);
     }
 
     return 0;